@@ -0,0 +1,4 @@
+// Depth pre-pass: depth comes from the rasterizer, nothing is shaded
+void main()
+{
+}
@@ -16,26 +16,36 @@ cbuffer PostProcessParams : register(b0, space3)
     float saturation;   // Default: 1.0, range: 0 to 2.0
     float vignette;     // Default: 0.0, range: 0 to 1.0
     float fxaa_enabled; // 0.0 or 1.0
-    float res_x;        // Screen resolution X for FXAA
-    float res_y;        // Screen resolution Y for FXAA
+    float res_x;        // Scene texture resolution X for FXAA
+    float res_y;        // Scene texture resolution Y for FXAA
+    float2 uv_scale;    // Part of the scene texture the scene covers
+    float2 padding;
 };
 
 Texture2D scene_texture : register(t0, space2);
 SamplerState scene_sampler : register(s0, space2);
 
+// Scene sample clamped to the rendered part of the texture, so filtering
+// never reads texels a scaled-down scene left untouched
+float3 sample_scene(float2 uv)
+{
+    float2 uv_max = uv_scale - 0.5 / float2(res_x, res_y);
+    return scene_texture.Sample(scene_sampler, min(uv, uv_max)).rgb;
+}
+
 // Working FXAA implementation
 float3 apply_fxaa(float2 uv, float2 texel_size)
 {
     // Sample neighbors
-    float3 center = scene_texture.Sample(scene_sampler, uv).rgb;
-    float3 n = scene_texture.Sample(scene_sampler, uv + float2(0.0, -texel_size.y)).rgb;
-    float3 s = scene_texture.Sample(scene_sampler, uv + float2(0.0, texel_size.y)).rgb;
-    float3 e = scene_texture.Sample(scene_sampler, uv + float2(texel_size.x, 0.0)).rgb;
-    float3 w = scene_texture.Sample(scene_sampler, uv + float2(-texel_size.x, 0.0)).rgb;
-    float3 nw = scene_texture.Sample(scene_sampler, uv + float2(-texel_size.x, -texel_size.y)).rgb;
-    float3 ne = scene_texture.Sample(scene_sampler, uv + float2(texel_size.x, -texel_size.y)).rgb;
-    float3 sw = scene_texture.Sample(scene_sampler, uv + float2(-texel_size.x, texel_size.y)).rgb;
-    float3 se = scene_texture.Sample(scene_sampler, uv + float2(texel_size.x, texel_size.y)).rgb;
+    float3 center = sample_scene(uv);
+    float3 n = sample_scene(uv + float2(0.0, -texel_size.y));
+    float3 s = sample_scene(uv + float2(0.0, texel_size.y));
+    float3 e = sample_scene(uv + float2(texel_size.x, 0.0));
+    float3 w = sample_scene(uv + float2(-texel_size.x, 0.0));
+    float3 nw = sample_scene(uv + float2(-texel_size.x, -texel_size.y));
+    float3 ne = sample_scene(uv + float2(texel_size.x, -texel_size.y));
+    float3 sw = sample_scene(uv + float2(-texel_size.x, texel_size.y));
+    float3 se = sample_scene(uv + float2(texel_size.x, texel_size.y));
     
     // Luminance
     const float3 luma_weights = float3(0.299, 0.587, 0.114);
@@ -91,11 +101,11 @@ float3 apply_fxaa(float2 uv, float2 texel_size)
     float2 uv4 = uv + offset * 1.0;
     float2 uv5 = uv - offset * 0.25;
     
-    float3 sample1 = scene_texture.Sample(scene_sampler, uv1).rgb;
-    float3 sample2 = scene_texture.Sample(scene_sampler, uv2).rgb;
-    float3 sample3 = scene_texture.Sample(scene_sampler, uv3).rgb;
-    float3 sample4 = scene_texture.Sample(scene_sampler, uv4).rgb;
-    float3 sample5 = scene_texture.Sample(scene_sampler, uv5).rgb;
+    float3 sample1 = sample_scene(uv1);
+    float3 sample2 = sample_scene(uv2);
+    float3 sample3 = sample_scene(uv3);
+    float3 sample4 = sample_scene(uv4);
+    float3 sample5 = sample_scene(uv5);
     
     // Blend samples (weighted towards center samples)
     float3 result = (sample1 * 0.2 + sample2 * 0.3 + sample3 * 0.3 + sample4 * 0.1 + sample5 * 0.1);
@@ -112,7 +122,10 @@ float3 apply_fxaa(float2 uv, float2 texel_size)
 
 float4 main(PixelInput input) : SV_Target0
 {
-    float2 uv = input.texcoord;
+    // Screen position for screen-space effects, texture position for the
+    // scene, which may cover only part of its texture
+    float2 screen_uv = input.texcoord;
+    float2 uv = screen_uv * uv_scale;
     float2 resolution = float2(res_x, res_y);
     float2 texel_size = 1.0 / resolution;
     
@@ -124,7 +137,7 @@ float4 main(PixelInput input) : SV_Target0
     }
     else
     {
-        color = scene_texture.Sample(scene_sampler, uv).rgb;
+        color = sample_scene(uv);
     }
     
     // Apply brightness (additive)
@@ -140,7 +153,7 @@ float4 main(PixelInput input) : SV_Target0
     // Apply vignette
     if (vignette > 0.001)
     {
-        float2 center_dist = uv - 0.5;
+        float2 center_dist = screen_uv - 0.5;
         float dist = length(center_dist) * 1.414; // Normalize to corner = 1.0
         float vig = 1.0 - smoothstep(0.5, 1.2, dist) * vignette;
         color *= vig;
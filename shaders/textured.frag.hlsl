@@ -2,23 +2,50 @@ struct PixelInput
 {
     float3 normal : NORMAL;
     float2 texcoord : TEXCOORD;
+    nointerpolation uint material : MATERIAL;
 };
 
-Texture2D tex : register(t0, space2);
+// Matches gpu_material in renderer.hpp
+struct Material
+{
+    float4 base_color;
+    float3 emissive;
+    float alpha_cutoff; // Alpha-tested and blended materials only
+    float metallic;
+    float roughness;
+    float unlit; // 1 skips lighting
+    uint layer;  // Slice of the base texture array
+};
+
+// Every base texture is an array; small textures of one size share one
+Texture2DArray tex : register(t0, space2);
 SamplerState samp : register(s0, space2);
 
+// Material table shared by every textured draw, indexed per draw
+StructuredBuffer<Material> materials : register(t1, space2);
+
 float4 main(PixelInput input) : SV_Target0
 {
-    float4 tex_color = tex.Sample(samp, input.texcoord);
-    
-    // Alpha test - discard transparent pixels
-    if (tex_color.a < 0.5)
+    Material material = materials[input.material];
+    float4 color = tex.Sample(samp, float3(input.texcoord, material.layer)) *
+                   material.base_color;
+
+#ifdef ALPHA
+    // Alpha-tested and blended materials. Opaque ones build without discard
+    // so the GPU can reject hidden fragments before shading them.
+    if (color.a < material.alpha_cutoff)
         discard;
-    
+#endif
+
     // Simple lighting
     float3 light_dir = normalize(float3(0.5, 1.0, 0.3));
     float ndotl = max(dot(normalize(input.normal), light_dir), 0.0);
-    float light = 0.4 + ndotl * 0.6;
-    
-    return float4(tex_color.rgb * light, 1.0);
+    float light = lerp(0.4 + ndotl * 0.6, 1.0, material.unlit);
+    float3 rgb = color.rgb * light + material.emissive;
+
+#ifdef ALPHA
+    return float4(rgb, color.a);
+#else
+    return float4(rgb, 1.0);
+#endif
 }
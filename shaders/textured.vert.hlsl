@@ -1,27 +1,102 @@
+#if defined(DEPTH_ONLY) && defined(PACKED_VERTEX)
+// Depth pre-pass: only the position of the interleaved vertex is read
+struct VertexInput
+{
+    float4 position : POSITION;
+};
+#elif defined(DEPTH_ONLY)
+struct VertexInput
+{
+    float3 position : POSITION;
+};
+#elif defined(PACKED_VERTEX)
+// Quantized vertex: unorm16 position in the model bounds (w = 1) that the
+// MVP matrix maps back to model space, octahedral snorm16 normal and
+// half-float texture coordinates
+struct VertexInput
+{
+    float4 position : POSITION;
+    float2 normal : NORMAL;
+    float2 texcoord : TEXCOORD;
+};
+#else
 struct VertexInput
 {
     float3 position : POSITION;
     float3 normal : NORMAL;
     float2 texcoord : TEXCOORD;
 };
+#endif
 
+#ifdef DEPTH_ONLY
+struct VertexOutput
+{
+    float4 position : SV_Position;
+};
+#else
 struct VertexOutput
 {
     float4 position : SV_Position;
     float3 normal : NORMAL;
     float2 texcoord : TEXCOORD;
+    nointerpolation uint material : MATERIAL;
 };
+#endif
 
+#ifdef INSTANCED
+// Per-instance MVP matrices for the whole frame
+StructuredBuffer<float4x4> instances : register(t0, space0);
+
+cbuffer UniformBlock : register(b0, space1)
+{
+    uint base_instance; // First matrix of this draw in the instance buffer
+    uint material;      // Index into the material table
+};
+#else
 cbuffer UniformBlock : register(b0, space1)
 {
     float4x4 mvp;
+    uint material; // Index into the material table
 };
+#endif
+
+#if defined(PACKED_VERTEX) && !defined(DEPTH_ONLY)
+float3 octahedral_decode(float2 e)
+{
+    float3 n = float3(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+#endif
 
+#ifdef INSTANCED
+VertexOutput main(VertexInput input, uint instance_id : SV_InstanceID)
+{
+    float4x4 mvp = instances[base_instance + instance_id];
+#else
 VertexOutput main(VertexInput input)
 {
+#endif
+    // Precise, so the pre-pass and the color pass produce the same depth
+    // for the equal test
+#ifdef PACKED_VERTEX
+    precise float4 position = mul(mvp, input.position);
+#else
+    precise float4 position = mul(mvp, float4(input.position, 1.0));
+#endif
+
     VertexOutput output;
-    output.position = mul(mvp, float4(input.position, 1.0));
+    output.position = position;
+#ifndef DEPTH_ONLY
+#ifdef PACKED_VERTEX
+    output.normal = octahedral_decode(input.normal);
+#else
     output.normal = input.normal;
+#endif
     output.texcoord = input.texcoord;
+    output.material = material;
+#endif
     return output;
 }
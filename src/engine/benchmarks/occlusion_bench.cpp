@@ -0,0 +1,192 @@
+/// @file occlusion_bench.cpp
+/// @brief Software occlusion culling: rasterization cost and box test
+/// throughput for a street of buildings at increasing occluder detail
+
+#include "occlusion.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+constexpr std::uint32_t k_width   = 256;
+constexpr std::uint32_t k_height  = 144;
+constexpr std::uint32_t k_queries = 1u << 16;
+constexpr std::uint32_t k_rounds  = 5;
+
+/// Mesh in world space; the benchmark passes the view-projection as MVP
+struct mesh final
+{
+    std::vector<glm::vec3>     positions;
+    std::vector<std::uint32_t> indices;
+};
+
+/// Axis-aligned box with each face split into n x n quads
+void add_box(mesh& out, glm::vec3 min, glm::vec3 max, std::uint32_t n)
+{
+    const glm::vec3 size = max - min;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const int u = (axis + 1) % 3;
+        const int v = (axis + 2) % 3;
+        for (const float side : { 0.0f, 1.0f })
+        {
+            const auto base = static_cast<std::uint32_t>(out.positions.size());
+            for (std::uint32_t j = 0; j <= n; ++j)
+            {
+                for (std::uint32_t i = 0; i <= n; ++i)
+                {
+                    glm::vec3 p = min;
+                    p[axis] += side * size[axis];
+                    p[u] += size[u] * static_cast<float>(i) /
+                            static_cast<float>(n);
+                    p[v] += size[v] * static_cast<float>(j) /
+                            static_cast<float>(n);
+                    out.positions.push_back(p);
+                }
+            }
+            for (std::uint32_t j = 0; j < n; ++j)
+            {
+                for (std::uint32_t i = 0; i < n; ++i)
+                {
+                    const auto a = base + (j * (n + 1)) + i;
+                    const auto b = a + 1;
+                    const auto c = a + n + 1;
+                    const auto d = c + 1;
+                    out.indices.insert(out.indices.end(), { a, b, d, a, d, c });
+                }
+            }
+        }
+    }
+}
+
+/// Best-of-rounds milliseconds to set up and rasterize every occluder
+double rasterize(egen::occlusion_buffer&  buffer,
+                 const std::vector<mesh>& occluders,
+                 const glm::mat4&         view_proj)
+{
+    double best = 1e30;
+    for (std::uint32_t round = 0; round < k_rounds; ++round)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        buffer.clear();
+        for (const auto& o : occluders)
+        {
+            buffer.add_occluder(o.positions, o.indices, view_proj);
+        }
+        for (std::size_t i = 0; i < buffer.occluder_count(); ++i)
+        {
+            buffer.setup_occluder(i);
+        }
+        for (std::size_t b = 0; b < buffer.band_count(); ++b)
+        {
+            buffer.rasterize_band(b);
+        }
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+/// Buildings on both sides of a street and across its far end, seen from
+/// street level; props are scattered over the whole block
+bool run(std::uint32_t subdivisions)
+{
+    std::vector<mesh> occluders;
+    for (int i = 0; i < 8; ++i)
+    {
+        const float z = -10.0f - (static_cast<float>(i) * 12.0f);
+        for (const float x : { -14.0f, 6.0f })
+        {
+            add_box(occluders.emplace_back(),
+                    { x, 0.0f, z - 10.0f },
+                    { x + 8.0f, 20.0f + static_cast<float>(i), z },
+                    subdivisions);
+        }
+    }
+    add_box(occluders.emplace_back(),
+            { -20.0f, 0.0f, -110.0f },
+            { 20.0f, 30.0f, -105.0f },
+            subdivisions);
+
+    const auto view_proj =
+        glm::perspective(glm::radians(60.0f),
+                         static_cast<float>(k_width) /
+                             static_cast<float>(k_height),
+                         0.1f,
+                         500.0f) *
+        glm::lookAt(glm::vec3(0.0f, 1.7f, 0.0f),
+                    glm::vec3(0.0f, 1.7f, -1.0f),
+                    glm::vec3(0.0f, 1.0f, 0.0f));
+
+    egen::occlusion_buffer buffer;
+    buffer.resize(k_width, k_height);
+    const auto raster_ms = rasterize(buffer, occluders, view_proj);
+
+    std::mt19937                          rng(42);
+    std::uniform_real_distribution<float> x(-40.0f, 40.0f);
+    std::uniform_real_distribution<float> z(-200.0f, -2.0f);
+    std::vector<glm::vec3>                centers(k_queries);
+    for (auto& c : centers)
+    {
+        c = { x(rng), 0.5f, z(rng) };
+    }
+
+    double        best     = 1e30;
+    std::uint32_t occluded = 0;
+    for (std::uint32_t round = 0; round < k_rounds; ++round)
+    {
+        occluded         = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& c : centers)
+        {
+            occluded += buffer.occluded(c, glm::vec3(0.5f), view_proj) ? 1 : 0;
+        }
+        const std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() / k_queries);
+    }
+
+    spdlog::info("=> {:>2}x{:<2} quads/face: {:>6} tris, rasterize "
+                 "{:6.3f} ms, test {:6.1f} ns/box, {:4.1f}% occluded",
+                 subdivisions,
+                 subdivisions,
+                 buffer.triangle_count(),
+                 raster_ms,
+                 best,
+                 100.0 * occluded / k_queries);
+
+    // Behind the far wall must be hidden, the open street must not be
+    const bool hidden  = buffer.occluded(
+        { 0.0f, 2.0f, -130.0f }, glm::vec3(1.0f), view_proj);
+    const bool visible = !buffer.occluded(
+        { 0.0f, 2.0f, -50.0f }, glm::vec3(1.0f), view_proj);
+    if (!hidden || !visible)
+    {
+        spdlog::error("== occlusion results are wrong");
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    for (const std::uint32_t subdivisions : { 1u, 4u, 16u, 32u })
+    {
+        if (!run(subdivisions))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
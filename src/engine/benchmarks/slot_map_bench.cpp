@@ -0,0 +1,109 @@
+/// @file slot_map_bench.cpp
+/// @brief Handle lookup throughput: slot_map against std::unordered_map
+
+#include <core-api/slot_map.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+/// Stand-in for a renderer resource record
+struct payload final
+{
+    std::uint64_t id    = 0;
+    float         data[6] {};
+};
+
+constexpr std::uint32_t k_lookups = 1u << 24;
+constexpr std::uint32_t k_rounds  = 5;
+
+/// Best-of-rounds nanoseconds per lookup. The checksum keeps the loop from
+/// being optimised away.
+template <typename Lookup>
+double measure(const std::vector<std::uint64_t>& handles, Lookup lookup)
+{
+    double        best = 1e30;
+    std::uint64_t sum  = 0;
+    for (std::uint32_t round = 0; round < k_rounds; ++round)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::uint32_t i = 0; i < k_lookups; ++i)
+        {
+            sum += lookup(handles[i % handles.size()]);
+        }
+        const std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() / k_lookups);
+    }
+    if (sum == 0)
+    {
+        spdlog::warn("== empty checksum");
+    }
+    return best;
+}
+
+void run(std::uint32_t count)
+{
+    std::unordered_map<std::uint64_t, payload> map;
+    egen::slot_map<payload>                    slots;
+    std::vector<std::uint64_t>                 map_handles;
+    std::vector<std::uint64_t>                 slot_handles;
+
+    // Churn the tables the way loads and unloads would: insert twice the
+    // live count and erase every other entry
+    std::uint64_t next = 1;
+    for (std::uint32_t i = 0; i < count * 2; ++i)
+    {
+        const payload p { .id = next };
+        map.emplace(next++, p);
+        slot_handles.push_back(slots.insert(p));
+    }
+    for (std::uint32_t i = 0; i < count * 2; i += 2)
+    {
+        map.erase(i + 1);
+        slots.erase(slot_handles[i]);
+    }
+    for (const auto& [h, p] : map)
+    {
+        map_handles.push_back(h);
+    }
+    slot_handles.assign(slots.handles().begin(), slots.handles().end());
+
+    // Random access order, as draw calls reference resources
+    std::mt19937_64 rng(42);
+    std::ranges::shuffle(map_handles, rng);
+    std::ranges::shuffle(slot_handles, rng);
+
+    const auto map_ns =
+        measure(map_handles,
+                [&](std::uint64_t h) { return map.find(h)->second.id; });
+    const auto slot_ns = measure(slot_handles,
+                                 [&](std::uint64_t h)
+                                 { return slots.find(h)->id; });
+
+    spdlog::info("=> {:>7} handles: unordered_map {:6.2f} ns, "
+                 "slot_map {:6.2f} ns, {:4.1f}x",
+                 count,
+                 map_ns,
+                 slot_ns,
+                 map_ns / slot_ns);
+}
+
+} // namespace
+
+int main()
+{
+    for (const std::uint32_t count : { 64u, 1024u, 16384u, 262144u })
+    {
+        run(count);
+    }
+    return 0;
+}
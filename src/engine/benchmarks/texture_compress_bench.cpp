@@ -0,0 +1,178 @@
+/// @file texture_compress_bench.cpp
+/// @brief Block compression: encode throughput on one and on all hardware
+/// threads, and the quality of the top level as PSNR per codec
+
+#include "texture_compress.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+constexpr std::int32_t  k_size   = 1024;
+constexpr std::uint32_t k_rounds = 3;
+
+/// Gradients, a smooth wave, a checkerboard and noise, so every codec
+/// meets both flat and busy blocks
+std::vector<std::byte> make_image()
+{
+    const auto             texels = static_cast<std::size_t>(k_size) * k_size;
+    std::vector<std::byte> image(texels * 4);
+    std::mt19937                       rng(42);
+    std::uniform_int_distribution<int> noise(0, 15);
+    for (std::int32_t y = 0; y < k_size; ++y)
+    {
+        for (std::int32_t x = 0; x < k_size; ++x)
+        {
+            const float fx = static_cast<float>(x) / k_size;
+            const float fy = static_cast<float>(y) / k_size;
+            const int   n  = noise(rng);
+
+            const int channels[4] = {
+                static_cast<int>(255.0f * fx) + n,
+                128 + static_cast<int>(100.0f * std::sin(fy * 20.0f)),
+                (((x / 16) + (y / 16)) % 2) * 200 + n,
+                static_cast<int>(255.0f * fy),
+            };
+            auto* texel =
+                &image[((static_cast<std::size_t>(y) * k_size) + x) * 4];
+            for (int c = 0; c < 4; ++c)
+            {
+                texel[c] =
+                    static_cast<std::byte>(std::clamp(channels[c], 0, 255));
+            }
+        }
+    }
+    return image;
+}
+
+/// Splits a range evenly over one std::jthread per hardware thread
+void split_over_threads(
+    std::size_t                                          count,
+    const std::function<void(std::size_t, std::size_t)>& fn)
+{
+    const auto threads =
+        std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    const auto per_thread = (count + threads - 1) / threads;
+
+    std::vector<std::jthread> workers;
+    for (std::size_t first = 0; first < count; first += per_thread)
+    {
+        const auto last = std::min(first + per_thread, count);
+        workers.emplace_back([&fn, first, last] { fn(first, last); });
+    }
+}
+
+/// Best-of-rounds megabytes of RGBA8 source encoded per second, the whole
+/// mip chain included
+double throughput(egen::texture_codec            codec,
+                  const std::vector<std::byte>&  image,
+                  const egen::parallel_range_fn& parallel,
+                  std::vector<std::byte>&        out)
+{
+    double best = 1e30;
+    for (std::uint32_t round = 0; round < k_rounds; ++round)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        out = egen::compress_mip_chain(codec, image, k_size, k_size, parallel);
+        const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return static_cast<double>(image.size()) / (1024.0 * 1024.0) / best;
+}
+
+/// PSNR of the top level over the channels a codec stores
+double psnr(egen::texture_codec           codec,
+            const std::vector<std::byte>& image,
+            const std::vector<std::byte>& blocks)
+{
+    const int channels = codec == egen::texture_codec::bc4   ? 1
+                         : codec == egen::texture_codec::bc5 ? 2
+                                                             : 4;
+    const auto blocks_x = static_cast<std::size_t>(k_size / 4);
+
+    double       squared = 0.0;
+    std::uint8_t texels[64];
+    for (std::size_t by = 0; by < blocks_x; ++by)
+    {
+        for (std::size_t bx = 0; bx < blocks_x; ++bx)
+        {
+            egen::decode_block(
+                codec,
+                blocks.data() + ((by * blocks_x) + bx) * block_bytes(codec),
+                texels);
+            for (std::size_t i = 0; i < 16; ++i)
+            {
+                const auto x   = (bx * 4) + (i % 4);
+                const auto y   = (by * 4) + (i / 4);
+                const auto* in = &image[((y * k_size) + x) * 4];
+                for (int c = 0; c < channels; ++c)
+                {
+                    const double d =
+                        static_cast<double>(texels[(i * 4) + c]) -
+                        static_cast<double>(std::to_integer<int>(in[c]));
+                    squared += d * d;
+                }
+            }
+        }
+    }
+
+    const double mse =
+        squared / (static_cast<double>(k_size) * k_size * channels);
+    return 10.0 * std::log10(255.0 * 255.0 / std::max(mse, 1e-9));
+}
+
+} // namespace
+
+int main()
+{
+    const auto image = make_image();
+
+    struct codec_case final
+    {
+        egen::texture_codec codec;
+        const char*         name;
+        double              min_psnr; // Below this the encoder regressed
+    };
+    const codec_case cases[] = {
+        { egen::texture_codec::bc4, "BC4", 40.0 },
+        { egen::texture_codec::bc5, "BC5", 40.0 },
+        { egen::texture_codec::bc7, "BC7", 38.0 },
+    };
+
+    std::vector<std::byte> blocks;
+    for (const auto& c : cases)
+    {
+        const auto single = throughput(c.codec, image, {}, blocks);
+        const auto threaded =
+            throughput(c.codec, image, split_over_threads, blocks);
+        const auto quality = psnr(c.codec, image, blocks);
+
+        spdlog::info("=> {} {}x{}: {:7.1f} MB/s on 1 thread, {:7.1f} MB/s "
+                     "on {} threads, PSNR {:5.2f} dB, {} bytes with mips",
+                     c.name,
+                     k_size,
+                     k_size,
+                     single,
+                     threaded,
+                     std::thread::hardware_concurrency(),
+                     quality,
+                     blocks.size());
+        if (quality < c.min_psnr)
+        {
+            spdlog::error("== {} PSNR below {:.1f} dB", c.name, c.min_psnr);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "model_loader.hpp"
 #include "window.hpp"
 
 #include <cstdint>
@@ -43,6 +44,15 @@ public:
     virtual void                set_render_scale(float scale) noexcept = 0;
     [[nodiscard]] virtual float get_render_scale() const noexcept      = 0;
 
+    /// Dynamic resolution: render scale driven by frame time. While it is
+    /// enabled, set_render_scale only restarts the governor from that scale.
+    virtual void set_dynamic_resolution(
+        const dynamic_resolution_settings& settings) noexcept = 0;
+    [[nodiscard]] virtual dynamic_resolution_settings get_dynamic_resolution()
+        const noexcept = 0;
+    [[nodiscard]] virtual dynamic_resolution_state
+    get_dynamic_resolution_state() const noexcept = 0;
+
     virtual void set_max_anisotropy(float anisotropy) noexcept      = 0;
     [[nodiscard]] virtual float get_max_anisotropy() const noexcept = 0;
 
@@ -94,6 +104,38 @@ public:
     virtual void set_render_distance(float distance) noexcept        = 0;
     [[nodiscard]] virtual float get_render_distance() const noexcept = 0;
 
+    /// Frustum culling of models and meshes (default: enabled)
+    virtual void               set_frustum_culling(bool enabled) noexcept  = 0;
+    [[nodiscard]] virtual bool is_frustum_culling_enabled() const noexcept = 0;
+
+    /// Culling of draws hidden behind occluder models (default: enabled)
+    virtual void set_occlusion_culling(bool enabled) noexcept = 0;
+    [[nodiscard]] virtual bool is_occlusion_culling_enabled()
+        const noexcept = 0;
+
+    /// Depth pre-pass of opaque geometry before shading (default: disabled).
+    /// Pays off when fragment shading dominates and overdraw is high.
+    virtual void               set_depth_prepass(bool enabled) noexcept  = 0;
+    [[nodiscard]] virtual bool is_depth_prepass_enabled() const noexcept = 0;
+
+    /// Level-of-detail bias (-2.0 to 4.0, default 0.0). Each step doubles
+    /// the screen-space error accepted before a coarser level is used.
+    virtual void                set_lod_bias(float bias) noexcept = 0;
+    [[nodiscard]] virtual float get_lod_bias() const noexcept     = 0;
+
+    /// GPU memory for streamed texture levels in MB (64 to 65536, default
+    /// 2048). Over it, textures not seen lately lose their finest levels.
+    virtual void set_texture_budget_mb(std::uint32_t megabytes) noexcept = 0;
+    [[nodiscard]] virtual std::uint32_t get_texture_budget_mb()
+        const noexcept = 0;
+
+    /// Processing of models loaded from now on: mesh optimization,
+    /// splitting, quantization, levels of detail and texture handling.
+    /// Loaded models keep what they were loaded with until reloaded.
+    virtual void set_load_options(const load_options& options) noexcept = 0;
+    [[nodiscard]] virtual const load_options& get_load_options()
+        const noexcept = 0;
+
     virtual void request_quit() noexcept = 0;
 
     virtual void stop() noexcept = 0;
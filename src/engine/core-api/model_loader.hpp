@@ -2,6 +2,7 @@
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <expected>
 #include <filesystem>
 #include <limits>
@@ -56,6 +57,21 @@ struct aabb final
     {
         return min.x <= max.x && min.y <= max.y && min.z <= max.z;
     }
+
+    /// Box around this box's corners after an affine transform
+    [[nodiscard]] aabb transformed(const glm::mat4& m) const noexcept
+    {
+        // Arvo's method: each output axis takes the extreme of every column
+        aabb result { .min = glm::vec3(m[3]), .max = glm::vec3(m[3]) };
+        for (int col = 0; col < 3; ++col)
+        {
+            const auto a = glm::vec3(m[col]) * min[col];
+            const auto b = glm::vec3(m[col]) * max[col];
+            result.min += glm::min(a, b);
+            result.max += glm::max(a, b);
+        }
+        return result;
+    }
 };
 
 /// Texture type/usage
@@ -92,19 +108,61 @@ struct morph_target final
     std::vector<glm::vec3> tangents;  // Tangent deltas (optional)
 };
 
+/// Most vertices a mesh can have and still be drawn with 16-bit indices
+constexpr std::size_t k_max_16bit_vertices = 65536;
+
+/// Index element width of a mesh on the GPU
+enum class index_format : uint8_t
+{
+    uint16, // Half the index bandwidth, up to k_max_16bit_vertices vertices
+    uint32,
+};
+
+/// Most levels of detail a mesh can have, including the full-detail level
+constexpr std::size_t k_max_mesh_lods = 5;
+
+/// Range of a mesh's indices drawn at one level of detail. All levels
+/// share the mesh's vertices.
+struct mesh_lod final
+{
+    uint32_t first_index = 0;
+    uint32_t index_count = 0;
+    float    error = 0.0f; // Surface deviation relative to the bounds radius
+};
+
 /// Single mesh within a model
 struct loaded_mesh final
 {
     std::vector<model_vertex> vertices;
-    std::vector<uint16_t>     indices;
+    std::vector<uint32_t>     indices; // Narrowed on upload when they fit
     std::string               material_name;
     std::size_t               material_index = 0; // Index into materials array
+    aabb                      bounds;             // Bounds of vertex positions
 
     // Morph targets
     std::vector<morph_target> morph_targets;
 
     // Skin index (if mesh is skinned)
     std::size_t skin_index = SIZE_MAX;
+
+    // Levels of detail, finest first; coarser index lists are appended
+    // after the original ones. Empty if the mesh only has full detail.
+    std::vector<mesh_lod> lods;
+
+    /// Narrowest index width that addresses every vertex
+    [[nodiscard]] index_format required_index_format() const noexcept
+    {
+        return vertices.size() > k_max_16bit_vertices ? index_format::uint32
+                                                      : index_format::uint16;
+    }
+};
+
+/// How a material's base color alpha is used (glTF alphaMode)
+enum class alpha_mode : uint8_t
+{
+    opaque, // Alpha ignored
+    mask,   // Fragments below alpha_cutoff are discarded
+    blend   // Composited over what is behind
 };
 
 /// Material information
@@ -122,6 +180,7 @@ struct model_material final
     float       metallic_factor                  = 0.0f;
     float       roughness_factor                 = 1.0f;
     float       alpha_cutoff                     = 0.5f;
+    alpha_mode  alpha                            = alpha_mode::opaque;
     bool        double_sided                     = false;
     bool        unlit = false; // KHR_materials_unlit extension
 };
@@ -198,6 +257,13 @@ struct scene_node final
     std::vector<std::size_t> children; // Indices of child nodes
 };
 
+/// Placement of a mesh within the model
+struct mesh_instance final
+{
+    std::size_t mesh      = 0;               // Index into meshes array
+    glm::mat4   transform = glm::mat4(1.0f); // Mesh space to model space
+};
+
 /// Complete loaded model data
 struct loaded_model final
 {
@@ -208,6 +274,12 @@ struct loaded_model final
     std::vector<model_skin>      skins;      // All skins (skeletons)
     std::vector<scene_node>      nodes;      // Scene graph nodes
     std::vector<std::size_t>     root_nodes; // Root node indices
+
+    // Where meshes are drawn. A mesh used by a single node has that node's
+    // transform baked into its vertices; a mesh shared by several nodes is
+    // kept once in mesh space and placed by one instance per node. Empty
+    // means every mesh is drawn once as is.
+    std::vector<mesh_instance> instances;
     std::filesystem::path
          texture_path; // Legacy: first base color texture (for backward compat)
     aabb bounds;
@@ -261,6 +333,47 @@ struct loaded_model final
 /// Result type for model loading operations
 using load_result = std::expected<loaded_model, std::string>;
 
+/// Processing applied to a model after it has been parsed
+struct load_options final
+{
+    /// Partition meshes over k_max_16bit_vertices vertices into chunks that
+    /// can be drawn with 16-bit indices instead of keeping 32-bit indices
+    bool split_large_meshes = false;
+
+    /// Coarser levels of detail generated per mesh, up to
+    /// k_max_mesh_lods - 1; each targets lod_ratio of the previous level's
+    /// triangles. 0 disables generation.
+    std::uint32_t lod_levels = 4;
+    float         lod_ratio  = 0.5f;
+
+    /// Reorder triangles for the post-transform vertex cache and overdraw,
+    /// then vertices for fetch locality. Runs on every level of detail.
+    bool optimize_meshes = true;
+
+    /// Upload vertices in a 16-byte quantized format instead of 32-byte
+    /// floats when the model's texture coordinates allow it
+    bool quantize_vertices = true;
+
+    /// Pack textures of one size, at most pack_texture_size texels on a
+    /// side, into a texture array per size. Meshes sampling any layer of an
+    /// array share one sampler binding.
+    bool          pack_textures     = true;
+    std::uint32_t pack_texture_size = 1024;
+
+    /// Block-compress textures on the CPU with a full mip chain: BC7 for
+    /// color, BC5 for normal maps, BC4 for occlusion. Results are cached
+    /// under texture_cache by source content, so later loads upload them
+    /// directly; an empty path disables the cache. The engine points it
+    /// at a directory under the user's preference path.
+    bool                  compress_textures = true;
+    std::filesystem::path texture_cache;
+
+    /// Create compressed textures from their coarse levels only and stream
+    /// in finer ones as draws need them, within the texture budget. The
+    /// full chain stays in system memory while the model is loaded.
+    bool stream_textures = true;
+};
+
 /// Model loader interface - abstracts model loading implementation
 /// Engine doesn't know about specific format (GLTF, OBJ, etc.)
 class i_model_loader
@@ -270,9 +383,11 @@ public:
 
     /// Load a model from file
     /// @param path Path to model file
+    /// @param options Post-load processing
     /// @return Loaded model data on success, error message on failure
     [[nodiscard]] virtual load_result load(
-        const std::filesystem::path& path) const = 0;
+        const std::filesystem::path& path,
+        const load_options&          options = {}) const = 0;
 
     /// Check if this loader supports the given file extension
     [[nodiscard]] virtual bool supports(std::string_view extension) const = 0;
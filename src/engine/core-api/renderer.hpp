@@ -6,6 +6,7 @@
 
 #include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <span>
 
 namespace egen
@@ -28,6 +29,20 @@ struct vertex final
     glm::vec3 color;
 };
 
+/// Progress of a model handle, see i_renderer::load_model_async
+enum class model_load_state : uint8_t
+{
+    unknown, // Not a model handle, or unloaded
+    loading, // Parsing, decoding or uploading; draws its bounds once known
+    ready,   // Drawn like a synchronously loaded model
+    failed,  // Draws nothing until unloaded
+};
+
+/// Called on the render thread when an asynchronous load settles, with
+/// ready or failed
+using model_load_callback =
+    std::function<void(model_handle model, model_load_state state)>;
+
 enum class primitive_type : uint8_t
 {
     lines,
@@ -68,6 +83,106 @@ struct render_stats final
     uint32_t models_loaded   = 0;
     uint32_t textures_loaded = 0;
     uint32_t meshes_loaded   = 0;
+    uint32_t models_culled   = 0; // Rejected by model bounds vs frustum
+    uint32_t meshes_culled   = 0; // Rejected by per-mesh bounds vs frustum
+    uint32_t meshes_lod      = 0; // Drawn at a reduced level of detail
+    uint32_t models_occluded = 0; // Rejected by model bounds vs occluders
+    uint32_t meshes_occluded = 0; // Rejected by per-mesh bounds vs occluders
+
+    // State changes issued vs skipped by the sorted draw queue
+    uint32_t pipeline_binds       = 0;
+    uint32_t pipeline_binds_saved = 0;
+    uint32_t texture_binds        = 0;
+    uint32_t texture_binds_saved  = 0;
+    uint32_t buffer_binds         = 0;
+    uint32_t buffer_binds_saved   = 0;
+
+    // Textures packed into arrays, one binding for every layer
+    uint32_t texture_arrays  = 0;
+    uint32_t textures_packed = 0; // Layers across those arrays
+
+    // Mip streaming of model textures under the texture budget
+    uint32_t textures_streamed    = 0; // Textures with streamed levels
+    uint32_t textures_restreamed  = 0; // Recreated with new levels this frame
+    uint32_t texture_resident_kb  = 0; // Levels on the GPU
+    uint32_t texture_requested_kb = 0; // Levels draws asked for
+
+    // Draws merged into instanced submissions
+    uint32_t instanced_draws = 0; // Draw calls with more than one instance
+    uint32_t instances       = 0; // Instances submitted by those draw calls
+
+    // Parallel culling and recording of model draws
+    uint32_t prep_workers  = 0;    // Threads that took part this frame
+    float    prep_ms_max   = 0.0f; // Slowest worker
+    float    prep_ms_total = 0.0f; // Summed over workers
+
+    // Software occlusion culling against designated occluders
+    uint32_t occluders          = 0;    // Occluder draws rasterized
+    uint32_t occluder_triangles = 0;    // After near-plane clipping
+    float    occlusion_ms       = 0.0f; // Setup and rasterization
+
+    // Depth pre-pass, counted apart from the color pass draws above
+    uint32_t prepass_draw_calls = 0;
+    uint32_t prepass_triangles  = 0;
+    float    prepass_ms         = 0.0f; // CPU time recording the pass
+
+    // Shared mesh buffers (all vertex formats)
+    uint32_t arena_used_kb       = 0;
+    uint32_t arena_capacity_kb   = 0;
+    uint32_t arena_free_blocks   = 0;    // Holes in the free lists
+    uint32_t arena_compactions   = 0;    // Since renderer init
+    float    arena_fragmentation = 0.0f; // 0 = free space is one block
+
+    // Staging ring traffic since the start of the frame
+    uint32_t upload_submits = 0; // Copy command buffers submitted
+    uint32_t upload_kb      = 0;
+
+    // Immediate-mode debug lines
+    uint32_t debug_lines         = 0;
+    uint32_t debug_lines_dropped = 0; // Over the per-frame budget
+};
+
+/// Depth handling of debug lines
+enum class debug_depth : uint8_t
+{
+    tested,  // Hidden behind scene geometry
+    overlay, // Always drawn on top
+};
+
+/// Immediate-mode debug lines in world space. Lines accumulate until the end
+/// of the frame and are drawn with one draw call per depth mode; shapes that
+/// do not fit the per-frame budget are dropped and counted in render_stats.
+class i_debug_draw
+{
+public:
+    virtual ~i_debug_draw() = default;
+
+    virtual void line(const glm::vec3& a,
+                      const glm::vec3& b,
+                      const glm::vec3& color,
+                      debug_depth      depth = debug_depth::tested) = 0;
+    virtual void aabb(const bounds&    b,
+                      const glm::vec3& color,
+                      debug_depth      depth = debug_depth::tested) = 0;
+    // Local-space box placed by a world matrix
+    virtual void obb(const bounds&    local,
+                     const glm::mat4& world,
+                     const glm::vec3& color,
+                     debug_depth      depth = debug_depth::tested) = 0;
+    // Three great circles
+    virtual void sphere(const glm::vec3& center,
+                        float            radius,
+                        const glm::vec3& color,
+                        debug_depth      depth    = debug_depth::tested,
+                        int              segments = 16)        = 0;
+    // Edges of the volume seen through a view-projection matrix
+    virtual void frustum(const glm::mat4& view_proj,
+                         const glm::vec3& color,
+                         debug_depth      depth = debug_depth::tested) = 0;
+    // Red/green/blue X/Y/Z axes of a world matrix
+    virtual void axis(const glm::mat4& world,
+                      float            length = 1.0f,
+                      debug_depth      depth  = debug_depth::overlay) = 0;
 };
 
 class i_renderer
@@ -101,8 +216,27 @@ public:
     virtual model_handle load_model(
         const std::filesystem::path& path,
         const glm::vec3&             color = glm::vec3(1.0f))                       = 0;
+    // Returns at once. The file is parsed and its textures decoded on
+    // worker threads; GPU uploads are drained at the start of later frames
+    // within a time budget, then on_done runs. Until ready, drawing the
+    // handle draws its bounds once they are known, or nothing.
+    virtual model_handle load_model_async(
+        const std::filesystem::path& path,
+        const glm::vec3&             color   = glm::vec3(1.0f),
+        model_load_callback          on_done = {}) = 0;
+    [[nodiscard]] virtual model_load_state get_load_state(
+        model_handle model) const = 0;
+    // Stop a pending load and drop its handle; on_done is not called.
+    // Unloading a handle that is still loading does the same.
+    virtual void cancel_load(model_handle model) = 0;
     virtual void unload_model(model_handle model)                       = 0;
     virtual void draw_model(model_handle model, const transform& xform) = 0;
+    // One lookup for many transforms; batched like repeated draw_model calls
+    virtual void draw_model_instanced(model_handle               model,
+                                      std::span<const transform> xforms) = 0;
+    // Occluders are rasterized into a CPU depth buffer each frame and hide
+    // the draws behind them; large, solid models make good occluders
+    virtual void set_occluder(model_handle model, bool occluder) = 0;
 
     [[nodiscard]] virtual bounds get_bounds(model_handle model) const = 0;
 
@@ -112,6 +246,8 @@ public:
                                                                 1.0f,
                                                                 0.0f)) = 0;
 
+    [[nodiscard]] virtual i_debug_draw& debug_draw() = 0;
+
     virtual texture_handle load_texture(const std::filesystem::path& path) = 0;
     virtual void           unload_texture(texture_handle tex)              = 0;
 
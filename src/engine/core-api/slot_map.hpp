@@ -0,0 +1,185 @@
+#pragma once
+
+/// @file slot_map.hpp
+/// @brief Generational handle table with dense value storage
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace egen
+{
+
+/// Maps 64-bit handles to densely packed values.
+///
+/// A handle is (generation << 32) | slot. Lookup indexes the slot array and
+/// compares generations, so it costs one array access plus one compare and
+/// never hashes. Erasing bumps the slot generation, which makes every handle
+/// still pointing at it stale. Generation 0 is never issued, so handle 0 is
+/// always invalid.
+///
+/// Values live in one contiguous vector; erase moves the last value into
+/// the hole. Pointers and references to values are therefore invalidated
+/// by insert and erase, handles are not.
+template <typename T>
+class slot_map final
+{
+public:
+    using handle_type = std::uint64_t;
+
+    static constexpr handle_type invalid_handle = 0;
+
+    template <typename... Args>
+    handle_type emplace(Args&&... args)
+    {
+        std::uint32_t index = 0;
+        if (free_head_ != k_free_end)
+        {
+            index      = free_head_;
+            free_head_ = slots_[index].dense;
+        }
+        else
+        {
+            index = static_cast<std::uint32_t>(slots_.size());
+            slots_.push_back({});
+        }
+
+        auto& s = slots_[index];
+        s.dense = static_cast<std::uint32_t>(values_.size());
+        values_.emplace_back(std::forward<Args>(args)...);
+
+        const auto h = make_handle(index, s.generation);
+        handles_.push_back(h);
+        return h;
+    }
+
+    handle_type insert(T value) { return emplace(std::move(value)); }
+
+    /// @return Value for h, or nullptr if h is stale or invalid
+    [[nodiscard]] T* find(handle_type h) noexcept
+    {
+        const auto* s = live_slot(h);
+        return s != nullptr ? &values_[s->dense] : nullptr;
+    }
+
+    [[nodiscard]] const T* find(handle_type h) const noexcept
+    {
+        const auto* s = live_slot(h);
+        return s != nullptr ? &values_[s->dense] : nullptr;
+    }
+
+    [[nodiscard]] bool contains(handle_type h) const noexcept
+    {
+        return live_slot(h) != nullptr;
+    }
+
+    /// @return False if h was already stale
+    bool erase(handle_type h)
+    {
+        const auto* live = live_slot(h);
+        if (live == nullptr)
+        {
+            return false;
+        }
+
+        // Fill the hole with the last value and repoint its slot
+        const auto dense = live->dense;
+        const auto last  = values_.size() - 1;
+        if (dense != last)
+        {
+            values_[dense]  = std::move(values_[last]);
+            handles_[dense] = handles_[last];
+            slots_[slot_of(handles_[dense])].dense = dense;
+        }
+        values_.pop_back();
+        handles_.pop_back();
+
+        release(slot_of(h));
+        return true;
+    }
+
+    /// Erase every value; all outstanding handles become stale
+    void clear() noexcept
+    {
+        for (auto h : handles_)
+        {
+            release(slot_of(h));
+        }
+        values_.clear();
+        handles_.clear();
+    }
+
+    void reserve(std::size_t count)
+    {
+        slots_.reserve(count);
+        values_.reserve(count);
+        handles_.reserve(count);
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return values_.size(); }
+    [[nodiscard]] bool        empty() const noexcept { return values_.empty(); }
+
+    /// Dense iteration over values, in no particular order
+    [[nodiscard]] auto begin() noexcept { return values_.begin(); }
+    [[nodiscard]] auto end() noexcept { return values_.end(); }
+    [[nodiscard]] auto begin() const noexcept { return values_.begin(); }
+    [[nodiscard]] auto end() const noexcept { return values_.end(); }
+
+    /// Handles parallel to the dense values
+    [[nodiscard]] std::span<const handle_type> handles() const noexcept
+    {
+        return handles_;
+    }
+
+private:
+    static constexpr std::uint32_t k_free_end = UINT32_MAX;
+
+    struct slot final
+    {
+        std::uint32_t dense      = 0; // Value index, or next free slot
+        std::uint32_t generation = 1; // Never 0, see handle layout
+    };
+
+    [[nodiscard]] static constexpr handle_type make_handle(
+        std::uint32_t index, std::uint32_t generation) noexcept
+    {
+        return (handle_type { generation } << 32) | index;
+    }
+
+    [[nodiscard]] static constexpr std::uint32_t slot_of(handle_type h) noexcept
+    {
+        return static_cast<std::uint32_t>(h);
+    }
+
+    [[nodiscard]] const slot* live_slot(handle_type h) const noexcept
+    {
+        const auto index = slot_of(h);
+        if (index >= slots_.size() ||
+            slots_[index].generation != static_cast<std::uint32_t>(h >> 32))
+        {
+            return nullptr;
+        }
+        return &slots_[index];
+    }
+
+    /// Invalidate a slot's handles and push it onto the free list
+    void release(std::uint32_t index) noexcept
+    {
+        auto& s = slots_[index];
+        if (++s.generation == 0)
+        {
+            s.generation = 1;
+        }
+        s.dense    = free_head_;
+        free_head_ = index;
+    }
+
+    std::vector<slot>        slots_;
+    std::vector<T>           values_;
+    std::vector<handle_type> handles_; // Parallel to values_
+    std::uint32_t            free_head_ = k_free_end;
+};
+
+} // namespace egen
@@ -67,15 +67,51 @@ struct window_settings final
     }
 };
 
+/// Frame-time governor that drives the render scale. A PID controller
+/// acts on the relative error against the budget and moves the scale by at
+/// most step per frame; errors within the hysteresis band leave it alone.
+struct dynamic_resolution_settings final
+{
+    bool  enabled    = false;
+    float target_ms  = 16.667f; ///< Frame time budget
+    float min_scale  = 0.5f;
+    float max_scale  = 1.0f;
+    float step       = 0.05f;  ///< Largest scale change per frame
+    float hysteresis = 0.05f;  ///< Ignored error, fraction of the budget
+    float kp         = 0.15f;  ///< Proportional gain
+    float ki         = 0.005f; ///< Integral gain
+    float kd         = 0.05f;  ///< Derivative gain
+};
+
+/// Controller state after the last frame, for graphs
+struct dynamic_resolution_state final
+{
+    float scale      = 1.0f; ///< Render scale chosen for the next frame
+    float frame_ms   = 0.0f; ///< Smoothed frame time the error came from
+    float error      = 0.0f; ///< (budget - frame time) / budget
+    float integral   = 0.0f; ///< Accumulated error, clamped
+    float derivative = 0.0f; ///< Error change since the previous frame
+    float output     = 0.0f; ///< Scale change applied, after clamping
+};
+
 struct renderer_settings final
 {
-    bool  wireframe_mode  = false;
-    bool  show_debug_info = false;
-    bool  frustum_culling = true;
-    float render_scale    = 1.0f; ///< Internal resolution multiplier
-    float max_anisotropy  = 16.0f;
-    float gamma           = 2.2f;
-    float exposure        = 1.0f;
+    bool  wireframe_mode    = false;
+    bool  show_debug_info   = false;
+    bool  frustum_culling   = true;
+    bool  occlusion_culling = true;  ///< Against models marked as occluders
+    bool  depth_prepass     = false; ///< Opaque depth before shading
+    float render_scale      = 1.0f;  ///< Internal resolution multiplier
+    float max_anisotropy    = 16.0f;
+    float lod_bias          = 0.0f; ///< Positive = coarser levels sooner
+    float gamma             = 2.2f;
+    float exposure          = 1.0f;
+
+    /// GPU memory for streamed texture levels in MB, see
+    /// i_engine_settings::set_texture_budget_mb
+    std::uint32_t texture_budget_mb = 2048;
+
+    dynamic_resolution_settings dynamic_resolution;
 
     [[nodiscard]] static constexpr renderer_settings defaults() noexcept
     {
@@ -67,7 +67,7 @@ void audio_system::shutdown()
 
     stop_music();
 
-    for (auto& [h, audio] : music)
+    for (auto* audio : music)
     {
         if (audio != nullptr)
         {
@@ -76,7 +76,7 @@ void audio_system::shutdown()
     }
     music.clear();
 
-    for (auto& [h, audio] : sounds)
+    for (auto* audio : sounds)
     {
         if (audio != nullptr)
         {
@@ -116,33 +116,33 @@ music_handle audio_system::load_music(const std::filesystem::path& path)
         return invalid_music;
     }
 
-    music[next_music] = audio;
+    const auto h = music.insert(audio);
     spdlog::info("=> music: {}", path.filename().string());
-    return next_music++;
+    return h;
 }
 
 void audio_system::unload_music(music_handle h)
 {
-    if (auto it = music.find(h); it != music.end())
+    if (auto* const* audio = music.find(h))
     {
         if (current_playing_music == h)
         {
             stop_music();
         }
-        MIX_DestroyAudio(it->second);
-        music.erase(it);
+        MIX_DestroyAudio(*audio);
+        music.erase(h);
     }
 }
 
 void audio_system::play_music(music_handle h, bool loop)
 {
-    auto it = music.find(h);
-    if (it == music.end() || (music_track == nullptr))
+    auto* const* audio = music.find(h);
+    if (audio == nullptr || (music_track == nullptr))
     {
         return;
     }
 
-    if (!MIX_SetTrackAudio(music_track, it->second))
+    if (!MIX_SetTrackAudio(music_track, *audio))
     {
         spdlog::error("MIX_SetTrackAudio: {}", SDL_GetError());
         return;
@@ -222,28 +222,28 @@ sound_handle audio_system::load_sound(const std::filesystem::path& path)
         return invalid_sound;
     }
 
-    sounds[next_sound] = audio;
+    const auto h = sounds.insert(audio);
     spdlog::info("=> sound: {}", path.filename().string());
-    return next_sound++;
+    return h;
 }
 
 void audio_system::unload_sound(sound_handle h)
 {
-    if (auto it = sounds.find(h); it != sounds.end())
+    if (auto* const* audio = sounds.find(h))
     {
-        MIX_DestroyAudio(it->second);
-        sounds.erase(it);
+        MIX_DestroyAudio(*audio);
+        sounds.erase(h);
     }
 }
 
 void audio_system::play_sound(sound_handle h, [[maybe_unused]] float volume)
 {
-    auto it = sounds.find(h);
-    if (it == sounds.end() || (mixer == nullptr))
+    auto* const* audio = sounds.find(h);
+    if (audio == nullptr || (mixer == nullptr))
     {
         return;
     }
-    MIX_PlayAudio(mixer, it->second);
+    MIX_PlayAudio(mixer, *audio);
 }
 
 void audio_system::set_sound_volume(float volume)
@@ -1,8 +1,7 @@
 #pragma once
 
 #include <core-api/audio.hpp>
-
-#include <unordered_map>
+#include <core-api/slot_map.hpp>
 
 struct MIX_Mixer;
 struct MIX_Audio;
@@ -59,11 +58,8 @@ private:
     MIX_Mixer* mixer       = nullptr;
     MIX_Track* music_track = nullptr;
 
-    std::unordered_map<music_handle, MIX_Audio*> music;
-    std::unordered_map<sound_handle, MIX_Audio*> sounds;
-
-    std::uint64_t next_music = 1;
-    std::uint64_t next_sound = 1;
+    slot_map<MIX_Audio*> music;
+    slot_map<MIX_Audio*> sounds;
 
     music_handle current_playing_music = invalid_music;
     bool         music_paused          = false;
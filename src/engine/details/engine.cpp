@@ -12,6 +12,7 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <vector>
 
@@ -136,9 +137,16 @@ bool engine::init(const preinit_settings& settings)
     apply_vsync_mode();
 
     // Initialize rendering settings
-    current_msaa_   = settings.window.msaa;
-    render_scale_   = settings.renderer.render_scale;
-    max_anisotropy_ = settings.renderer.max_anisotropy;
+    current_msaa_      = settings.window.msaa;
+    render_scale_      = settings.renderer.render_scale;
+    max_anisotropy_    = settings.renderer.max_anisotropy;
+    frustum_culling_   = settings.renderer.frustum_culling;
+    occlusion_culling_ = settings.renderer.occlusion_culling;
+    depth_prepass_     = settings.renderer.depth_prepass;
+    lod_bias_          = settings.renderer.lod_bias;
+    texture_budget_mb_ = settings.renderer.texture_budget_mb;
+    resolution_governor_.configure(settings.renderer.dynamic_resolution);
+    resolution_governor_.reset(render_scale_);
 
     // Initialize shader system
     shader_system_ = std::make_unique<shader_system>(device_.get());
@@ -155,6 +163,28 @@ bool engine::init(const preinit_settings& settings)
     // Apply initial rendering settings to renderer
     render_system_->set_msaa_samples(current_msaa_);
     render_system_->set_max_anisotropy(max_anisotropy_);
+    render_system_->set_frustum_culling(frustum_culling_);
+    render_system_->set_occlusion_culling(occlusion_culling_);
+    render_system_->set_lod_bias(lod_bias_);
+    render_system_->set_texture_budget(std::size_t { texture_budget_mb_ }
+                                       << 20);
+
+    // Encoded textures are cached per user rather than in the working
+    // directory, which may be read-only
+    if (load_options_.texture_cache.empty())
+    {
+        if (char* pref = SDL_GetPrefPath("egen", settings.window.title.c_str()))
+        {
+            load_options_.texture_cache =
+                std::filesystem::path { pref } / "texture_cache";
+            SDL_free(pref);
+        }
+        else
+        {
+            spdlog::warn("texture cache disabled: {}", SDL_GetError());
+        }
+    }
+    render_system_->set_load_options(load_options_);
 
     // Set frame buffering (default: 2 = double buffering)
     SDL_SetGPUAllowedFramesInFlight(device_.get(), frames_in_flight_);
@@ -381,7 +411,26 @@ void engine::set_msaa(msaa_samples samples) noexcept
 void engine::set_render_scale(float scale) noexcept
 {
     render_scale_ = std::clamp(scale, 0.25f, 4.0f);
-    // Render scale can be applied immediately in render() if needed
+    if (resolution_governor_.settings().enabled)
+    {
+        resolution_governor_.reset(render_scale_);
+        render_scale_ = resolution_governor_.state().scale;
+    }
+}
+
+void engine::set_dynamic_resolution(
+    const dynamic_resolution_settings& settings) noexcept
+{
+    const bool was_enabled = resolution_governor_.settings().enabled;
+    resolution_governor_.configure(settings);
+    if (settings.enabled && !was_enabled)
+    {
+        resolution_governor_.reset(render_scale_);
+    }
+    if (settings.enabled)
+    {
+        render_scale_ = resolution_governor_.state().scale;
+    }
 }
 
 void engine::set_max_anisotropy(float anisotropy) noexcept
@@ -494,6 +543,58 @@ void engine::set_render_distance(float distance) noexcept
     }
 }
 
+void engine::set_frustum_culling(bool enabled) noexcept
+{
+    frustum_culling_ = enabled;
+    if (render_system_)
+    {
+        render_system_->set_frustum_culling(enabled);
+    }
+}
+
+void engine::set_occlusion_culling(bool enabled) noexcept
+{
+    occlusion_culling_ = enabled;
+    if (render_system_)
+    {
+        render_system_->set_occlusion_culling(enabled);
+    }
+}
+
+void engine::set_depth_prepass(bool enabled) noexcept
+{
+    // Takes effect with the next frame's render passes
+    depth_prepass_ = enabled;
+}
+
+void engine::set_lod_bias(float bias) noexcept
+{
+    lod_bias_ = std::clamp(bias, -2.0f, 4.0f);
+    if (render_system_)
+    {
+        render_system_->set_lod_bias(lod_bias_);
+    }
+}
+
+void engine::set_texture_budget_mb(std::uint32_t megabytes) noexcept
+{
+    texture_budget_mb_ = std::clamp<std::uint32_t>(megabytes, 64, 65536);
+    if (render_system_)
+    {
+        render_system_->set_texture_budget(std::size_t { texture_budget_mb_ }
+                                           << 20);
+    }
+}
+
+void engine::set_load_options(const load_options& options) noexcept
+{
+    load_options_ = options;
+    if (render_system_)
+    {
+        render_system_->set_load_options(load_options_);
+    }
+}
+
 bool engine::is_postprocess_available() const noexcept
 {
     return render_system_ != nullptr;
@@ -1056,8 +1157,13 @@ void engine::render()
     Uint32          swapchain_w = 0;
     Uint32          swapchain_h = 0;
 
-    if (!SDL_WaitAndAcquireGPUSwapchainTexture(
-            cmd, window_.get(), &swapchain, &swapchain_w, &swapchain_h))
+    const Uint64 acquire_start = SDL_GetPerformanceCounter();
+    const bool   acquired      = SDL_WaitAndAcquireGPUSwapchainTexture(
+        cmd, window_.get(), &swapchain, &swapchain_w, &swapchain_h);
+    swapchain_wait_ms_ =
+        static_cast<float>(SDL_GetPerformanceCounter() - acquire_start) *
+        1000.0f / static_cast<float>(SDL_GetPerformanceFrequency());
+    if (!acquired)
     {
         SDL_CancelGPUCommandBuffer(cmd);
         return;
@@ -1069,22 +1175,45 @@ void engine::render()
         return;
     }
 
-    render_system_->ensure_depth_texture(swapchain_w, swapchain_h);
+    // Render scale: the scene renders into the top-left corner of targets
+    // sized for the largest scale in use, and post-processing stretches it
+    // over the swapchain. Targets keep their size while the governor moves
+    // the scale within its range.
+    const auto scaled = [](Uint32 size, float scale)
+    {
+        const auto pixels = std::lround(static_cast<float>(size) * scale);
+        return static_cast<Uint32>(std::max(pixels, 1L));
+    };
+    const auto& dynamic      = resolution_governor_.settings();
+    const float target_scale = std::max(
+        dynamic.enabled ? dynamic.max_scale : render_scale_, 1.0f);
+    const Uint32 target_w = scaled(swapchain_w, target_scale);
+    const Uint32 target_h = scaled(swapchain_h, target_scale);
+    const Uint32 scene_w =
+        std::min(scaled(swapchain_w, render_scale_), target_w);
+    const Uint32 scene_h =
+        std::min(scaled(swapchain_h, render_scale_), target_h);
+    const bool use_scaling =
+        scene_w != swapchain_w || scene_h != swapchain_h ||
+        target_w != swapchain_w || target_h != swapchain_h;
+
+    render_system_->ensure_depth_texture(target_w, target_h);
 
     // Get swapchain format for MSAA and post-processing targets
     auto swapchain_format =
         SDL_GetGPUSwapchainTextureFormat(device_.get(), window_.get());
 
-    // Check if post-processing is enabled (any non-default value)
+    // Check if post-processing is enabled (any non-default value). A scaled
+    // scene always goes through it to reach swapchain size.
     const bool use_postprocess =
         (gamma_ != 2.2f || brightness_ != 0.0f || contrast_ != 1.0f ||
-         saturation_ != 1.0f || vignette_ > 0.001f || fxaa_enabled_);
+         saturation_ != 1.0f || vignette_ > 0.001f || fxaa_enabled_ ||
+         use_scaling);
 
     // Ensure post-processing target if needed
     if (use_postprocess)
     {
-        render_system_->ensure_pp_target(
-            swapchain_w, swapchain_h, swapchain_format);
+        render_system_->ensure_pp_target(target_w, target_h, swapchain_format);
     }
 
     // Ensure MSAA render targets if MSAA is enabled
@@ -1093,7 +1222,7 @@ void engine::render()
     if (use_msaa)
     {
         render_system_->ensure_msaa_targets(
-            swapchain_w, swapchain_h, swapchain_format);
+            target_w, target_h, swapchain_format);
     }
 
     // Determine scene output target:
@@ -1144,34 +1273,82 @@ void engine::render()
     depth_target.stencil_load_op  = SDL_GPU_LOADOP_CLEAR;
     depth_target.stencil_store_op = SDL_GPU_STOREOP_DONT_CARE;
 
+    // Record scene draws first: instance data is uploaded with a copy pass,
+    // which cannot run inside the render pass
+    {
+        [[maybe_unused]] auto profiler_zone_record =
+            profiler_zone_begin(context_.profiler, "engine::render::record");
+        render_system_->begin_frame(cmd, scene_h);
+
+        // Set view projection from first camera
+        auto camera_view = registry_.view<camera_component>();
+        for (auto&& [entity, cam] : camera_view.each())
+        {
+            render_system_->set_view_projection(
+                cam.projection(context_.display.aspect) * cam.view());
+            break;
+        }
+
+        if (game_module_system_ != nullptr)
+        {
+            game_module_system_->call_render(&context_);
+        }
+
+        render_system_->prepare_frame();
+    }
+
     auto* depth_ptr =
         (depth_target.texture != nullptr) ? &depth_target : nullptr;
-    if (auto* pass = SDL_BeginGPURenderPass(cmd, &color_target, 1, depth_ptr))
+
+    const SDL_GPUViewport scene_viewport {
+        .x         = 0.0f,
+        .y         = 0.0f,
+        .w         = static_cast<float>(scene_w),
+        .h         = static_cast<float>(scene_h),
+        .min_depth = 0.0f,
+        .max_depth = 1.0f,
+    };
+
+    // Depth pre-pass: opaque depth in a pass of its own, which the scene
+    // pass then loads instead of clearing
+    if (depth_prepass_ && depth_ptr != nullptr &&
+        render_system_->depth_prepass_available())
     {
+        if (auto* pass = SDL_BeginGPURenderPass(cmd, nullptr, 0, depth_ptr))
         {
-            [[maybe_unused]] auto profiler_zone_scene =
-                profiler_zone_begin(context_.profiler, "engine::render::scene");
-            render_system_->begin_frame(cmd, pass);
-
-            // Set view projection from first camera
-            auto camera_view = registry_.view<camera_component>();
-            for (auto&& [entity, cam] : camera_view.each())
+            if (use_scaling)
             {
-                render_system_->set_view_projection(
-                    cam.projection(context_.display.aspect) * cam.view());
-                break;
+                SDL_SetGPUViewport(pass, &scene_viewport);
             }
-
-            render_system_->bind_pipeline();
-            if (game_module_system_ != nullptr)
             {
-                game_module_system_->call_render(&context_);
+                [[maybe_unused]] auto profiler_zone_prepass =
+                    profiler_zone_begin(context_.profiler,
+                                        "engine::render::prepass");
+                render_system_->depth_prepass(pass);
             }
+            SDL_EndGPURenderPass(pass);
+            depth_target.load_op         = SDL_GPU_LOADOP_LOAD;
+            depth_target.stencil_load_op = SDL_GPU_LOADOP_LOAD;
+        }
+    }
 
-            render_system_->end_frame();
+    if (auto* pass = SDL_BeginGPURenderPass(cmd, &color_target, 1, depth_ptr))
+    {
+        if (use_scaling)
+        {
+            SDL_SetGPUViewport(pass, &scene_viewport);
+        }
+        {
+            [[maybe_unused]] auto profiler_zone_scene =
+                profiler_zone_begin(context_.profiler, "engine::render::scene");
+            render_system_->end_frame(pass);
         }
         SDL_EndGPURenderPass(pass);
     }
+    else
+    {
+        render_system_->end_frame(nullptr); // Drop recorded draws
+    }
 
     // Apply post-processing if enabled
     if (use_postprocess && render_system_->pp_color_target() != nullptr)
@@ -1185,8 +1362,12 @@ void engine::render()
         pp_params.saturation   = saturation_;
         pp_params.vignette     = vignette_;
         pp_params.fxaa_enabled = fxaa_enabled_ ? 1.0f : 0.0f;
-        pp_params.res_x        = static_cast<float>(swapchain_w);
-        pp_params.res_y        = static_cast<float>(swapchain_h);
+        pp_params.res_x        = static_cast<float>(target_w);
+        pp_params.res_y        = static_cast<float>(target_h);
+        pp_params.uv_scale_x   = static_cast<float>(scene_w) /
+                               static_cast<float>(target_w);
+        pp_params.uv_scale_y   = static_cast<float>(scene_h) /
+                               static_cast<float>(target_h);
 
         render_system_->apply_postprocess(cmd, swapchain, pp_params);
     }
@@ -1227,6 +1408,23 @@ void engine::iterate()
         static_cast<float>(now - last_time_) / static_cast<float>(freq);
     last_time_ = now;
 
+    // Dynamic resolution follows the time the frame took, before the frame
+    // limiter below pads it out. Under vsync, a frame within its budget
+    // spent the rest waiting for the swapchain; that wait is headroom, so
+    // only the work counts. A frame over budget missed the interval and
+    // counts in full, since the wait then means the GPU is behind.
+    if (const auto& governor = resolution_governor_.settings();
+        governor.enabled && frame_count_ > 0)
+    {
+        auto frame_ms = delta_time_ * 1000.0f;
+        if (current_vsync_ != vsync_mode::disabled &&
+            frame_ms <= governor.target_ms * (1.0f + governor.hysteresis))
+        {
+            frame_ms = std::max(frame_ms - swapchain_wait_ms_, 0.0f);
+        }
+        render_scale_ = resolution_governor_.update(frame_ms);
+    }
+
     // Enforce max FPS if set (works even with vsync)
     // This must be done before clamping delta_time to ensure proper frame
     // limiting
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "render/resolution_governor.hpp"
+
 #include <core-api/game.hpp>
 
 #include <core-api/engine.hpp>
@@ -152,6 +154,18 @@ public:
     {
         return render_scale_;
     }
+    void set_dynamic_resolution(
+        const dynamic_resolution_settings& settings) noexcept override;
+    [[nodiscard]] dynamic_resolution_settings get_dynamic_resolution()
+        const noexcept override
+    {
+        return resolution_governor_.settings();
+    }
+    [[nodiscard]] dynamic_resolution_state get_dynamic_resolution_state()
+        const noexcept override
+    {
+        return resolution_governor_.state();
+    }
     void                set_max_anisotropy(float anisotropy) noexcept override;
     [[nodiscard]] float get_max_anisotropy() const noexcept override
     {
@@ -210,6 +224,42 @@ public:
         return render_distance_;
     }
 
+    void               set_frustum_culling(bool enabled) noexcept override;
+    [[nodiscard]] bool is_frustum_culling_enabled() const noexcept override
+    {
+        return frustum_culling_;
+    }
+
+    void               set_occlusion_culling(bool enabled) noexcept override;
+    [[nodiscard]] bool is_occlusion_culling_enabled() const noexcept override
+    {
+        return occlusion_culling_;
+    }
+
+    void               set_depth_prepass(bool enabled) noexcept override;
+    [[nodiscard]] bool is_depth_prepass_enabled() const noexcept override
+    {
+        return depth_prepass_;
+    }
+
+    void                set_lod_bias(float bias) noexcept override;
+    [[nodiscard]] float get_lod_bias() const noexcept override
+    {
+        return lod_bias_;
+    }
+
+    void set_texture_budget_mb(std::uint32_t megabytes) noexcept override;
+    [[nodiscard]] std::uint32_t get_texture_budget_mb() const noexcept override
+    {
+        return texture_budget_mb_;
+    }
+
+    void set_load_options(const load_options& options) noexcept override;
+    [[nodiscard]] const load_options& get_load_options() const noexcept override
+    {
+        return load_options_;
+    }
+
     // Profiler settings
     void set_profiler_frame_marks_enabled(bool enabled) noexcept override;
     [[nodiscard]] bool is_profiler_frame_marks_enabled() const noexcept override
@@ -299,6 +349,16 @@ private:
     float          saturation_             = 1.0f;
     float          vignette_               = 0.0f;
     float          render_distance_        = 200.0f;
+    bool           frustum_culling_        = true;
+    bool           occlusion_culling_      = true;
+    bool           depth_prepass_          = false;
+    float          lod_bias_               = 0.0f;
+    std::uint32_t  texture_budget_mb_      = 2048;
+    load_options   load_options_;
+
+    // Drives render_scale_ from frame times while enabled
+    resolution_governor resolution_governor_;
+    float swapchain_wait_ms_ = 0.0f; // Blocked acquiring the last image
 
     // Profiler settings
     bool profiler_frame_marks_enabled_ = true; // Default: enabled
@@ -0,0 +1,207 @@
+/// @file debug_lines.cpp
+/// @brief Debug shape tessellation into per-frame line lists
+
+#include "debug_lines.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace egen
+{
+
+namespace
+{
+
+/// Two PI for circle tessellation
+constexpr float k_two_pi = 6.28318530718f;
+
+/// Corner index pairs forming the edges of a box. Corners are numbered with
+/// bit 0 = +x, bit 1 = +y, bit 2 = +z.
+constexpr std::array<std::pair<int, int>, 12> k_box_edges { {
+    { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, // Along x
+    { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 }, // Along y
+    { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }, // Along z
+} };
+
+/// Box corner selected by the bits of i, see k_box_edges
+[[nodiscard]] glm::vec3 corner(const glm::vec3& lo,
+                               const glm::vec3& hi,
+                               int              i) noexcept
+{
+    return { (i & 1) != 0 ? hi.x : lo.x,
+             (i & 2) != 0 ? hi.y : lo.y,
+             (i & 4) != 0 ? hi.z : lo.z };
+}
+
+} // namespace
+
+debug_line_batch::debug_line_batch(std::uint32_t max_lines)
+    : max_lines_(max_lines)
+{
+    // Either list may take the whole budget
+    tested_.reserve(std::size_t { max_lines } * 2);
+    overlay_.reserve(std::size_t { max_lines } * 2);
+}
+
+void debug_line_batch::line(const glm::vec3& a,
+                            const glm::vec3& b,
+                            const glm::vec3& color,
+                            debug_depth      depth)
+{
+    if (fits(1))
+    {
+        push(a, b, color, depth);
+    }
+}
+
+void debug_line_batch::aabb(const bounds&    b,
+                            const glm::vec3& color,
+                            debug_depth      depth)
+{
+    glm::vec3 corners[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        corners[i] = corner(b.min, b.max, i);
+    }
+    box(corners, color, depth);
+}
+
+void debug_line_batch::obb(const bounds&    local,
+                           const glm::mat4& world,
+                           const glm::vec3& color,
+                           debug_depth      depth)
+{
+    glm::vec3 corners[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        corners[i] =
+            glm::vec3(world * glm::vec4(corner(local.min, local.max, i), 1.0f));
+    }
+    box(corners, color, depth);
+}
+
+void debug_line_batch::sphere(const glm::vec3& center,
+                              float            radius,
+                              const glm::vec3& color,
+                              debug_depth      depth,
+                              int              segments)
+{
+    segments = std::max(segments, 3);
+    if (!fits(static_cast<std::uint32_t>(segments) * 3))
+    {
+        return;
+    }
+
+    // One great circle per pair of axes
+    const auto circle = [&](int axis1, int axis2)
+    {
+        glm::vec3 prev = center;
+        prev[axis1] += radius;
+        for (int i = 1; i <= segments; ++i)
+        {
+            const float angle = k_two_pi * static_cast<float>(i) /
+                                static_cast<float>(segments);
+            glm::vec3 next = center;
+            next[axis1] += radius * std::cos(angle);
+            next[axis2] += radius * std::sin(angle);
+            push(prev, next, color, depth);
+            prev = next;
+        }
+    };
+
+    circle(0, 1); // XY plane
+    circle(0, 2); // XZ plane
+    circle(1, 2); // YZ plane
+}
+
+void debug_line_batch::frustum(const glm::mat4& view_proj,
+                               const glm::vec3& color,
+                               debug_depth      depth)
+{
+    // Unproject the corners of the clip-space cube
+    const auto inv = glm::inverse(view_proj);
+
+    glm::vec3 corners[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        const auto ndc   = corner(glm::vec3(-1.0f), glm::vec3(1.0f), i);
+        const auto world = inv * glm::vec4(ndc, 1.0f);
+        corners[i]       = glm::vec3(world) / world.w;
+    }
+    box(corners, color, depth);
+}
+
+void debug_line_batch::axis(const glm::mat4& world,
+                            float            length,
+                            debug_depth      depth)
+{
+    if (!fits(3))
+    {
+        return;
+    }
+
+    const auto origin = glm::vec3(world[3]);
+    for (int i = 0; i < 3; ++i)
+    {
+        glm::vec3 color(0.0f);
+        color[i]       = 1.0f;
+        const auto dir = glm::vec3(world[i]) * length;
+        push(origin, origin + dir, color, depth);
+    }
+}
+
+void debug_line_batch::clear() noexcept
+{
+    tested_.clear();
+    overlay_.clear();
+    dropped_ = 0;
+}
+
+std::span<const vertex> debug_line_batch::vertices(
+    debug_depth depth) const noexcept
+{
+    return depth == debug_depth::overlay ? overlay_ : tested_;
+}
+
+std::uint32_t debug_line_batch::line_count() const noexcept
+{
+    return static_cast<std::uint32_t>((tested_.size() + overlay_.size()) / 2);
+}
+
+bool debug_line_batch::fits(std::uint32_t lines) noexcept
+{
+    if (line_count() + lines > max_lines_)
+    {
+        dropped_ += lines;
+        return false;
+    }
+    return true;
+}
+
+void debug_line_batch::box(const glm::vec3 (&corners)[8],
+                           const glm::vec3& color,
+                           debug_depth      depth)
+{
+    if (!fits(static_cast<std::uint32_t>(k_box_edges.size())))
+    {
+        return;
+    }
+    for (const auto& [i, j] : k_box_edges)
+    {
+        push(corners[i], corners[j], color, depth);
+    }
+}
+
+void debug_line_batch::push(const glm::vec3& a,
+                            const glm::vec3& b,
+                            const glm::vec3& color,
+                            debug_depth      depth)
+{
+    auto& list = depth == debug_depth::overlay ? overlay_ : tested_;
+    list.push_back({ .position = a, .color = color });
+    list.push_back({ .position = b, .color = color });
+}
+
+} // namespace egen
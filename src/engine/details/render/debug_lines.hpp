@@ -0,0 +1,83 @@
+#pragma once
+
+/// @file debug_lines.hpp
+/// @brief Per-frame CPU batch of immediate-mode debug lines
+
+#include "core-api/renderer.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace egen
+{
+
+/// Accumulates debug lines into fixed-capacity vertex arrays, one per depth
+/// mode. Storage is reserved once; a shape that does not fit the remaining
+/// budget is dropped whole and counted instead of growing the arrays.
+class debug_line_batch final : public i_debug_draw
+{
+public:
+    /// @param max_lines Budget shared by both depth modes
+    explicit debug_line_batch(std::uint32_t max_lines);
+
+    void line(const glm::vec3& a,
+              const glm::vec3& b,
+              const glm::vec3& color,
+              debug_depth      depth) override;
+    void aabb(const bounds&    b,
+              const glm::vec3& color,
+              debug_depth      depth) override;
+    void obb(const bounds&    local,
+             const glm::mat4& world,
+             const glm::vec3& color,
+             debug_depth      depth) override;
+    void sphere(const glm::vec3& center,
+                float            radius,
+                const glm::vec3& color,
+                debug_depth      depth,
+                int              segments) override;
+    void frustum(const glm::mat4& view_proj,
+                 const glm::vec3& color,
+                 debug_depth      depth) override;
+    void axis(const glm::mat4& world,
+              float            length,
+              debug_depth      depth) override;
+
+    /// Drop all lines and reset the overflow counter
+    void clear() noexcept;
+
+    /// Line list vertices for one depth mode, two per line
+    [[nodiscard]] std::span<const vertex> vertices(
+        debug_depth depth) const noexcept;
+
+    [[nodiscard]] std::uint32_t line_count() const noexcept;
+    [[nodiscard]] std::uint32_t dropped() const noexcept { return dropped_; }
+    [[nodiscard]] std::uint32_t max_lines() const noexcept
+    {
+        return max_lines_;
+    }
+
+private:
+    /// True if this many more lines fit, otherwise counts them as dropped
+    [[nodiscard]] bool fits(std::uint32_t lines) noexcept;
+
+    /// Append the 12 edges of a box given its 8 corners
+    void box(const glm::vec3 (&corners)[8],
+             const glm::vec3& color,
+             debug_depth      depth);
+
+    void push(const glm::vec3& a,
+              const glm::vec3& b,
+              const glm::vec3& color,
+              debug_depth      depth);
+
+    std::vector<vertex> tested_;
+    std::vector<vertex> overlay_;
+    std::uint32_t       max_lines_ = 0;
+    std::uint32_t       dropped_   = 0; // Lines rejected this frame
+};
+
+} // namespace egen
@@ -0,0 +1,194 @@
+/// @file frustum.cpp
+/// @brief Frustum plane extraction and SIMD AABB tests
+
+#include "frustum.hpp"
+
+#if defined(__AVX__) || defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+namespace egen
+{
+
+namespace
+{
+
+/// Scalar test for box i, used for remainders and non-x86 targets
+[[nodiscard]] bool test_one(const frustum&  f,
+                            const aabb_soa& boxes,
+                            std::size_t     i) noexcept
+{
+    return f.intersects(
+        { boxes.center_x[i], boxes.center_y[i], boxes.center_z[i] },
+        { boxes.extent_x[i], boxes.extent_y[i], boxes.extent_z[i] });
+}
+
+} // namespace
+
+frustum frustum::from_matrix(const glm::mat4& m) noexcept
+{
+    // glm is column-major: row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    const glm::vec4 row0 { m[0][0], m[1][0], m[2][0], m[3][0] };
+    const glm::vec4 row1 { m[0][1], m[1][1], m[2][1], m[3][1] };
+    const glm::vec4 row2 { m[0][2], m[1][2], m[2][2], m[3][2] };
+    const glm::vec4 row3 { m[0][3], m[1][3], m[2][3], m[3][3] };
+
+    frustum f;
+    f.planes[0] = row3 + row0; // Left
+    f.planes[1] = row3 - row0; // Right
+    f.planes[2] = row3 + row1; // Bottom
+    f.planes[3] = row3 - row1; // Top
+    f.planes[4] = row3 + row2; // Near (-w..w clip; conservative for 0..w)
+    f.planes[5] = row3 - row2; // Far
+
+    for (auto& p : f.planes)
+    {
+        const float len = glm::length(glm::vec3(p));
+        if (len > 0.0f)
+        {
+            p /= len;
+        }
+    }
+    return f;
+}
+
+bool frustum::intersects(const glm::vec3& center,
+                         const glm::vec3& extents) const noexcept
+{
+    for (const auto& p : planes)
+    {
+        const glm::vec3 n { p };
+        const float     d = glm::dot(n, center) + p.w;
+        const float     r = glm::dot(glm::abs(n), extents);
+        if (d + r < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void aabb_soa::push_back(const glm::vec3& center, const glm::vec3& extents)
+{
+    center_x.push_back(center.x);
+    center_y.push_back(center.y);
+    center_z.push_back(center.z);
+    extent_x.push_back(extents.x);
+    extent_y.push_back(extents.y);
+    extent_z.push_back(extents.z);
+}
+
+void aabb_soa::clear() noexcept
+{
+    center_x.clear();
+    center_y.clear();
+    center_z.clear();
+    extent_x.clear();
+    extent_y.clear();
+    extent_z.clear();
+}
+
+std::size_t cull_aabbs(const frustum&          f,
+                       const aabb_soa&         boxes,
+                       std::span<std::uint8_t> visible) noexcept
+{
+    const std::size_t count       = std::min(boxes.size(), visible.size());
+    std::size_t       num_visible = 0;
+    std::size_t       i           = 0;
+
+#if defined(__AVX__)
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 cx = _mm256_loadu_ps(boxes.center_x.data() + i);
+        const __m256 cy = _mm256_loadu_ps(boxes.center_y.data() + i);
+        const __m256 cz = _mm256_loadu_ps(boxes.center_z.data() + i);
+        const __m256 ex = _mm256_loadu_ps(boxes.extent_x.data() + i);
+        const __m256 ey = _mm256_loadu_ps(boxes.extent_y.data() + i);
+        const __m256 ez = _mm256_loadu_ps(boxes.extent_z.data() + i);
+
+        __m256 outside = _mm256_setzero_ps();
+        for (const auto& p : f.planes)
+        {
+            const __m256 nx = _mm256_set1_ps(p.x);
+            const __m256 ny = _mm256_set1_ps(p.y);
+            const __m256 nz = _mm256_set1_ps(p.z);
+
+            const __m256 ax = _mm256_set1_ps(std::abs(p.x));
+            const __m256 ay = _mm256_set1_ps(std::abs(p.y));
+            const __m256 az = _mm256_set1_ps(std::abs(p.z));
+
+            // Signed distance of the center plus projected radius
+            __m256 d = _mm256_add_ps(_mm256_mul_ps(nx, cx),
+                                     _mm256_set1_ps(p.w));
+            d        = _mm256_add_ps(d, _mm256_mul_ps(ny, cy));
+            d        = _mm256_add_ps(d, _mm256_mul_ps(nz, cz));
+            d        = _mm256_add_ps(d, _mm256_mul_ps(ax, ex));
+            d        = _mm256_add_ps(d, _mm256_mul_ps(ay, ey));
+            d        = _mm256_add_ps(d, _mm256_mul_ps(az, ez));
+
+            outside = _mm256_or_ps(
+                outside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+
+        const auto mask = static_cast<unsigned>(_mm256_movemask_ps(outside));
+        for (std::size_t lane = 0; lane < 8; ++lane)
+        {
+            const bool in      = ((mask >> lane) & 1u) == 0;
+            visible[i + lane]  = static_cast<std::uint8_t>(in);
+            num_visible       += static_cast<std::size_t>(in);
+        }
+    }
+#endif
+
+#if defined(__SSE__) || defined(_M_X64)
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 cx = _mm_loadu_ps(boxes.center_x.data() + i);
+        const __m128 cy = _mm_loadu_ps(boxes.center_y.data() + i);
+        const __m128 cz = _mm_loadu_ps(boxes.center_z.data() + i);
+        const __m128 ex = _mm_loadu_ps(boxes.extent_x.data() + i);
+        const __m128 ey = _mm_loadu_ps(boxes.extent_y.data() + i);
+        const __m128 ez = _mm_loadu_ps(boxes.extent_z.data() + i);
+
+        __m128 outside = _mm_setzero_ps();
+        for (const auto& p : f.planes)
+        {
+            const __m128 ax = _mm_set1_ps(std::abs(p.x));
+            const __m128 ay = _mm_set1_ps(std::abs(p.y));
+            const __m128 az = _mm_set1_ps(std::abs(p.z));
+
+            __m128 d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.x), cx),
+                                  _mm_set1_ps(p.w));
+            d        = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(p.y), cy));
+            d        = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(p.z), cz));
+            d        = _mm_add_ps(d, _mm_mul_ps(ax, ex));
+            d        = _mm_add_ps(d, _mm_mul_ps(ay, ey));
+            d        = _mm_add_ps(d, _mm_mul_ps(az, ez));
+
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(d, _mm_setzero_ps()));
+        }
+
+        const auto mask = static_cast<unsigned>(_mm_movemask_ps(outside));
+        for (std::size_t lane = 0; lane < 4; ++lane)
+        {
+            const bool in      = ((mask >> lane) & 1u) == 0;
+            visible[i + lane]  = static_cast<std::uint8_t>(in);
+            num_visible       += static_cast<std::size_t>(in);
+        }
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        const bool in = test_one(f, boxes, i);
+        visible[i]    = static_cast<std::uint8_t>(in);
+        num_visible  += static_cast<std::size_t>(in);
+    }
+
+    return num_visible;
+}
+
+} // namespace egen
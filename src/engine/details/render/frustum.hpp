@@ -0,0 +1,58 @@
+#pragma once
+
+/// @file frustum.hpp
+/// @brief View frustum extraction and batched AABB culling (SSE/AVX)
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace egen
+{
+
+/// Six frustum planes (xyz = normal, w = distance), normals point inward
+struct frustum final
+{
+    std::array<glm::vec4, 6> planes {};
+
+    /// Extract planes from a clip matrix (Gribb-Hartmann).
+    /// Passing view_proj * model yields planes in model space.
+    [[nodiscard]] static frustum from_matrix(const glm::mat4& m) noexcept;
+
+    /// Test a single AABB given by center and half extents
+    [[nodiscard]] bool intersects(const glm::vec3& center,
+                                  const glm::vec3& extents) const noexcept;
+};
+
+/// Structure-of-arrays AABB set for batched culling
+struct aabb_soa final
+{
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> extent_x;
+    std::vector<float> extent_y;
+    std::vector<float> extent_z;
+
+    void push_back(const glm::vec3& center, const glm::vec3& extents);
+    void clear() noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return center_x.size();
+    }
+    [[nodiscard]] bool empty() const noexcept { return center_x.empty(); }
+};
+
+/// Test all boxes against the frustum, 8 (AVX) or 4 (SSE) at a time.
+/// @param visible Output, one entry per box: 1 = inside/intersecting
+/// @return Number of visible boxes
+std::size_t cull_aabbs(const frustum&          f,
+                       const aabb_soa&         boxes,
+                       std::span<std::uint8_t> visible) noexcept;
+
+} // namespace egen
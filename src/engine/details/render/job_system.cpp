@@ -0,0 +1,138 @@
+/// @file job_system.cpp
+/// @brief Worker pool and batched parallel_for
+
+#include "job_system.hpp"
+
+#include "core-api/profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+namespace egen
+{
+
+job_system::~job_system()
+{
+    shutdown();
+}
+
+void job_system::init(std::size_t threads)
+{
+    shutdown();
+
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    times_.assign(threads, 0.0f);
+
+    workers_.reserve(threads - 1);
+    for (std::size_t i = 1; i < threads; ++i)
+    {
+        workers_.emplace_back([this, i](const std::stop_token& stop)
+                              { worker_loop(stop, i); });
+    }
+}
+
+void job_system::shutdown()
+{
+    // Each jthread requests stop and joins as it is destroyed; the stop
+    // wakes the wake_.wait in worker_loop, which then returns
+    workers_.clear();
+    times_.assign(1, 0.0f);
+}
+
+void job_system::parallel_for(std::size_t     count,
+                              std::size_t     batch,
+                              const range_fn& fn)
+{
+    batch = std::max<std::size_t>(batch, 1);
+    std::ranges::fill(times_, 0.0f);
+    if (count == 0)
+    {
+        return;
+    }
+    if (workers_.empty() || count <= batch)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        fn(0, 0, count);
+        times_[0] = std::chrono::duration<float, std::milli>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+        return;
+    }
+
+    {
+        const std::lock_guard lock(mutex_);
+        job_   = &fn;
+        count_ = count;
+        batch_ = batch;
+        next_.store(0, std::memory_order_relaxed);
+        active_ = workers_.size();
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    run_batches(0);
+
+    // Every worker takes part in every job, so none can still hold fn
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] { return active_ == 0; });
+    job_ = nullptr;
+}
+
+void job_system::worker_loop(const std::stop_token& stop, std::size_t index)
+{
+    const auto    name  = "Render Worker " + std::to_string(index);
+    bool          named = false;
+    std::uint64_t seen  = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock lock(mutex_);
+            if (!wake_.wait(
+                    lock, stop, [&] { return generation_ != seen; }))
+            {
+                return; // Stop requested
+            }
+            seen = generation_;
+        }
+
+        if (!named && profiler_ != nullptr)
+        {
+            profiler_->set_thread_name(name.c_str());
+            named = true;
+        }
+
+        run_batches(index);
+
+        const std::lock_guard lock(mutex_);
+        if (--active_ == 0)
+        {
+            done_.notify_one();
+        }
+    }
+}
+
+void job_system::run_batches(std::size_t index)
+{
+    [[maybe_unused]] auto profiler_zone =
+        profiler_zone_begin(profiler_, "job_system::worker");
+
+    const auto start = std::chrono::steady_clock::now();
+    for (;;)
+    {
+        const auto first = next_.fetch_add(batch_, std::memory_order_relaxed);
+        if (first >= count_)
+        {
+            break;
+        }
+        (*job_)(index, first, std::min(first + batch_, count_));
+    }
+    times_[index] = std::chrono::duration<float, std::milli>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+}
+
+} // namespace egen
@@ -0,0 +1,86 @@
+#pragma once
+
+/// @file job_system.hpp
+/// @brief Fixed pool of worker threads for data-parallel frame work
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace egen
+{
+
+class i_profiler;
+
+/// Splits an index range into batches that the calling thread and a fixed
+/// set of workers pull from until it is exhausted. Worker 0 is always the
+/// calling thread, so per-worker output buffers need worker_count() slots.
+class job_system final
+{
+public:
+    /// Called with (worker index, first index, one past the last index)
+    using range_fn = std::function<void(std::size_t, std::size_t, std::size_t)>;
+
+    job_system() = default;
+    ~job_system();
+
+    job_system(const job_system&)            = delete;
+    job_system& operator=(const job_system&) = delete;
+    job_system(job_system&&)                 = delete;
+    job_system& operator=(job_system&&)      = delete;
+
+    /// Start threads - 1 workers; 0 picks one per hardware thread
+    void init(std::size_t threads = 0);
+
+    /// Stop and join the workers
+    void shutdown();
+
+    /// Run fn over [0, count) in batches of at most batch indices and wait
+    /// for all of them. Small ranges run inline on the calling thread.
+    void parallel_for(std::size_t count, std::size_t batch, const range_fn& fn);
+
+    /// Profiler for worker zones and thread names, set between jobs
+    void set_profiler(i_profiler* profiler) noexcept { profiler_ = profiler; }
+
+    /// Workers including the calling thread
+    [[nodiscard]] std::size_t worker_count() const noexcept
+    {
+        return workers_.size() + 1;
+    }
+
+    /// Busy time of each worker in the last parallel_for, in milliseconds
+    [[nodiscard]] std::span<const float> worker_times() const noexcept
+    {
+        return times_;
+    }
+
+private:
+    void worker_loop(const std::stop_token& stop, std::size_t index);
+
+    /// Pull batches of the current job until none are left
+    void run_batches(std::size_t index);
+
+    i_profiler*               profiler_ = nullptr;
+    std::vector<std::jthread> workers_;
+    std::vector<float>        times_; // One slot per worker, written by it
+
+    // Current job, published under the mutex by bumping the generation
+    const range_fn*          job_   = nullptr;
+    std::size_t              count_ = 0;
+    std::size_t              batch_ = 1;
+    std::atomic<std::size_t> next_  = 0;
+
+    std::mutex                  mutex_;
+    std::condition_variable_any wake_;
+    std::condition_variable     done_;
+    std::uint64_t               generation_ = 0;
+    std::size_t                 active_     = 0; // Workers still running
+};
+
+} // namespace egen
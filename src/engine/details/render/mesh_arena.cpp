@@ -0,0 +1,449 @@
+/// @file mesh_arena.cpp
+/// @brief Free-list sub-allocation of shared GPU mesh buffers
+
+#include "mesh_arena.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <iterator>
+
+namespace egen
+{
+
+namespace
+{
+
+/// Size of one index slot in bytes; 32-bit indices take two slots
+constexpr Uint32 k_index_size = sizeof(uint16_t);
+
+/// Free lists must be this fragmented before compaction is worthwhile
+constexpr float k_compact_fragmentation = 0.5f;
+
+/// ...and have at least this many holes
+constexpr Uint32 k_compact_min_free_blocks = 8;
+
+/// Index ranges start on 4-byte boundaries, which some backends require
+/// for buffer-to-buffer copies
+[[nodiscard]] constexpr Uint32 aligned_index_count(Uint32 count) noexcept
+{
+    return (count + 1u) & ~1u;
+}
+
+/// Index slots per index of the given element size
+[[nodiscard]] constexpr Uint32 slots_per_index(
+    SDL_GPUIndexElementSize size) noexcept
+{
+    return size == SDL_GPU_INDEXELEMENTSIZE_32BIT ? 2u : 1u;
+}
+
+/// Index slots reserved for a range, padded to the slot alignment
+[[nodiscard]] constexpr Uint32 range_slots(const mesh_range& range) noexcept
+{
+    return aligned_index_count(range.index_count *
+                               slots_per_index(range.index_size));
+}
+
+/// Capacity that fits count more elements, at least doubling
+[[nodiscard]] Uint32 grown_capacity(const range_allocator& a,
+                                    Uint32                 count) noexcept
+{
+    if (a.largest_free() >= count)
+    {
+        return a.capacity();
+    }
+    return std::max(a.capacity() * 2, a.capacity() + count);
+}
+
+} // namespace
+
+void range_allocator::reset(Uint32 capacity)
+{
+    free_.clear();
+    capacity_ = capacity;
+    used_     = 0;
+    if (capacity > 0)
+    {
+        free_.emplace(0, capacity);
+    }
+}
+
+void range_allocator::grow(Uint32 new_capacity)
+{
+    if (new_capacity <= capacity_)
+    {
+        return;
+    }
+    const auto old_capacity = capacity_;
+    capacity_               = new_capacity;
+    insert_free(old_capacity, new_capacity - old_capacity);
+}
+
+std::optional<Uint32> range_allocator::allocate(Uint32 count)
+{
+    if (count == 0)
+    {
+        return std::nullopt;
+    }
+
+    for (auto it = free_.begin(); it != free_.end(); ++it)
+    {
+        if (it->second < count)
+        {
+            continue;
+        }
+
+        const auto offset    = it->first;
+        const auto remaining = it->second - count;
+        free_.erase(it);
+        if (remaining > 0)
+        {
+            free_.emplace(offset + count, remaining);
+        }
+        used_ += count;
+        return offset;
+    }
+    return std::nullopt;
+}
+
+void range_allocator::free(Uint32 offset, Uint32 count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    used_ -= std::min(used_, count);
+    insert_free(offset, count);
+}
+
+void range_allocator::insert_free(Uint32 offset, Uint32 count)
+{
+    auto it = free_.emplace(offset, count).first;
+
+    // Merge with the following block
+    if (auto next = std::next(it);
+        next != free_.end() && it->first + it->second == next->first)
+    {
+        it->second += next->second;
+        free_.erase(next);
+    }
+
+    // Merge with the preceding block
+    if (it != free_.begin())
+    {
+        if (auto prev = std::prev(it); prev->first + prev->second == it->first)
+        {
+            prev->second += it->second;
+            free_.erase(it);
+        }
+    }
+}
+
+Uint32 range_allocator::largest_free() const noexcept
+{
+    Uint32 largest = 0;
+    for (const auto& [offset, size] : free_)
+    {
+        largest = std::max(largest, size);
+    }
+    return largest;
+}
+
+float range_allocator::fragmentation() const noexcept
+{
+    const auto total_free = capacity_ - used_;
+    if (total_free == 0)
+    {
+        return 0.0f;
+    }
+    return 1.0f - (static_cast<float>(largest_free()) /
+                   static_cast<float>(total_free));
+}
+
+mesh_arena::~mesh_arena()
+{
+    shutdown();
+}
+
+bool mesh_arena::init(SDL_GPUDevice* device,
+                      staging_ring&  staging,
+                      Uint32         vertex_stride,
+                      Uint32         vertex_capacity,
+                      Uint32         index_capacity)
+{
+    device_        = device;
+    staging_       = &staging;
+    vertex_stride_ = vertex_stride;
+
+    vertex_buffer_ = create_buffer(SDL_GPU_BUFFERUSAGE_VERTEX,
+                                   vertex_capacity * vertex_stride_);
+    index_buffer_  = create_buffer(SDL_GPU_BUFFERUSAGE_INDEX,
+                                  index_capacity * k_index_size);
+    if (vertex_buffer_ == nullptr || index_buffer_ == nullptr)
+    {
+        spdlog::error("== mesh arena: {}", SDL_GetError());
+        shutdown();
+        return false;
+    }
+
+    vertices_.reset(vertex_capacity);
+    indices_.reset(index_capacity);
+    return true;
+}
+
+void mesh_arena::shutdown()
+{
+    release_retired();
+    if (device_ == nullptr)
+    {
+        return;
+    }
+    if (vertex_buffer_ != nullptr)
+    {
+        SDL_ReleaseGPUBuffer(device_, vertex_buffer_);
+        vertex_buffer_ = nullptr;
+    }
+    if (index_buffer_ != nullptr)
+    {
+        SDL_ReleaseGPUBuffer(device_, index_buffer_);
+        index_buffer_ = nullptr;
+    }
+    vertices_.reset(0);
+    indices_.reset(0);
+}
+
+std::optional<mesh_range> mesh_arena::allocate(
+    Uint32 vertex_count, Uint32 index_count, SDL_GPUIndexElementSize index_size)
+{
+    if (vertex_buffer_ == nullptr || vertex_count == 0 || index_count == 0)
+    {
+        return std::nullopt;
+    }
+
+    const auto per_index   = slots_per_index(index_size);
+    const auto index_slots = aligned_index_count(index_count * per_index);
+    const auto vertex_cap  = grown_capacity(vertices_, vertex_count);
+    const auto index_cap   = grown_capacity(indices_, index_slots);
+    if ((vertex_cap != vertices_.capacity() ||
+         index_cap != indices_.capacity()) &&
+        !grow(vertex_cap, index_cap))
+    {
+        return std::nullopt;
+    }
+
+    const auto first_vertex = vertices_.allocate(vertex_count);
+    const auto first_index  = indices_.allocate(index_slots);
+    if (!first_vertex || !first_index)
+    {
+        if (first_vertex)
+        {
+            vertices_.free(*first_vertex, vertex_count);
+        }
+        if (first_index)
+        {
+            indices_.free(*first_index, index_slots);
+        }
+        return std::nullopt;
+    }
+
+    // Slot offsets are even, so they convert to either element size
+    return mesh_range { .first_vertex = *first_vertex,
+                        .vertex_count = vertex_count,
+                        .first_index  = *first_index / per_index,
+                        .index_count  = index_count,
+                        .index_size   = index_size };
+}
+
+void mesh_arena::free(const mesh_range& range)
+{
+    retired_ranges_.push_back(range);
+}
+
+bool mesh_arena::upload(const mesh_range&          range,
+                        std::span<const std::byte> vertices,
+                        std::span<const std::byte> indices)
+{
+    const auto index_offset =
+        range.first_index * slots_per_index(range.index_size) * k_index_size;
+    return staging_->upload_to_buffer(vertex_buffer_,
+                                      range.first_vertex * vertex_stride_,
+                                      vertices) &&
+           staging_->upload_to_buffer(index_buffer_, index_offset, indices);
+}
+
+bool mesh_arena::compact(std::span<mesh_range* const> live)
+{
+    auto* new_vb = create_buffer(SDL_GPU_BUFFERUSAGE_VERTEX,
+                                 vertices_.capacity() * vertex_stride_);
+    auto* new_ib = create_buffer(SDL_GPU_BUFFERUSAGE_INDEX,
+                                 indices_.capacity() * k_index_size);
+    if (new_vb == nullptr || new_ib == nullptr)
+    {
+        spdlog::error("== mesh arena compaction: {}", SDL_GetError());
+        if (new_vb != nullptr)
+        {
+            SDL_ReleaseGPUBuffer(device_, new_vb);
+        }
+        if (new_ib != nullptr)
+        {
+            SDL_ReleaseGPUBuffer(device_, new_ib);
+        }
+        return false;
+    }
+
+    // Pack ranges back to back, updating them in place
+    Uint32 next_vertex = 0;
+    Uint32 next_index  = 0;
+    for (auto* range : live)
+    {
+        staging_->copy_buffer(vertex_buffer_,
+                              range->first_vertex * vertex_stride_,
+                              new_vb,
+                              next_vertex * vertex_stride_,
+                              range->vertex_count * vertex_stride_);
+
+        const auto per_index   = slots_per_index(range->index_size);
+        const auto index_slots = range_slots(*range);
+        staging_->copy_buffer(index_buffer_,
+                              range->first_index * per_index * k_index_size,
+                              new_ib,
+                              next_index * k_index_size,
+                              index_slots * k_index_size);
+
+        range->first_vertex  = next_vertex;
+        range->first_index   = next_index / per_index;
+        next_vertex         += range->vertex_count;
+        next_index          += index_slots;
+    }
+
+    retired_.push_back(vertex_buffer_);
+    retired_.push_back(index_buffer_);
+    vertex_buffer_ = new_vb;
+    index_buffer_  = new_ib;
+
+    // Everything before the packed tail is in use, the rest is one block.
+    // Ranges freed this frame only live on in the retired buffers.
+    retired_ranges_.clear();
+    vertices_.reset(vertices_.capacity());
+    indices_.reset(indices_.capacity());
+    (void)vertices_.allocate(next_vertex);
+    (void)indices_.allocate(next_index);
+
+    ++compactions_;
+    spdlog::info("=> mesh arena compacted: {} meshes, {} verts, {} indices",
+                 live.size(),
+                 next_vertex,
+                 next_index);
+    return true;
+}
+
+bool mesh_arena::should_compact() const noexcept
+{
+    const auto fragmented = [](const range_allocator& a)
+    {
+        return a.free_blocks() >= k_compact_min_free_blocks &&
+               a.fragmentation() > k_compact_fragmentation;
+    };
+    return fragmented(vertices_) || fragmented(indices_);
+}
+
+void mesh_arena::release_retired()
+{
+    for (auto* buffer : retired_)
+    {
+        SDL_ReleaseGPUBuffer(device_, buffer);
+    }
+    retired_.clear();
+
+    for (const auto& range : retired_ranges_)
+    {
+        vertices_.free(range.first_vertex, range.vertex_count);
+        indices_.free(range.first_index * slots_per_index(range.index_size),
+                      range_slots(range));
+    }
+    retired_ranges_.clear();
+}
+
+mesh_arena_stats mesh_arena::stats() const noexcept
+{
+    return mesh_arena_stats {
+        .capacity = (std::uint64_t { vertices_.capacity() } * vertex_stride_) +
+                    (std::uint64_t { indices_.capacity() } * k_index_size),
+        .used     = (std::uint64_t { vertices_.used() } * vertex_stride_) +
+                    (std::uint64_t { indices_.used() } * k_index_size),
+        .free_blocks   = vertices_.free_blocks() + indices_.free_blocks(),
+        .fragmentation = std::max(vertices_.fragmentation(),
+                                  indices_.fragmentation()),
+    };
+}
+
+bool mesh_arena::grow(Uint32 vertex_capacity, Uint32 index_capacity)
+{
+    bool ok = true;
+
+    // Copy the old contents; buffers still referenced by recorded draws are
+    // retired and released at the start of the next frame
+    const auto replace = [&](SDL_GPUBuffer*&         buffer,
+                             SDL_GPUBufferUsageFlags usage,
+                             Uint32                  old_size,
+                             Uint32                  new_size)
+    {
+        auto* grown = create_buffer(usage, new_size);
+        if (grown == nullptr)
+        {
+            return false;
+        }
+
+        staging_->copy_buffer(buffer, 0, grown, 0, old_size);
+
+        retired_.push_back(buffer);
+        buffer = grown;
+        return true;
+    };
+
+    if (vertex_capacity > vertices_.capacity())
+    {
+        ok = replace(vertex_buffer_,
+                     SDL_GPU_BUFFERUSAGE_VERTEX,
+                     vertices_.capacity() * vertex_stride_,
+                     vertex_capacity * vertex_stride_);
+        if (ok)
+        {
+            vertices_.grow(vertex_capacity);
+        }
+    }
+
+    if (ok && index_capacity > indices_.capacity())
+    {
+        ok = replace(index_buffer_,
+                     SDL_GPU_BUFFERUSAGE_INDEX,
+                     indices_.capacity() * k_index_size,
+                     index_capacity * k_index_size);
+        if (ok)
+        {
+            indices_.grow(index_capacity);
+        }
+    }
+
+    if (!ok)
+    {
+        spdlog::error("== mesh arena grow: {}", SDL_GetError());
+        return false;
+    }
+
+    spdlog::info("=> mesh arena grown: {} verts, {} indices",
+                 vertices_.capacity(),
+                 indices_.capacity());
+    return true;
+}
+
+SDL_GPUBuffer* mesh_arena::create_buffer(SDL_GPUBufferUsageFlags usage,
+                                         Uint32                  size) const
+{
+    SDL_GPUBufferCreateInfo info {};
+    info.usage = usage;
+    info.size  = size;
+    return SDL_CreateGPUBuffer(device_, &info);
+}
+
+} // namespace egen
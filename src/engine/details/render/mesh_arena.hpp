@@ -0,0 +1,176 @@
+#pragma once
+
+/// @file mesh_arena.hpp
+/// @brief Shared vertex/index buffers with sub-allocated mesh ranges
+
+#include "staging.hpp"
+
+#include <SDL3/SDL_gpu.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace egen
+{
+
+/// First-fit free-list allocator over a range of elements.
+/// Free blocks are kept sorted by offset and merged with their neighbours.
+class range_allocator final
+{
+public:
+    /// Reset to a single free block covering the whole capacity
+    void reset(Uint32 capacity);
+
+    /// Extend capacity, the new tail becomes free space
+    void grow(Uint32 new_capacity);
+
+    /// Allocate count elements, nullopt if no block is large enough
+    [[nodiscard]] std::optional<Uint32> allocate(Uint32 count);
+
+    /// Return a previously allocated block
+    void free(Uint32 offset, Uint32 count);
+
+    [[nodiscard]] Uint32 capacity() const noexcept { return capacity_; }
+    [[nodiscard]] Uint32 used() const noexcept { return used_; }
+    [[nodiscard]] Uint32 free_blocks() const noexcept
+    {
+        return static_cast<Uint32>(free_.size());
+    }
+    [[nodiscard]] Uint32 largest_free() const noexcept;
+
+    /// 0 = all free space is one block, approaching 1 = scattered holes
+    [[nodiscard]] float fragmentation() const noexcept;
+
+private:
+    /// Insert a free block, merging it with adjacent free blocks
+    void insert_free(Uint32 offset, Uint32 count);
+
+    std::map<Uint32, Uint32> free_; // Offset -> size
+    Uint32                   capacity_ = 0;
+    Uint32                   used_     = 0;
+};
+
+/// Location of one mesh inside a mesh arena
+struct mesh_range final
+{
+    Uint32                  first_vertex = 0;
+    Uint32                  vertex_count = 0;
+    Uint32                  first_index  = 0; // In elements of index_size
+    Uint32                  index_count  = 0;
+    SDL_GPUIndexElementSize index_size   = SDL_GPU_INDEXELEMENTSIZE_16BIT;
+};
+
+/// Arena usage, sizes in bytes
+struct mesh_arena_stats final
+{
+    std::uint64_t capacity      = 0;
+    std::uint64_t used          = 0;
+    std::uint32_t free_blocks   = 0;
+    float         fragmentation = 0.0f; // Worst of vertex and index buffers
+};
+
+/// Large vertex and index buffers shared by many meshes of one vertex format.
+/// Meshes are drawn with base vertex / first index into the shared buffers,
+/// so consecutive draws need no buffer rebinds. Uploads and buffer moves
+/// are queued on a staging ring and reach the GPU on its next flush.
+///
+/// The index buffer is managed in 16-bit slots; a mesh with 32-bit indices
+/// takes two slots per index. Every range starts on a 4-byte boundary, so it
+/// can be addressed with either element size.
+class mesh_arena final
+{
+public:
+    mesh_arena() = default;
+    ~mesh_arena();
+
+    mesh_arena(const mesh_arena&)            = delete;
+    mesh_arena& operator=(const mesh_arena&) = delete;
+    mesh_arena(mesh_arena&&)                 = delete;
+    mesh_arena& operator=(mesh_arena&&)      = delete;
+
+    /// @param staging Upload queue, must outlive the arena
+    /// @param vertex_stride Size of one vertex in bytes
+    /// @param vertex_capacity Initial capacity in vertices
+    /// @param index_capacity Initial capacity in 16-bit index slots
+    [[nodiscard]] bool init(SDL_GPUDevice* device,
+                            staging_ring&  staging,
+                            Uint32         vertex_stride,
+                            Uint32         vertex_capacity,
+                            Uint32         index_capacity);
+
+    /// Release buffers, including retired ones
+    void shutdown();
+
+    /// Reserve space for a mesh, growing the buffers if needed
+    [[nodiscard]] std::optional<mesh_range> allocate(
+        Uint32                  vertex_count,
+        Uint32                  index_count,
+        SDL_GPUIndexElementSize index_size = SDL_GPU_INDEXELEMENTSIZE_16BIT);
+
+    /// Return a mesh range to the free lists once release_retired() runs.
+    /// Draws recorded earlier in the frame may still read it, so it must
+    /// not be handed out again before the frame is submitted.
+    void free(const mesh_range& range);
+
+    /// Queue vertex and index data for an allocated range
+    /// @param indices Index data in the element size of the range
+    [[nodiscard]] bool upload(const mesh_range&          range,
+                              std::span<const std::byte> vertices,
+                              std::span<const std::byte> indices);
+
+    /// Pack all live ranges to the start of fresh buffers and update them.
+    /// @param live Every range still allocated from this arena
+    [[nodiscard]] bool compact(std::span<mesh_range* const> live);
+
+    /// True when free space is scattered enough to be worth compacting
+    [[nodiscard]] bool should_compact() const noexcept;
+
+    /// Release buffers replaced by growth or compaction and return freed
+    /// ranges to the free lists. Draws recorded earlier in the frame may
+    /// still reference them, so call at frame start after the staging ring
+    /// has flushed the copies out of them.
+    void release_retired();
+
+    [[nodiscard]] SDL_GPUBuffer* vertex_buffer() const noexcept
+    {
+        return vertex_buffer_;
+    }
+    [[nodiscard]] SDL_GPUBuffer* index_buffer() const noexcept
+    {
+        return index_buffer_;
+    }
+
+    [[nodiscard]] mesh_arena_stats stats() const noexcept;
+
+    /// Number of compactions performed since init
+    [[nodiscard]] std::uint32_t compactions() const noexcept
+    {
+        return compactions_;
+    }
+
+private:
+    /// Replace buffers with larger ones, copying the old contents
+    [[nodiscard]] bool grow(Uint32 vertex_capacity, Uint32 index_capacity);
+
+    [[nodiscard]] SDL_GPUBuffer* create_buffer(SDL_GPUBufferUsageFlags usage,
+                                               Uint32 size) const;
+
+    SDL_GPUDevice* device_        = nullptr;
+    staging_ring*  staging_       = nullptr;
+    SDL_GPUBuffer* vertex_buffer_ = nullptr;
+    SDL_GPUBuffer* index_buffer_  = nullptr;
+    Uint32         vertex_stride_ = 0;
+
+    range_allocator vertices_; // In vertices
+    range_allocator indices_;  // In 16-bit index slots
+
+    std::vector<SDL_GPUBuffer*> retired_;
+    std::vector<mesh_range>     retired_ranges_; // Freed this frame
+    std::uint32_t               compactions_ = 0;
+};
+
+} // namespace egen
@@ -144,6 +144,7 @@ void process_primitive(const fastgltf::Asset&     asset,
             mesh.vertices[base_vertex + idx].position =
                 glm::vec3(transformed_pos);
             bounds.expand(mesh.vertices[base_vertex + idx].position);
+            mesh.bounds.expand(mesh.vertices[base_vertex + idx].position);
         });
 
     // Load normals
@@ -205,8 +206,9 @@ void process_primitive(const fastgltf::Asset&     asset,
             { mesh.vertices[base_vertex + idx].weights = w; });
     }
 
-    // Build indices
-    const auto base_index = static_cast<uint16_t>(base_vertex);
+    // Build indices; primitives merged into one mesh can exceed 16 bits, so
+    // they stay 32-bit until upload
+    const auto base_index = static_cast<std::uint32_t>(base_vertex);
 
     if (primitive.indicesAccessor.has_value())
     {
@@ -217,7 +219,7 @@ void process_primitive(const fastgltf::Asset&     asset,
             asset,
             idx_accessor,
             [&](std::uint32_t idx) {
-                mesh.indices.push_back(static_cast<uint16_t>(base_index + idx));
+                mesh.indices.push_back(base_index + idx);
             });
     }
     else
@@ -226,7 +228,8 @@ void process_primitive(const fastgltf::Asset&     asset,
         mesh.indices.reserve(mesh.indices.size() + vertex_count);
         for (std::size_t i = 0; i < vertex_count; ++i)
         {
-            mesh.indices.push_back(static_cast<uint16_t>(base_index + i));
+            mesh.indices.push_back(
+                base_index + static_cast<std::uint32_t>(i));
         }
     }
 }
@@ -634,9 +637,17 @@ void extract_textures_and_materials(const fastgltf::Asset&       asset,
         mat.emissive_factor  = glm::vec3(emissive[0], emissive[1], emissive[2]);
 
         // Alpha mode and cutoff
-        if (gltf_mat.alphaMode == fastgltf::AlphaMode::Mask)
+        switch (gltf_mat.alphaMode)
         {
-            mat.alpha_cutoff = gltf_mat.alphaCutoff;
+            case fastgltf::AlphaMode::Mask:
+                mat.alpha        = alpha_mode::mask;
+                mat.alpha_cutoff = gltf_mat.alphaCutoff;
+                break;
+            case fastgltf::AlphaMode::Blend:
+                mat.alpha = alpha_mode::blend;
+                break;
+            case fastgltf::AlphaMode::Opaque:
+                break;
         }
 
         // Double sided
@@ -1029,17 +1040,40 @@ load_result gltf_loader::load(const std::filesystem::path& path)
         model.texture_path = model.textures[0].path;
     }
 
-    // Compute world transforms for all nodes (for flattening)
+    // Compute world transforms for all nodes
     auto world_transforms = compute_world_transforms(asset);
 
+    // Meshes referenced by several nodes are loaded once and instanced
+    std::vector<std::size_t> mesh_users(asset.meshes.size(), 0);
+    for (const auto& node : asset.nodes)
+    {
+        if (node.meshIndex.has_value() && *node.meshIndex < mesh_users.size())
+        {
+            ++mesh_users[*node.meshIndex];
+        }
+    }
+
+    // First loaded mesh and primitive count of each shared glTF mesh
+    constexpr auto k_not_loaded = SIZE_MAX;
+    std::vector<std::pair<std::size_t, std::size_t>> shared_meshes(
+        asset.meshes.size(), { k_not_loaded, 0 });
+
+    // Model bounds grow by every placed mesh
+    const auto place = [&model](std::size_t mesh, const glm::mat4& transform)
+    {
+        model.instances.push_back({ .mesh = mesh, .transform = transform });
+        const auto placed = model.meshes[mesh].bounds.transformed(transform);
+        model.bounds.expand(placed.min);
+        model.bounds.expand(placed.max);
+    };
+
     int mesh_node_count = 0;
 
-    // Process nodes that have meshes (flatten for backward compatibility)
-    // TODO: Support hierarchical rendering with scene graph
     for (std::size_t node_idx = 0; node_idx < asset.nodes.size(); ++node_idx)
     {
         const auto& node = asset.nodes[node_idx];
-        if (!node.meshIndex.has_value())
+        if (!node.meshIndex.has_value() ||
+            *node.meshIndex >= asset.meshes.size())
         {
             continue;
         }
@@ -1054,7 +1088,20 @@ load_result gltf_loader::load(const std::filesystem::path& path)
             world_transform = it->second;
         }
 
-        const auto& gltf_mesh = asset.meshes[*node.meshIndex];
+        const bool shared = mesh_users[*node.meshIndex] > 1;
+        auto&      loaded = shared_meshes[*node.meshIndex];
+        if (shared && loaded.first != k_not_loaded)
+        {
+            // Already in mesh space, only place it again
+            for (std::size_t i = 0; i < loaded.second; ++i)
+            {
+                place(loaded.first + i, world_transform);
+            }
+            continue;
+        }
+
+        const auto& gltf_mesh  = asset.meshes[*node.meshIndex];
+        const auto  first_mesh = model.meshes.size();
 
         // Store skin index for this mesh
         std::size_t mesh_skin_index = SIZE_MAX;
@@ -1089,8 +1136,13 @@ load_result gltf_loader::load(const std::filesystem::path& path)
                 mesh.material_name = path.stem().string();
             }
 
-            process_primitive(
-                asset, primitive, world_transform, mesh, model.bounds);
+            // Shared meshes stay in mesh space, the rest is baked
+            aabb primitive_bounds;
+            process_primitive(asset,
+                              primitive,
+                              shared ? glm::mat4(1.0f) : world_transform,
+                              mesh,
+                              primitive_bounds);
 
             // Extract morph targets
             extract_morph_targets(asset, primitive, mesh);
@@ -1098,8 +1150,15 @@ load_result gltf_loader::load(const std::filesystem::path& path)
             if (!mesh.vertices.empty() && !mesh.indices.empty())
             {
                 model.meshes.push_back(std::move(mesh));
+                place(model.meshes.size() - 1,
+                      shared ? world_transform : glm::mat4(1.0f));
             }
         }
+
+        if (shared)
+        {
+            loaded = { first_mesh, model.meshes.size() - first_mesh };
+        }
     }
 
     if (model.meshes.empty())
@@ -1108,10 +1167,11 @@ load_result gltf_loader::load(const std::filesystem::path& path)
     }
 
     spdlog::info("=> model (gltf): {} ({} mesh nodes, {} total meshes, {} "
-                 "materials, {} textures, {} animations)",
+                 "instances, {} materials, {} textures, {} animations)",
                  path.filename().string(),
                  mesh_node_count,
                  model.meshes.size(),
+                 model.instances.size(),
                  model.materials.size(),
                  model.textures.size(),
                  model.animations.size());
@@ -0,0 +1,541 @@
+/// @file mesh_lod.cpp
+/// @brief Quadric error metric simplification with vertex-to-vertex collapse
+
+#include "mesh_lod.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <unordered_map>
+
+namespace egen
+{
+
+namespace
+{
+
+/// Meshes with fewer indices are cheap enough to always draw in full
+constexpr std::size_t k_min_lod_indices = 3 * 64;
+
+/// A level must drop at least this share of the previous one's triangles.
+/// Deliberately looser than lod_ratio: a level that misses its target
+/// because of locked borders is still worth drawing.
+constexpr float k_min_lod_reduction = 0.15f;
+
+/// Largest collapse error relative to the mesh's bounds radius
+constexpr double k_max_lod_error = 0.25;
+
+/// Symmetric 4x4 quadric accumulating weighted squared plane distances
+struct quadric final
+{
+    double xx = 0, xy = 0, xz = 0, xw = 0;
+    double yy = 0, yz = 0, yw = 0;
+    double zz = 0, zw = 0;
+    double ww     = 0;
+    double weight = 0; // Summed plane weights, to normalize the error
+
+    [[nodiscard]] static quadric plane(const glm::dvec3& n, double d, double w)
+    {
+        quadric q;
+        q.xx     = w * n.x * n.x;
+        q.xy     = w * n.x * n.y;
+        q.xz     = w * n.x * n.z;
+        q.xw     = w * n.x * d;
+        q.yy     = w * n.y * n.y;
+        q.yz     = w * n.y * n.z;
+        q.yw     = w * n.y * d;
+        q.zz     = w * n.z * n.z;
+        q.zw     = w * n.z * d;
+        q.ww     = w * d * d;
+        q.weight = w;
+        return q;
+    }
+
+    quadric& operator+=(const quadric& o) noexcept
+    {
+        xx += o.xx;
+        xy += o.xy;
+        xz += o.xz;
+        xw += o.xw;
+        yy += o.yy;
+        yz += o.yz;
+        yw += o.yw;
+        zz += o.zz;
+        zw += o.zw;
+        ww += o.ww;
+        weight += o.weight;
+        return *this;
+    }
+
+    /// Weighted sum of squared distances from p to the planes
+    [[nodiscard]] double error(const glm::dvec3& p) const noexcept
+    {
+        const double x = p.x;
+        const double y = p.y;
+        const double z = p.z;
+        return (xx * x * x) + (2 * xy * x * y) + (2 * xz * x * z) +
+               (2 * xw * x) + (yy * y * y) + (2 * yz * y * z) + (2 * yw * y) +
+               (zz * z * z) + (2 * zw * z) + ww;
+    }
+};
+
+/// Collapse of every vertex at position `from` onto position `to`
+struct edge_collapse final
+{
+    std::uint32_t from = 0;
+    std::uint32_t to   = 0;
+    double        cost = 0; // Mean squared distance, see quadric::weight
+};
+
+/// Progressive simplifier; each simplify() call continues from the result
+/// of the previous one so quadrics accumulate across levels.
+///
+/// Vertices sharing a position (UV seams, hard edges) are welded into one
+/// position id for the error metric. When a position collapses, each of
+/// its vertices is redirected to the target vertex with the closest
+/// attributes, so the output only references existing vertices.
+class simplifier final
+{
+public:
+    simplifier(std::span<const model_vertex>  vertices,
+               std::span<const std::uint32_t> indices)
+        : vertices_(vertices)
+        , indices_(indices.begin(), indices.end())
+        , remap_(vertices.size())
+    {
+        for (std::uint32_t v = 0; v < remap_.size(); ++v)
+        {
+            remap_[v] = v;
+        }
+        weld_positions();
+        build_quadrics();
+        lock_borders();
+    }
+
+    /// Collapse edges until at most target indices remain or the next
+    /// collapse would move the surface further than max_error
+    void simplify(std::size_t target, double max_error)
+    {
+        while (indices_.size() > target &&
+               collapse_pass(target, max_error * max_error))
+        {
+        }
+    }
+
+    [[nodiscard]] const std::vector<std::uint32_t>& indices() const noexcept
+    {
+        return indices_;
+    }
+
+    /// Largest surface deviation introduced so far
+    [[nodiscard]] double error() const noexcept { return std::sqrt(error_); }
+
+private:
+    [[nodiscard]] std::uint32_t pos(std::size_t corner) const noexcept
+    {
+        return weld_[indices_[corner]];
+    }
+
+    void weld_positions()
+    {
+        // Exact bit patterns: exporters duplicate seam vertices verbatim
+        struct key_hash final
+        {
+            std::size_t operator()(
+                const std::array<std::uint32_t, 3>& k) const noexcept
+            {
+                return (k[0] * 73856093u) ^ (k[1] * 19349663u) ^
+                       (k[2] * 83492791u);
+            }
+        };
+        using position_bits = std::array<std::uint32_t, 3>;
+        std::unordered_map<position_bits, std::uint32_t, key_hash> ids;
+        ids.reserve(vertices_.size());
+
+        weld_.resize(vertices_.size());
+        for (std::size_t v = 0; v < vertices_.size(); ++v)
+        {
+            const auto& p = vertices_[v].position;
+            const std::array key { std::bit_cast<std::uint32_t>(p.x),
+                                   std::bit_cast<std::uint32_t>(p.y),
+                                   std::bit_cast<std::uint32_t>(p.z) };
+            const auto [it, added] =
+                ids.try_emplace(key, static_cast<std::uint32_t>(ids.size()));
+            weld_[v] = it->second;
+            if (added)
+            {
+                positions_.emplace_back(p);
+            }
+        }
+
+        // Vertices of each position, grouped for the collapse redirect
+        group_first_.assign(positions_.size() + 1, 0);
+        for (const auto p : weld_)
+        {
+            ++group_first_[p + 1];
+        }
+        for (std::size_t p = 0; p < positions_.size(); ++p)
+        {
+            group_first_[p + 1] += group_first_[p];
+        }
+        group_.resize(weld_.size());
+        auto fill = group_first_;
+        for (std::uint32_t v = 0; v < weld_.size(); ++v)
+        {
+            group_[fill[weld_[v]]++] = v;
+        }
+    }
+
+    void build_quadrics()
+    {
+        quadrics_.assign(positions_.size(), {});
+        for (std::size_t i = 0; i + 2 < indices_.size(); i += 3)
+        {
+            const auto& p0 = positions_[pos(i)];
+            const auto  e  = glm::cross(positions_[pos(i + 1)] - p0,
+                                      positions_[pos(i + 2)] - p0);
+            const double len = glm::length(e);
+            if (len <= 0.0)
+            {
+                continue;
+            }
+            const auto n = e / len;
+            const auto q = quadric::plane(n, -glm::dot(n, p0), len * 0.5);
+            quadrics_[pos(i)] += q;
+            quadrics_[pos(i + 1)] += q;
+            quadrics_[pos(i + 2)] += q;
+        }
+    }
+
+    void lock_borders()
+    {
+        // An edge used by one triangle is on an open border, one used by
+        // more than two is non-manifold; neither end may move
+        std::vector<std::uint64_t> edges;
+        edges.reserve(indices_.size());
+        for (std::size_t i = 0; i + 2 < indices_.size(); i += 3)
+        {
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                edges.push_back(edge_key(pos(i + k), pos(i + ((k + 1) % 3))));
+            }
+        }
+        std::ranges::sort(edges);
+
+        locked_.assign(positions_.size(), 0);
+        for (std::size_t i = 0; i < edges.size();)
+        {
+            std::size_t run = 1;
+            while (i + run < edges.size() && edges[i + run] == edges[i])
+            {
+                ++run;
+            }
+            if (run != 2)
+            {
+                locked_[edges[i] >> 32]                        = 1;
+                locked_[static_cast<std::uint32_t>(edges[i])] = 1;
+            }
+            i += run;
+        }
+    }
+
+    [[nodiscard]] static std::uint64_t edge_key(std::uint32_t a,
+                                                std::uint32_t b) noexcept
+    {
+        const auto lo = std::min(a, b);
+        const auto hi = std::max(a, b);
+        return (static_cast<std::uint64_t>(lo) << 32) | hi;
+    }
+
+    /// One round of non-overlapping collapses, cheapest first
+    [[nodiscard]] bool collapse_pass(std::size_t target, double max_error_sq)
+    {
+        build_adjacency();
+
+        // Unique edges, each evaluated in its cheaper valid direction
+        std::vector<std::uint64_t> edges;
+        edges.reserve(indices_.size());
+        for (std::size_t i = 0; i + 2 < indices_.size(); i += 3)
+        {
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                edges.push_back(edge_key(pos(i + k), pos(i + ((k + 1) % 3))));
+            }
+        }
+        std::ranges::sort(edges);
+        const auto dupes = std::ranges::unique(edges);
+        edges.erase(dupes.begin(), dupes.end());
+
+        std::vector<edge_collapse> candidates;
+        candidates.reserve(edges.size());
+        for (const auto key : edges)
+        {
+            const auto a = static_cast<std::uint32_t>(key >> 32);
+            const auto b = static_cast<std::uint32_t>(key);
+            if (a == b)
+            {
+                continue;
+            }
+            auto q = quadrics_[a];
+            q += quadrics_[b];
+            const double norm = q.weight > 0.0 ? 1.0 / q.weight : 0.0;
+
+            edge_collapse best { .from = a, .to = b, .cost = -1.0 };
+            if (locked_[a] == 0)
+            {
+                best.cost = q.error(positions_[b]) * norm;
+            }
+            if (locked_[b] == 0)
+            {
+                const double cost = q.error(positions_[a]) * norm;
+                if (best.cost < 0.0 || cost < best.cost)
+                {
+                    best = { .from = b, .to = a, .cost = cost };
+                }
+            }
+            if (best.cost >= 0.0)
+            {
+                candidates.push_back(best);
+            }
+        }
+        std::ranges::sort(candidates, {}, &edge_collapse::cost);
+
+        // Each collapse removes about two triangles
+        const auto budget =
+            std::max<std::size_t>((indices_.size() - target) / 6, 1);
+
+        std::vector<std::uint8_t> touched(positions_.size(), 0);
+        std::size_t               applied = 0;
+        for (const auto& c : candidates)
+        {
+            if (applied >= budget || c.cost > max_error_sq)
+            {
+                break;
+            }
+            if (touched[c.from] != 0 || touched[c.to] != 0 || flips(c))
+            {
+                continue;
+            }
+
+            // Triangles around `from` change shape, keep their corners
+            // out of this round so later flip tests see final positions
+            for (auto t = adj_first_[c.from]; t < adj_first_[c.from + 1]; ++t)
+            {
+                const auto tri = adj_[t] * 3;
+                touched[pos(tri)]     = 1;
+                touched[pos(tri + 1)] = 1;
+                touched[pos(tri + 2)] = 1;
+            }
+            touched[c.to] = 1;
+
+            redirect(c.from, c.to);
+            quadrics_[c.to] += quadrics_[c.from];
+            error_ = std::max(error_, c.cost);
+            ++applied;
+        }
+        if (applied == 0)
+        {
+            return false;
+        }
+
+        // Rewrite triangles through the redirects and drop collapsed ones
+        std::size_t out = 0;
+        for (std::size_t i = 0; i + 2 < indices_.size(); i += 3)
+        {
+            const std::array tri { remap_[indices_[i]],
+                                   remap_[indices_[i + 1]],
+                                   remap_[indices_[i + 2]] };
+            if (weld_[tri[0]] == weld_[tri[1]] ||
+                weld_[tri[1]] == weld_[tri[2]] ||
+                weld_[tri[2]] == weld_[tri[0]])
+            {
+                continue;
+            }
+            indices_[out++] = tri[0];
+            indices_[out++] = tri[1];
+            indices_[out++] = tri[2];
+        }
+        indices_.resize(out);
+        return true;
+    }
+
+    /// Triangles incident to each position, in CSR form
+    void build_adjacency()
+    {
+        adj_first_.assign(positions_.size() + 1, 0);
+        for (std::size_t i = 0; i < indices_.size(); ++i)
+        {
+            ++adj_first_[pos(i) + 1];
+        }
+        for (std::size_t p = 0; p < positions_.size(); ++p)
+        {
+            adj_first_[p + 1] += adj_first_[p];
+        }
+        adj_.resize(indices_.size());
+        auto fill = adj_first_;
+        for (std::size_t i = 0; i < indices_.size(); ++i)
+        {
+            adj_[fill[pos(i)]++] = static_cast<std::uint32_t>(i / 3);
+        }
+    }
+
+    /// True if moving `from` onto `to` would turn a surviving triangle over
+    [[nodiscard]] bool flips(const edge_collapse& c) const
+    {
+        for (auto t = adj_first_[c.from]; t < adj_first_[c.from + 1]; ++t)
+        {
+            const auto tri = static_cast<std::size_t>(adj_[t]) * 3;
+            std::array p { pos(tri), pos(tri + 1), pos(tri + 2) };
+            if (std::ranges::find(p, c.to) != p.end())
+            {
+                continue; // Degenerates and is removed
+            }
+
+            const auto before =
+                glm::cross(positions_[p[1]] - positions_[p[0]],
+                           positions_[p[2]] - positions_[p[0]]);
+            std::ranges::replace(p, c.from, c.to);
+            const auto after =
+                glm::cross(positions_[p[1]] - positions_[p[0]],
+                           positions_[p[2]] - positions_[p[0]]);
+            if (glm::dot(before, after) <= 0.0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Point every vertex at position `from` to the vertex at `to` with the
+    /// most similar normal and texture coordinate
+    void redirect(std::uint32_t from, std::uint32_t to)
+    {
+        for (auto i = group_first_[from]; i < group_first_[from + 1]; ++i)
+        {
+            const auto& src  = vertices_[group_[i]];
+            auto        best = group_[group_first_[to]];
+            float       best_distance = std::numeric_limits<float>::max();
+            for (auto j = group_first_[to]; j < group_first_[to + 1]; ++j)
+            {
+                const auto& dst = vertices_[group_[j]];
+                const auto  dn  = dst.normal - src.normal;
+                const auto  dt  = dst.texcoord - src.texcoord;
+                const float d   = glm::dot(dn, dn) + glm::dot(dt, dt);
+                if (d < best_distance)
+                {
+                    best          = group_[j];
+                    best_distance = d;
+                }
+            }
+            remap_[group_[i]] = best;
+        }
+    }
+
+    std::span<const model_vertex> vertices_;
+    std::vector<std::uint32_t>    indices_; // Current triangles
+    std::vector<std::uint32_t>    remap_;   // Vertex -> surviving vertex
+
+    // Welded positions and the vertices that share each one
+    std::vector<std::uint32_t> weld_; // Vertex -> position id
+    std::vector<glm::dvec3>    positions_;
+    std::vector<std::uint32_t> group_first_;
+    std::vector<std::uint32_t> group_;
+
+    std::vector<quadric>       quadrics_;
+    std::vector<std::uint8_t>  locked_; // Border positions never move
+    std::vector<std::uint32_t> adj_first_;
+    std::vector<std::uint32_t> adj_; // Triangles around each position
+    double                     error_ = 0; // Squared
+};
+
+} // namespace
+
+void generate_mesh_lods(loaded_mesh& mesh, const load_options& options)
+{
+    mesh.lods.clear();
+    const auto levels =
+        std::min<std::size_t>(options.lod_levels, k_max_mesh_lods - 1);
+    const double radius = glm::length(mesh.bounds.extents());
+    if (levels == 0 || mesh.indices.size() < k_min_lod_indices ||
+        radius <= 0.0)
+    {
+        return;
+    }
+
+    const auto base_count = mesh.indices.size();
+    mesh.lods.push_back(
+        { .first_index = 0, .index_count = static_cast<uint32_t>(base_count) });
+
+    simplifier  simplify(mesh.vertices, mesh.indices);
+    std::size_t previous = base_count;
+    for (std::size_t level = 1; level <= levels; ++level)
+    {
+        const auto target =
+            static_cast<std::size_t>(static_cast<float>(previous / 3) *
+                                     options.lod_ratio) *
+            3;
+        if (target < k_min_lod_indices)
+        {
+            break;
+        }
+
+        simplify.simplify(target, k_max_lod_error * radius);
+        const auto& lod = simplify.indices();
+        if (static_cast<float>(lod.size()) >
+            static_cast<float>(previous) * (1.0f - k_min_lod_reduction))
+        {
+            break; // Stuck on locked borders or the error limit
+        }
+
+        mesh.lods.push_back({
+            .first_index = static_cast<uint32_t>(mesh.indices.size()),
+            .index_count = static_cast<uint32_t>(lod.size()),
+            .error       = static_cast<float>(simplify.error() / radius),
+        });
+        mesh.indices.insert(mesh.indices.end(), lod.begin(), lod.end());
+        previous = lod.size();
+    }
+
+    if (mesh.lods.size() == 1)
+    {
+        mesh.lods.clear();
+    }
+}
+
+void generate_lods(loaded_model& model, const load_options& options)
+{
+    if (options.lod_levels == 0)
+    {
+        return;
+    }
+
+    std::size_t meshes = 0;
+    std::size_t full   = 0;
+    std::size_t coarse = 0;
+    for (auto& mesh : model.meshes)
+    {
+        generate_mesh_lods(mesh, options);
+        if (!mesh.lods.empty())
+        {
+            ++meshes;
+            full += mesh.lods.front().index_count / 3;
+            coarse += mesh.lods.back().index_count / 3;
+        }
+    }
+    if (meshes != 0)
+    {
+        spdlog::info("=> lods: {} of {} meshes, {} -> {} tris at the coarsest",
+                     meshes,
+                     model.meshes.size(),
+                     full,
+                     coarse);
+    }
+}
+
+} // namespace egen
@@ -0,0 +1,23 @@
+#pragma once
+
+/// @file mesh_lod.hpp
+/// @brief Level-of-detail generation by quadric edge collapse
+
+#include <core-api/model_loader.hpp>
+
+namespace egen
+{
+
+/// Append coarser index lists to a mesh and describe them in mesh.lods.
+/// Edges collapse onto existing vertices, so every level shares the vertex
+/// buffer. Open borders are kept in place to preserve silhouettes.
+/// Each level targets options.lod_ratio of the previous one; generation
+/// stops once a level removes less than 15% of the previous triangles or
+/// would exceed the error limit. Leaves mesh.lods empty if no level was
+/// worth generating.
+void generate_mesh_lods(loaded_mesh& mesh, const load_options& options);
+
+/// Generate levels of detail for every mesh of a model
+void generate_lods(loaded_model& model, const load_options& options);
+
+} // namespace egen
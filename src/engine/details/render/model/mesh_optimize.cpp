@@ -0,0 +1,414 @@
+/// @file mesh_optimize.cpp
+/// @brief Tipsify, outside-in cluster sorting and vertex fetch remapping
+
+#include "mesh_optimize.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace egen
+{
+
+namespace
+{
+
+constexpr std::uint32_t k_none = UINT32_MAX;
+
+/// A cluster may end once its miss ratio is within this factor of the
+/// mesh's; smaller clusters sort better but pay more cold-cache misses
+constexpr float k_cluster_acmr_ratio = 1.05f;
+
+/// Tipsify (Sander, Nehab, Barczak 2007): fan around the vertex that will
+/// stay in the cache longest, falling back to recently used vertices
+/// @param clusters Receives the first triangle of each run that started
+/// with a jump to an unrelated vertex
+[[nodiscard]] std::vector<std::uint32_t> tipsify(
+    std::span<const std::uint32_t> indices,
+    std::size_t                    vertex_count,
+    std::vector<std::size_t>&      clusters)
+{
+    const auto tri_count = indices.size() / 3;
+
+    // Triangles around each vertex, in CSR form
+    std::vector<std::uint32_t> first(vertex_count + 1, 0);
+    for (const auto v : indices)
+    {
+        ++first[v + 1];
+    }
+    std::partial_sum(first.begin(), first.end(), first.begin());
+    std::vector<std::uint32_t> adj(indices.size());
+    {
+        auto fill = first;
+        for (std::size_t i = 0; i < indices.size(); ++i)
+        {
+            adj[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+        }
+    }
+
+    // Triangles still to emit around each vertex
+    std::vector<std::uint32_t> live(vertex_count);
+    for (std::size_t v = 0; v < vertex_count; ++v)
+    {
+        live[v] = first[v + 1] - first[v];
+    }
+
+    std::vector<std::size_t>   stamp(vertex_count, 0); // Time entered cache
+    std::vector<std::uint8_t>  emitted(tri_count, 0);
+    std::vector<std::uint32_t> dead_end;
+    std::vector<std::uint32_t> candidates;
+    std::vector<std::uint32_t> out;
+    out.reserve(indices.size());
+
+    std::size_t time   = k_vertex_cache_size + 1;
+    std::size_t cursor = 0;
+
+    const auto skip_dead_end = [&]
+    {
+        while (!dead_end.empty())
+        {
+            const auto v = dead_end.back();
+            dead_end.pop_back();
+            if (live[v] > 0)
+            {
+                return v;
+            }
+        }
+        for (; cursor < vertex_count; ++cursor)
+        {
+            if (live[cursor] > 0)
+            {
+                return static_cast<std::uint32_t>(cursor);
+            }
+        }
+        return k_none;
+    };
+
+    auto fan    = skip_dead_end();
+    bool jumped = true;
+    while (fan != k_none)
+    {
+        if (jumped)
+        {
+            clusters.push_back(out.size() / 3);
+        }
+
+        candidates.clear();
+        for (auto a = first[fan]; a < first[fan + 1]; ++a)
+        {
+            const auto t = adj[a];
+            if (emitted[t] != 0)
+            {
+                continue;
+            }
+            emitted[t] = 1;
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                const auto v = indices[(t * 3) + k];
+                out.push_back(v);
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (time - stamp[v] > k_vertex_cache_size)
+                {
+                    stamp[v] = time++;
+                }
+            }
+        }
+
+        // Prefer the candidate that stays cached through its whole fan
+        fan                = k_none;
+        std::size_t best   = 0;
+        bool        picked = false;
+        for (const auto v : candidates)
+        {
+            if (live[v] == 0)
+            {
+                continue;
+            }
+            std::size_t priority = 0;
+            if (time - stamp[v] + (2 * live[v]) <= k_vertex_cache_size)
+            {
+                priority = time - stamp[v];
+            }
+            if (!picked || priority > best)
+            {
+                best   = priority;
+                fan    = v;
+                picked = true;
+            }
+        }
+
+        jumped = fan == k_none;
+        if (jumped)
+        {
+            fan = skip_dead_end();
+        }
+    }
+    return out;
+}
+
+/// Split clusters further wherever the running miss ratio, counted from a
+/// cold cache, is already close to the mesh's, so ending the cluster there
+/// costs few extra misses once clusters are reordered
+void split_clusters(std::span<const std::uint32_t> indices,
+                    std::size_t                    vertex_count,
+                    std::vector<std::size_t>&      clusters)
+{
+    const auto tri_count = indices.size() / 3;
+    const auto threshold =
+        analyze_vertex_cache(indices, vertex_count).acmr() *
+        k_cluster_acmr_ratio;
+
+    std::vector<std::size_t> stamp(vertex_count, 0);
+    std::size_t              time = k_vertex_cache_size + 1;
+
+    std::vector<std::size_t> split;
+    split.reserve(clusters.size());
+    for (std::size_t c = 0; c < clusters.size(); ++c)
+    {
+        const auto end = c + 1 < clusters.size() ? clusters[c + 1] : tri_count;
+
+        auto        start  = clusters[c];
+        std::size_t misses = 0;
+        split.push_back(start);
+        time += k_vertex_cache_size + 1; // Sorted clusters may start cold
+        for (auto t = start; t < end; ++t)
+        {
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                const auto v = indices[(t * 3) + k];
+                if (time - stamp[v] > k_vertex_cache_size)
+                {
+                    stamp[v] = time++;
+                    ++misses;
+                }
+            }
+
+            const auto tris = static_cast<float>(t + 1 - start);
+            if (t + 1 < end && static_cast<float>(misses) <= threshold * tris)
+            {
+                start  = t + 1;
+                misses = 0;
+                split.push_back(start);
+                time += k_vertex_cache_size + 1;
+            }
+        }
+    }
+    clusters = std::move(split);
+}
+
+/// Draw clusters facing away from the mesh center first: they tend to
+/// occlude the rest, so later fragments fail the depth test
+void sort_clusters(std::span<std::uint32_t>       indices,
+                   std::span<const model_vertex>  vertices,
+                   const std::vector<std::size_t>& clusters)
+{
+    const auto tri_count = indices.size() / 3;
+
+    glm::vec3 mesh_center {};
+    float     mesh_area = 0.0f;
+
+    struct cluster_info final
+    {
+        glm::vec3 centroid {};
+        glm::vec3 normal {};
+        float     area = 0.0f;
+        float     key  = 0.0f;
+    };
+    std::vector<cluster_info> info(clusters.size());
+    for (std::size_t c = 0; c < clusters.size(); ++c)
+    {
+        const auto end = c + 1 < clusters.size() ? clusters[c + 1] : tri_count;
+        for (auto t = clusters[c]; t < end; ++t)
+        {
+            const auto& p0 = vertices[indices[t * 3]].position;
+            const auto& p1 = vertices[indices[(t * 3) + 1]].position;
+            const auto& p2 = vertices[indices[(t * 3) + 2]].position;
+            const auto  n  = glm::cross(p1 - p0, p2 - p0);
+            const float a  = glm::length(n);
+
+            info[c].centroid += (p0 + p1 + p2) * (a / 3.0f);
+            info[c].normal += n;
+            info[c].area += a;
+        }
+        mesh_center += info[c].centroid;
+        mesh_area += info[c].area;
+    }
+    if (mesh_area <= 0.0f)
+    {
+        return;
+    }
+    mesh_center /= mesh_area;
+
+    for (auto& ci : info)
+    {
+        const float n = glm::length(ci.normal);
+        if (ci.area > 0.0f && n > 0.0f)
+        {
+            ci.key = glm::dot(ci.centroid / ci.area - mesh_center,
+                              ci.normal / n);
+        }
+    }
+
+    std::vector<std::uint32_t> order(clusters.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::ranges::stable_sort(order,
+                             [&](std::uint32_t a, std::uint32_t b)
+                             { return info[a].key > info[b].key; });
+
+    std::vector<std::uint32_t> sorted;
+    sorted.reserve(indices.size());
+    for (const auto c : order)
+    {
+        const auto end = c + 1 < clusters.size() ? clusters[c + 1] : tri_count;
+        sorted.insert(sorted.end(),
+                      indices.begin() + static_cast<std::ptrdiff_t>(
+                                            clusters[c] * 3),
+                      indices.begin() + static_cast<std::ptrdiff_t>(end * 3));
+    }
+    std::ranges::copy(sorted, indices.begin());
+}
+
+/// Reorder the triangles of one index range in place
+void optimize_range(std::span<std::uint32_t>      indices,
+                    std::span<const model_vertex> vertices)
+{
+    if (indices.size() < 6)
+    {
+        return;
+    }
+
+    std::vector<std::size_t> clusters;
+    const auto ordered = tipsify(indices, vertices.size(), clusters);
+    std::ranges::copy(ordered, indices.begin());
+
+    split_clusters(indices, vertices.size(), clusters);
+    sort_clusters(indices, vertices, clusters);
+}
+
+/// Renumber vertices in order of first use; unreferenced ones are dropped
+void remap_vertex_fetch(loaded_mesh& mesh)
+{
+    const auto                 count = mesh.vertices.size();
+    std::vector<std::uint32_t> remap(count, k_none);
+    std::uint32_t              next = 0;
+    for (auto& i : mesh.indices)
+    {
+        if (remap[i] == k_none)
+        {
+            remap[i] = next++;
+        }
+        i = remap[i];
+    }
+
+    const auto reorder = [&](auto& values)
+    {
+        if (values.size() != count)
+        {
+            return; // Not per-vertex
+        }
+        std::remove_cvref_t<decltype(values)> out(next);
+        for (std::size_t v = 0; v < count; ++v)
+        {
+            if (remap[v] != k_none)
+            {
+                out[remap[v]] = values[v];
+            }
+        }
+        values = std::move(out);
+    };
+
+    reorder(mesh.vertices);
+    for (auto& target : mesh.morph_targets)
+    {
+        reorder(target.positions);
+        reorder(target.normals);
+        reorder(target.tangents);
+    }
+}
+
+} // namespace
+
+vertex_cache_stats analyze_vertex_cache(std::span<const std::uint32_t> indices,
+                                        std::size_t vertex_count)
+{
+    vertex_cache_stats stats { .triangles = indices.size() / 3 };
+
+    std::vector<std::size_t>  stamp(vertex_count, 0);
+    std::vector<std::uint8_t> seen(vertex_count, 0);
+    std::size_t               time = k_vertex_cache_size + 1;
+    for (const auto v : indices)
+    {
+        if (v >= vertex_count)
+        {
+            continue;
+        }
+        if (time - stamp[v] > k_vertex_cache_size)
+        {
+            stamp[v] = time++;
+            ++stats.transformed;
+        }
+        if (seen[v] == 0)
+        {
+            seen[v] = 1;
+            ++stats.vertices;
+        }
+    }
+    return stats;
+}
+
+std::pair<vertex_cache_stats, vertex_cache_stats> optimize_mesh(
+    loaded_mesh& mesh)
+{
+    // Full detail is the whole list unless levels were appended
+    const auto base_count =
+        mesh.lods.empty() ? mesh.indices.size() : mesh.lods.front().index_count;
+    const auto before = analyze_vertex_cache(
+        std::span(mesh.indices).first(base_count), mesh.vertices.size());
+
+    if (std::ranges::any_of(mesh.indices,
+                            [&](std::uint32_t i)
+                            { return i >= mesh.vertices.size(); }))
+    {
+        return { before, before }; // Malformed, leave as exported
+    }
+
+    if (mesh.lods.empty())
+    {
+        optimize_range(mesh.indices, mesh.vertices);
+    }
+    for (const auto& lod : mesh.lods)
+    {
+        optimize_range(
+            std::span(mesh.indices).subspan(lod.first_index, lod.index_count),
+            mesh.vertices);
+    }
+    remap_vertex_fetch(mesh);
+
+    const auto after = analyze_vertex_cache(
+        std::span(mesh.indices).first(base_count), mesh.vertices.size());
+    return { before, after };
+}
+
+void optimize_meshes(loaded_model& model)
+{
+    vertex_cache_stats before;
+    vertex_cache_stats after;
+    for (auto& mesh : model.meshes)
+    {
+        const auto [b, a] = optimize_mesh(mesh);
+        before += b;
+        after += a;
+    }
+    spdlog::info("=> vertex cache: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> "
+                 "{:.3f}",
+                 before.acmr(),
+                 after.acmr(),
+                 before.atvr(),
+                 after.atvr());
+}
+
+} // namespace egen
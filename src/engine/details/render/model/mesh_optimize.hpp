@@ -0,0 +1,66 @@
+#pragma once
+
+/// @file mesh_optimize.hpp
+/// @brief Triangle and vertex reordering for post-transform cache, overdraw
+/// and vertex fetch efficiency
+
+#include <core-api/model_loader.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+namespace egen
+{
+
+/// FIFO post-transform cache size the optimizer and the statistics assume
+constexpr std::size_t k_vertex_cache_size = 16;
+
+/// Vertex shader invocations of an index buffer under a simulated FIFO cache
+struct vertex_cache_stats final
+{
+    std::size_t transformed = 0; // Cache misses
+    std::size_t triangles   = 0;
+    std::size_t vertices    = 0; // Distinct vertices referenced
+
+    vertex_cache_stats& operator+=(const vertex_cache_stats& o) noexcept
+    {
+        transformed += o.transformed;
+        triangles += o.triangles;
+        vertices += o.vertices;
+        return *this;
+    }
+
+    /// Average cache miss ratio: transformed vertices per triangle (0.5-3)
+    [[nodiscard]] float acmr() const noexcept
+    {
+        return triangles != 0 ? static_cast<float>(transformed) /
+                                    static_cast<float>(triangles)
+                              : 0.0f;
+    }
+
+    /// Average transform to vertex ratio: 1.0 means each vertex once
+    [[nodiscard]] float atvr() const noexcept
+    {
+        return vertices != 0 ? static_cast<float>(transformed) /
+                                   static_cast<float>(vertices)
+                             : 0.0f;
+    }
+};
+
+/// Simulate a FIFO post-transform cache over an index buffer
+[[nodiscard]] vertex_cache_stats analyze_vertex_cache(
+    std::span<const std::uint32_t> indices, std::size_t vertex_count);
+
+/// Reorder a mesh for the GPU. Every level of detail is reordered with
+/// Tipsify, the resulting clusters are sorted outside-in to cut overdraw,
+/// then vertices are renumbered in order of first use so fetches stream.
+/// @return Cache statistics of the full-detail level before and after
+std::pair<vertex_cache_stats, vertex_cache_stats> optimize_mesh(
+    loaded_mesh& mesh);
+
+/// Optimize every mesh of a model and log the combined statistics
+void optimize_meshes(loaded_model& model);
+
+} // namespace egen
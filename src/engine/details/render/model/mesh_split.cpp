@@ -0,0 +1,172 @@
+/// @file mesh_split.cpp
+/// @brief Greedy triangle partitioning for 16-bit index buffers
+
+#include "mesh_split.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+namespace egen
+{
+
+namespace
+{
+
+/// Marks a source vertex not yet copied into the current chunk
+constexpr std::uint32_t k_unmapped = UINT32_MAX;
+
+/// Empty chunk carrying the non-geometry fields of the source mesh
+[[nodiscard]] loaded_mesh make_chunk(const loaded_mesh& src)
+{
+    loaded_mesh chunk;
+    chunk.material_name  = src.material_name;
+    chunk.material_index = src.material_index;
+    chunk.skin_index     = src.skin_index;
+    chunk.morph_targets.resize(src.morph_targets.size());
+    for (std::size_t t = 0; t < src.morph_targets.size(); ++t)
+    {
+        chunk.morph_targets[t].name = src.morph_targets[t].name;
+    }
+    return chunk;
+}
+
+/// Append source vertex v and its morph deltas to a chunk
+void copy_vertex(const loaded_mesh& src, std::uint32_t v, loaded_mesh& chunk)
+{
+    chunk.vertices.push_back(src.vertices[v]);
+    chunk.bounds.expand(src.vertices[v].position);
+
+    for (std::size_t t = 0; t < src.morph_targets.size(); ++t)
+    {
+        const auto& from = src.morph_targets[t];
+        auto&       to   = chunk.morph_targets[t];
+        if (v < from.positions.size())
+        {
+            to.positions.push_back(from.positions[v]);
+        }
+        if (v < from.normals.size())
+        {
+            to.normals.push_back(from.normals[v]);
+        }
+        if (v < from.tangents.size())
+        {
+            to.tangents.push_back(from.tangents[v]);
+        }
+    }
+}
+
+} // namespace
+
+std::vector<loaded_mesh> split_mesh_16bit(const loaded_mesh& mesh)
+{
+    if (mesh.required_index_format() == index_format::uint16)
+    {
+        return { mesh };
+    }
+
+    std::vector<loaded_mesh>   chunks;
+    std::vector<std::uint32_t> remap(mesh.vertices.size(), k_unmapped);
+    std::vector<std::uint32_t> touched; // Source vertices in the chunk
+    auto                       chunk = make_chunk(mesh);
+
+    const auto next_chunk = [&]
+    {
+        for (auto v : touched)
+        {
+            remap[v] = k_unmapped;
+        }
+        touched.clear();
+        chunks.push_back(std::move(chunk));
+        chunk = make_chunk(mesh);
+    };
+
+    for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+    {
+        const std::array<std::uint32_t, 3> tri { mesh.indices[i],
+                                                 mesh.indices[i + 1],
+                                                 mesh.indices[i + 2] };
+        if (std::ranges::any_of(tri,
+                                [&](std::uint32_t v)
+                                { return v >= mesh.vertices.size(); }))
+        {
+            continue; // Malformed index, drop the triangle
+        }
+
+        // Start a new chunk if the triangle's new vertices would not fit
+        const auto added = static_cast<std::size_t>(std::ranges::count(
+            tri, k_unmapped, [&](std::uint32_t v) { return remap[v]; }));
+        if (chunk.vertices.size() + added > k_max_16bit_vertices)
+        {
+            next_chunk();
+        }
+
+        for (auto v : tri)
+        {
+            if (remap[v] == k_unmapped)
+            {
+                remap[v] = static_cast<std::uint32_t>(chunk.vertices.size());
+                touched.push_back(v);
+                copy_vertex(mesh, v, chunk);
+            }
+            chunk.indices.push_back(remap[v]);
+        }
+    }
+
+    if (!chunk.indices.empty())
+    {
+        chunks.push_back(std::move(chunk));
+    }
+    return chunks;
+}
+
+void split_large_meshes(loaded_model& model)
+{
+    std::vector<loaded_mesh> meshes;
+    meshes.reserve(model.meshes.size());
+
+    // New mesh range of every original mesh, for remapping instances
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+    ranges.reserve(model.meshes.size());
+
+    for (auto& mesh : model.meshes)
+    {
+        const auto first = meshes.size();
+        if (mesh.required_index_format() == index_format::uint16)
+        {
+            meshes.push_back(std::move(mesh));
+            ranges.emplace_back(first, 1);
+            continue;
+        }
+
+        auto chunks = split_mesh_16bit(mesh);
+        spdlog::info("=> split mesh {}: {} verts into {} chunks",
+                     mesh.material_name,
+                     mesh.vertices.size(),
+                     chunks.size());
+        std::ranges::move(chunks, std::back_inserter(meshes));
+        ranges.emplace_back(first, chunks.size());
+    }
+
+    // Each chunk is placed wherever the mesh it came from was
+    std::vector<mesh_instance> instances;
+    instances.reserve(model.instances.size());
+    for (const auto& instance : model.instances)
+    {
+        const auto [first, count] = ranges[instance.mesh];
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            instances.push_back(
+                { .mesh = first + i, .transform = instance.transform });
+        }
+    }
+
+    model.meshes    = std::move(meshes);
+    model.instances = std::move(instances);
+}
+
+} // namespace egen
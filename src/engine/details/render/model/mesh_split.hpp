@@ -0,0 +1,24 @@
+#pragma once
+
+/// @file mesh_split.hpp
+/// @brief Partitioning of large meshes into 16-bit indexable chunks
+
+#include <core-api/model_loader.hpp>
+
+#include <vector>
+
+namespace egen
+{
+
+/// Partition a mesh into chunks of at most k_max_16bit_vertices vertices.
+/// Triangles are assigned in index order, so chunks keep the locality of the
+/// source index buffer. Morph targets are remapped with their vertices.
+/// @return The chunks, or a single copy of the mesh if it already fits
+[[nodiscard]] std::vector<loaded_mesh> split_mesh_16bit(
+    const loaded_mesh& mesh);
+
+/// Replace every mesh that needs 32-bit indices with its 16-bit chunks,
+/// keeping mesh order. Instances of a split mesh place all of its chunks.
+void split_large_meshes(loaded_model& model);
+
+} // namespace egen
@@ -1,5 +1,8 @@
 #include "model_system.hpp"
 #include "gltf_loader.hpp"
+#include "mesh_lod.hpp"
+#include "mesh_optimize.hpp"
+#include "mesh_split.hpp"
 
 #include <algorithm>
 #include <cctype>
@@ -18,7 +21,8 @@ public:
         loader_ = std::make_unique<gltf_loader>();
     }
 
-    load_result load(const std::filesystem::path& path) const
+    load_result load(const std::filesystem::path& path,
+                     const load_options&          options) const
     {
         if (!loader_)
         {
@@ -34,7 +38,22 @@ public:
             return std::unexpected("unsupported file extension: " + ext);
         }
 
-        return loader_->load(path);
+        auto result = loader_->load(path);
+        if (result && options.split_large_meshes)
+        {
+            split_large_meshes(*result);
+        }
+        // After splitting, so every level of a chunk fits its index width
+        if (result)
+        {
+            generate_lods(*result, options);
+        }
+        // Last, so the vertex remap covers the indices of every level
+        if (result && options.optimize_meshes)
+        {
+            optimize_meshes(*result);
+        }
+        return result;
     }
 
     bool supports(std::string_view extension) const
@@ -62,9 +81,10 @@ model_system::model_system()
 
 model_system::~model_system() = default;
 
-load_result model_system::load(const std::filesystem::path& path) const
+load_result model_system::load(const std::filesystem::path& path,
+                               const load_options&          options) const
 {
-    return pimpl_->load(path);
+    return pimpl_->load(path, options);
 }
 
 bool model_system::supports(std::string_view extension) const
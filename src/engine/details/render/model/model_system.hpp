@@ -23,9 +23,11 @@ public:
 
     /// Load a model from file
     /// @param path Path to model file
+    /// @param options Post-load processing
     /// @return Loaded model data on success, error message on failure
     [[nodiscard]] load_result load(
-        const std::filesystem::path& path) const override;
+        const std::filesystem::path& path,
+        const load_options&          options = {}) const override;
 
     /// Check if this loader supports the given file extension
     [[nodiscard]] bool supports(std::string_view extension) const override;
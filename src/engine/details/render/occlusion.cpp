@@ -0,0 +1,414 @@
+/// @file occlusion.cpp
+/// @brief Occluder triangle setup, half-space rasterization and box tests
+
+#include "occlusion.hpp"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace egen
+{
+
+namespace
+{
+
+/// Depth of pixels no occluder covers
+constexpr float k_far = std::numeric_limits<float>::max();
+
+/// Clip-space w below which a vertex is treated as degenerate
+constexpr float k_min_w = 1e-6f;
+
+} // namespace
+
+void occlusion_buffer::resize(std::uint32_t width, std::uint32_t height)
+{
+    const auto tiles_x = (width + k_tile_size - 1) / k_tile_size;
+    const auto tiles_y = (height + k_tile_size - 1) / k_tile_size;
+    if (tiles_x == tiles_x_ && tiles_y == tiles_y_)
+    {
+        return;
+    }
+    tiles_x_ = tiles_x;
+    tiles_y_ = tiles_y;
+    width_   = tiles_x * k_tile_size;
+    height_  = tiles_y * k_tile_size;
+    depth_.assign(static_cast<std::size_t>(width_) * height_, k_far);
+    tile_max_.assign(static_cast<std::size_t>(tiles_x_) * tiles_y_, k_far);
+}
+
+void occlusion_buffer::clear() noexcept
+{
+    occluder_count_ = 0;
+}
+
+void occlusion_buffer::add_occluder(std::span<const glm::vec3>     positions,
+                                    std::span<const std::uint32_t> indices,
+                                    const glm::mat4&               mvp)
+{
+    if (occluder_count_ == occluders_.size())
+    {
+        occluders_.emplace_back();
+    }
+    auto& o     = occluders_[occluder_count_++];
+    o.positions = positions;
+    o.indices   = indices;
+    o.mvp       = mvp;
+}
+
+void occlusion_buffer::setup_occluder(std::size_t index)
+{
+    auto& o = occluders_[index];
+    o.triangles.clear();
+
+    o.clip.resize(o.positions.size());
+    for (std::size_t v = 0; v < o.positions.size(); ++v)
+    {
+        o.clip[v] = o.mvp * glm::vec4(o.positions[v], 1.0f);
+    }
+
+    const auto vertex_count = o.clip.size();
+    for (std::size_t i = 0; i + 2 < o.indices.size(); i += 3)
+    {
+        const auto i0 = o.indices[i];
+        const auto i1 = o.indices[i + 1];
+        const auto i2 = o.indices[i + 2];
+        if (i0 >= vertex_count || i1 >= vertex_count || i2 >= vertex_count)
+        {
+            continue;
+        }
+        const std::array<glm::vec4, 3> tri { o.clip[i0], o.clip[i1],
+                                             o.clip[i2] };
+
+        const int in_front = static_cast<int>(tri[0].z < 0.0f) +
+                             static_cast<int>(tri[1].z < 0.0f) +
+                             static_cast<int>(tri[2].z < 0.0f);
+        if (in_front == 3)
+        {
+            continue;
+        }
+        if (in_front == 0)
+        {
+            setup_triangle(o.triangles, tri[0], tri[1], tri[2]);
+            continue;
+        }
+
+        // Sutherland-Hodgman against z = 0 leaves a triangle or a quad
+        std::array<glm::vec4, 4> poly {};
+        std::size_t              count = 0;
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            const auto& a = tri[k];
+            const auto& b = tri[(k + 1) % 3];
+            if (a.z >= 0.0f)
+            {
+                poly[count++] = a;
+            }
+            if ((a.z >= 0.0f) != (b.z >= 0.0f))
+            {
+                poly[count++] = glm::mix(a, b, a.z / (a.z - b.z));
+            }
+        }
+        for (std::size_t k = 2; k < count; ++k)
+        {
+            setup_triangle(o.triangles, poly[0], poly[k - 1], poly[k]);
+        }
+    }
+}
+
+void occlusion_buffer::setup_triangle(std::vector<triangle>& out,
+                                      const glm::vec4&       c0,
+                                      const glm::vec4&       c1,
+                                      const glm::vec4&       c2) const
+{
+    if (c0.w <= k_min_w || c1.w <= k_min_w || c2.w <= k_min_w)
+    {
+        return;
+    }
+
+    // Pixel (x, y) has its center at (x + 0.5, y + 0.5), rows top down
+    const auto w = static_cast<float>(width_);
+    const auto h = static_cast<float>(height_);
+    const auto to_screen = [&](const glm::vec4& c)
+    {
+        const float inv = 1.0f / c.w;
+        return glm::vec3 { ((c.x * inv * 0.5f) + 0.5f) * w,
+                           (0.5f - (c.y * inv * 0.5f)) * h,
+                           c.z * inv };
+    };
+    auto v0 = to_screen(c0);
+    auto v1 = to_screen(c1);
+    auto v2 = to_screen(c2);
+
+    // Occluders are closed or two-sided, so both windings rasterize
+    float area = ((v1.x - v0.x) * (v2.y - v0.y)) -
+                 ((v1.y - v0.y) * (v2.x - v0.x));
+    if (area < 0.0f)
+    {
+        std::swap(v1, v2);
+        area = -area;
+    }
+    if (!(area > 0.0f))
+    {
+        return; // Degenerate or NaN
+    }
+
+    const float min_sx = std::min({ v0.x, v1.x, v2.x });
+    const float max_sx = std::max({ v0.x, v1.x, v2.x });
+    const float min_sy = std::min({ v0.y, v1.y, v2.y });
+    const float max_sy = std::max({ v0.y, v1.y, v2.y });
+    if (max_sx < 0.0f || max_sy < 0.0f || min_sx > w || min_sy > h)
+    {
+        return;
+    }
+
+    // Pixels whose centers can fall inside, clamped before the int cast
+    triangle t;
+    t.min_x = static_cast<std::int32_t>(
+        std::ceil(std::clamp(min_sx - 0.5f, 0.0f, w - 1.0f)));
+    t.max_x = static_cast<std::int32_t>(
+        std::floor(std::clamp(max_sx - 0.5f, 0.0f, w - 1.0f)));
+    t.min_y = static_cast<std::int32_t>(
+        std::ceil(std::clamp(min_sy - 0.5f, 0.0f, h - 1.0f)));
+    t.max_y = static_cast<std::int32_t>(
+        std::floor(std::clamp(max_sy - 0.5f, 0.0f, h - 1.0f)));
+    if (t.min_x > t.max_x || t.min_y > t.max_y)
+    {
+        return; // Falls between pixel centers
+    }
+
+    const std::array<glm::vec3, 3> v { v0, v1, v2 };
+    for (std::size_t e = 0; e < 3; ++e)
+    {
+        const auto& p = v[e];
+        const auto& q = v[(e + 1) % 3];
+        t.a[e]        = p.y - q.y;
+        t.b[e]        = q.x - p.x;
+        t.c[e]        = -((t.a[e] * p.x) + (t.b[e] * p.y));
+    }
+
+    // Depth plane, pushed back by its largest change within half a pixel
+    // so a covered pixel never claims to be nearer than the triangle
+    t.zx = (((v1.z - v0.z) * (v2.y - v0.y)) -
+            ((v2.z - v0.z) * (v1.y - v0.y))) /
+           area;
+    t.zy = (((v2.z - v0.z) * (v1.x - v0.x)) -
+            ((v1.z - v0.z) * (v2.x - v0.x))) /
+           area;
+    t.z0 = v0.z - (t.zx * v0.x) - (t.zy * v0.y) +
+           (0.5f * (std::abs(t.zx) + std::abs(t.zy)));
+
+    out.push_back(t);
+}
+
+void occlusion_buffer::rasterize(const triangle& tri,
+                                 std::int32_t    band_min_y,
+                                 std::int32_t    band_max_y) noexcept
+{
+    const auto y0 = std::max(tri.min_y, band_min_y);
+    const auto y1 = std::min(tri.max_y, band_max_y);
+
+    // Four pixels per step; rows are a whole number of tiles wide
+    const auto x0 = tri.min_x & ~3;
+    const auto x1 = tri.max_x;
+
+    for (auto y = y0; y <= y1; ++y)
+    {
+        const float yc    = static_cast<float>(y) + 0.5f;
+        const float row_0 = (tri.b[0] * yc) + tri.c[0];
+        const float row_1 = (tri.b[1] * yc) + tri.c[1];
+        const float row_2 = (tri.b[2] * yc) + tri.c[2];
+        const float row_z = tri.z0 + (tri.zy * yc);
+        float*      row   = depth_.data() + (static_cast<std::size_t>(y) *
+                                          width_);
+        bool        entered = false;
+
+#if defined(__SSE__) || defined(_M_X64)
+        const __m128 a0   = _mm_set1_ps(tri.a[0]);
+        const __m128 a1   = _mm_set1_ps(tri.a[1]);
+        const __m128 a2   = _mm_set1_ps(tri.a[2]);
+        const __m128 r0   = _mm_set1_ps(row_0);
+        const __m128 r1   = _mm_set1_ps(row_1);
+        const __m128 r2   = _mm_set1_ps(row_2);
+        const __m128 zx   = _mm_set1_ps(tri.zx);
+        const __m128 rz   = _mm_set1_ps(row_z);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 step = _mm_set1_ps(4.0f);
+        const float  xc   = static_cast<float>(x0) + 0.5f;
+        __m128       xs   = _mm_setr_ps(xc, xc + 1.0f, xc + 2.0f, xc + 3.0f);
+
+        for (auto x = x0; x <= x1; x += 4, xs = _mm_add_ps(xs, step))
+        {
+            const __m128 e0 = _mm_add_ps(_mm_mul_ps(a0, xs), r0);
+            const __m128 e1 = _mm_add_ps(_mm_mul_ps(a1, xs), r1);
+            const __m128 e2 = _mm_add_ps(_mm_mul_ps(a2, xs), r2);
+            const __m128 inside =
+                _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero),
+                                      _mm_cmpge_ps(e1, zero)),
+                           _mm_cmpge_ps(e2, zero));
+            if (_mm_movemask_ps(inside) == 0)
+            {
+                if (entered)
+                {
+                    break; // Convex: nothing further along this row
+                }
+                continue;
+            }
+            entered = true;
+
+            const __m128 z       = _mm_add_ps(_mm_mul_ps(zx, xs), rz);
+            const __m128 old     = _mm_loadu_ps(row + x);
+            const __m128 nearest = _mm_min_ps(old, z);
+            _mm_storeu_ps(row + x,
+                          _mm_or_ps(_mm_and_ps(inside, nearest),
+                                    _mm_andnot_ps(inside, old)));
+        }
+#else
+        for (auto x = x0; x <= x1; ++x)
+        {
+            const float xc = static_cast<float>(x) + 0.5f;
+            if ((tri.a[0] * xc) + row_0 < 0.0f ||
+                (tri.a[1] * xc) + row_1 < 0.0f ||
+                (tri.a[2] * xc) + row_2 < 0.0f)
+            {
+                if (entered)
+                {
+                    break;
+                }
+                continue;
+            }
+            entered = true;
+            row[x]  = std::min(row[x], (tri.zx * xc) + row_z);
+        }
+#endif
+    }
+}
+
+void occlusion_buffer::rasterize_band(std::size_t band)
+{
+    const auto min_y = static_cast<std::int32_t>(band * k_tile_size);
+    const auto max_y = min_y + static_cast<std::int32_t>(k_tile_size) - 1;
+
+    const auto first = static_cast<std::size_t>(min_y) * width_;
+    std::fill(depth_.begin() + static_cast<std::ptrdiff_t>(first),
+              depth_.begin() +
+                  static_cast<std::ptrdiff_t>(first + (k_tile_size * width_)),
+              k_far);
+
+    for (std::size_t i = 0; i < occluder_count_; ++i)
+    {
+        for (const auto& tri : occluders_[i].triangles)
+        {
+            if (tri.max_y >= min_y && tri.min_y <= max_y)
+            {
+                rasterize(tri, min_y, max_y);
+            }
+        }
+    }
+
+    // Tiles entirely nearer than a box let occluded() skip their pixels
+    for (std::uint32_t tx = 0; tx < tiles_x_; ++tx)
+    {
+        float farthest = 0.0f;
+        for (std::uint32_t y = 0; y < k_tile_size; ++y)
+        {
+            const auto* row = depth_.data() + first + (y * width_) +
+                              (tx * k_tile_size);
+            farthest = std::max(farthest, *std::max_element(row,
+                                                            row + k_tile_size));
+        }
+        tile_max_[(band * tiles_x_) + tx] = farthest;
+    }
+}
+
+bool occlusion_buffer::occluded(const glm::vec3& center,
+                                const glm::vec3& extents,
+                                const glm::mat4& mvp) const noexcept
+{
+    if (occluder_count_ == 0 || width_ == 0)
+    {
+        return false;
+    }
+
+    const auto w = static_cast<float>(width_);
+    const auto h = static_cast<float>(height_);
+
+    float min_sx = std::numeric_limits<float>::max();
+    float min_sy = std::numeric_limits<float>::max();
+    float max_sx = std::numeric_limits<float>::lowest();
+    float max_sy = std::numeric_limits<float>::lowest();
+    float min_z  = std::numeric_limits<float>::max();
+    for (std::uint32_t i = 0; i < 8; ++i)
+    {
+        const glm::vec3 sign { (i & 1u) != 0 ? 1.0f : -1.0f,
+                               (i & 2u) != 0 ? 1.0f : -1.0f,
+                               (i & 4u) != 0 ? 1.0f : -1.0f };
+        const auto c = mvp * glm::vec4(center + (extents * sign), 1.0f);
+        if (c.z < 0.0f || c.w <= k_min_w)
+        {
+            return false; // Crosses the near plane
+        }
+        const float inv = 1.0f / c.w;
+        const float sx  = ((c.x * inv * 0.5f) + 0.5f) * w;
+        const float sy  = (0.5f - (c.y * inv * 0.5f)) * h;
+        min_sx          = std::min(min_sx, sx);
+        max_sx          = std::max(max_sx, sx);
+        min_sy          = std::min(min_sy, sy);
+        max_sy          = std::max(max_sy, sy);
+        min_z           = std::min(min_z, c.z * inv);
+    }
+    if (max_sx < 0.0f || max_sy < 0.0f || min_sx >= w || min_sy >= h)
+    {
+        return false; // Off screen; frustum culling decides
+    }
+
+    // Every pixel the projected box touches
+    const auto x0 = static_cast<std::uint32_t>(std::max(min_sx, 0.0f));
+    const auto y0 = static_cast<std::uint32_t>(std::max(min_sy, 0.0f));
+    const auto x1 = static_cast<std::uint32_t>(std::min(max_sx, w - 1.0f));
+    const auto y1 = static_cast<std::uint32_t>(std::min(max_sy, h - 1.0f));
+
+    for (auto ty = y0 / k_tile_size; ty <= y1 / k_tile_size; ++ty)
+    {
+        for (auto tx = x0 / k_tile_size; tx <= x1 / k_tile_size; ++tx)
+        {
+            if (tile_max_[(ty * tiles_x_) + tx] < min_z)
+            {
+                continue; // Whole tile is nearer than the box
+            }
+            const auto py0 = std::max(y0, ty * k_tile_size);
+            const auto py1 = std::min(y1, (ty * k_tile_size) + k_tile_size - 1);
+            const auto px0 = std::max(x0, tx * k_tile_size);
+            const auto px1 = std::min(x1, (tx * k_tile_size) + k_tile_size - 1);
+            for (auto y = py0; y <= py1; ++y)
+            {
+                const auto* row = depth_.data() +
+                                  (static_cast<std::size_t>(y) * width_);
+                for (auto x = px0; x <= px1; ++x)
+                {
+                    if (row[x] >= min_z)
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+std::size_t occlusion_buffer::triangle_count() const noexcept
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < occluder_count_; ++i)
+    {
+        count += occluders_[i].triangles.size();
+    }
+    return count;
+}
+
+} // namespace egen
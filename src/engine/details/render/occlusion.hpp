@@ -0,0 +1,133 @@
+#pragma once
+
+/// @file occlusion.hpp
+/// @brief Software depth buffer for occlusion culling
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace egen
+{
+
+/// Low-resolution depth buffer rasterized on the CPU from occluder meshes,
+/// then used to reject bounding boxes hidden behind them. Works on any
+/// model-space mesh and matrix, independent of the GPU.
+///
+/// A frame runs in three phases, each parallel across its own items:
+/// setup_occluder() for every occluder, rasterize_band() for every band,
+/// then any number of occluded() queries. Depth is z/w of the clip space
+/// the matrices produce; geometry in front of z = 0 is clipped away.
+///
+/// Rejection is conservative: occluders store the farthest depth over each
+/// pixel they cover, boxes are tested with their nearest corner, and boxes
+/// that cross the near plane are never rejected.
+class occlusion_buffer final
+{
+public:
+    /// Pixels per tile side; bands are one tile row high
+    static constexpr std::uint32_t k_tile_size = 8;
+
+    /// Set the resolution, rounded up to whole tiles
+    void resize(std::uint32_t width, std::uint32_t height);
+
+    /// Drop the previous frame's occluders
+    void clear() noexcept;
+
+    /// Queue an occluder. The spans must stay valid until rasterization
+    /// has finished.
+    void add_occluder(std::span<const glm::vec3>     positions,
+                      std::span<const std::uint32_t> indices,
+                      const glm::mat4&               mvp);
+
+    [[nodiscard]] std::size_t occluder_count() const noexcept
+    {
+        return occluder_count_;
+    }
+
+    /// Transform, clip and set up the triangles of one occluder
+    void setup_occluder(std::size_t index);
+
+    [[nodiscard]] std::size_t band_count() const noexcept { return tiles_y_; }
+
+    /// Clear one band, rasterize every set-up triangle that overlaps it and
+    /// refresh the band's tile depths. Requires every occluder set up.
+    void rasterize_band(std::size_t band);
+
+    /// True if the box is hidden behind the rasterized occluders
+    /// @param center, extents Box in the space mvp transforms from
+    [[nodiscard]] bool occluded(const glm::vec3& center,
+                                const glm::vec3& extents,
+                                const glm::mat4& mvp) const noexcept;
+
+    /// Triangles set up this frame, after clipping
+    [[nodiscard]] std::size_t triangle_count() const noexcept;
+
+    [[nodiscard]] std::uint32_t width() const noexcept { return width_; }
+    [[nodiscard]] std::uint32_t height() const noexcept { return height_; }
+
+    /// Per-pixel nearest occluder depth, rows top to bottom
+    [[nodiscard]] std::span<const float> depth() const noexcept
+    {
+        return depth_;
+    }
+
+private:
+    /// Screen-space triangle ready for rasterization
+    struct triangle final
+    {
+        // Edge functions a * x + b * y + c, non-negative inside
+        std::array<float, 3> a {};
+        std::array<float, 3> b {};
+        std::array<float, 3> c {};
+
+        // Farthest depth over the pixel at (x, y): z0 + zx * x + zy * y
+        float z0 = 0.0f;
+        float zx = 0.0f;
+        float zy = 0.0f;
+
+        // Covered pixels, inclusive and clamped to the buffer
+        std::int32_t min_x = 0;
+        std::int32_t max_x = 0;
+        std::int32_t min_y = 0;
+        std::int32_t max_y = 0;
+    };
+
+    struct occluder final
+    {
+        std::span<const glm::vec3>     positions;
+        std::span<const std::uint32_t> indices;
+        glm::mat4                      mvp { 1.0f };
+        std::vector<glm::vec4>         clip;      // Scratch, per vertex
+        std::vector<triangle>          triangles; // Set up this frame
+    };
+
+    /// Add a clip-space triangle with every vertex on or past the near
+    /// plane
+    void setup_triangle(std::vector<triangle>& out,
+                        const glm::vec4&       c0,
+                        const glm::vec4&       c1,
+                        const glm::vec4&       c2) const;
+
+    void rasterize(const triangle& tri,
+                   std::int32_t    band_min_y,
+                   std::int32_t    band_max_y) noexcept;
+
+    // Occluders are reused across frames to keep their allocations
+    std::vector<occluder> occluders_;
+    std::size_t           occluder_count_ = 0;
+
+    std::vector<float> depth_;    // Nearest occluder depth per pixel
+    std::vector<float> tile_max_; // Farthest of each tile's pixels
+
+    std::uint32_t width_   = 0;
+    std::uint32_t height_  = 0;
+    std::uint32_t tiles_x_ = 0;
+    std::uint32_t tiles_y_ = 0;
+};
+
+} // namespace egen
@@ -0,0 +1,222 @@
+/// @file pipeline_cache.cpp
+/// @brief Pipeline variant creation, lookup and background pre-creation
+
+#include "pipeline_cache.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace egen
+{
+
+pipeline_cache::~pipeline_cache()
+{
+    shutdown();
+}
+
+void pipeline_cache::shutdown()
+{
+    cancel_precreate();
+
+    const std::lock_guard lock(mutex_);
+    for (const auto& e : entries_)
+    {
+        if (e.pipeline != nullptr)
+        {
+            SDL_ReleaseGPUGraphicsPipeline(device_, e.pipeline);
+        }
+    }
+    entries_.clear();
+    programs_ = {};
+    device_   = nullptr;
+}
+
+void pipeline_cache::set_program(pipeline_program      program,
+                                 pipeline_program_desc desc)
+{
+    // The worker may be reading the old shaders
+    cancel_precreate();
+
+    const std::lock_guard lock(mutex_);
+    std::erase_if(entries_,
+                  [&](const entry& e)
+                  {
+                      if (e.key.program != program)
+                      {
+                          return false;
+                      }
+                      if (e.pipeline != nullptr)
+                      {
+                          SDL_ReleaseGPUGraphicsPipeline(device_, e.pipeline);
+                      }
+                      return true;
+                  });
+    programs_[static_cast<std::size_t>(program)] = std::move(desc);
+}
+
+SDL_GPUGraphicsPipeline* pipeline_cache::get(const pipeline_key& key)
+{
+    std::unique_lock lock(mutex_);
+    for (;;)
+    {
+        if (const auto* e = find(key))
+        {
+            return e->pipeline;
+        }
+        if (std::ranges::find(building_, key) == building_.end())
+        {
+            break;
+        }
+        built_.wait(lock);
+    }
+
+    // Create outside the lock so the other thread can keep looking up
+    building_.push_back(key);
+    const auto desc = programs_[static_cast<std::size_t>(key.program)];
+    lock.unlock();
+
+    auto* pipeline = create(key, desc);
+
+    lock.lock();
+    std::erase(building_, key);
+    entries_.push_back({ .key = key, .pipeline = pipeline });
+    built_.notify_all();
+    return pipeline;
+}
+
+void pipeline_cache::precreate(std::vector<pipeline_key> keys)
+{
+    cancel_precreate();
+    if (keys.empty())
+    {
+        return;
+    }
+
+    worker_ = std::jthread(
+        [this, keys = std::move(keys)](const std::stop_token& stop)
+        {
+            std::size_t built = 0;
+            for (const auto& key : keys)
+            {
+                if (stop.stop_requested())
+                {
+                    return;
+                }
+                built += get(key) != nullptr ? 1 : 0;
+            }
+            spdlog::info("=> pipelines: {} of {} variants ready",
+                         built,
+                         keys.size());
+        });
+}
+
+void pipeline_cache::cancel_precreate()
+{
+    if (worker_.joinable())
+    {
+        worker_.request_stop();
+        worker_.join();
+    }
+}
+
+std::size_t pipeline_cache::size() const
+{
+    const std::lock_guard lock(mutex_);
+    return entries_.size();
+}
+
+SDL_GPUGraphicsPipeline* pipeline_cache::create(
+    const pipeline_key& key, const pipeline_program_desc& desc) const
+{
+    if (desc.vertex_shader == nullptr || desc.fragment_shader == nullptr)
+    {
+        return nullptr;
+    }
+
+    SDL_GPUVertexBufferDescription vb_desc {};
+    vb_desc.slot       = 0;
+    vb_desc.pitch      = desc.vertex_pitch;
+    vb_desc.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX;
+
+    // Programs without a vertex pitch generate vertices from the vertex ID
+    SDL_GPUVertexInputState vertex_input {};
+    if (desc.vertex_pitch != 0)
+    {
+        vertex_input.vertex_buffer_descriptions = &vb_desc;
+        vertex_input.num_vertex_buffers         = 1;
+        vertex_input.vertex_attributes          = desc.attributes.data();
+        vertex_input.num_vertex_attributes =
+            static_cast<Uint32>(desc.attributes.size());
+    }
+
+    SDL_GPUColorTargetDescription color_target {};
+    color_target.format                   = key.color_format;
+    color_target.blend_state.enable_blend = key.blend;
+    if (key.blend)
+    {
+        auto& blend                 = color_target.blend_state;
+        blend.src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA;
+        blend.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+        blend.color_blend_op        = SDL_GPU_BLENDOP_ADD;
+        blend.src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
+        blend.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
+        blend.alpha_blend_op        = SDL_GPU_BLENDOP_ADD;
+    }
+
+    SDL_GPURasterizerState raster_state {};
+    raster_state.fill_mode  = key.fill_mode;
+    raster_state.cull_mode  = key.cull_mode;
+    raster_state.front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE;
+
+    SDL_GPUGraphicsPipelineCreateInfo info {};
+    info.vertex_shader                         = desc.vertex_shader;
+    info.fragment_shader                       = desc.fragment_shader;
+    info.vertex_input_state                    = vertex_input;
+    info.primitive_type                        = key.topology;
+    info.rasterizer_state                      = raster_state;
+    info.multisample_state.sample_count        = key.sample_count;
+    if (key.color_format != SDL_GPU_TEXTUREFORMAT_INVALID)
+    {
+        info.target_info.color_target_descriptions = &color_target;
+        info.target_info.num_color_targets         = 1;
+    }
+
+    if (key.depth != pipeline_depth::none)
+    {
+        const bool tested = key.depth != pipeline_depth::overlay;
+
+        SDL_GPUDepthStencilState depth_state {};
+        depth_state.compare_op = key.depth == pipeline_depth::equal
+                                     ? SDL_GPU_COMPAREOP_EQUAL
+                                 : tested ? SDL_GPU_COMPAREOP_LESS
+                                          : SDL_GPU_COMPAREOP_ALWAYS;
+        depth_state.enable_depth_test  = tested;
+        depth_state.enable_depth_write = key.depth == pipeline_depth::tested;
+
+        info.depth_stencil_state = depth_state;
+        info.target_info.depth_stencil_format =
+            SDL_GPU_TEXTUREFORMAT_D32_FLOAT;
+        info.target_info.has_depth_stencil_target = true;
+    }
+
+    auto* pipeline = SDL_CreateGPUGraphicsPipeline(device_, &info);
+    if (pipeline == nullptr)
+    {
+        spdlog::error("== pipeline (program {}, {}x): {}",
+                      static_cast<int>(key.program),
+                      1 << static_cast<int>(key.sample_count),
+                      SDL_GetError());
+    }
+    return pipeline;
+}
+
+const pipeline_cache::entry* pipeline_cache::find(
+    const pipeline_key& key) const noexcept
+{
+    const auto it = std::ranges::find(entries_, key, &entry::key);
+    return it != entries_.end() ? &*it : nullptr;
+}
+
+} // namespace egen
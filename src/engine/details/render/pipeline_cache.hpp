@@ -0,0 +1,141 @@
+#pragma once
+
+/// @file pipeline_cache.hpp
+/// @brief Graphics pipeline variants keyed by render state, built on demand
+/// or ahead of time on a worker thread
+
+#include <SDL3/SDL_gpu.h>
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace egen
+{
+
+/// Shader programs pipelines are built from
+enum class pipeline_program : std::uint8_t
+{
+    wireframe,
+    textured,
+    textured_instanced,
+    textured_packed,
+    textured_packed_instanced,
+    textured_alpha, // Alpha-test/blend fragment shader for the above four
+    textured_alpha_instanced,
+    textured_packed_alpha,
+    textured_packed_alpha_instanced,
+    depth_only, // Position-only depth pre-pass for the first four
+    depth_only_instanced,
+    depth_only_packed,
+    depth_only_packed_instanced,
+    postprocess,
+    count,
+};
+
+/// Depth state of a pipeline variant
+enum class pipeline_depth : std::uint8_t
+{
+    none,      // No depth target
+    tested,    // Less-than test with depth writes
+    read_only, // Less-than test without depth writes
+    equal,     // Equal test without depth writes, after a depth pre-pass
+    overlay,   // Depth target bound but ignored
+};
+
+/// Everything that distinguishes one pipeline variant from another
+struct pipeline_key final
+{
+    pipeline_program     program      = pipeline_program::wireframe;
+    SDL_GPUSampleCount   sample_count = SDL_GPU_SAMPLECOUNT_1;
+    SDL_GPUPrimitiveType topology     = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST;
+    SDL_GPUFillMode      fill_mode    = SDL_GPU_FILLMODE_FILL;
+    SDL_GPUCullMode      cull_mode    = SDL_GPU_CULLMODE_NONE;
+    pipeline_depth       depth        = pipeline_depth::tested;
+    SDL_GPUTextureFormat color_format =
+        SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM; // Invalid = no color target
+    bool blend = false;                       // Source alpha over target
+
+    [[nodiscard]] bool operator==(const pipeline_key&) const = default;
+};
+
+/// Shaders and vertex layout shared by every variant of a program
+struct pipeline_program_desc final
+{
+    SDL_GPUShader*                      vertex_shader   = nullptr;
+    SDL_GPUShader*                      fragment_shader = nullptr;
+    std::vector<SDL_GPUVertexAttribute> attributes;
+    Uint32 vertex_pitch = 0; // 0 = no vertex buffer
+};
+
+/// Owns every pipeline variant created so far. Variants stay alive until
+/// their program is replaced, so switching between states that were seen
+/// before (e.g. MSAA levels) is a lookup. precreate() builds variants on a
+/// worker thread ahead of their first use; get() on a variant the worker is
+/// still building waits for it instead of building it twice.
+class pipeline_cache final
+{
+public:
+    pipeline_cache() = default;
+    ~pipeline_cache();
+
+    pipeline_cache(const pipeline_cache&)            = delete;
+    pipeline_cache& operator=(const pipeline_cache&) = delete;
+    pipeline_cache(pipeline_cache&&)                 = delete;
+    pipeline_cache& operator=(pipeline_cache&&)      = delete;
+
+    void init(SDL_GPUDevice* device) noexcept { device_ = device; }
+
+    /// Stop the worker and release every pipeline
+    void shutdown();
+
+    /// Replace a program's shaders, releasing the variants built from the
+    /// old ones. Stops background creation first.
+    void set_program(pipeline_program program, pipeline_program_desc desc);
+
+    /// Pipeline for key, created on the calling thread on a miss. Safe to
+    /// call from the worker and the render thread at once.
+    /// @return Pipeline, or nullptr if the program has no shaders or
+    /// creation failed
+    [[nodiscard]] SDL_GPUGraphicsPipeline* get(const pipeline_key& key);
+
+    /// Build the given variants on a worker thread. Replaces any batch that
+    /// is still running.
+    void precreate(std::vector<pipeline_key> keys);
+
+    /// Abandon background creation after the variant in progress.
+    /// Required before the shaders of any program are released.
+    void cancel_precreate();
+
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    struct entry final
+    {
+        pipeline_key             key;
+        SDL_GPUGraphicsPipeline* pipeline = nullptr; // nullptr = failed
+    };
+
+    [[nodiscard]] SDL_GPUGraphicsPipeline* create(
+        const pipeline_key& key, const pipeline_program_desc& desc) const;
+
+    [[nodiscard]] const entry* find(const pipeline_key& key) const noexcept;
+
+    SDL_GPUDevice* device_ = nullptr;
+
+    std::array<pipeline_program_desc,
+               static_cast<std::size_t>(pipeline_program::count)>
+                              programs_;
+    std::vector<entry>        entries_;
+    std::vector<pipeline_key> building_; // Being created outside the lock
+
+    mutable std::mutex      mutex_;
+    std::condition_variable built_;
+    std::jthread            worker_;
+};
+
+} // namespace egen
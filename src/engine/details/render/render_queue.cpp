@@ -0,0 +1,75 @@
+/// @file render_queue.cpp
+/// @brief Radix sort for draw packets
+
+#include "render_queue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace egen
+{
+
+std::uint32_t sort_key::quantize_depth(float depth) noexcept
+{
+    const auto bits = std::bit_cast<std::uint32_t>(std::max(depth, 0.0f));
+    return bits >> 8; // 32 - 24 bits
+}
+
+void render_queue::sort()
+{
+    constexpr std::size_t k_radix  = 256;
+    constexpr std::size_t k_passes = sizeof(std::uint64_t);
+
+    if (packets_.size() < 2)
+    {
+        return;
+    }
+
+    // Build all histograms in a single read of the keys
+    std::array<std::array<std::uint32_t, k_radix>, k_passes> histograms {};
+    for (const auto& p : packets_)
+    {
+        for (std::size_t pass = 0; pass < k_passes; ++pass)
+        {
+            ++histograms[pass][(p.key >> (pass * 8)) & 0xFF];
+        }
+    }
+
+    scratch_.resize(packets_.size());
+    auto* src = &packets_;
+    auto* dst = &scratch_;
+
+    for (std::size_t pass = 0; pass < k_passes; ++pass)
+    {
+        auto& histogram = histograms[pass];
+
+        // Every key has the same byte here, nothing to reorder
+        const auto first_key_byte = ((*src)[0].key >> (pass * 8)) & 0xFF;
+        if (histogram[first_key_byte] == src->size())
+        {
+            continue;
+        }
+
+        std::uint32_t offset = 0;
+        for (auto& count : histogram)
+        {
+            const auto c = count;
+            count        = offset;
+            offset      += c;
+        }
+
+        for (const auto& p : *src)
+        {
+            (*dst)[histogram[(p.key >> (pass * 8)) & 0xFF]++] = p;
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != &packets_)
+    {
+        packets_.swap(scratch_);
+    }
+}
+
+} // namespace egen
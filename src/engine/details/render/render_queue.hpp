@@ -0,0 +1,112 @@
+#pragma once
+
+/// @file render_queue.hpp
+/// @brief Per-frame queue of sort-keyed draw packets
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace egen
+{
+
+/// Draw packet: 64-bit sort key plus index of the recorded draw item
+struct draw_packet final
+{
+    std::uint64_t key  = 0;
+    std::uint32_t item = 0;
+};
+
+/// Sort key layout, most significant bits first:
+///   [63..62] layer     - coarse ordering (opaque, masked, blended, overlay)
+///   [61..56] pipeline  - pipeline slot
+///   [55..40] material  - low bits of the material index, which also fixes
+///                        the texture, so each material binds once
+///   [39..24] mesh      - low bits of the mesh id
+///   [23..0]  depth     - view depth, front to back
+/// Blended draws keep only the depth, inverted, so they sort back to front.
+namespace sort_key
+{
+
+/// Coarse draw layers, drawn in ascending order
+enum class layer : std::uint8_t
+{
+    world       = 0,
+    alpha_test  = 1, // Discarding fragments, after opaque depth is laid down
+    transparent = 2, // Blended without depth writes
+    overlay     = 3, // No depth test, must come last
+};
+
+constexpr std::uint64_t k_layer_shift    = 62;
+constexpr std::uint64_t k_pipeline_shift = 56;
+constexpr std::uint64_t k_material_shift = 40;
+constexpr std::uint64_t k_mesh_shift     = 24;
+
+constexpr std::uint64_t k_pipeline_mask = 0x3Full;
+constexpr std::uint64_t k_material_mask = 0xFFFFull;
+constexpr std::uint64_t k_mesh_mask     = 0xFFFFull;
+constexpr std::uint64_t k_depth_mask    = 0xFFFFFFull;
+
+/// Quantize a non-negative view depth to 24 bits. Positive IEEE floats sort
+/// like integers, so the top bits of the pattern keep the ordering.
+[[nodiscard]] std::uint32_t quantize_depth(float depth) noexcept;
+
+[[nodiscard]] constexpr std::uint64_t make(layer         l,
+                                           std::uint32_t pipeline,
+                                           std::uint64_t material,
+                                           std::uint64_t mesh,
+                                           std::uint32_t depth) noexcept
+{
+    return (static_cast<std::uint64_t>(l) << k_layer_shift) |
+           ((pipeline & k_pipeline_mask) << k_pipeline_shift) |
+           ((material & k_material_mask) << k_material_shift) |
+           ((mesh & k_mesh_mask) << k_mesh_shift) | (depth & k_depth_mask);
+}
+
+/// Key for a blended draw: composited back to front regardless of state
+[[nodiscard]] constexpr std::uint64_t make_blended(std::uint32_t depth) noexcept
+{
+    const auto inverted =
+        static_cast<std::uint32_t>(k_depth_mask - (depth & k_depth_mask));
+    return make(layer::transparent, 0, 0, 0, inverted);
+}
+
+} // namespace sort_key
+
+/// Per-frame list of draw packets with an LSD radix sort on the keys
+class render_queue final
+{
+public:
+    void push(std::uint64_t key, std::uint32_t item)
+    {
+        packets_.push_back({ .key = key, .item = item });
+    }
+
+    /// Append packets recorded elsewhere whose items start at item_offset
+    void append(std::span<const draw_packet> packets, std::uint32_t item_offset)
+    {
+        packets_.reserve(packets_.size() + packets.size());
+        for (const auto& p : packets)
+        {
+            push(p.key, p.item + item_offset);
+        }
+    }
+
+    /// Stable radix sort by key (8 passes of 8 bits, uniform passes skipped)
+    void sort();
+
+    void clear() noexcept { packets_.clear(); }
+
+    [[nodiscard]] std::span<const draw_packet> packets() const noexcept
+    {
+        return packets_;
+    }
+    [[nodiscard]] std::size_t size() const noexcept { return packets_.size(); }
+    [[nodiscard]] bool empty() const noexcept { return packets_.empty(); }
+
+private:
+    std::vector<draw_packet> packets_;
+    std::vector<draw_packet> scratch_; // Ping-pong buffer, kept across frames
+};
+
+} // namespace egen
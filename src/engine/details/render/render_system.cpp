@@ -26,12 +26,24 @@ public:
 
     i_renderer* get_renderer() noexcept { return &renderer_; }
 
-    void begin_frame(SDL_GPUCommandBuffer* cmd, SDL_GPURenderPass* pass)
+    void begin_frame(SDL_GPUCommandBuffer* cmd, std::uint32_t view_height)
     {
-        renderer_.begin_frame(cmd, pass);
+        renderer_.begin_frame(cmd, view_height);
     }
 
-    void end_frame() { renderer_.end_frame(); }
+    void prepare_frame() { renderer_.prepare_frame(); }
+
+    void depth_prepass(SDL_GPURenderPass* pass)
+    {
+        renderer_.depth_prepass(pass);
+    }
+
+    bool depth_prepass_available() const noexcept
+    {
+        return renderer_.depth_prepass_available();
+    }
+
+    void end_frame(SDL_GPURenderPass* pass) { renderer_.end_frame(pass); }
 
     void ensure_depth_texture(std::uint32_t width, std::uint32_t height)
     {
@@ -93,6 +105,8 @@ public:
         pp_params.fxaa_enabled = params.fxaa_enabled;
         pp_params.res_x        = params.res_x;
         pp_params.res_y        = params.res_y;
+        pp_params.uv_scale_x   = params.uv_scale_x;
+        pp_params.uv_scale_y   = params.uv_scale_y;
         renderer_.apply_postprocess(cmd, target, pp_params);
     }
 
@@ -101,8 +115,6 @@ public:
         return renderer_.depth_texture();
     }
 
-    void bind_pipeline() { renderer_.bind_pipeline(); }
-
     void reload_pipelines() { renderer_.reload_pipelines(); }
 
     void set_profiler(i_profiler* profiler) noexcept
@@ -132,6 +144,31 @@ public:
         renderer_.set_view_projection(vp);
     }
 
+    void set_frustum_culling(bool enabled) noexcept
+    {
+        renderer_.set_frustum_culling(enabled);
+    }
+
+    void set_occlusion_culling(bool enabled) noexcept
+    {
+        renderer_.set_occlusion_culling(enabled);
+    }
+
+    void set_lod_bias(float bias) noexcept
+    {
+        renderer_.set_lod_bias(bias);
+    }
+
+    void set_texture_budget(std::size_t bytes) noexcept
+    {
+        renderer_.set_texture_budget(bytes);
+    }
+
+    void set_load_options(const load_options& options) noexcept
+    {
+        renderer_.set_load_options(options);
+    }
+
 private:
     Renderer renderer_;
 };
@@ -160,14 +197,29 @@ i_renderer* render_system::get_renderer() const noexcept
 }
 
 void render_system::begin_frame(SDL_GPUCommandBuffer* cmd,
-                                SDL_GPURenderPass*    pass)
+                                std::uint32_t         view_height)
+{
+    pimpl_->begin_frame(cmd, view_height);
+}
+
+void render_system::prepare_frame()
+{
+    pimpl_->prepare_frame();
+}
+
+void render_system::depth_prepass(SDL_GPURenderPass* pass)
+{
+    pimpl_->depth_prepass(pass);
+}
+
+bool render_system::depth_prepass_available() const noexcept
 {
-    pimpl_->begin_frame(cmd, pass);
+    return pimpl_->depth_prepass_available();
 }
 
-void render_system::end_frame()
+void render_system::end_frame(SDL_GPURenderPass* pass)
 {
-    pimpl_->end_frame();
+    pimpl_->end_frame(pass);
 }
 
 void render_system::ensure_depth_texture(std::uint32_t width,
@@ -228,11 +280,6 @@ SDL_GPUTexture* render_system::depth_texture() const noexcept
     return pimpl_->depth_texture();
 }
 
-void render_system::bind_pipeline()
-{
-    pimpl_->bind_pipeline();
-}
-
 void render_system::reload_pipelines()
 {
     pimpl_->reload_pipelines();
@@ -268,4 +315,29 @@ void render_system::set_view_projection(const glm::mat4& vp)
     pimpl_->set_view_projection(vp);
 }
 
+void render_system::set_frustum_culling(bool enabled) noexcept
+{
+    pimpl_->set_frustum_culling(enabled);
+}
+
+void render_system::set_occlusion_culling(bool enabled) noexcept
+{
+    pimpl_->set_occlusion_culling(enabled);
+}
+
+void render_system::set_lod_bias(float bias) noexcept
+{
+    pimpl_->set_lod_bias(bias);
+}
+
+void render_system::set_texture_budget(std::size_t bytes) noexcept
+{
+    pimpl_->set_texture_budget(bytes);
+}
+
+void render_system::set_load_options(const load_options& options) noexcept
+{
+    pimpl_->set_load_options(options);
+}
+
 } // namespace egen
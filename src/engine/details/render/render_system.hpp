@@ -1,7 +1,9 @@
 #pragma once
 
+#include <core-api/model_loader.hpp>
 #include <core-api/renderer.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <glm/glm.hpp>
 #include <memory>
@@ -28,8 +30,10 @@ struct postprocess_params
     float saturation   = 1.0f;
     float vignette     = 0.0f;
     float fxaa_enabled = 0.0f;
-    float res_x        = 1920.0f;
+    float res_x        = 1920.0f; // Scene texture size
     float res_y        = 1080.0f;
+    float uv_scale_x   = 1.0f; // Part of the scene texture rendered to
+    float uv_scale_y   = 1.0f;
 };
 
 /// Render system - handles renderer initialization and frame management
@@ -58,13 +62,28 @@ public:
     /// @return Pointer to i_renderer interface, or nullptr if not initialized
     [[nodiscard]] i_renderer* get_renderer() const noexcept;
 
-    /// Begin a new frame
+    /// Begin a new frame, draws are recorded until prepare_frame
     /// @param cmd Command buffer for this frame
-    /// @param pass Render pass for this frame
-    void begin_frame(SDL_GPUCommandBuffer* cmd, SDL_GPURenderPass* pass);
+    /// @param view_height Height of the scene viewport in pixels
+    void begin_frame(SDL_GPUCommandBuffer* cmd, std::uint32_t view_height);
 
-    /// End current frame
-    void end_frame();
+    /// Sort recorded draws and upload per-instance data (copy pass).
+    /// Must be called before the scene render pass begins.
+    void prepare_frame();
+
+    /// Draw the depth of the prepared opaque draws; the scene pass then
+    /// tests them for equal depth. Optional, between prepare_frame and
+    /// end_frame.
+    /// @param pass Render pass with only the scene depth target
+    void depth_prepass(SDL_GPURenderPass* pass);
+
+    /// Whether depth_prepass draws anything. When false the scene pass
+    /// has to clear and write depth itself.
+    [[nodiscard]] bool depth_prepass_available() const noexcept;
+
+    /// End current frame, submitting recorded draws
+    /// @param pass Scene render pass
+    void end_frame(SDL_GPURenderPass* pass);
 
     /// Ensure depth texture matches given dimensions
     void ensure_depth_texture(std::uint32_t width, std::uint32_t height);
@@ -117,9 +136,6 @@ public:
     /// @return SDL3 GPU texture pointer, or nullptr
     [[nodiscard]] SDL_GPUTexture* depth_texture() const noexcept;
 
-    /// Bind default pipeline (called at frame start)
-    void bind_pipeline();
-
     /// Rebuild pipelines if shaders changed
     void reload_pipelines();
 
@@ -141,6 +157,21 @@ public:
     /// Set view projection matrix
     void set_view_projection(const glm::mat4& vp);
 
+    /// Enable/disable frustum culling
+    void set_frustum_culling(bool enabled) noexcept;
+
+    /// Enable/disable culling against models marked as occluders
+    void set_occlusion_culling(bool enabled) noexcept;
+
+    /// Set level-of-detail bias, positive selects coarser levels sooner
+    void set_lod_bias(float bias) noexcept;
+
+    /// Set GPU memory streamed texture levels may use
+    void set_texture_budget(std::size_t bytes) noexcept;
+
+    /// Set processing applied to subsequently loaded models
+    void set_load_options(const load_options& options) noexcept;
+
 private:
     class impl;
     std::unique_ptr<impl> pimpl_;
@@ -1,18 +1,29 @@
 #include "renderer.hpp"
 #include "shader/shader.hpp"
 #include "texture/texture.hpp"
+#include "texture/texture_cache.hpp"
 
 #include <SDL3/SDL_gpu.h>
 
 #include <core-api/profiler.hpp>
 
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
 #include <ranges>
+#include <tuple>
+#include <utility>
 
 namespace egen
 {
@@ -55,6 +66,395 @@ constexpr std::array k_texture_extensions { ".tga", ".TGA", ".png", ".PNG",
 /// Two PI for circle calculations
 constexpr float k_two_pi = 6.28318530718f;
 
+/// Initial mesh arena sizes; arenas double when full
+constexpr Uint32 k_wireframe_arena_vertices = 16 * 1024;
+constexpr Uint32 k_wireframe_arena_indices  = 32 * 1024;
+constexpr Uint32 k_textured_arena_vertices  = 256 * 1024;
+constexpr Uint32 k_textured_arena_indices   = 1024 * 1024;
+
+/// Models whose texture coordinates stay within this magnitude keep at
+/// least 1/1024 precision as half floats and may use the packed format
+constexpr float k_max_packed_texcoord = 2.0f;
+
+/// Persistent staging ring size; larger uploads get their own buffer
+constexpr Uint32 k_staging_ring_size = 32 * 1024 * 1024;
+
+// Debug lines upload core-api vertices straight into wireframe vertex buffers
+static_assert(sizeof(vertex) == sizeof(vertex_pos_color));
+
+/// Smallest instance buffer allocation, in matrices
+constexpr Uint32 k_min_instance_capacity = 256;
+
+/// Smallest material buffer allocation, in materials
+constexpr Uint32 k_min_material_capacity = 64;
+
+/// Most layers per packed texture array; the guaranteed Vulkan minimum
+constexpr std::size_t k_max_texture_array_layers = 256;
+
+/// Bytes of streamed texture levels re-uploaded per frame, beyond the first
+/// recreation
+constexpr std::size_t k_stream_upload_limit = std::size_t { 16 } << 20;
+
+/// Block rows per job when encoding a compressed texture level
+constexpr std::size_t k_texture_encode_batch = 4;
+
+/// Background threads parsing and decoding asynchronous model loads
+constexpr std::size_t k_loader_threads = 2;
+
+/// Render-thread time per frame spent uploading asynchronous model loads.
+/// Uploads go one phase of one model at a time, so a frame may overshoot
+/// by its largest phase.
+constexpr double k_model_upload_budget_ms = 4.0;
+
+/// Bounds drawn in place of a model that is still loading
+constexpr glm::vec3 k_loading_bounds_color = glm::vec3(0.5f);
+
+/// Codec a model texture is compressed with, by what it holds
+[[nodiscard]] texture_codec codec_for(texture_type type) noexcept
+{
+    switch (type)
+    {
+        case texture_type::normal:
+            return texture_codec::bc5; // Z is reconstructed from X and Y
+        case texture_type::occlusion:
+            return texture_codec::bc4;
+        case texture_type::base_color:
+        case texture_type::metallic_roughness:
+        case texture_type::emissive:
+        case texture_type::unknown:
+            break;
+    }
+    return texture_codec::bc7;
+}
+
+/// Whole contents of a file, empty if it cannot be read
+[[nodiscard]] std::vector<std::byte> read_file_bytes(
+    const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        return {};
+    }
+    file.seekg(0, std::ios::end);
+    const auto size = file.tellg();
+    if (size <= 0)
+    {
+        return {};
+    }
+    file.seekg(0, std::ios::beg);
+
+    std::vector<std::byte> bytes(static_cast<std::size_t>(size));
+    file.read(reinterpret_cast<char*>(bytes.data()), size);
+    if (!file)
+    {
+        return {};
+    }
+    return bytes;
+}
+
+/// True if two draws differ at most in their matrix and can be instanced
+[[nodiscard]] bool same_draw_state(const draw_item& a,
+                                   const draw_item& b) noexcept
+{
+    return a.pipeline == b.pipeline && a.vertex_buffer == b.vertex_buffer &&
+           a.index_buffer == b.index_buffer &&
+           a.index_count == b.index_count && a.first_index == b.first_index &&
+           a.vertex_offset == b.vertex_offset && a.index_size == b.index_size &&
+           a.texture == b.texture && a.material == b.material;
+}
+
+/// Scene pipeline variants, built once per MSAA sample count
+enum class scene_variant : std::uint8_t
+{
+    wireframe,
+    wireframe_tri,
+    wireframe_overlay, // Bounds drawn on top of everything
+    textured,
+    textured_wireframe,
+    textured_instanced,
+    textured_instanced_wireframe,
+    textured_packed,
+    textured_packed_wireframe,
+    textured_packed_instanced,
+    textured_packed_instanced_wireframe,
+    textured_mask,
+    textured_blend,
+    textured_instanced_mask,
+    textured_instanced_blend,
+    textured_packed_mask,
+    textured_packed_blend,
+    textured_packed_instanced_mask,
+    textured_packed_instanced_blend,
+    depth_only, // Depth pre-pass, no color target
+    depth_only_instanced,
+    depth_only_packed,
+    depth_only_packed_instanced,
+    textured_equal, // Opaque draws after the depth pre-pass
+    textured_instanced_equal,
+    textured_packed_equal,
+    textured_packed_instanced_equal,
+    count,
+};
+
+constexpr auto k_scene_variant_count =
+    static_cast<std::size_t>(scene_variant::count);
+
+/// Render state of each scene variant, sample count filled in per level
+constexpr std::array<pipeline_key, k_scene_variant_count> k_scene_variants { {
+    { .program  = pipeline_program::wireframe,
+      .topology = SDL_GPU_PRIMITIVETYPE_LINELIST },
+    { .program = pipeline_program::wireframe },
+    { .program  = pipeline_program::wireframe,
+      .topology = SDL_GPU_PRIMITIVETYPE_LINELIST,
+      .depth    = pipeline_depth::overlay },
+    { .program   = pipeline_program::textured,
+      .cull_mode = SDL_GPU_CULLMODE_BACK },
+    { .program   = pipeline_program::textured,
+      .fill_mode = SDL_GPU_FILLMODE_LINE },
+    { .program   = pipeline_program::textured_instanced,
+      .cull_mode = SDL_GPU_CULLMODE_BACK },
+    { .program   = pipeline_program::textured_instanced,
+      .fill_mode = SDL_GPU_FILLMODE_LINE },
+    { .program   = pipeline_program::textured_packed,
+      .cull_mode = SDL_GPU_CULLMODE_BACK },
+    { .program   = pipeline_program::textured_packed,
+      .fill_mode = SDL_GPU_FILLMODE_LINE },
+    { .program   = pipeline_program::textured_packed_instanced,
+      .cull_mode = SDL_GPU_CULLMODE_BACK },
+    { .program   = pipeline_program::textured_packed_instanced,
+      .fill_mode = SDL_GPU_FILLMODE_LINE },
+    { .program   = pipeline_program::textured_alpha,
+      .cull_mode = SDL_GPU_CULLMODE_BACK },
+    { .program   = pipeline_program::textured_alpha,
+      .cull_mode = SDL_GPU_CULLMODE_BACK,
+      .depth     = pipeline_depth::read_only,
+      .blend     = true },
+    { .program   = pipeline_program::textured_alpha_instanced,
+      .cull_mode = SDL_GPU_CULLMODE_BACK },
+    { .program   = pipeline_program::textured_alpha_instanced,
+      .cull_mode = SDL_GPU_CULLMODE_BACK,
+      .depth     = pipeline_depth::read_only,
+      .blend     = true },
+    { .program   = pipeline_program::textured_packed_alpha,
+      .cull_mode = SDL_GPU_CULLMODE_BACK },
+    { .program   = pipeline_program::textured_packed_alpha,
+      .cull_mode = SDL_GPU_CULLMODE_BACK,
+      .depth     = pipeline_depth::read_only,
+      .blend     = true },
+    { .program   = pipeline_program::textured_packed_alpha_instanced,
+      .cull_mode = SDL_GPU_CULLMODE_BACK },
+    { .program   = pipeline_program::textured_packed_alpha_instanced,
+      .cull_mode = SDL_GPU_CULLMODE_BACK,
+      .depth     = pipeline_depth::read_only,
+      .blend     = true },
+    { .program      = pipeline_program::depth_only,
+      .cull_mode    = SDL_GPU_CULLMODE_BACK,
+      .color_format = SDL_GPU_TEXTUREFORMAT_INVALID },
+    { .program      = pipeline_program::depth_only_instanced,
+      .cull_mode    = SDL_GPU_CULLMODE_BACK,
+      .color_format = SDL_GPU_TEXTUREFORMAT_INVALID },
+    { .program      = pipeline_program::depth_only_packed,
+      .cull_mode    = SDL_GPU_CULLMODE_BACK,
+      .color_format = SDL_GPU_TEXTUREFORMAT_INVALID },
+    { .program      = pipeline_program::depth_only_packed_instanced,
+      .cull_mode    = SDL_GPU_CULLMODE_BACK,
+      .color_format = SDL_GPU_TEXTUREFORMAT_INVALID },
+    { .program   = pipeline_program::textured,
+      .cull_mode = SDL_GPU_CULLMODE_BACK,
+      .depth     = pipeline_depth::equal },
+    { .program   = pipeline_program::textured_instanced,
+      .cull_mode = SDL_GPU_CULLMODE_BACK,
+      .depth     = pipeline_depth::equal },
+    { .program   = pipeline_program::textured_packed,
+      .cull_mode = SDL_GPU_CULLMODE_BACK,
+      .depth     = pipeline_depth::equal },
+    { .program   = pipeline_program::textured_packed_instanced,
+      .cull_mode = SDL_GPU_CULLMODE_BACK,
+      .depth     = pipeline_depth::equal },
+} };
+
+/// The post-process pass always renders single-sampled without depth
+constexpr pipeline_key k_postprocess_key {
+    .program = pipeline_program::postprocess,
+    .depth   = pipeline_depth::none,
+};
+
+[[nodiscard]] constexpr pipeline_key scene_variant_key(
+    scene_variant variant, SDL_GPUSampleCount samples) noexcept
+{
+    auto key         = k_scene_variants[static_cast<std::size_t>(variant)];
+    key.sample_count = samples;
+    return key;
+}
+
+/// Screen-space error accepted per level of detail, in NDC units (about a
+/// pixel at 1080p)
+constexpr float k_lod_error_threshold = 2.0f / 1080.0f;
+
+/// Relative change in projected size needed to leave the current level
+constexpr float k_lod_hysteresis = 0.15f;
+
+/// Blended fragments this transparent are discarded instead of blended
+constexpr float k_blend_alpha_cutoff = 1.0f / 255.0f;
+
+/// Pipeline slot of a filled textured mesh draw for its material
+[[nodiscard]] constexpr pipeline_slot textured_slot(bool       packed,
+                                                    alpha_mode alpha) noexcept
+{
+    switch (alpha)
+    {
+        case alpha_mode::mask:
+            return packed ? pipeline_slot::textured_packed_mask
+                          : pipeline_slot::textured_mask;
+        case alpha_mode::blend:
+            return packed ? pipeline_slot::textured_packed_blend
+                          : pipeline_slot::textured_blend;
+        case alpha_mode::opaque:
+            break;
+    }
+    return packed ? pipeline_slot::textured_packed : pipeline_slot::textured;
+}
+
+/// Material table entry for a loaded material; blended materials discard
+/// only fully transparent fragments
+[[nodiscard]] gpu_material to_gpu_material(const model_material& m) noexcept
+{
+    float alpha_cutoff = 0.0f;
+    if (m.alpha == alpha_mode::mask)
+    {
+        alpha_cutoff = m.alpha_cutoff;
+    }
+    else if (m.alpha == alpha_mode::blend)
+    {
+        alpha_cutoff = k_blend_alpha_cutoff;
+    }
+    return gpu_material {
+        .base_color   = m.base_color_factor,
+        .emissive     = m.emissive_factor,
+        .alpha_cutoff = alpha_cutoff,
+        .metallic     = m.metallic_factor,
+        .roughness    = m.roughness_factor,
+        .unlit        = m.unlit ? 1.0f : 0.0f,
+    };
+}
+
+/// True if the slot's fragment shader reads the material table
+[[nodiscard]] constexpr bool uses_materials(pipeline_slot slot) noexcept
+{
+    return slot != pipeline_slot::wireframe &&
+           slot != pipeline_slot::wireframe_tri;
+}
+
+/// Occlusion buffer width; the height follows the render target's aspect
+constexpr std::uint32_t k_occlusion_width = 256;
+
+/// Surface deviation accepted for occluder geometry, relative to each
+/// mesh's radius; coarser levels rasterize faster but may hide slivers
+constexpr float k_occluder_lod_error = 0.01f;
+
+/// Radius of the model's bounding sphere projected to NDC
+[[nodiscard]] float projected_radius(const gpu_model& model,
+                                     const glm::mat4& mvp) noexcept
+{
+    const glm::vec4 depth_row { mvp[0][3], mvp[1][3], mvp[2][3], mvp[3][3] };
+    const float     w =
+        glm::dot(depth_row, glm::vec4(model.model_bounds.center(), 1.0f));
+    if (w <= 0.0f)
+    {
+        return std::numeric_limits<float>::max(); // Camera inside or past it
+    }
+
+    // The clip-space y row scales model-space lengths by the projection's
+    // focal length and the model's scale
+    const float scale = glm::length(glm::vec3(mvp[0][1], mvp[1][1], mvp[2][1]));
+    return glm::length(model.model_bounds.size()) * 0.5f * scale / w;
+}
+
+/// Coarsest level whose error, at the given projected size, is acceptable
+[[nodiscard]] std::uint8_t coarsest_lod(const gpu_model& model,
+                                        float            size,
+                                        float            threshold) noexcept
+{
+    std::uint8_t lod = 0;
+    while (lod + 1 < model.lod_count &&
+           model.lod_errors[lod + 1] * size <= threshold)
+    {
+        ++lod;
+    }
+    return lod;
+}
+
+/// Build model matrix: translate -> rotate (YXZ order) -> scale
+[[nodiscard]] glm::mat4 model_matrix(const transform& xform)
+{
+    auto model_mat = glm::mat4(1.0f);
+    model_mat      = glm::translate(model_mat, xform.position);
+    model_mat      = glm::rotate(
+        model_mat, glm::radians(xform.rotation.y), glm::vec3(0, 1, 0));
+    model_mat = glm::rotate(
+        model_mat, glm::radians(xform.rotation.x), glm::vec3(1, 0, 0));
+    model_mat = glm::rotate(
+        model_mat, glm::radians(xform.rotation.z), glm::vec3(0, 0, 1));
+    return glm::scale(model_mat, xform.scale);
+}
+
+/// Octahedral mapping of a unit vector onto [-1, 1]^2
+[[nodiscard]] glm::vec2 octahedral_encode(glm::vec3 n) noexcept
+{
+    const float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (l1 <= 0.0f)
+    {
+        return { 0.0f, 0.0f };
+    }
+    n /= l1;
+    if (n.z < 0.0f)
+    {
+        // Fold the lower hemisphere over the diagonals
+        return { (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                 (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f) };
+    }
+    return { n.x, n.y };
+}
+
+/// Quantize a vertex; positions map origin..origin+extent onto 0..1
+[[nodiscard]] vertex_textured_packed pack_vertex(
+    const model_vertex& v,
+    const glm::vec3&    origin,
+    const glm::vec3&    inv_extent) noexcept
+{
+    const auto q = (v.position - origin) * inv_extent;
+    const auto n = octahedral_encode(v.normal);
+    const auto snorm = [](float f)
+    { return std::bit_cast<std::int16_t>(glm::packSnorm1x16(f)); };
+    return {
+        .position = { glm::packUnorm1x16(q.x),
+                      glm::packUnorm1x16(q.y),
+                      glm::packUnorm1x16(q.z),
+                      UINT16_MAX },
+        .normal   = { snorm(n.x), snorm(n.y) },
+        .texcoord = { glm::packHalf1x16(v.texcoord.x),
+                      glm::packHalf1x16(v.texcoord.y) },
+    };
+}
+
+/// True if every texture coordinate keeps its precision as a half float
+[[nodiscard]] bool fits_packed_format(const loaded_model& data) noexcept
+{
+    return std::ranges::all_of(
+        data.meshes,
+        [](const loaded_mesh& mesh)
+        {
+            return std::ranges::all_of(
+                mesh.vertices,
+                [](const model_vertex& v)
+                {
+                    return std::abs(v.texcoord.x) <= k_max_packed_texcoord &&
+                           std::abs(v.texcoord.y) <= k_max_packed_texcoord;
+                });
+        });
+}
+
 } // namespace
 
 Renderer::~Renderer()
@@ -67,6 +467,47 @@ bool Renderer::init(SDL_GPUDevice* device, shader_system* shaders)
     device_  = device;
     shaders_ = shaders;
 
+    if (!staging_.init(device_, k_staging_ring_size))
+    {
+        return false;
+    }
+    samplers_.init(device_);
+    for (std::size_t c = 0; c < codec_supported_.size(); ++c)
+    {
+        codec_supported_[c] =
+            supports_codec(device_, static_cast<texture_codec>(c));
+    }
+
+    // Frame preparation workers, one bucket of recorded draws each
+    jobs_.init();
+    jobs_.set_profiler(profiler_);
+    prep_buckets_.resize(jobs_.worker_count());
+    spdlog::info("=> frame preparation on {} threads", jobs_.worker_count());
+
+    // Asynchronous model loads parse and decode in the background
+    loader_.set_profiler(profiler_);
+    loader_.init(k_loader_threads);
+
+    // Shared vertex/index buffers that all meshes are sub-allocated from
+    if (!wireframe_arena_.init(device_,
+                               staging_,
+                               static_cast<Uint32>(sizeof(vertex_pos_color)),
+                               k_wireframe_arena_vertices,
+                               k_wireframe_arena_indices) ||
+        !textured_arena_.init(device_,
+                              staging_,
+                              static_cast<Uint32>(sizeof(vertex_textured)),
+                              k_textured_arena_vertices,
+                              k_textured_arena_indices) ||
+        !packed_arena_.init(device_,
+                            staging_,
+                            static_cast<Uint32>(sizeof(vertex_textured_packed)),
+                            k_textured_arena_vertices,
+                            k_textured_arena_indices))
+    {
+        return false;
+    }
+
     // Load wireframe shader program
     const ShaderProgramDesc wireframe_desc {
         .name     = "wireframe",
@@ -95,6 +536,153 @@ bool Renderer::init(SDL_GPUDevice* device, shader_system* shaders)
         return false;
     }
 
+    // Instanced variant: same sources, per-instance MVP from a storage buffer
+    const ShaderProgramDesc textured_instanced_desc {
+        .name     = "textured_instanced",
+        .vertex   = { .path    = "textured.vert.hlsl",
+                      .stage   = ShaderStage::Vertex,
+                      .defines = { "INSTANCED" } },
+        .fragment = { .path  = "textured.frag.hlsl",
+                      .stage = ShaderStage::Fragment },
+    };
+    if (auto result = shaders_->load_program(textured_instanced_desc); !result)
+    {
+        // Not fatal: repeated meshes fall back to one draw per instance
+        spdlog::warn("=> load textured_instanced shader: {}", result.error());
+    }
+
+    // Quantized vertex variants; without them models keep float vertices
+    const ShaderProgramDesc textured_packed_desc {
+        .name     = "textured_packed",
+        .vertex   = { .path    = "textured.vert.hlsl",
+                      .stage   = ShaderStage::Vertex,
+                      .defines = { "PACKED_VERTEX" } },
+        .fragment = { .path  = "textured.frag.hlsl",
+                      .stage = ShaderStage::Fragment },
+    };
+    if (auto result = shaders_->load_program(textured_packed_desc); !result)
+    {
+        spdlog::warn("=> load textured_packed shader: {}", result.error());
+    }
+
+    const ShaderProgramDesc textured_packed_instanced_desc {
+        .name     = "textured_packed_instanced",
+        .vertex   = { .path    = "textured.vert.hlsl",
+                      .stage   = ShaderStage::Vertex,
+                      .defines = { "PACKED_VERTEX", "INSTANCED" } },
+        .fragment = { .path  = "textured.frag.hlsl",
+                      .stage = ShaderStage::Fragment },
+    };
+    if (auto result = shaders_->load_program(textured_packed_instanced_desc);
+        !result)
+    {
+        spdlog::warn("=> load textured_packed_instanced shader: {}",
+                     result.error());
+    }
+
+    // Alpha-tested and blended materials; opaque shaders never discard, so
+    // early depth testing stays enabled for them
+    const ShaderProgramDesc textured_alpha_desc {
+        .name     = "textured_alpha",
+        .vertex   = { .path  = "textured.vert.hlsl",
+                      .stage = ShaderStage::Vertex },
+        .fragment = { .path    = "textured.frag.hlsl",
+                      .stage   = ShaderStage::Fragment,
+                      .defines = { "ALPHA" } },
+    };
+    if (auto result = shaders_->load_program(textured_alpha_desc); !result)
+    {
+        // Not fatal: such materials are drawn as opaque
+        spdlog::warn("=> load textured_alpha shader: {}", result.error());
+    }
+
+    const ShaderProgramDesc textured_alpha_instanced_desc {
+        .name     = "textured_alpha_instanced",
+        .vertex   = { .path    = "textured.vert.hlsl",
+                      .stage   = ShaderStage::Vertex,
+                      .defines = { "INSTANCED" } },
+        .fragment = { .path    = "textured.frag.hlsl",
+                      .stage   = ShaderStage::Fragment,
+                      .defines = { "ALPHA" } },
+    };
+    if (auto result = shaders_->load_program(textured_alpha_instanced_desc);
+        !result)
+    {
+        spdlog::warn("=> load textured_alpha_instanced shader: {}",
+                     result.error());
+    }
+
+    const ShaderProgramDesc textured_packed_alpha_desc {
+        .name     = "textured_packed_alpha",
+        .vertex   = { .path    = "textured.vert.hlsl",
+                      .stage   = ShaderStage::Vertex,
+                      .defines = { "PACKED_VERTEX" } },
+        .fragment = { .path    = "textured.frag.hlsl",
+                      .stage   = ShaderStage::Fragment,
+                      .defines = { "ALPHA" } },
+    };
+    if (auto result = shaders_->load_program(textured_packed_alpha_desc);
+        !result)
+    {
+        spdlog::warn("=> load textured_packed_alpha shader: {}",
+                     result.error());
+    }
+
+    const ShaderProgramDesc textured_packed_alpha_instanced_desc {
+        .name     = "textured_packed_alpha_instanced",
+        .vertex   = { .path    = "textured.vert.hlsl",
+                      .stage   = ShaderStage::Vertex,
+                      .defines = { "PACKED_VERTEX", "INSTANCED" } },
+        .fragment = { .path    = "textured.frag.hlsl",
+                      .stage   = ShaderStage::Fragment,
+                      .defines = { "ALPHA" } },
+    };
+    if (auto result =
+            shaders_->load_program(textured_packed_alpha_instanced_desc);
+        !result)
+    {
+        spdlog::warn("=> load textured_packed_alpha_instanced shader: {}",
+                     result.error());
+    }
+
+    // Depth pre-pass programs read only the position of each vertex
+    const std::array<ShaderProgramDesc, 4> depth_only_descs { {
+        { .name     = "depth_only",
+          .vertex   = { .path    = "textured.vert.hlsl",
+                        .stage   = ShaderStage::Vertex,
+                        .defines = { "DEPTH_ONLY" } },
+          .fragment = { .path  = "depth.frag.hlsl",
+                        .stage = ShaderStage::Fragment } },
+        { .name     = "depth_only_instanced",
+          .vertex   = { .path    = "textured.vert.hlsl",
+                        .stage   = ShaderStage::Vertex,
+                        .defines = { "DEPTH_ONLY", "INSTANCED" } },
+          .fragment = { .path  = "depth.frag.hlsl",
+                        .stage = ShaderStage::Fragment } },
+        { .name     = "depth_only_packed",
+          .vertex   = { .path    = "textured.vert.hlsl",
+                        .stage   = ShaderStage::Vertex,
+                        .defines = { "DEPTH_ONLY", "PACKED_VERTEX" } },
+          .fragment = { .path  = "depth.frag.hlsl",
+                        .stage = ShaderStage::Fragment } },
+        { .name     = "depth_only_packed_instanced",
+          .vertex   = { .path    = "textured.vert.hlsl",
+                        .stage   = ShaderStage::Vertex,
+                        .defines = { "DEPTH_ONLY",
+                                     "PACKED_VERTEX",
+                                     "INSTANCED" } },
+          .fragment = { .path  = "depth.frag.hlsl",
+                        .stage = ShaderStage::Fragment } },
+    } };
+    for (const auto& desc : depth_only_descs)
+    {
+        if (auto result = shaders_->load_program(desc); !result)
+        {
+            // Not fatal: frames are drawn without the pre-pass
+            spdlog::warn("=> load {} shader: {}", desc.name, result.error());
+        }
+    }
+
     // Load post-processing shader program
     const ShaderProgramDesc postprocess_desc {
         .name     = "postprocess",
@@ -109,123 +697,171 @@ bool Renderer::init(SDL_GPUDevice* device, shader_system* shaders)
         return false;
     }
 
-    // Setup shader hot-reload callback
+    // Setup shader hot-reload callbacks. The pipeline worker may be using
+    // the shaders that are about to be released.
+    shaders_->set_pre_reload_callback(
+        [this](const std::string&) { pipelines_.cancel_precreate(); });
     shaders_->set_reload_callback(
         [this](const std::string& name)
         {
-            if (name == "wireframe" || name == "textured" ||
-                name == "postprocess")
+            if (name == "wireframe" || name.starts_with("textured") ||
+                name.starts_with("depth_only") || name == "postprocess")
             {
-                pipeline_dirty_ = true;
+                shaders_dirty_ = true;
             }
         });
 
-    if (!create_wireframe_pipeline() || !create_textured_pipeline() ||
-        !create_postprocess_pipeline())
+    pipelines_.init(device_);
+    register_pipeline_programs();
+    if (!resolve_pipelines())
     {
         return false;
     }
+    // Other MSAA levels build in the background so switching is a lookup
+    precreate_pipeline_variants();
+
+    // Debug line buffers hold the whole per-frame budget
+    const auto debug_size = k_debug_line_budget * 2 *
+                            static_cast<Uint32>(sizeof(vertex_pos_color));
+
+    SDL_GPUBufferCreateInfo debug_info {};
+    debug_info.usage     = SDL_GPU_BUFFERUSAGE_VERTEX;
+    debug_info.size      = debug_size;
+    debug_vertex_buffer_ = SDL_CreateGPUBuffer(device_, &debug_info);
+
+    SDL_GPUTransferBufferCreateInfo debug_tb_info {};
+    debug_tb_info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+    debug_tb_info.size  = debug_size;
+    debug_transfer_buffer_ =
+        SDL_CreateGPUTransferBuffer(device_, &debug_tb_info);
+
+    if (debug_vertex_buffer_ == nullptr || debug_transfer_buffer_ == nullptr)
+    {
+        // Not fatal: debug lines are simply not drawn
+        spdlog::warn("== debug line buffers: {}", SDL_GetError());
+    }
 
     // Create default white texture
-    if (auto tex = create_default_texture(device_))
+    if (auto tex = create_default_texture(device_, staging_))
+    {
+        default_texture_ = textures_.insert({ .texture    = tex->texture,
+                                              .sampler    = tex->sampler,
+                                              .width      = tex->width,
+                                              .height     = tex->height,
+                                              .mip_levels = tex->mip_levels });
+    }
+
+    // Entry 0 of the material table: white, lit and opaque
+    materials_.push_back(gpu_material {});
+    if (!upload_materials())
     {
-        default_texture_            = next_texture_handle_++;
-        textures_[default_texture_] = { .texture = tex->texture,
-                                        .sampler = tex->sampler,
-                                        .width   = tex->width,
-                                        .height  = tex->height };
+        return false;
     }
+    staging_.flush();
 
     return true;
 }
 
 void Renderer::shutdown()
 {
-    // Release temporary debug meshes
-    for (auto& mesh : temp_meshes_)
+    // Loads still running stop at their next texture
+    for (const auto& load : loads_)
     {
-        if (mesh.vertex_buffer != nullptr)
-        {
-            SDL_ReleaseGPUBuffer(device_, mesh.vertex_buffer);
-        }
-        if (mesh.index_buffer != nullptr)
-        {
-            SDL_ReleaseGPUBuffer(device_, mesh.index_buffer);
-        }
+        load->cancelled.store(true, std::memory_order_relaxed);
     }
-    temp_meshes_.clear();
+    loader_.shutdown();
+    loads_.clear();
+    jobs_.shutdown();
+    prep_buckets_.clear();
 
-    // Release all meshes
-    for (auto& [handle, mesh] : meshes_)
-    {
-        if (mesh.vertex_buffer != nullptr)
-        {
-            SDL_ReleaseGPUBuffer(device_, mesh.vertex_buffer);
-        }
-        if (mesh.index_buffer != nullptr)
-        {
-            SDL_ReleaseGPUBuffer(device_, mesh.index_buffer);
-        }
-    }
-    meshes_.clear();
+    // Let in-flight uploads finish before their destinations go away
+    staging_.shutdown();
 
-    // Release all models
-    for (auto& [handle, model] : models_)
-    {
-        for (auto& mesh : model.meshes)
-        {
-            if (mesh.vertex_buffer != nullptr)
-            {
-                SDL_ReleaseGPUBuffer(device_, mesh.vertex_buffer);
-            }
-            if (mesh.index_buffer != nullptr)
-            {
-                SDL_ReleaseGPUBuffer(device_, mesh.index_buffer);
-            }
-        }
-    }
+    // Mesh data lives in the arenas, releasing them frees every mesh
+    meshes_.clear();
     models_.clear();
+    wireframe_arena_.shutdown();
+    textured_arena_.shutdown();
+    packed_arena_.shutdown();
 
     // Release all textures
-    for (auto& [handle, tex] : textures_)
+    for (auto& tex : textures_)
     {
         if (tex.texture != nullptr)
         {
             SDL_ReleaseGPUTexture(device_, tex.texture);
         }
-        if (tex.sampler != nullptr)
-        {
-            SDL_ReleaseGPUSampler(device_, tex.sampler);
-        }
     }
     textures_.clear();
+    streamer_ = {};
+    samplers_.shutdown();
 
     // Release pipelines
-    if (wireframe_pipeline_ != nullptr)
-    {
-        SDL_ReleaseGPUGraphicsPipeline(device_, wireframe_pipeline_);
-        wireframe_pipeline_ = nullptr;
-    }
-    if (wireframe_tri_pipeline_ != nullptr)
-    {
-        SDL_ReleaseGPUGraphicsPipeline(device_, wireframe_tri_pipeline_);
-        wireframe_tri_pipeline_ = nullptr;
-    }
-    if (wireframe_bounds_pipeline_ != nullptr)
-    {
-        SDL_ReleaseGPUGraphicsPipeline(device_, wireframe_bounds_pipeline_);
-        wireframe_bounds_pipeline_ = nullptr;
-    }
-    if (textured_pipeline_ != nullptr)
-    {
-        SDL_ReleaseGPUGraphicsPipeline(device_, textured_pipeline_);
-        textured_pipeline_ = nullptr;
-    }
-    if (textured_wireframe_pipeline_ != nullptr)
-    {
-        SDL_ReleaseGPUGraphicsPipeline(device_, textured_wireframe_pipeline_);
-        textured_wireframe_pipeline_ = nullptr;
-    }
+    pipelines_.shutdown();
+    wireframe_pipeline_                    = nullptr;
+    wireframe_tri_pipeline_                = nullptr;
+    wireframe_bounds_pipeline_             = nullptr;
+    textured_pipeline_                     = nullptr;
+    textured_wireframe_pipeline_           = nullptr;
+    textured_instanced_pipeline_           = nullptr;
+    textured_instanced_wireframe_pipeline_ = nullptr;
+    textured_packed_pipeline_              = nullptr;
+    textured_packed_wireframe_pipeline_    = nullptr;
+    textured_packed_instanced_pipeline_    = nullptr;
+    textured_packed_instanced_wireframe_pipeline_ = nullptr;
+    textured_mask_pipeline_                       = nullptr;
+    textured_blend_pipeline_                      = nullptr;
+    textured_packed_mask_pipeline_                = nullptr;
+    textured_packed_blend_pipeline_               = nullptr;
+    textured_instanced_mask_pipeline_             = nullptr;
+    textured_instanced_blend_pipeline_            = nullptr;
+    textured_packed_instanced_mask_pipeline_      = nullptr;
+    textured_packed_instanced_blend_pipeline_     = nullptr;
+    depth_only_pipeline_                          = nullptr;
+    depth_only_instanced_pipeline_                = nullptr;
+    depth_only_packed_pipeline_                   = nullptr;
+    depth_only_packed_instanced_pipeline_         = nullptr;
+    textured_equal_pipeline_                      = nullptr;
+    textured_instanced_equal_pipeline_            = nullptr;
+    textured_packed_equal_pipeline_               = nullptr;
+    textured_packed_instanced_equal_pipeline_     = nullptr;
+    postprocess_pipeline_                         = nullptr;
+
+    // Release per-instance data buffers
+    if (instance_buffer_ != nullptr)
+    {
+        SDL_ReleaseGPUBuffer(device_, instance_buffer_);
+        instance_buffer_ = nullptr;
+    }
+    if (instance_transfer_buffer_ != nullptr)
+    {
+        SDL_ReleaseGPUTransferBuffer(device_, instance_transfer_buffer_);
+        instance_transfer_buffer_ = nullptr;
+    }
+    instance_capacity_ = 0;
+
+    if (material_buffer_ != nullptr)
+    {
+        SDL_ReleaseGPUBuffer(device_, material_buffer_);
+        material_buffer_ = nullptr;
+    }
+    material_capacity_ = 0;
+    materials_.clear();
+    free_materials_.clear();
+
+    // Release debug line buffers
+    if (debug_vertex_buffer_ != nullptr)
+    {
+        SDL_ReleaseGPUBuffer(device_, debug_vertex_buffer_);
+        debug_vertex_buffer_ = nullptr;
+    }
+    if (debug_transfer_buffer_ != nullptr)
+    {
+        SDL_ReleaseGPUTransferBuffer(device_, debug_transfer_buffer_);
+        debug_transfer_buffer_ = nullptr;
+    }
+    debug_lines_.clear();
+
     if (depth_texture_ != nullptr)
     {
         SDL_ReleaseGPUTexture(device_, depth_texture_);
@@ -260,11 +896,6 @@ void Renderer::shutdown()
         SDL_ReleaseGPUSampler(device_, pp_sampler_);
         pp_sampler_ = nullptr;
     }
-    if (postprocess_pipeline_ != nullptr)
-    {
-        SDL_ReleaseGPUGraphicsPipeline(device_, postprocess_pipeline_);
-        postprocess_pipeline_ = nullptr;
-    }
 }
 
 void Renderer::ensure_depth_texture(Uint32 width, Uint32 height)
@@ -359,23 +990,7 @@ void Renderer::ensure_msaa_targets(Uint32               width,
         msaa_resolve_texture_ = nullptr;
     }
 
-    // Determine sample count
-    SDL_GPUSampleCount sample_count = SDL_GPU_SAMPLECOUNT_1;
-    switch (msaa_samples_)
-    {
-        case msaa_samples::none:
-            sample_count = SDL_GPU_SAMPLECOUNT_1;
-            break;
-        case msaa_samples::x2:
-            sample_count = SDL_GPU_SAMPLECOUNT_2;
-            break;
-        case msaa_samples::x4:
-            sample_count = SDL_GPU_SAMPLECOUNT_4;
-            break;
-        case msaa_samples::x8:
-            sample_count = SDL_GPU_SAMPLECOUNT_8;
-            break;
-    }
+    const auto sample_count = msaa_sample_count();
 
     // Check if this sample count is supported
     if (!SDL_GPUTextureSupportsSampleCount(device_, format, sample_count))
@@ -460,314 +1075,290 @@ void Renderer::resolve_msaa(SDL_GPUCommandBuffer* cmd, SDL_GPUTexture* target)
     SDL_BlitGPUTexture(cmd, &blit_info);
 }
 
-bool Renderer::create_wireframe_pipeline()
+void Renderer::register_pipeline_programs()
 {
-    auto* prog = shaders_->get_program("wireframe");
-    if ((prog == nullptr) || !prog->valid())
-    {
-        return false;
-    }
-
-    std::array<SDL_GPUVertexAttribute, 2> attrs {};
-    attrs[0].location    = 0;
-    attrs[0].buffer_slot = 0;
-    attrs[0].format      = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3;
-    attrs[0].offset      = 0;
-    attrs[1].location    = 1;
-    attrs[1].buffer_slot = 0;
-    attrs[1].format      = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3;
-    attrs[1].offset      = sizeof(glm::vec3);
-
-    SDL_GPUVertexBufferDescription vb_desc {};
-    vb_desc.slot       = 0;
-    vb_desc.pitch      = sizeof(vertex_pos_color);
-    vb_desc.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX;
-
-    SDL_GPUVertexInputState vertex_input {};
-    vertex_input.vertex_buffer_descriptions = &vb_desc;
-    vertex_input.num_vertex_buffers         = 1;
-    vertex_input.vertex_attributes          = attrs.data();
-    vertex_input.num_vertex_attributes      = static_cast<Uint32>(attrs.size());
-
-    SDL_GPUColorTargetDescription color_target {};
-    color_target.format = SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM;
-    color_target.blend_state.enable_blend = false;
-
-    SDL_GPUGraphicsPipelineTargetInfo target_info {};
-    target_info.color_target_descriptions = &color_target;
-    target_info.num_color_targets         = 1;
-    target_info.depth_stencil_format      = SDL_GPU_TEXTUREFORMAT_D32_FLOAT;
-    target_info.has_depth_stencil_target  = true;
-
-    SDL_GPURasterizerState raster_state {};
-    raster_state.fill_mode  = SDL_GPU_FILLMODE_FILL;
-    raster_state.cull_mode  = SDL_GPU_CULLMODE_NONE;
-    raster_state.front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE;
-
-    SDL_GPUMultisampleState ms_state {};
-    // Convert msaa_samples to SDL_GPUSampleCount
-    SDL_GPUSampleCount sample_count = SDL_GPU_SAMPLECOUNT_1;
-    switch (msaa_samples_)
+    const auto program_desc = [this](std::string_view name)
     {
-        case msaa_samples::none:
-            sample_count = SDL_GPU_SAMPLECOUNT_1;
-            break;
-        case msaa_samples::x2:
-            sample_count = SDL_GPU_SAMPLECOUNT_2;
-            break;
-        case msaa_samples::x4:
-            sample_count = SDL_GPU_SAMPLECOUNT_4;
-            break;
-        case msaa_samples::x8:
-            sample_count = SDL_GPU_SAMPLECOUNT_8;
-            break;
-    }
-    ms_state.sample_count = sample_count;
-    spdlog::debug("Creating pipeline with MSAA: {}x (sample_count={})",
-                  static_cast<int>(msaa_samples_),
-                  static_cast<int>(sample_count));
+        pipeline_program_desc desc;
+        auto*                 prog = shaders_->get_program(name);
+        if ((prog != nullptr) && prog->valid())
+        {
+            desc.vertex_shader   = prog->vertex_shader();
+            desc.fragment_shader = prog->fragment_shader();
+        }
+        return desc;
+    };
+    const auto attribute = [](Uint32                     location,
+                              SDL_GPUVertexElementFormat format,
+                              std::size_t                offset)
+    {
+        return SDL_GPUVertexAttribute { .location    = location,
+                                        .buffer_slot = 0,
+                                        .format      = format,
+                                        .offset = static_cast<Uint32>(offset) };
+    };
 
-    SDL_GPUDepthStencilState depth_state {};
-    depth_state.compare_op         = SDL_GPU_COMPAREOP_LESS;
-    depth_state.enable_depth_test  = true;
-    depth_state.enable_depth_write = true;
+    auto wireframe         = program_desc("wireframe");
+    wireframe.vertex_pitch = sizeof(vertex_pos_color);
+    wireframe.attributes   = {
+        attribute(0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3, 0),
+        attribute(1, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3, sizeof(glm::vec3)),
+    };
+    pipelines_.set_program(pipeline_program::wireframe, std::move(wireframe));
+
+    const std::vector textured_attributes {
+        attribute(0,
+                  SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
+                  offsetof(vertex_textured, position)),
+        attribute(1,
+                  SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
+                  offsetof(vertex_textured, normal)),
+        attribute(2,
+                  SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2,
+                  offsetof(vertex_textured, texcoord)),
+    };
 
-    SDL_GPUGraphicsPipelineCreateInfo pipeline_info {};
-    pipeline_info.vertex_shader       = prog->vertex_shader();
-    pipeline_info.fragment_shader     = prog->fragment_shader();
-    pipeline_info.vertex_input_state  = vertex_input;
-    pipeline_info.primitive_type      = SDL_GPU_PRIMITIVETYPE_LINELIST;
-    pipeline_info.rasterizer_state    = raster_state;
-    pipeline_info.multisample_state   = ms_state;
-    pipeline_info.depth_stencil_state = depth_state;
-    pipeline_info.target_info         = target_info;
+    auto textured         = program_desc("textured");
+    textured.vertex_pitch = sizeof(vertex_textured);
+    textured.attributes   = textured_attributes;
+    pipelines_.set_program(pipeline_program::textured, std::move(textured));
+
+    // Instanced variants share all state except the vertex shader
+    auto instanced         = program_desc("textured_instanced");
+    instanced.vertex_pitch = sizeof(vertex_textured);
+    instanced.attributes   = textured_attributes;
+    pipelines_.set_program(pipeline_program::textured_instanced,
+                           std::move(instanced));
+
+    const std::vector packed_attributes {
+        attribute(0,
+                  SDL_GPU_VERTEXELEMENTFORMAT_USHORT4_NORM,
+                  offsetof(vertex_textured_packed, position)),
+        attribute(1,
+                  SDL_GPU_VERTEXELEMENTFORMAT_SHORT2_NORM,
+                  offsetof(vertex_textured_packed, normal)),
+        attribute(2,
+                  SDL_GPU_VERTEXELEMENTFORMAT_HALF2,
+                  offsetof(vertex_textured_packed, texcoord)),
+    };
 
-    if (wireframe_pipeline_ != nullptr)
+    auto packed         = program_desc("textured_packed");
+    packed.vertex_pitch = sizeof(vertex_textured_packed);
+    packed.attributes   = packed_attributes;
+    pipelines_.set_program(pipeline_program::textured_packed,
+                           std::move(packed));
+
+    auto packed_instanced         = program_desc("textured_packed_instanced");
+    packed_instanced.vertex_pitch = sizeof(vertex_textured_packed);
+    packed_instanced.attributes   = packed_attributes;
+    pipelines_.set_program(pipeline_program::textured_packed_instanced,
+                           std::move(packed_instanced));
+
+    // Alpha variants share the vertex layouts of the programs above
+    auto alpha         = program_desc("textured_alpha");
+    alpha.vertex_pitch = sizeof(vertex_textured);
+    alpha.attributes   = textured_attributes;
+    pipelines_.set_program(pipeline_program::textured_alpha,
+                           std::move(alpha));
+
+    auto alpha_instanced         = program_desc("textured_alpha_instanced");
+    alpha_instanced.vertex_pitch = sizeof(vertex_textured);
+    alpha_instanced.attributes   = textured_attributes;
+    pipelines_.set_program(pipeline_program::textured_alpha_instanced,
+                           std::move(alpha_instanced));
+
+    auto packed_alpha         = program_desc("textured_packed_alpha");
+    packed_alpha.vertex_pitch = sizeof(vertex_textured_packed);
+    packed_alpha.attributes   = packed_attributes;
+    pipelines_.set_program(pipeline_program::textured_packed_alpha,
+                           std::move(packed_alpha));
+
+    auto packed_alpha_instanced =
+        program_desc("textured_packed_alpha_instanced");
+    packed_alpha_instanced.vertex_pitch = sizeof(vertex_textured_packed);
+    packed_alpha_instanced.attributes   = packed_attributes;
+    pipelines_.set_program(pipeline_program::textured_packed_alpha_instanced,
+                           std::move(packed_alpha_instanced));
+
+    // Depth-only programs read the position out of the same interleaved
+    // vertices, so the pre-pass needs no second copy of the meshes
+    const std::array depth_only_programs {
+        std::tuple { pipeline_program::depth_only,
+                     "depth_only",
+                     SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
+                     sizeof(vertex_textured) },
+        std::tuple { pipeline_program::depth_only_instanced,
+                     "depth_only_instanced",
+                     SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
+                     sizeof(vertex_textured) },
+        std::tuple { pipeline_program::depth_only_packed,
+                     "depth_only_packed",
+                     SDL_GPU_VERTEXELEMENTFORMAT_USHORT4_NORM,
+                     sizeof(vertex_textured_packed) },
+        std::tuple { pipeline_program::depth_only_packed_instanced,
+                     "depth_only_packed_instanced",
+                     SDL_GPU_VERTEXELEMENTFORMAT_USHORT4_NORM,
+                     sizeof(vertex_textured_packed) },
+    };
+    static_assert(offsetof(vertex_textured, position) == 0 &&
+                  offsetof(vertex_textured_packed, position) == 0);
+    for (const auto& [program, name, format, pitch] : depth_only_programs)
     {
-        SDL_ReleaseGPUGraphicsPipeline(device_, wireframe_pipeline_);
+        auto depth_only         = program_desc(name);
+        depth_only.vertex_pitch = static_cast<Uint32>(pitch);
+        depth_only.attributes   = { attribute(0, format, 0) };
+        pipelines_.set_program(program, std::move(depth_only));
     }
 
-    wireframe_pipeline_ =
-        SDL_CreateGPUGraphicsPipeline(device_, &pipeline_info);
-    if (wireframe_pipeline_ == nullptr)
-    {
-        return false;
-    }
+    // No vertex input, the fullscreen triangle comes from the vertex ID
+    pipelines_.set_program(pipeline_program::postprocess,
+                           program_desc("postprocess"));
+}
 
-    // Create triangle variant for thick lines
-    pipeline_info.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST;
-    if (wireframe_tri_pipeline_ != nullptr)
+bool Renderer::resolve_pipelines()
+{
+    const auto samples = msaa_sample_count();
+    const auto get     = [&](scene_variant variant)
+    { return pipelines_.get(scene_variant_key(variant, samples)); };
+
+    wireframe_pipeline_         = get(scene_variant::wireframe);
+    wireframe_tri_pipeline_     = get(scene_variant::wireframe_tri);
+    wireframe_bounds_pipeline_  = get(scene_variant::wireframe_overlay);
+    textured_pipeline_          = get(scene_variant::textured);
+    textured_wireframe_pipeline_ = get(scene_variant::textured_wireframe);
+    textured_instanced_pipeline_ = get(scene_variant::textured_instanced);
+    textured_instanced_wireframe_pipeline_ =
+        get(scene_variant::textured_instanced_wireframe);
+    textured_packed_pipeline_ = get(scene_variant::textured_packed);
+    textured_packed_wireframe_pipeline_ =
+        get(scene_variant::textured_packed_wireframe);
+    textured_packed_instanced_pipeline_ =
+        get(scene_variant::textured_packed_instanced);
+    textured_packed_instanced_wireframe_pipeline_ =
+        get(scene_variant::textured_packed_instanced_wireframe);
+
+    // Without the alpha shaders, masked and blended meshes draw as opaque
+    const auto get_or = [&](scene_variant            variant,
+                            SDL_GPUGraphicsPipeline* fallback)
+    {
+        auto* pipeline = get(variant);
+        return pipeline != nullptr ? pipeline : fallback;
+    };
+    textured_mask_pipeline_ =
+        get_or(scene_variant::textured_mask, textured_pipeline_);
+    textured_blend_pipeline_ =
+        get_or(scene_variant::textured_blend, textured_pipeline_);
+    textured_instanced_mask_pipeline_ =
+        get_or(scene_variant::textured_instanced_mask,
+               textured_instanced_pipeline_);
+    textured_instanced_blend_pipeline_ =
+        get_or(scene_variant::textured_instanced_blend,
+               textured_instanced_pipeline_);
+    textured_packed_mask_pipeline_ =
+        get_or(scene_variant::textured_packed_mask, textured_packed_pipeline_);
+    textured_packed_blend_pipeline_ = get_or(
+        scene_variant::textured_packed_blend, textured_packed_pipeline_);
+    textured_packed_instanced_mask_pipeline_ =
+        get_or(scene_variant::textured_packed_instanced_mask,
+               textured_packed_instanced_pipeline_);
+    textured_packed_instanced_blend_pipeline_ =
+        get_or(scene_variant::textured_packed_instanced_blend,
+               textured_packed_instanced_pipeline_);
+
+    // The pre-pass needs every variant: a draw it skips would fail the
+    // equal test in the color pass
+    std::array prepass_pipelines {
+        std::pair { &depth_only_pipeline_, scene_variant::depth_only },
+        std::pair { &depth_only_instanced_pipeline_,
+                    scene_variant::depth_only_instanced },
+        std::pair { &depth_only_packed_pipeline_,
+                    scene_variant::depth_only_packed },
+        std::pair { &depth_only_packed_instanced_pipeline_,
+                    scene_variant::depth_only_packed_instanced },
+        std::pair { &textured_equal_pipeline_, scene_variant::textured_equal },
+        std::pair { &textured_instanced_equal_pipeline_,
+                    scene_variant::textured_instanced_equal },
+        std::pair { &textured_packed_equal_pipeline_,
+                    scene_variant::textured_packed_equal },
+        std::pair { &textured_packed_instanced_equal_pipeline_,
+                    scene_variant::textured_packed_instanced_equal },
+    };
+    bool prepass_ready = true;
+    for (auto& [pipeline, variant] : prepass_pipelines)
     {
-        SDL_ReleaseGPUGraphicsPipeline(device_, wireframe_tri_pipeline_);
+        *pipeline     = get(variant);
+        prepass_ready = prepass_ready && *pipeline != nullptr;
     }
-    wireframe_tri_pipeline_ =
-        SDL_CreateGPUGraphicsPipeline(device_, &pipeline_info);
-    if (wireframe_tri_pipeline_ == nullptr)
+    if (!prepass_ready)
     {
-        return false;
+        for (auto& [pipeline, variant] : prepass_pipelines)
+        {
+            *pipeline = nullptr;
+        }
     }
 
-    // Create bounds wireframe pipeline - disable depth test entirely
-    // This ensures bounding boxes are always visible, even when camera is
-    // inside the object This is how most game engines handle selection
-    // gizmos/bounding boxes
-    pipeline_info.primitive_type = SDL_GPU_PRIMITIVETYPE_LINELIST;
-    depth_state.compare_op       = SDL_GPU_COMPAREOP_ALWAYS;
-    depth_state.enable_depth_test =
-        false; // Disable depth test - always render on top
-    depth_state.enable_depth_write    = false; // Don't write to depth buffer
-    pipeline_info.depth_stencil_state = depth_state;
-
-    if (wireframe_bounds_pipeline_ != nullptr)
+    postprocess_pipeline_ = pipelines_.get(k_postprocess_key);
+    if (postprocess_pipeline_ == nullptr)
     {
-        SDL_ReleaseGPUGraphicsPipeline(device_, wireframe_bounds_pipeline_);
+        spdlog::warn("Postprocess pipeline not available");
     }
-    wireframe_bounds_pipeline_ =
-        SDL_CreateGPUGraphicsPipeline(device_, &pipeline_info);
-    return wireframe_bounds_pipeline_ != nullptr;
+
+    // Instanced, packed and textured wireframe variants are optional
+    return wireframe_pipeline_ != nullptr &&
+           wireframe_tri_pipeline_ != nullptr &&
+           wireframe_bounds_pipeline_ != nullptr &&
+           textured_pipeline_ != nullptr && postprocess_pipeline_ != nullptr;
 }
 
-bool Renderer::create_textured_pipeline()
+void Renderer::precreate_pipeline_variants()
 {
-    auto* prog = shaders_->get_program("textured");
-    if ((prog == nullptr) || !prog->valid())
-    {
-        return false;
+    std::vector<pipeline_key> keys;
+    for (const auto samples : { SDL_GPU_SAMPLECOUNT_1,
+                                SDL_GPU_SAMPLECOUNT_2,
+                                SDL_GPU_SAMPLECOUNT_4,
+                                SDL_GPU_SAMPLECOUNT_8 })
+    {
+        const auto format = scene_variant_key(scene_variant::wireframe, samples)
+                                .color_format;
+        if (samples == msaa_sample_count() ||
+            !SDL_GPUTextureSupportsSampleCount(device_, format, samples))
+        {
+            continue;
+        }
+        for (std::size_t v = 0; v < k_scene_variant_count; ++v)
+        {
+            keys.push_back(
+                scene_variant_key(static_cast<scene_variant>(v), samples));
+        }
     }
+    pipelines_.precreate(std::move(keys));
+}
 
-    std::array<SDL_GPUVertexAttribute, 3> attrs {};
-    attrs[0].location    = 0;
-    attrs[0].buffer_slot = 0;
-    attrs[0].format      = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3;
-    attrs[0].offset      = offsetof(vertex_textured, position);
-    attrs[1].location    = 1;
-    attrs[1].buffer_slot = 0;
-    attrs[1].format      = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3;
-    attrs[1].offset      = offsetof(vertex_textured, normal);
-    attrs[2].location    = 2;
-    attrs[2].buffer_slot = 0;
-    attrs[2].format      = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2;
-    attrs[2].offset      = offsetof(vertex_textured, texcoord);
-
-    SDL_GPUVertexBufferDescription vb_desc {};
-    vb_desc.slot       = 0;
-    vb_desc.pitch      = sizeof(vertex_textured);
-    vb_desc.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX;
-
-    SDL_GPUVertexInputState vertex_input {};
-    vertex_input.vertex_buffer_descriptions = &vb_desc;
-    vertex_input.num_vertex_buffers         = 1;
-    vertex_input.vertex_attributes          = attrs.data();
-    vertex_input.num_vertex_attributes      = static_cast<Uint32>(attrs.size());
-
-    SDL_GPUColorTargetDescription color_target {};
-    color_target.format = SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM;
-    color_target.blend_state.enable_blend = false;
-
-    SDL_GPUGraphicsPipelineTargetInfo target_info {};
-    target_info.color_target_descriptions = &color_target;
-    target_info.num_color_targets         = 1;
-    target_info.depth_stencil_format      = SDL_GPU_TEXTUREFORMAT_D32_FLOAT;
-    target_info.has_depth_stencil_target  = true;
-
-    SDL_GPURasterizerState raster_state {};
-    raster_state.fill_mode  = SDL_GPU_FILLMODE_FILL;
-    raster_state.cull_mode  = SDL_GPU_CULLMODE_BACK;
-    raster_state.front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE;
-
-    SDL_GPUMultisampleState ms_state {};
-    // Convert msaa_samples to SDL_GPUSampleCount
-    SDL_GPUSampleCount sample_count = SDL_GPU_SAMPLECOUNT_1;
+SDL_GPUSampleCount Renderer::msaa_sample_count() const noexcept
+{
     switch (msaa_samples_)
     {
         case msaa_samples::none:
-            sample_count = SDL_GPU_SAMPLECOUNT_1;
-            break;
+            return SDL_GPU_SAMPLECOUNT_1;
         case msaa_samples::x2:
-            sample_count = SDL_GPU_SAMPLECOUNT_2;
-            break;
+            return SDL_GPU_SAMPLECOUNT_2;
         case msaa_samples::x4:
-            sample_count = SDL_GPU_SAMPLECOUNT_4;
-            break;
+            return SDL_GPU_SAMPLECOUNT_4;
         case msaa_samples::x8:
-            sample_count = SDL_GPU_SAMPLECOUNT_8;
-            break;
+            return SDL_GPU_SAMPLECOUNT_8;
     }
-    ms_state.sample_count = sample_count;
-    spdlog::debug("Creating pipeline with MSAA: {}x (sample_count={})",
-                  static_cast<int>(msaa_samples_),
-                  static_cast<int>(sample_count));
-
-    SDL_GPUDepthStencilState depth_state {};
-    depth_state.compare_op         = SDL_GPU_COMPAREOP_LESS;
-    depth_state.enable_depth_test  = true;
-    depth_state.enable_depth_write = true;
-
-    SDL_GPUGraphicsPipelineCreateInfo pipeline_info {};
-    pipeline_info.vertex_shader       = prog->vertex_shader();
-    pipeline_info.fragment_shader     = prog->fragment_shader();
-    pipeline_info.vertex_input_state  = vertex_input;
-    pipeline_info.primitive_type      = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST;
-    pipeline_info.rasterizer_state    = raster_state;
-    pipeline_info.multisample_state   = ms_state;
-    pipeline_info.depth_stencil_state = depth_state;
-    pipeline_info.target_info         = target_info;
+    return SDL_GPU_SAMPLECOUNT_1;
+}
 
-    if (textured_pipeline_ != nullptr)
+void Renderer::ensure_pp_target(Uint32               width,
+                                Uint32               height,
+                                SDL_GPUTextureFormat format)
+{
+    // Check if we need to recreate
+    if (pp_color_texture_ != nullptr && pp_width_ == width &&
+        pp_height_ == height)
     {
-        SDL_ReleaseGPUGraphicsPipeline(device_, textured_pipeline_);
-    }
-
-    textured_pipeline_ = SDL_CreateGPUGraphicsPipeline(device_, &pipeline_info);
-    if (textured_pipeline_ == nullptr)
-    {
-        return false;
-    }
-
-    // Create wireframe variant
-    raster_state.fill_mode         = SDL_GPU_FILLMODE_LINE;
-    raster_state.cull_mode         = SDL_GPU_CULLMODE_NONE;
-    pipeline_info.rasterizer_state = raster_state;
-
-    if (textured_wireframe_pipeline_ != nullptr)
-    {
-        SDL_ReleaseGPUGraphicsPipeline(device_, textured_wireframe_pipeline_);
-    }
-
-    textured_wireframe_pipeline_ =
-        SDL_CreateGPUGraphicsPipeline(device_, &pipeline_info);
-    return true;
-}
-
-bool Renderer::create_postprocess_pipeline()
-{
-    auto* prog = shaders_->get_program("postprocess");
-    if ((prog == nullptr) || !prog->valid())
-    {
-        spdlog::warn("Postprocess shader not available");
-        return false;
-    }
-
-    // No vertex input - we generate vertices from vertex ID
-    SDL_GPUVertexInputState vertex_input {};
-    vertex_input.vertex_buffer_descriptions = nullptr;
-    vertex_input.num_vertex_buffers         = 0;
-    vertex_input.vertex_attributes          = nullptr;
-    vertex_input.num_vertex_attributes      = 0;
-
-    SDL_GPUColorTargetDescription color_target {};
-    color_target.format = SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM;
-    color_target.blend_state.enable_blend = false;
-
-    SDL_GPUGraphicsPipelineTargetInfo target_info {};
-    target_info.color_target_descriptions = &color_target;
-    target_info.num_color_targets         = 1;
-    target_info.has_depth_stencil_target  = false;
-
-    SDL_GPURasterizerState raster_state {};
-    raster_state.fill_mode  = SDL_GPU_FILLMODE_FILL;
-    raster_state.cull_mode  = SDL_GPU_CULLMODE_NONE;
-    raster_state.front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE;
-
-    SDL_GPUMultisampleState ms_state {};
-    ms_state.sample_count = SDL_GPU_SAMPLECOUNT_1;
-
-    SDL_GPUGraphicsPipelineCreateInfo pipeline_info {};
-    pipeline_info.vertex_shader      = prog->vertex_shader();
-    pipeline_info.fragment_shader    = prog->fragment_shader();
-    pipeline_info.vertex_input_state = vertex_input;
-    pipeline_info.primitive_type     = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST;
-    pipeline_info.rasterizer_state   = raster_state;
-    pipeline_info.multisample_state  = ms_state;
-    pipeline_info.target_info        = target_info;
-
-    if (postprocess_pipeline_ != nullptr)
-    {
-        SDL_ReleaseGPUGraphicsPipeline(device_, postprocess_pipeline_);
-    }
-
-    postprocess_pipeline_ =
-        SDL_CreateGPUGraphicsPipeline(device_, &pipeline_info);
-    if (postprocess_pipeline_ == nullptr)
-    {
-        spdlog::error("Failed to create postprocess pipeline: {}",
-                      SDL_GetError());
-        return false;
-    }
-
-    spdlog::info("Post-processing pipeline created successfully");
-    return true;
-}
-
-void Renderer::ensure_pp_target(Uint32               width,
-                                Uint32               height,
-                                SDL_GPUTextureFormat format)
-{
-    // Check if we need to recreate
-    if (pp_color_texture_ != nullptr && pp_width_ == width &&
-        pp_height_ == height)
-    {
-        return;
+        return;
     }
 
     // Release old texture
@@ -863,34 +1454,57 @@ void Renderer::apply_postprocess(SDL_GPUCommandBuffer*     cmd,
 
 void Renderer::reload_pipelines()
 {
+    if (shaders_dirty_)
+    {
+        // Re-registering drops every variant built from the old shaders;
+        // the current ones are rebuilt now, the rest in the background
+        register_pipeline_programs();
+        (void)resolve_pipelines();
+        precreate_pipeline_variants();
+        shaders_dirty_  = false;
+        pipeline_dirty_ = false;
+    }
     if (pipeline_dirty_)
     {
-        (void)create_wireframe_pipeline(); // This also creates
-                                           // wireframe_tri_pipeline_
-        (void)create_textured_pipeline();
-        (void)create_postprocess_pipeline();
+        // Sample count changed, usually a lookup of a precreated variant
+        (void)resolve_pipelines();
         pipeline_dirty_ = false;
     }
 }
 
-void Renderer::begin_frame(SDL_GPUCommandBuffer* cmd, SDL_GPURenderPass* pass)
+void Renderer::begin_frame(SDL_GPUCommandBuffer* cmd, Uint32 view_height)
 {
-    current_cmd_  = cmd;
-    current_pass_ = pass;
-
-    // Clean up temporary debug meshes from previous frame
-    for (auto& mesh : temp_meshes_)
-    {
-        if (mesh.vertex_buffer != nullptr)
-        {
-            SDL_ReleaseGPUBuffer(device_, mesh.vertex_buffer);
-        }
-        if (mesh.index_buffer != nullptr)
-        {
-            SDL_ReleaseGPUBuffer(device_, mesh.index_buffer);
-        }
-    }
-    temp_meshes_.clear();
+    current_cmd_   = cmd;
+    current_pass_  = nullptr;
+    prepass_drawn_ = false;
+    view_height_   = view_height;
+
+    // Submit uploads queued between frames; retired buffers may be the
+    // source of a queued copy, so they must be flushed first
+    staging_.reclaim();
+    staging_frame_start_ = staging_.stats();
+    staging_.flush();
+
+    // Draws recorded last frame have been submitted, old buffers and
+    // freed ranges can go; compaction sees the ranges freed since then
+    wireframe_arena_.release_retired();
+    textured_arena_.release_retired();
+    packed_arena_.release_retired();
+    compact_mesh_arenas();
+
+    // Drop anything recorded without a matching end_frame
+    draw_queue_.clear();
+    draw_items_.clear();
+    draw_batches_.clear();
+    frame_matrices_.clear();
+    view_proj_matrix_ = UINT32_MAX;
+    model_draws_.clear();
+    frame_views_.clear();
+    view_index_ = UINT32_MAX;
+
+    // Asynchronous loads whose files are ready go to the GPU before this
+    // frame's draws are recorded
+    drain_model_loads();
 
     // Reset per-frame stats
     frame_stats_ = render_stats {
@@ -898,19 +1512,155 @@ void Renderer::begin_frame(SDL_GPUCommandBuffer* cmd, SDL_GPURenderPass* pass)
         .textures_loaded = static_cast<std::uint32_t>(textures_.size()),
         .meshes_loaded   = static_cast<std::uint32_t>(meshes_.size()),
     };
+    for (const auto& tex : textures_)
+    {
+        if (tex.layers > 1)
+        {
+            ++frame_stats_.texture_arrays;
+            frame_stats_.textures_packed += tex.layers;
+        }
+    }
 
     reload_pipelines();
 }
 
-void Renderer::end_frame()
+void Renderer::prepare_frame()
+{
+    [[maybe_unused]] auto profiler_zone =
+        profiler_zone_begin(profiler_, "Renderer::prepare_frame");
+
+    record_model_draws();
+    {
+        [[maybe_unused]] auto profiler_zone_sort =
+            profiler_zone_begin(profiler_, "Renderer::prepare_frame::sort");
+        draw_queue_.sort();
+    }
+
+    build_draw_batches(true);
+    if (!upload_instance_data())
+    {
+        build_draw_batches(false); // No instance buffer: one draw per item
+    }
+    debug_lines_uploaded_ = upload_debug_lines();
+
+    // Uploads queued while recording (debug meshes, loads) are submitted
+    // ahead of the frame command buffer that draws them
+    staging_.flush();
+}
+
+void Renderer::depth_prepass(SDL_GPURenderPass* pass)
+{
+    [[maybe_unused]] auto profiler_zone =
+        profiler_zone_begin(profiler_, "Renderer::depth_prepass");
+
+    if (pass == nullptr || current_cmd_ == nullptr ||
+        depth_only_pipeline_ == nullptr)
+    {
+        return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+
+    // Same batches as the color pass, restricted to opaque filled draws
+    SDL_GPUGraphicsPipeline* bound_pipeline = nullptr;
+    SDL_GPUBuffer*           bound_vb       = nullptr;
+    SDL_GPUBuffer*           bound_ib       = nullptr;
+    SDL_GPUIndexElementSize  bound_index_size = SDL_GPU_INDEXELEMENTSIZE_16BIT;
+    std::uint32_t            pushed_matrix    = UINT32_MAX;
+
+    for (const auto& batch : draw_batches_)
+    {
+        const auto& item      = draw_items_[batch.item];
+        const bool  instanced = batch.instance_count > 1;
+        auto*       pipeline  = depth_pipeline_for(item.pipeline, instanced);
+        if (pipeline == nullptr)
+        {
+            continue;
+        }
+
+        if (pipeline != bound_pipeline)
+        {
+            SDL_BindGPUGraphicsPipeline(pass, pipeline);
+            bound_pipeline = pipeline;
+            pushed_matrix  = UINT32_MAX;
+            if (instanced)
+            {
+                SDL_BindGPUVertexStorageBuffers(pass, 0, &instance_buffer_, 1);
+            }
+        }
+
+        if (instanced)
+        {
+            const uniform_instancing uniforms { .base_instance =
+                                                    batch.base_instance };
+            SDL_PushGPUVertexUniformData(
+                current_cmd_, 0, &uniforms, sizeof(uniforms));
+        }
+        else if (item.matrix != pushed_matrix)
+        {
+            const uniform_mvp uniforms { frame_matrices_[item.matrix] };
+            SDL_PushGPUVertexUniformData(
+                current_cmd_, 0, &uniforms, sizeof(uniforms));
+            pushed_matrix = item.matrix;
+        }
+
+        if (item.vertex_buffer != bound_vb)
+        {
+            SDL_GPUBufferBinding vb {};
+            vb.buffer = item.vertex_buffer;
+            SDL_BindGPUVertexBuffers(pass, 0, &vb, 1);
+            bound_vb = item.vertex_buffer;
+        }
+        if (item.index_buffer != bound_ib ||
+            item.index_size != bound_index_size)
+        {
+            SDL_GPUBufferBinding ib {};
+            ib.buffer = item.index_buffer;
+            SDL_BindGPUIndexBuffer(pass, &ib, item.index_size);
+            bound_ib         = item.index_buffer;
+            bound_index_size = item.index_size;
+        }
+
+        SDL_DrawGPUIndexedPrimitives(pass,
+                                     item.index_count,
+                                     batch.instance_count,
+                                     item.first_index,
+                                     item.vertex_offset,
+                                     0);
+
+        ++frame_stats_.prepass_draw_calls;
+        frame_stats_.prepass_triangles +=
+            (item.index_count / 3) * batch.instance_count;
+    }
+
+    prepass_drawn_ = true;
+    frame_stats_.prepass_ms =
+        std::chrono::duration<float, std::milli>(
+            std::chrono::steady_clock::now() - start)
+            .count();
+}
+
+void Renderer::end_frame(SDL_GPURenderPass* pass)
 {
-    current_cmd_  = nullptr;
-    current_pass_ = nullptr;
+    current_pass_ = pass;
+    flush_draw_queue();
+    draw_debug_lines();
+
+    // Lines added after this point (e.g. from UI code) go to the next frame
+    frame_stats_.debug_lines         = debug_lines_.line_count();
+    frame_stats_.debug_lines_dropped = debug_lines_.dropped();
+    debug_lines_.clear();
+    debug_lines_uploaded_ = false;
+
+    current_cmd_   = nullptr;
+    current_pass_  = nullptr;
+    prepass_drawn_ = false;
 }
 
 void Renderer::set_view_projection(const glm::mat4& vp)
 {
-    view_proj_ = vp;
+    view_proj_        = vp;
+    view_proj_matrix_ = UINT32_MAX;
+    view_index_       = UINT32_MAX;
 }
 
 void Renderer::set_render_mode(render_mode mode)
@@ -918,138 +1668,112 @@ void Renderer::set_render_mode(render_mode mode)
     render_mode_ = mode;
 }
 
-void Renderer::bind_pipeline()
-{
-    if ((wireframe_pipeline_ != nullptr) && (current_pass_ != nullptr))
-    {
-        SDL_BindGPUGraphicsPipeline(current_pass_, wireframe_pipeline_);
-    }
-}
-
 gpu_mesh Renderer::upload_wireframe_mesh(
     std::span<const vertex_pos_color> verts, std::span<const uint16_t> idx)
 {
     gpu_mesh mesh {};
-    mesh.index_count  = static_cast<Uint32>(idx.size());
-    mesh.vertex_count = static_cast<Uint32>(verts.size());
-
-    const auto vb_size = static_cast<Uint32>(verts.size_bytes());
-    const auto ib_size = static_cast<Uint32>(idx.size_bytes());
-
-    // Create vertex buffer
-    SDL_GPUBufferCreateInfo vb_info {};
-    vb_info.usage      = SDL_GPU_BUFFERUSAGE_VERTEX;
-    vb_info.size       = vb_size;
-    mesh.vertex_buffer = SDL_CreateGPUBuffer(device_, &vb_info);
-
-    // Create index buffer
-    SDL_GPUBufferCreateInfo ib_info {};
-    ib_info.usage     = SDL_GPU_BUFFERUSAGE_INDEX;
-    ib_info.size      = ib_size;
-    mesh.index_buffer = SDL_CreateGPUBuffer(device_, &ib_info);
-
-    // Create transfer buffer and upload
-    SDL_GPUTransferBufferCreateInfo tb_info {};
-    tb_info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-    tb_info.size  = vb_size + ib_size;
-    auto* tb      = SDL_CreateGPUTransferBuffer(device_, &tb_info);
-    auto* ptr     = SDL_MapGPUTransferBuffer(device_, tb, false);
-    std::memcpy(ptr, verts.data(), vb_size);
-    std::memcpy(static_cast<char*>(ptr) + vb_size, idx.data(), ib_size);
-    SDL_UnmapGPUTransferBuffer(device_, tb);
-
-    auto* cmd = SDL_AcquireGPUCommandBuffer(device_);
-    auto* cp  = SDL_BeginGPUCopyPass(cmd);
-
-    // Upload vertex data
-    SDL_GPUTransferBufferLocation src1 {};
-    src1.transfer_buffer = tb;
-    src1.offset          = 0;
-    SDL_GPUBufferRegion dst1 {};
-    dst1.buffer = mesh.vertex_buffer;
-    dst1.offset = 0;
-    dst1.size   = vb_size;
-    SDL_UploadToGPUBuffer(cp, &src1, &dst1, false);
-
-    // Upload index data
-    SDL_GPUTransferBufferLocation src2 {};
-    src2.transfer_buffer = tb;
-    src2.offset          = vb_size;
-    SDL_GPUBufferRegion dst2 {};
-    dst2.buffer = mesh.index_buffer;
-    dst2.offset = 0;
-    dst2.size   = ib_size;
-    SDL_UploadToGPUBuffer(cp, &src2, &dst2, false);
+    mesh.id = next_mesh_id_++;
 
-    SDL_EndGPUCopyPass(cp);
-    SDL_SubmitGPUCommandBuffer(cmd);
-    SDL_ReleaseGPUTransferBuffer(device_, tb);
+    // Sub-allocate from the shared buffers; an empty range draws nothing
+    auto range = wireframe_arena_.allocate(static_cast<Uint32>(verts.size()),
+                                           static_cast<Uint32>(idx.size()));
+    if (!range)
+    {
+        spdlog::error("== wireframe mesh: arena allocation failed");
+        return mesh;
+    }
+    if (!wireframe_arena_.upload(
+            *range, std::as_bytes(verts), std::as_bytes(idx)))
+    {
+        wireframe_arena_.free(*range);
+        return mesh;
+    }
 
+    mesh.range = *range;
     return mesh;
 }
 
 gpu_textured_mesh Renderer::upload_textured_mesh(
-    std::span<const vertex_textured> verts, std::span<const uint16_t> idx)
+    mesh_arena&                arena,
+    std::span<const std::byte> verts,
+    Uint32                     vertex_count,
+    std::span<const uint32_t>  idx,
+    index_format               format)
 {
     gpu_textured_mesh mesh {};
-    mesh.index_count  = static_cast<Uint32>(idx.size());
-    mesh.vertex_count = static_cast<Uint32>(verts.size());
-
-    const auto vb_size = static_cast<Uint32>(verts.size_bytes());
-    const auto ib_size = static_cast<Uint32>(idx.size_bytes());
-
-    // Create vertex buffer
-    SDL_GPUBufferCreateInfo vb_info {};
-    vb_info.usage      = SDL_GPU_BUFFERUSAGE_VERTEX;
-    vb_info.size       = vb_size;
-    mesh.vertex_buffer = SDL_CreateGPUBuffer(device_, &vb_info);
-
-    // Create index buffer
-    SDL_GPUBufferCreateInfo ib_info {};
-    ib_info.usage     = SDL_GPU_BUFFERUSAGE_INDEX;
-    ib_info.size      = ib_size;
-    mesh.index_buffer = SDL_CreateGPUBuffer(device_, &ib_info);
-
-    // Create transfer buffer and upload
-    SDL_GPUTransferBufferCreateInfo tb_info {};
-    tb_info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-    tb_info.size  = vb_size + ib_size;
-    auto* tb      = SDL_CreateGPUTransferBuffer(device_, &tb_info);
-    auto* ptr     = SDL_MapGPUTransferBuffer(device_, tb, false);
-    std::memcpy(ptr, verts.data(), vb_size);
-    std::memcpy(static_cast<char*>(ptr) + vb_size, idx.data(), ib_size);
-    SDL_UnmapGPUTransferBuffer(device_, tb);
-
-    auto* cmd = SDL_AcquireGPUCommandBuffer(device_);
-    auto* cp  = SDL_BeginGPUCopyPass(cmd);
-
-    // Upload vertex data
-    SDL_GPUTransferBufferLocation src1 {};
-    src1.transfer_buffer = tb;
-    src1.offset          = 0;
-    SDL_GPUBufferRegion dst1 {};
-    dst1.buffer = mesh.vertex_buffer;
-    dst1.offset = 0;
-    dst1.size   = vb_size;
-    SDL_UploadToGPUBuffer(cp, &src1, &dst1, false);
-
-    // Upload index data
-    SDL_GPUTransferBufferLocation src2 {};
-    src2.transfer_buffer = tb;
-    src2.offset          = vb_size;
-    SDL_GPUBufferRegion dst2 {};
-    dst2.buffer = mesh.index_buffer;
-    dst2.offset = 0;
-    dst2.size   = ib_size;
-    SDL_UploadToGPUBuffer(cp, &src2, &dst2, false);
+    mesh.id = next_mesh_id_++;
 
-    SDL_EndGPUCopyPass(cp);
-    SDL_SubmitGPUCommandBuffer(cmd);
-    SDL_ReleaseGPUTransferBuffer(device_, tb);
+    const bool wide  = format == index_format::uint32;
+    auto       range = arena.allocate(vertex_count,
+                                static_cast<Uint32>(idx.size()),
+                                wide ? SDL_GPU_INDEXELEMENTSIZE_32BIT
+                                     : SDL_GPU_INDEXELEMENTSIZE_16BIT);
+    if (!range)
+    {
+        spdlog::error("== textured mesh: arena allocation failed");
+        return mesh;
+    }
+
+    // Narrow to 16 bits when every vertex is addressable, halving the
+    // index memory and fetch bandwidth
+    std::vector<uint16_t> narrow;
+    if (!wide)
+    {
+        narrow.resize(idx.size());
+        std::ranges::transform(idx,
+                               narrow.begin(),
+                               [](uint32_t i)
+                               { return static_cast<uint16_t>(i); });
+    }
+    const auto index_bytes = wide ? std::as_bytes(idx)
+                                  : std::as_bytes(std::span(narrow));
+
+    if (!arena.upload(*range, verts, index_bytes))
+    {
+        arena.free(*range);
+        return mesh;
+    }
 
+    mesh.range = *range;
     return mesh;
 }
 
+void Renderer::compact_mesh_arenas()
+{
+    if (wireframe_arena_.should_compact())
+    {
+        std::vector<mesh_range*> live;
+        live.reserve(meshes_.size());
+        for (auto& mesh : meshes_)
+        {
+            live.push_back(&mesh.range);
+        }
+        (void)wireframe_arena_.compact(live);
+    }
+
+    for (const bool packed : { false, true })
+    {
+        auto& arena = packed ? packed_arena_ : textured_arena_;
+        if (!arena.should_compact())
+        {
+            continue;
+        }
+        std::vector<mesh_range*> live;
+        for (auto& model : models_)
+        {
+            if (model.packed != packed)
+            {
+                continue;
+            }
+            for (auto& mesh : model.meshes)
+            {
+                live.push_back(&mesh.range);
+            }
+        }
+        (void)arena.compact(live);
+    }
+}
+
 mesh_handle Renderer::create_wireframe_cube(const glm::vec3& center,
                                             float            size,
                                             const glm::vec3& color)
@@ -1073,8 +1797,7 @@ mesh_handle Renderer::create_wireframe_cube(const glm::vec3& center,
         indices.push_back(static_cast<uint16_t>(j));
     }
 
-    meshes_[next_mesh_handle_] = upload_wireframe_mesh(verts, indices);
-    return next_mesh_handle_++;
+    return meshes_.insert(upload_wireframe_mesh(verts, indices));
 }
 
 mesh_handle Renderer::create_wireframe_sphere(const glm::vec3& center,
@@ -1110,8 +1833,7 @@ mesh_handle Renderer::create_wireframe_sphere(const glm::vec3& center,
     add_circle(0, 2); // XZ plane
     add_circle(1, 2); // YZ plane
 
-    meshes_[next_mesh_handle_] = upload_wireframe_mesh(verts, indices);
-    return next_mesh_handle_++;
+    return meshes_.insert(upload_wireframe_mesh(verts, indices));
 }
 
 mesh_handle Renderer::create_wireframe_grid(float            size,
@@ -1142,8 +1864,7 @@ mesh_handle Renderer::create_wireframe_grid(float            size,
         indices.push_back(static_cast<uint16_t>(base + 3));
     }
 
-    meshes_[next_mesh_handle_] = upload_wireframe_mesh(verts, indices);
-    return next_mesh_handle_++;
+    return meshes_.insert(upload_wireframe_mesh(verts, indices));
 }
 
 mesh_handle Renderer::create_mesh(std::span<const vertex>   verts,
@@ -1165,354 +1886,1570 @@ mesh_handle Renderer::create_mesh(std::span<const vertex>   verts,
                                                          .color    = v.color };
                            });
 
-    auto mesh                  = upload_wireframe_mesh(converted, idx);
-    mesh.type                  = type;
-    meshes_[next_mesh_handle_] = mesh;
-    return next_mesh_handle_++;
+    auto mesh = upload_wireframe_mesh(converted, idx);
+    mesh.type = type;
+    return meshes_.insert(mesh);
 }
 
 void Renderer::destroy_mesh(mesh_handle h)
 {
-    if (auto it = meshes_.find(h); it != meshes_.end())
+    if (const auto* mesh = meshes_.find(h))
     {
-        if (it->second.vertex_buffer != nullptr)
-        {
-            SDL_ReleaseGPUBuffer(device_, it->second.vertex_buffer);
-        }
-        if (it->second.index_buffer != nullptr)
-        {
-            SDL_ReleaseGPUBuffer(device_, it->second.index_buffer);
-        }
-        meshes_.erase(it);
+        wireframe_arena_.free(mesh->range);
+        meshes_.erase(h);
     }
 }
 
-void Renderer::draw_mesh_internal(const gpu_mesh& m)
+SDL_GPUGraphicsPipeline* Renderer::pipeline_for(
+    pipeline_slot slot) const noexcept
 {
-    if ((current_pass_ == nullptr) || (current_cmd_ == nullptr))
+    // Opaque draws already have their depth after the pre-pass
+    switch (slot)
+    {
+        case pipeline_slot::textured:
+            return prepass_drawn_ ? textured_equal_pipeline_
+                                  : textured_pipeline_;
+        case pipeline_slot::textured_wireframe:
+            return textured_wireframe_pipeline_;
+        case pipeline_slot::textured_packed:
+            return prepass_drawn_ ? textured_packed_equal_pipeline_
+                                  : textured_packed_pipeline_;
+        case pipeline_slot::textured_packed_wireframe:
+            return textured_packed_wireframe_pipeline_;
+        case pipeline_slot::textured_mask:
+            return textured_mask_pipeline_;
+        case pipeline_slot::textured_blend:
+            return textured_blend_pipeline_;
+        case pipeline_slot::textured_packed_mask:
+            return textured_packed_mask_pipeline_;
+        case pipeline_slot::textured_packed_blend:
+            return textured_packed_blend_pipeline_;
+        case pipeline_slot::wireframe:
+            return wireframe_pipeline_;
+        case pipeline_slot::wireframe_tri:
+            return wireframe_tri_pipeline_;
+    }
+    return nullptr;
+}
+
+SDL_GPUGraphicsPipeline* Renderer::instanced_pipeline_for(
+    pipeline_slot slot) const noexcept
+{
+    switch (slot)
+    {
+        case pipeline_slot::textured:
+            return prepass_drawn_ ? textured_instanced_equal_pipeline_
+                                  : textured_instanced_pipeline_;
+        case pipeline_slot::textured_wireframe:
+            return textured_instanced_wireframe_pipeline_;
+        case pipeline_slot::textured_packed:
+            return prepass_drawn_ ? textured_packed_instanced_equal_pipeline_
+                                  : textured_packed_instanced_pipeline_;
+        case pipeline_slot::textured_packed_wireframe:
+            return textured_packed_instanced_wireframe_pipeline_;
+        case pipeline_slot::textured_mask:
+            return textured_instanced_mask_pipeline_;
+        case pipeline_slot::textured_blend:
+            return textured_instanced_blend_pipeline_;
+        case pipeline_slot::textured_packed_mask:
+            return textured_packed_instanced_mask_pipeline_;
+        case pipeline_slot::textured_packed_blend:
+            return textured_packed_instanced_blend_pipeline_;
+        case pipeline_slot::wireframe:
+        case pipeline_slot::wireframe_tri:
+            return nullptr;
+    }
+    return nullptr;
+}
+
+SDL_GPUGraphicsPipeline* Renderer::depth_pipeline_for(
+    pipeline_slot slot, bool instanced) const noexcept
+{
+    // Only opaque filled draws write depth in the pre-pass; cut-outs need
+    // their texture and blended draws do not write depth at all
+    if (slot == pipeline_slot::textured)
     {
-        return;
+        return instanced ? depth_only_instanced_pipeline_
+                         : depth_only_pipeline_;
+    }
+    if (slot == pipeline_slot::textured_packed)
+    {
+        return instanced ? depth_only_packed_instanced_pipeline_
+                         : depth_only_packed_pipeline_;
     }
+    return nullptr;
+}
 
-    const uniform_mvp uniforms { view_proj_ };
-    SDL_PushGPUVertexUniformData(current_cmd_, 0, &uniforms, sizeof(uniforms));
+SDL_GPUSampler* Renderer::sampler_for(const gpu_texture& tex)
+{
+    auto key = tex.sampler;
+    if (key.min_filter == SDL_GPU_FILTER_LINEAR)
+    {
+        const bool nearest   = texture_filter_ == texture_filter::nearest;
+        const bool trilinear = texture_filter_ == texture_filter::trilinear;
 
-    SDL_GPUBufferBinding vb {};
-    vb.buffer = m.vertex_buffer;
-    vb.offset = 0;
-    SDL_BindGPUVertexBuffers(current_pass_, 0, &vb, 1);
+        key.min_filter  = nearest ? SDL_GPU_FILTER_NEAREST
+                                  : SDL_GPU_FILTER_LINEAR;
+        key.mag_filter  = key.min_filter;
+        key.mipmap_mode = trilinear ? SDL_GPU_SAMPLERMIPMAPMODE_LINEAR
+                                    : SDL_GPU_SAMPLERMIPMAPMODE_NEAREST;
+        key.max_anisotropy = nearest ? 1.0f : max_anisotropy_;
+    }
+    return samplers_.get(key);
+}
 
-    SDL_GPUBufferBinding ib {};
-    ib.buffer = m.index_buffer;
-    ib.offset = 0;
-    SDL_BindGPUIndexBuffer(current_pass_, &ib, SDL_GPU_INDEXELEMENTSIZE_16BIT);
-    SDL_DrawGPUIndexedPrimitives(current_pass_, m.index_count, 1, 0, 0, 0);
+std::uint32_t Renderer::push_frame_matrix(const glm::mat4& m)
+{
+    frame_matrices_.push_back(m);
+    return static_cast<std::uint32_t>(frame_matrices_.size() - 1);
+}
 
-    ++frame_stats_.draw_calls;
-    frame_stats_.vertices += m.vertex_count;
+void Renderer::queue_draw(const draw_item& item, std::uint64_t key)
+{
+    draw_queue_.push(key, static_cast<std::uint32_t>(draw_items_.size()));
+    draw_items_.push_back(item);
 }
 
-void Renderer::draw(mesh_handle h)
+void Renderer::build_draw_batches(bool instancing)
 {
-    [[maybe_unused]] auto profiler_zone =
-        profiler_zone_begin(profiler_, "Renderer::draw");
+    draw_batches_.clear();
+    instance_matrices_.clear();
 
-    if (auto it = meshes_.find(h); it != meshes_.end())
+    const auto packets = draw_queue_.packets();
+    for (std::size_t i = 0; i < packets.size();)
     {
-        if (current_pass_ != nullptr)
+        const auto& first = draw_items_[packets[i].item];
+
+        // Sorting puts draws of the same mesh and texture next to each other
+        std::size_t run = 1;
+        if (instancing && (instanced_pipeline_for(first.pipeline) != nullptr))
         {
-            // Select pipeline based on primitive type
-            SDL_GPUGraphicsPipeline* pipeline = nullptr;
-            if (it->second.type == primitive_type::triangles)
+            while (i + run < packets.size() &&
+                   same_draw_state(first, draw_items_[packets[i + run].item]))
             {
-                pipeline = wireframe_tri_pipeline_;
-            }
-            else
-            {
-                pipeline = wireframe_pipeline_;
+                ++run;
             }
+        }
 
-            if (pipeline != nullptr)
+        draw_batch batch { .item = packets[i].item };
+        if (run > 1)
+        {
+            batch.instance_count = static_cast<std::uint32_t>(run);
+            batch.base_instance =
+                static_cast<std::uint32_t>(instance_matrices_.size());
+            for (std::size_t j = i; j < i + run; ++j)
             {
-                SDL_BindGPUGraphicsPipeline(current_pass_, pipeline);
+                instance_matrices_.push_back(
+                    frame_matrices_[draw_items_[packets[j].item].matrix]);
             }
         }
-        draw_mesh_internal(it->second);
+        draw_batches_.push_back(batch);
+        i += run;
     }
 }
 
-std::filesystem::path Renderer::find_texture_for_model(
-    const std::filesystem::path& model_path)
+bool Renderer::upload_instance_data()
 {
-    const auto dir  = model_path.parent_path();
-    const auto stem = model_path.stem();
-
-    // First try matching texture with same name
-    for (const auto& ext : k_texture_extensions)
+    if (instance_matrices_.empty())
     {
-        auto tex_path = dir / (stem.string() + ext);
-        if (std::filesystem::exists(tex_path))
-        {
-            return tex_path;
-        }
+        return true;
+    }
+    if (current_cmd_ == nullptr)
+    {
+        return false;
     }
 
-    // Fall back to first texture file in directory
-    for (const auto& entry : std::filesystem::directory_iterator(dir))
+    const auto count = static_cast<Uint32>(instance_matrices_.size());
+    if (count > instance_capacity_)
     {
-        if (!entry.is_regular_file())
+        // Grow geometrically; SDL defers destruction until the GPU is done
+        if (instance_buffer_ != nullptr)
         {
-            continue;
+            SDL_ReleaseGPUBuffer(device_, instance_buffer_);
+            instance_buffer_ = nullptr;
         }
+        if (instance_transfer_buffer_ != nullptr)
+        {
+            SDL_ReleaseGPUTransferBuffer(device_, instance_transfer_buffer_);
+            instance_transfer_buffer_ = nullptr;
+        }
+        instance_capacity_ = 0;
 
-        const auto ext        = entry.path().extension().string();
-        const bool is_texture = std::ranges::any_of(
-            k_texture_extensions, [&ext](const char* e) { return ext == e; });
-        if (is_texture)
+        const auto capacity =
+            std::bit_ceil(std::max(count, k_min_instance_capacity));
+        const auto size = capacity * static_cast<Uint32>(sizeof(glm::mat4));
+
+        SDL_GPUBufferCreateInfo buf_info {};
+        buf_info.usage   = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ;
+        buf_info.size    = size;
+        instance_buffer_ = SDL_CreateGPUBuffer(device_, &buf_info);
+
+        SDL_GPUTransferBufferCreateInfo tb_info {};
+        tb_info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+        tb_info.size  = size;
+        instance_transfer_buffer_ =
+            SDL_CreateGPUTransferBuffer(device_, &tb_info);
+
+        if (instance_buffer_ == nullptr || instance_transfer_buffer_ == nullptr)
         {
-            return entry.path();
+            spdlog::error("== instance buffer: {}", SDL_GetError());
+            return false;
         }
+        instance_capacity_ = capacity;
     }
 
-    return {};
-}
+    const auto size = count * static_cast<Uint32>(sizeof(glm::mat4));
 
-texture_handle Renderer::load_texture(const std::filesystem::path& path)
-{
-    auto result = egen::load_texture(device_, path, true);
-    if (!result)
+    // Cycle both buffers so the previous frame's data stays untouched while
+    // the GPU may still be reading it
+    auto* ptr =
+        SDL_MapGPUTransferBuffer(device_, instance_transfer_buffer_, true);
+    if (ptr == nullptr)
     {
-        spdlog::error("== texture {}: {}", path.string(), result.error());
-        return invalid_texture;
+        return false;
     }
+    std::memcpy(ptr, instance_matrices_.data(), size);
+    SDL_UnmapGPUTransferBuffer(device_, instance_transfer_buffer_);
 
-    textures_[next_texture_handle_] = { .texture = result->texture,
-                                        .sampler = result->sampler,
-                                        .width   = result->width,
-                                        .height  = result->height };
+    auto* cp = SDL_BeginGPUCopyPass(current_cmd_);
 
-    spdlog::info("=> texture: {} ({}x{})",
-                 path.filename().string(),
-                 result->width,
-                 result->height);
-    return next_texture_handle_++;
+    SDL_GPUTransferBufferLocation src {};
+    src.transfer_buffer = instance_transfer_buffer_;
+    src.offset          = 0;
+    SDL_GPUBufferRegion dst {};
+    dst.buffer = instance_buffer_;
+    dst.offset = 0;
+    dst.size   = size;
+    SDL_UploadToGPUBuffer(cp, &src, &dst, true);
+
+    SDL_EndGPUCopyPass(cp);
+    return true;
 }
 
-void Renderer::unload_texture(texture_handle h)
+std::uint32_t Renderer::add_material(const gpu_material& material)
 {
-    if (h == default_texture_)
-    {
-        return;
-    }
-
-    if (auto it = textures_.find(h); it != textures_.end())
+    if (!free_materials_.empty())
     {
-        if (it->second.texture != nullptr)
-        {
-            SDL_ReleaseGPUTexture(device_, it->second.texture);
-        }
-        if (it->second.sampler != nullptr)
-        {
-            SDL_ReleaseGPUSampler(device_, it->second.sampler);
-        }
-        textures_.erase(it);
+        const auto index = free_materials_.back();
+        free_materials_.pop_back();
+        materials_[index] = material;
+        return index;
     }
+    materials_.push_back(material);
+    return static_cast<std::uint32_t>(materials_.size() - 1);
 }
 
-gpu_model Renderer::upload_loaded_model(const loaded_model& data,
-                                        const glm::vec3&    color)
+bool Renderer::upload_materials()
 {
-    gpu_model model {};
-    model.color            = color;
-    model.has_uvs          = data.has_uvs;
-    model.model_bounds.min = data.bounds.min;
-    model.model_bounds.max = data.bounds.max;
-
-    // Upload each mesh to GPU
-    for (const auto& src_mesh : data.meshes)
+    const auto count = static_cast<Uint32>(materials_.size());
+    if (count > material_capacity_)
     {
-        // Convert model_vertex to vertex_textured
-        std::vector<vertex_textured> verts;
-        verts.reserve(src_mesh.vertices.size());
-        for (const auto& v : src_mesh.vertices)
+        // Frames in flight may still read the old buffer; SDL defers its
+        // destruction until the GPU is done with it
+        if (material_buffer_ != nullptr)
         {
-            verts.push_back(vertex_textured {
-                .position = v.position,
-                .normal   = v.normal,
-                .texcoord = v.texcoord,
-            });
+            SDL_ReleaseGPUBuffer(device_, material_buffer_);
+            material_buffer_ = nullptr;
         }
+        material_capacity_ = 0;
+
+        const auto capacity =
+            std::bit_ceil(std::max(count, k_min_material_capacity));
 
-        if (!verts.empty() && !src_mesh.indices.empty())
+        SDL_GPUBufferCreateInfo buf_info {};
+        buf_info.usage   = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ;
+        buf_info.size    = capacity * static_cast<Uint32>(sizeof(gpu_material));
+        material_buffer_ = SDL_CreateGPUBuffer(device_, &buf_info);
+        if (material_buffer_ == nullptr)
         {
-            auto gpu_mesh = upload_textured_mesh(verts, src_mesh.indices);
-            // Texture will be set later in load_model based on material
-            model.meshes.push_back(std::move(gpu_mesh));
+            spdlog::error("== material buffer: {}", SDL_GetError());
+            return false;
         }
+        material_capacity_ = capacity;
     }
 
-    return model;
+    // The whole table is rewritten; it is small and only changes on load
+    return staging_.upload_to_buffer(
+        material_buffer_, 0, std::as_bytes(std::span(materials_)));
 }
 
-model_handle Renderer::load_model(const std::filesystem::path& path,
-                                  const glm::vec3&             color)
+bool Renderer::upload_debug_lines()
 {
-    // Use model system to load model
-    static model_system loader;
-    auto                result = loader.load(path);
-    if (!result)
+    const auto tested  = debug_lines_.vertices(debug_depth::tested);
+    const auto overlay = debug_lines_.vertices(debug_depth::overlay);
+    if (tested.empty() && overlay.empty())
     {
-        spdlog::error("== model {}: {}", path.string(), result.error());
-        return invalid_model;
+        return false;
+    }
+    if (current_cmd_ == nullptr || debug_transfer_buffer_ == nullptr ||
+        debug_vertex_buffer_ == nullptr)
+    {
+        return false;
     }
 
-    auto& data = result.value();
-
-    // Load all textures from the model
-    std::vector<texture_handle> loaded_textures;
-    loaded_textures.reserve(data.textures.size());
+    // Depth-tested lines first, overlay lines right after them
+    const auto tested_size  = static_cast<Uint32>(tested.size_bytes());
+    const auto overlay_size = static_cast<Uint32>(overlay.size_bytes());
 
-    for (const auto& model_tex : data.textures)
+    auto* ptr = static_cast<std::byte*>(
+        SDL_MapGPUTransferBuffer(device_, debug_transfer_buffer_, true));
+    if (ptr == nullptr)
     {
-        texture_handle tex = invalid_texture;
-
-        if (!model_tex.path.empty())
-        {
-            // Load from file
-            tex = load_texture(model_tex.path);
-        }
-        else if (!model_tex.embedded_data.empty())
-        {
-            // Load from embedded data
-            auto tex_result =
-                load_texture_from_memory(device_,
-                                         model_tex.embedded_data.data(),
-                                         model_tex.embedded_data.size(),
-                                         true);
+        return false;
+    }
+    std::memcpy(ptr, tested.data(), tested_size);
+    std::memcpy(ptr + tested_size, overlay.data(), overlay_size);
+    SDL_UnmapGPUTransferBuffer(device_, debug_transfer_buffer_);
 
-            if (tex_result)
-            {
-                const auto h = next_texture_handle_++;
-                textures_[h] = { .texture = tex_result->texture,
-                                 .sampler = tex_result->sampler,
-                                 .width   = tex_result->width,
-                                 .height  = tex_result->height };
-                tex          = h;
-                spdlog::info("=> embedded texture: {}x{} ({})",
-                             tex_result->width,
-                             tex_result->height,
-                             model_tex.mime_type.empty() ? "unknown"
-                                                         : model_tex.mime_type);
-            }
-        }
+    auto* cp = SDL_BeginGPUCopyPass(current_cmd_);
 
-        loaded_textures.push_back(tex);
-    }
+    SDL_GPUTransferBufferLocation src {};
+    src.transfer_buffer = debug_transfer_buffer_;
+    src.offset          = 0;
+    SDL_GPUBufferRegion dst {};
+    dst.buffer = debug_vertex_buffer_;
+    dst.offset = 0;
+    dst.size   = tested_size + overlay_size;
+    SDL_UploadToGPUBuffer(cp, &src, &dst, true);
+
+    SDL_EndGPUCopyPass(cp);
+    return true;
+}
+
+void Renderer::draw_debug_lines()
+{
+    if (!debug_lines_uploaded_ || current_pass_ == nullptr ||
+        current_cmd_ == nullptr)
+    {
+        return;
+    }
+
+    // Vertices are already in world space
+    const uniform_mvp uniforms { view_proj_ };
+
+    const SDL_GPUBufferBinding vb { .buffer = debug_vertex_buffer_,
+                                    .offset = 0 };
+
+    const auto tested_count = static_cast<Uint32>(
+        debug_lines_.vertices(debug_depth::tested).size());
+    const auto overlay_count = static_cast<Uint32>(
+        debug_lines_.vertices(debug_depth::overlay).size());
+
+    const auto draw_lines = [&](SDL_GPUGraphicsPipeline* pipeline,
+                                Uint32                   count,
+                                Uint32                   first)
+    {
+        if (pipeline == nullptr || count == 0)
+        {
+            return;
+        }
+        SDL_BindGPUGraphicsPipeline(current_pass_, pipeline);
+        SDL_PushGPUVertexUniformData(
+            current_cmd_, 0, &uniforms, sizeof(uniforms));
+        SDL_BindGPUVertexBuffers(current_pass_, 0, &vb, 1);
+        SDL_DrawGPUPrimitives(current_pass_, count, 1, first, 0);
+
+        ++frame_stats_.draw_calls;
+        ++frame_stats_.pipeline_binds;
+        ++frame_stats_.buffer_binds;
+        frame_stats_.vertices += count;
+    };
+
+    draw_lines(wireframe_pipeline_, tested_count, 0);
+
+    // Overlay lines go last: their pipeline has no depth test
+    draw_lines(wireframe_bounds_pipeline_ != nullptr
+                   ? wireframe_bounds_pipeline_
+                   : wireframe_pipeline_,
+               overlay_count,
+               tested_count);
+}
+
+void Renderer::flush_draw_queue()
+{
+    [[maybe_unused]] auto profiler_zone =
+        profiler_zone_begin(profiler_, "Renderer::flush_draw_queue");
+
+    if ((current_pass_ == nullptr) || (current_cmd_ == nullptr))
+    {
+        draw_queue_.clear();
+        draw_items_.clear();
+        draw_batches_.clear();
+        return;
+    }
+
+    // Last bound state; anything unchanged between batches is skipped
+    SDL_GPUGraphicsPipeline* bound_pipeline = nullptr;
+    texture_handle           bound_texture  = invalid_texture;
+    SDL_GPUBuffer*           bound_vb       = nullptr;
+    SDL_GPUBuffer*           bound_ib       = nullptr;
+    SDL_GPUIndexElementSize  bound_index_size = SDL_GPU_INDEXELEMENTSIZE_16BIT;
+    std::uint32_t            pushed_matrix    = UINT32_MAX;
+    std::uint32_t            pushed_material  = UINT32_MAX;
+
+    for (const auto& batch : draw_batches_)
+    {
+        const auto& item      = draw_items_[batch.item];
+        const bool  instanced = batch.instance_count > 1;
+        auto*       pipeline  = instanced
+                                    ? instanced_pipeline_for(item.pipeline)
+                                    : pipeline_for(item.pipeline);
+        if (pipeline == nullptr)
+        {
+            continue;
+        }
+
+        if (pipeline != bound_pipeline)
+        {
+            SDL_BindGPUGraphicsPipeline(current_pass_, pipeline);
+            bound_pipeline = pipeline;
+            ++frame_stats_.pipeline_binds;
+
+            // Resource layouts may differ between pipelines: rebind uniforms
+            // and samplers for the first draw that uses the new pipeline
+            pushed_matrix = UINT32_MAX;
+            bound_texture = invalid_texture;
+
+            if (instanced)
+            {
+                SDL_BindGPUVertexStorageBuffers(
+                    current_pass_, 0, &instance_buffer_, 1);
+            }
+            if (uses_materials(item.pipeline))
+            {
+                SDL_BindGPUFragmentStorageBuffers(
+                    current_pass_, 0, &material_buffer_, 1);
+            }
+        }
+        else
+        {
+            ++frame_stats_.pipeline_binds_saved;
+        }
+
+        if (instanced)
+        {
+            // Every batch owns a distinct range of the instance buffer
+            const uniform_instancing uniforms {
+                .base_instance = batch.base_instance,
+                .material      = item.material,
+            };
+            SDL_PushGPUVertexUniformData(
+                current_cmd_, 0, &uniforms, sizeof(uniforms));
+        }
+        else if (item.matrix != pushed_matrix ||
+                 item.material != pushed_material)
+        {
+            // Material parameters live in the table; only the index rides
+            // along with the matrix
+            const uniform_mvp uniforms {
+                .mvp      = frame_matrices_[item.matrix],
+                .material = item.material,
+            };
+            SDL_PushGPUVertexUniformData(
+                current_cmd_, 0, &uniforms, sizeof(uniforms));
+            pushed_matrix   = item.matrix;
+            pushed_material = item.material;
+        }
+
+        if (item.texture != invalid_texture)
+        {
+            if (item.texture != bound_texture)
+            {
+                const auto* tex = textures_.find(item.texture);
+                if (tex == nullptr)
+                {
+                    tex = textures_.find(default_texture_);
+                }
+                auto* sampler =
+                    tex != nullptr ? sampler_for(*tex) : nullptr;
+                if (sampler == nullptr)
+                {
+                    continue;
+                }
+
+                SDL_GPUTextureSamplerBinding tsb {};
+                tsb.texture = tex->texture;
+                tsb.sampler = sampler;
+                SDL_BindGPUFragmentSamplers(current_pass_, 0, &tsb, 1);
+                bound_texture = item.texture;
+                ++frame_stats_.texture_binds;
+            }
+            else
+            {
+                ++frame_stats_.texture_binds_saved;
+            }
+        }
+
+        if (item.vertex_buffer != bound_vb)
+        {
+            SDL_GPUBufferBinding vb {};
+            vb.buffer = item.vertex_buffer;
+            vb.offset = 0;
+            SDL_BindGPUVertexBuffers(current_pass_, 0, &vb, 1);
+            bound_vb = item.vertex_buffer;
+            ++frame_stats_.buffer_binds;
+        }
+        else
+        {
+            ++frame_stats_.buffer_binds_saved;
+        }
+
+        // One index buffer holds both widths, rebind when the width changes
+        if (item.index_buffer != bound_ib ||
+            item.index_size != bound_index_size)
+        {
+            SDL_GPUBufferBinding ib {};
+            ib.buffer = item.index_buffer;
+            ib.offset = 0;
+            SDL_BindGPUIndexBuffer(current_pass_, &ib, item.index_size);
+            bound_ib         = item.index_buffer;
+            bound_index_size = item.index_size;
+            ++frame_stats_.buffer_binds;
+        }
+        else
+        {
+            ++frame_stats_.buffer_binds_saved;
+        }
+
+        SDL_DrawGPUIndexedPrimitives(current_pass_,
+                                     item.index_count,
+                                     batch.instance_count,
+                                     item.first_index,
+                                     item.vertex_offset,
+                                     0);
+
+        ++frame_stats_.draw_calls;
+        frame_stats_.vertices += item.vertex_count * batch.instance_count;
+        if (item.triangles)
+        {
+            frame_stats_.triangles +=
+                (item.index_count / 3) * batch.instance_count;
+        }
+        if (instanced)
+        {
+            ++frame_stats_.instanced_draws;
+            frame_stats_.instances += batch.instance_count;
+        }
+    }
+
+    draw_queue_.clear();
+    draw_items_.clear();
+    draw_batches_.clear();
+}
+
+void Renderer::draw(mesh_handle h)
+{
+    [[maybe_unused]] auto profiler_zone =
+        profiler_zone_begin(profiler_, "Renderer::draw");
+
+    const auto* found = meshes_.find(h);
+    if (found == nullptr)
+    {
+        return;
+    }
+
+    const auto& mesh = *found;
+    if (mesh.range.index_count == 0)
+    {
+        return; // Upload failed
+    }
+    if (view_proj_matrix_ == UINT32_MAX)
+    {
+        view_proj_matrix_ = push_frame_matrix(view_proj_);
+    }
+
+    // Select pipeline based on primitive type
+    const auto slot = (mesh.type == primitive_type::triangles)
+                          ? pipeline_slot::wireframe_tri
+                          : pipeline_slot::wireframe;
+
+    queue_draw(
+        draw_item {
+            .pipeline      = slot,
+            .vertex_buffer = wireframe_arena_.vertex_buffer(),
+            .index_buffer  = wireframe_arena_.index_buffer(),
+            .index_count   = mesh.range.index_count,
+            .vertex_count  = mesh.range.vertex_count,
+            .first_index   = mesh.range.first_index,
+            .vertex_offset = static_cast<Sint32>(mesh.range.first_vertex),
+            .index_size    = mesh.range.index_size,
+            .matrix        = view_proj_matrix_,
+        },
+        sort_key::make(sort_key::layer::world,
+                       static_cast<std::uint32_t>(slot),
+                       0,
+                       mesh.id,
+                       0));
+}
+
+std::filesystem::path Renderer::find_texture_for_model(
+    const std::filesystem::path& model_path)
+{
+    const auto dir  = model_path.parent_path();
+    const auto stem = model_path.stem();
+
+    // First try matching texture with same name
+    for (const auto& ext : k_texture_extensions)
+    {
+        auto tex_path = dir / (stem.string() + ext);
+        if (std::filesystem::exists(tex_path))
+        {
+            return tex_path;
+        }
+    }
+
+    // Fall back to first texture file in directory
+    for (const auto& entry : std::filesystem::directory_iterator(dir))
+    {
+        if (!entry.is_regular_file())
+        {
+            continue;
+        }
+
+        const auto ext        = entry.path().extension().string();
+        const bool is_texture = std::ranges::any_of(
+            k_texture_extensions, [&ext](const char* e) { return ext == e; });
+        if (is_texture)
+        {
+            return entry.path();
+        }
+    }
+
+    return {};
+}
+
+texture_handle Renderer::load_texture(const std::filesystem::path& path)
+{
+    auto result = egen::load_texture(device_, staging_, path, true);
+    if (!result)
+    {
+        spdlog::error("== texture {}: {}", path.string(), result.error());
+        return invalid_texture;
+    }
+
+    const auto h = textures_.insert({ .texture    = result->texture,
+                                      .sampler    = result->sampler,
+                                      .width      = result->width,
+                                      .height     = result->height,
+                                      .mip_levels = result->mip_levels });
+
+    // Submitted now, like a model's uploads, rather than with the frame
+    staging_.flush();
+
+    spdlog::info("=> texture: {} ({}x{}, {} mips)",
+                 path.filename().string(),
+                 result->width,
+                 result->height,
+                 result->mip_levels);
+    return h;
+}
+
+void Renderer::unload_texture(texture_handle h)
+{
+    if (h == default_texture_)
+    {
+        return;
+    }
+
+    if (const auto* tex = textures_.find(h))
+    {
+        if (tex->texture != nullptr)
+        {
+            // Uploads still queued would copy into the released texture
+            staging_.discard_texture(tex->texture);
+            SDL_ReleaseGPUTexture(device_, tex->texture);
+        }
+        textures_.erase(h);
+        streamer_.remove(h);
+    }
+}
+
+std::expected<prepared_model, std::string> Renderer::prepare_model(
+    const std::filesystem::path& path,
+    const load_options&          options,
+    const std::array<bool, 4>&   codecs,
+    const parallel_range_fn&     parallel,
+    const std::atomic<bool>*     cancelled)
+{
+    const auto is_cancelled = [cancelled]
+    {
+        return cancelled != nullptr &&
+               cancelled->load(std::memory_order_relaxed);
+    };
+    if (is_cancelled())
+    {
+        return std::unexpected("cancelled");
+    }
+
+    // Loaders keep no state between calls, so one serves every thread
+    static model_system loader;
+    auto                result = loader.load(path, options);
+    if (!result)
+    {
+        return std::unexpected(result.error());
+    }
+
+    prepared_model prepared { .data = std::move(*result) };
+    const auto&    data = prepared.data;
+
+    // Decode everything first, so textures of one size can be grouped
+    const auto start = std::chrono::steady_clock::now();
+    prepared.images.resize(data.textures.size());
+    for (std::size_t i = 0; i < data.textures.size(); ++i)
+    {
+        if (is_cancelled())
+        {
+            return std::unexpected("cancelled");
+        }
+
+        const auto& model_tex = data.textures[i];
+        if (model_tex.path.empty() && model_tex.embedded_data.empty())
+        {
+            continue;
+        }
+        // Textures whose codec the device cannot sample stay RGBA8
+        auto codec = codec_for(model_tex.type);
+        if (!options.compress_textures ||
+            !codecs[static_cast<std::size_t>(codec)])
+        {
+            codec = texture_codec::none;
+        }
+
+        auto cache = cache_outcome::unused;
+        auto image = load_model_image(
+            model_tex, codec, options, parallel, cancelled, cache);
+        if (is_cancelled())
+        {
+            return std::unexpected("cancelled");
+        }
+        if (image && image->codec != texture_codec::none)
+        {
+            ++prepared.compressed;
+            prepared.cache_hits += cache == cache_outcome::hit ? 1 : 0;
+        }
+        prepared.cache_fails += cache == cache_outcome::write_failed ? 1 : 0;
+        if (!image)
+        {
+            spdlog::error("== texture {}: {}",
+                          model_tex.path.empty() ? "(embedded)"
+                                                 : model_tex.path.string(),
+                          image.error());
+            continue;
+        }
+        prepared.images[i] = std::move(*image);
+    }
+
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    prepared.decode_ms = elapsed.count();
+
+    // Once per load; a read-only cache directory fails for every texture
+    if (prepared.cache_fails > 0)
+    {
+        spdlog::warn("=> texture cache: cannot write {} textures to {}",
+                     prepared.cache_fails,
+                     options.texture_cache.string());
+    }
+    return prepared;
+}
+
+std::vector<texture_ref> Renderer::create_model_textures(
+    prepared_model& prepared, std::vector<texture_handle>& owned)
+{
+    const auto& data   = prepared.data;
+    auto&       images = prepared.images;
+
+    std::vector<texture_ref> refs(data.textures.size());
+
+    // Textures that carry their levels stream: they are created from a
+    // small tail and registered with the streamer once everything exists
+    std::vector<std::pair<texture_handle, std::vector<std::size_t>>>
+               streamed;
+    const auto first_level = [this](const image_data& image)
+    {
+        return load_options_.stream_textures &&
+                       image.codec != texture_codec::none
+                   ? texture_streamer::tail_level(image)
+                   : 0u;
+    };
+
+    // Small textures sorted by size; every run of two or more of one size
+    // becomes a texture array
+    std::uint32_t packed_arrays = 0;
+    std::uint32_t packed_layers = 0;
+    if (load_options_.pack_textures)
+    {
+        // Layers of one array share a size and a codec
+        const auto size_of = [&](std::size_t i)
+        {
+            return std::tuple(
+                images[i].width, images[i].height, images[i].codec);
+        };
+
+        std::vector<std::size_t> order;
+        for (std::size_t i = 0; i < images.size(); ++i)
+        {
+            const auto largest = static_cast<std::uint32_t>(
+                std::max(images[i].width, images[i].height));
+            if (!images[i].pixels.empty() &&
+                largest <= load_options_.pack_texture_size)
+            {
+                order.push_back(i);
+            }
+        }
+        std::ranges::stable_sort(order, {}, size_of);
+
+        std::vector<const image_data*> layers;
+        for (std::size_t begin = 0; begin < order.size();)
+        {
+            auto end = begin + 1;
+            while (end < order.size() &&
+                   end - begin < k_max_texture_array_layers &&
+                   size_of(order[end]) == size_of(order[begin]))
+            {
+                ++end;
+            }
+
+            if (end - begin > 1)
+            {
+                layers.clear();
+                for (auto k = begin; k < end; ++k)
+                {
+                    layers.push_back(&images[order[k]]);
+                }
+                const auto& image = *layers.front();
+                const auto  level = first_level(image);
+                if (auto tex = create_texture_array(
+                        device_, staging_, layers, level))
+                {
+                    const auto h =
+                        textures_.insert({ .texture     = tex->texture,
+                                           .sampler     = tex->sampler,
+                                           .width       = image.width,
+                                           .height      = image.height,
+                                           .mip_levels  = tex->mip_levels,
+                                           .layers      = tex->layers,
+                                           .first_level = level });
+                    owned.push_back(h);
+                    if (level > 0)
+                    {
+                        streamed.emplace_back(
+                            h,
+                            std::vector(order.begin() +
+                                            static_cast<std::ptrdiff_t>(begin),
+                                        order.begin() +
+                                            static_cast<std::ptrdiff_t>(end)));
+                    }
+                    for (auto k = begin; k < end; ++k)
+                    {
+                        refs[order[k]] = {
+                            .texture = h,
+                            .layer   = static_cast<std::uint32_t>(k - begin),
+                        };
+                    }
+                    ++packed_arrays;
+                    packed_layers += tex->layers;
+                }
+                else
+                {
+                    spdlog::warn("=> texture array: {}", tex.error());
+                }
+            }
+            begin = end;
+        }
+    }
+
+    // Everything else becomes a texture of its own
+    std::size_t decoded = 0;
+    for (std::size_t i = 0; i < images.size(); ++i)
+    {
+        if (images[i].pixels.empty())
+        {
+            continue;
+        }
+        ++decoded;
+        if (refs[i].texture != invalid_texture)
+        {
+            continue;
+        }
+
+        const image_data* layer = &images[i];
+        const auto        level = first_level(images[i]);
+        auto              tex   = create_texture_array(
+            device_, staging_, { &layer, 1 }, level);
+        if (!tex)
+        {
+            spdlog::error("== texture {}: {}", i, tex.error());
+            continue;
+        }
+        refs[i].texture = textures_.insert({ .texture     = tex->texture,
+                                             .sampler     = tex->sampler,
+                                             .width       = images[i].width,
+                                             .height      = images[i].height,
+                                             .mip_levels  = tex->mip_levels,
+                                             .layers      = 1,
+                                             .first_level = level });
+        owned.push_back(refs[i].texture);
+        if (level > 0)
+        {
+            streamed.emplace_back(refs[i].texture,
+                                  std::vector<std::size_t> { i });
+        }
+    }
+
+    // The streamer keeps every level to upload finer ones on demand
+    const auto tails_before = streamer_.resident_bytes();
+    for (auto& [h, indices] : streamed)
+    {
+        std::vector<image_data> layers;
+        layers.reserve(indices.size());
+        for (const auto i : indices)
+        {
+            layers.push_back(std::move(images[i]));
+        }
+        streamer_.add(h, std::move(layers));
+    }
+
+    if (!streamed.empty())
+    {
+        spdlog::info("=> texture streaming: {} textures start from {} KB "
+                     "of coarse levels",
+                     streamed.size(),
+                     (streamer_.resident_bytes() - tails_before) / 1024);
+    }
+    if (prepared.compressed > 0)
+    {
+        spdlog::info("=> compressed textures: {} ({} from cache, {} encoded) "
+                     "in {:.1f} ms",
+                     prepared.compressed,
+                     prepared.cache_hits,
+                     prepared.compressed - prepared.cache_hits,
+                     prepared.decode_ms);
+    }
+    if (packed_arrays > 0)
+    {
+        spdlog::info("=> texture arrays: {} of {} textures in {} arrays, "
+                     "{} texture objects instead of {}",
+                     packed_layers,
+                     decoded,
+                     packed_arrays,
+                     owned.size(),
+                     decoded);
+    }
+    return refs;
+}
+
+std::expected<image_data, std::string> Renderer::load_model_image(
+    const model_texture&     tex,
+    texture_codec            codec,
+    const load_options&      options,
+    const parallel_range_fn& parallel,
+    const std::atomic<bool>* cancelled,
+    cache_outcome&           cache)
+{
+    cache = cache_outcome::unused;
+
+    // The cache is keyed by the encoded source, so a hit skips decoding too
+    std::vector<std::byte>     file_bytes;
+    std::span<const std::byte> source =
+        std::as_bytes(std::span { tex.embedded_data });
+    if (!tex.path.empty())
+    {
+        file_bytes = read_file_bytes(tex.path);
+        if (file_bytes.empty())
+        {
+            return std::unexpected("cannot read " + tex.path.string());
+        }
+        source = file_bytes;
+    }
+
+    const auto& cache_dir = options.texture_cache;
+    const auto  key       = texture_cache_key(source, codec);
+    if (codec != texture_codec::none && !cache_dir.empty())
+    {
+        if (auto image = read_cached_texture(cache_dir, key))
+        {
+            cache = cache_outcome::hit;
+            return std::move(*image);
+        }
+    }
+
+    auto image = decode_image_from_memory(source.data(), source.size());
+    if (!image || codec == texture_codec::none)
+    {
+        return image;
+    }
+    if (image->width % 4 != 0 || image->height % 4 != 0)
+    {
+        // Block formats need whole blocks at the top level
+        return image;
+    }
+
+    image_data result { .pixels = compress_mip_chain(codec,
+                                                     image->pixels,
+                                                     image->width,
+                                                     image->height,
+                                                     parallel),
+                        .width  = image->width,
+                        .height = image->height,
+                        .codec  = codec,
+                        .levels = mip_count(image->width, image->height) };
+    if (cancelled != nullptr && cancelled->load(std::memory_order_relaxed))
+    {
+        return std::unexpected("cancelled"); // Levels may be missing
+    }
+    if (!cache_dir.empty())
+    {
+        cache = write_cached_texture(cache_dir, key, result)
+                    ? cache_outcome::stored
+                    : cache_outcome::write_failed;
+    }
+    return result;
+}
+
+gpu_model Renderer::upload_loaded_model(
+    const loaded_model&          data,
+    std::span<const texture_ref> textures,
+    texture_ref                  fallback,
+    const glm::vec3&             color)
+{
+    gpu_model model {};
+    model.color            = color;
+    model.has_uvs          = data.has_uvs;
+    model.model_bounds.min = data.bounds.min;
+    model.model_bounds.max = data.bounds.max;
+
+    const float model_radius = glm::length(data.bounds.extents());
+
+    // Quantize positions to the bounds of every mesh, so one matrix per
+    // model dequantizes them
+    aabb quantized;
+    for (const auto& src_mesh : data.meshes)
+    {
+        quantized.expand(src_mesh.bounds.min);
+        quantized.expand(src_mesh.bounds.max);
+    }
+    model.packed = load_options_.quantize_vertices &&
+                   textured_packed_pipeline_ != nullptr &&
+                   quantized.valid() && fits_packed_format(data);
+
+    const glm::vec3 extent = model.packed ? quantized.max - quantized.min
+                                          : glm::vec3(0.0f);
+    glm::vec3       inv_extent {};
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        inv_extent[axis] = extent[axis] > 0.0f ? 1.0f / extent[axis] : 0.0f;
+    }
+    if (model.packed)
+    {
+        model.dequantize = glm::scale(
+            glm::translate(glm::mat4(1.0f), quantized.min), extent);
+    }
+    auto& arena = model.packed ? packed_arena_ : textured_arena_;
+
+    // Base texture of every material; the last entry is for meshes
+    // without a material
+    const auto               no_material = data.materials.size();
+    std::vector<texture_ref> material_textures(no_material + 1, fallback);
+    for (std::size_t k = 0; k < no_material; ++k)
+    {
+        const auto index = data.materials[k].base_color_texture_index;
+        if (index < textures.size() &&
+            textures[index].texture != invalid_texture)
+        {
+            material_textures[k] = textures[index];
+        }
+    }
+
+    // One table entry per material, so meshes sharing a material are
+    // sorted and bound together. Entries are allocated in texture order,
+    // which keeps the layers of one array next to each other.
+    std::vector<std::size_t> order(material_textures.size());
+    std::iota(order.begin(), order.end(), std::size_t { 0 });
+    std::ranges::stable_sort(order,
+                             {},
+                             [&](std::size_t k)
+                             {
+                                 return std::pair(material_textures[k].texture,
+                                                  material_textures[k].layer);
+                             });
+    model.materials.resize(material_textures.size());
+    for (const auto k : order)
+    {
+        auto material  = (k < no_material) ? to_gpu_material(data.materials[k])
+                                            : gpu_material {};
+        material.layer = material_textures[k].layer;
+        model.materials[k] = add_material(material);
+    }
+
+    // Upload each mesh to GPU; empty meshes are skipped, so instances are
+    // remapped to the uploaded ones
+    constexpr auto             k_skipped = UINT32_MAX;
+    std::vector<std::uint32_t> uploaded(data.meshes.size(), k_skipped);
+    std::vector<vertex_textured>        verts;
+    std::vector<vertex_textured_packed> packed_verts;
+    std::vector<std::uint32_t>          occluder_remap;
+    for (std::size_t m = 0; m < data.meshes.size(); ++m)
+    {
+        const auto& src_mesh = data.meshes[m];
+        verts.clear();
+        packed_verts.clear();
+        if (model.packed)
+        {
+            packed_verts.reserve(src_mesh.vertices.size());
+            for (const auto& v : src_mesh.vertices)
+            {
+                packed_verts.push_back(
+                    pack_vertex(v, quantized.min, inv_extent));
+            }
+        }
+        else
+        {
+            verts.reserve(src_mesh.vertices.size());
+            for (const auto& v : src_mesh.vertices)
+            {
+                verts.push_back(vertex_textured {
+                    .position = v.position,
+                    .normal   = v.normal,
+                    .texcoord = v.texcoord,
+                });
+            }
+        }
+
+        if (!src_mesh.vertices.empty() && !src_mesh.indices.empty())
+        {
+            auto gpu_mesh = upload_textured_mesh(
+                arena,
+                model.packed ? std::as_bytes(std::span(packed_verts))
+                             : std::as_bytes(std::span(verts)),
+                static_cast<Uint32>(src_mesh.vertices.size()),
+                src_mesh.indices,
+                src_mesh.required_index_format());
+            gpu_mesh.mesh_bounds.min = src_mesh.bounds.min;
+            gpu_mesh.mesh_bounds.max = src_mesh.bounds.max;
+
+            // Level ranges are relative to the mesh's first index
+            gpu_mesh.lods[0].index_count = gpu_mesh.range.index_count;
+            if (!src_mesh.lods.empty() && gpu_mesh.range.index_count != 0)
+            {
+                std::ranges::copy(src_mesh.lods, gpu_mesh.lods.begin());
+                gpu_mesh.lod_count =
+                    static_cast<std::uint8_t>(src_mesh.lods.size());
+            }
+
+            model.lod_count = std::max(model.lod_count, gpu_mesh.lod_count);
+
+            // Alpha mode picks the pipeline, the rest of the material is
+            // read from the table
+            const auto k = std::min(src_mesh.material_index, no_material);
+            if (k < no_material)
+            {
+                gpu_mesh.alpha = data.materials[k].alpha;
+            }
+            gpu_mesh.material = model.materials[k];
+            gpu_mesh.texture  = material_textures[k].texture;
+
+            uploaded[m] = static_cast<std::uint32_t>(model.meshes.size());
+            model.meshes.push_back(std::move(gpu_mesh));
+        }
+    }
+
+    const auto add_instance = [&](std::size_t src, const glm::mat4& transform)
+    {
+        if (src >= uploaded.size() || uploaded[src] == k_skipped)
+        {
+            return;
+        }
+        const auto& mesh   = model.meshes[uploaded[src]];
+        const auto  placed = data.meshes[src].bounds.transformed(transform);
+        model.instances.push_back({
+            .transform = transform,
+            .center    = placed.center(),
+            .mesh      = uploaded[src],
+            .placed    = transform != glm::mat4(1.0f),
+        });
+        model.mesh_bounds.push_back(placed.center(), placed.extents());
+
+        // Mesh errors are relative to the mesh's own radius, as placed
+        const float scale =
+            model_radius > 0.0f
+                ? glm::length(placed.extents()) / model_radius
+                : 0.0f;
+        for (std::size_t l = 0; l < k_max_mesh_lods; ++l)
+        {
+            const auto& lod =
+                mesh.lods[std::min<std::size_t>(l, mesh.lod_count - 1u)];
+            model.lod_errors[l] =
+                std::max(model.lod_errors[l], lod.error * scale);
+        }
+
+        // Occluder geometry from the coarsest level still close to the
+        // surface, keeping only the vertices it references. Cut-out and
+        // see-through meshes do not hide what is behind them.
+        if (mesh.alpha != alpha_mode::opaque)
+        {
+            return;
+        }
+        const auto& src_mesh = data.meshes[src];
+        std::size_t first    = 0;
+        std::size_t count    = src_mesh.indices.size();
+        for (const auto& lod : src_mesh.lods)
+        {
+            if (lod.error <= k_occluder_lod_error)
+            {
+                first = lod.first_index;
+                count = lod.index_count;
+            }
+        }
+        occluder_remap.assign(src_mesh.vertices.size(), k_skipped);
+        const auto tris = std::span(src_mesh.indices).subspan(first, count);
+        for (std::size_t t = 0; t + 2 < tris.size(); t += 3)
+        {
+            if (tris[t] >= occluder_remap.size() ||
+                tris[t + 1] >= occluder_remap.size() ||
+                tris[t + 2] >= occluder_remap.size())
+            {
+                continue;
+            }
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                auto& index = occluder_remap[tris[t + k]];
+                if (index == k_skipped)
+                {
+                    index = static_cast<std::uint32_t>(
+                        model.occluder_positions.size());
+                    model.occluder_positions.emplace_back(
+                        transform *
+                        glm::vec4(src_mesh.vertices[tris[t + k]].position,
+                                  1.0f));
+                }
+                model.occluder_indices.push_back(index);
+            }
+        }
+    };
+    if (data.instances.empty())
+    {
+        for (std::size_t m = 0; m < data.meshes.size(); ++m)
+        {
+            add_instance(m, glm::mat4(1.0f));
+        }
+    }
+    for (const auto& instance : data.instances)
+    {
+        add_instance(instance.mesh, instance.transform);
+    }
+
+    return model;
+}
+
+parallel_range_fn Renderer::encode_parallel()
+{
+    return [this](std::size_t                                          count,
+                  const std::function<void(std::size_t, std::size_t)>& fn)
+    {
+        jobs_.parallel_for(
+            count,
+            k_texture_encode_batch,
+            [&](std::size_t, std::size_t first, std::size_t last)
+            { fn(first, last); });
+    };
+}
+
+std::expected<gpu_model, std::string> Renderer::finish_model(
+    const prepared_model&        prepared,
+    const std::filesystem::path& path,
+    const glm::vec3&             color,
+    std::span<const texture_ref> textures,
+    std::vector<texture_handle>  owned)
+{
+    const auto& data = prepared.data;
 
     // Fallback: try to find texture by name if no textures were loaded
-    texture_handle primary_tex = invalid_texture;
-    if (loaded_textures.empty() ||
-        (loaded_textures.size() == 1 && loaded_textures[0] == invalid_texture))
+    texture_ref primary;
+    if (const auto it = std::ranges::find_if(textures,
+                                             [](const texture_ref& t)
+                                             {
+                                                 return t.texture !=
+                                                        invalid_texture;
+                                             });
+        it != textures.end())
+    {
+        primary = *it;
+    }
+    else
+    {
+        if (!data.texture_path.empty())
+        {
+            primary.texture = load_texture(data.texture_path);
+        }
+        if (primary.texture == invalid_texture)
+        {
+            if (auto tex_path = find_texture_for_model(path); !tex_path.empty())
+            {
+                primary.texture = load_texture(tex_path);
+            }
+        }
+    }
+
+    // Upload to GPU; meshes without a texture of their own use the primary
+    const texture_ref fallback =
+        (primary.texture != invalid_texture)
+            ? primary
+            : texture_ref { .texture = default_texture_ };
+    gpu_model model = upload_loaded_model(data, textures, fallback, color);
+    model.texture   = primary.texture;  // Legacy: primary texture
+    model.textures  = std::move(owned); // Store all textures
+
+    // Textures, materials and meshes of the model go to the GPU as one
+    // submission
+    if (!upload_materials())
+    {
+        spdlog::warn("=> model {}: material table not updated",
+                     path.string());
+    }
+    staging_.flush();
+
+    if (model.meshes.empty())
     {
-        if (!data.texture_path.empty())
+        free_materials_.insert(free_materials_.end(),
+                               model.materials.begin(),
+                               model.materials.end());
+        for (auto tex : model.textures)
         {
-            primary_tex = load_texture(data.texture_path);
+            unload_texture(tex);
         }
-        if (primary_tex == invalid_texture)
+        if (std::ranges::find(model.textures, model.texture) ==
+            model.textures.end())
         {
-            if (auto tex_path = find_texture_for_model(path); !tex_path.empty())
-            {
-                primary_tex = load_texture(tex_path);
-            }
+            unload_texture(model.texture);
         }
+        return std::unexpected("no meshes uploaded");
     }
-    else
+
+    // Determine loader type for logging
+    auto ext = path.extension().string();
+    std::ranges::transform(ext, ext.begin(), ::tolower);
+    const char* type = (ext == ".gltf" || ext == ".glb") ? "gltf" : "obj";
+
+    spdlog::info("=> model ({}): {} ({} meshes, {} verts, {} B/vertex)",
+                 type,
+                 path.filename().string(),
+                 model.meshes.size(),
+                 data.total_vertices(),
+                 model.packed ? sizeof(vertex_textured_packed)
+                              : sizeof(vertex_textured));
+    return model;
+}
+
+model_handle Renderer::load_model(const std::filesystem::path& path,
+                                  const glm::vec3&             color)
+{
+    auto prepared = prepare_model(
+        path, load_options_, codec_supported_, encode_parallel());
+    if (!prepared)
+    {
+        spdlog::error("== model {}: {}", path.string(), prepared.error());
+        return invalid_model;
+    }
+
+    std::vector<texture_handle> owned;
+    const auto textures = create_model_textures(*prepared, owned);
+
+    auto model =
+        finish_model(*prepared, path, color, textures, std::move(owned));
+    if (!model)
     {
-        // Use first valid texture as primary
-        for (auto tex : loaded_textures)
+        spdlog::error("== model {}: {}", path.string(), model.error());
+        return invalid_model;
+    }
+    return models_.insert(std::move(*model));
+}
+
+model_handle Renderer::load_model_async(const std::filesystem::path& path,
+                                        const glm::vec3&             color,
+                                        model_load_callback          on_done)
+{
+    // Draws nothing until the file has been parsed
+    gpu_model placeholder {};
+    placeholder.color = color;
+    placeholder.state = model_load_state::loading;
+
+    auto load     = std::make_shared<model_load>();
+    load->handle  = models_.insert(std::move(placeholder));
+    load->path    = path;
+    load->color   = color;
+    load->on_done = std::move(on_done);
+    loads_.push_back(load);
+
+    // The job system belongs to the render thread, so textures of a load
+    // are encoded on its loader thread alone, in slices that stop once the
+    // load is cancelled
+    loader_.submit(
+        [load, options = load_options_, codecs = codec_supported_]
         {
-            if (tex != invalid_texture)
+            const parallel_range_fn parallel =
+                [&load](std::size_t count,
+                        const std::function<void(std::size_t, std::size_t)>&
+                            fn)
             {
-                primary_tex = tex;
-                break;
-            }
-        }
+                for (std::size_t first = 0;
+                     first < count &&
+                     !load->cancelled.load(std::memory_order_relaxed);
+                     first += k_texture_encode_batch)
+                {
+                    fn(first, std::min(first + k_texture_encode_batch, count));
+                }
+            };
+            load->result = prepare_model(
+                load->path, options, codecs, parallel, &load->cancelled);
+            load->prepared.store(true, std::memory_order_release);
+        });
+    return load->handle;
+}
+
+model_load_state Renderer::get_load_state(model_handle h) const
+{
+    if (const auto* model = models_.find(h))
+    {
+        return model->state;
     }
+    return model_load_state::unknown;
+}
 
-    // Upload to GPU
-    gpu_model model = upload_loaded_model(data, color);
-    model.texture   = primary_tex; // Legacy: keep for backward compatibility
-    model.textures  = loaded_textures; // Store all textures
+void Renderer::cancel_load(model_handle h)
+{
+    const auto it = std::ranges::find(
+        loads_, h, [](const auto& load) { return load->handle; });
+    if (it == loads_.end())
+    {
+        return;
+    }
 
-    // Assign textures to meshes based on materials
-    for (std::size_t i = 0; i < model.meshes.size() && i < data.meshes.size();
-         ++i)
+    // A task still running sees the flag at its next texture and its
+    // result is dropped with the last reference to the load
+    auto& load = **it;
+    load.cancelled.store(true, std::memory_order_relaxed);
+    for (auto tex : load.owned)
     {
-        const auto& src_mesh = data.meshes[i];
-        auto&       gpu_mesh = model.meshes[i];
+        unload_texture(tex);
+    }
+    loads_.erase(it);
+    models_.erase(h);
+}
 
-        // Get texture from material
-        texture_handle mesh_tex = invalid_texture;
-        if (src_mesh.material_index < data.materials.size())
-        {
-            const auto& material = data.materials[src_mesh.material_index];
+model_load_state Renderer::advance_model_load(model_load& load)
+{
+    auto* placeholder = models_.find(load.handle);
+    if (placeholder == nullptr)
+    {
+        return model_load_state::unknown;
+    }
 
-            // Try base color texture first
-            if (material.base_color_texture_index < loaded_textures.size())
-            {
-                mesh_tex = loaded_textures[material.base_color_texture_index];
-            }
-        }
+    if (!load.result)
+    {
+        spdlog::error(
+            "== model {}: {}", load.path.string(), load.result.error());
+        placeholder->state = model_load_state::failed;
+        return model_load_state::failed;
+    }
 
-        // Fallback to primary texture or default
-        if (mesh_tex == invalid_texture)
-        {
-            mesh_tex = (primary_tex != invalid_texture) ? primary_tex
-                                                        : default_texture_;
-        }
+    auto& prepared = *load.result;
+    if (!load.textures_created)
+    {
+        // Drawn as its bounds from here on
+        placeholder->model_bounds.min = prepared.data.bounds.min;
+        placeholder->model_bounds.max = prepared.data.bounds.max;
 
-        gpu_mesh.texture = mesh_tex;
+        load.textures         = create_model_textures(prepared, load.owned);
+        load.textures_created = true;
+        return model_load_state::loading;
     }
 
-    if (model.meshes.empty())
+    auto model = finish_model(
+        prepared, load.path, load.color, load.textures, std::move(load.owned));
+    load.owned.clear();
+    if (!model)
     {
-        spdlog::error("== model {}: no meshes uploaded", path.string());
-        return invalid_model;
+        spdlog::error("== model {}: {}", load.path.string(), model.error());
+        placeholder->state = model_load_state::failed;
+        return model_load_state::failed;
     }
+    model->occluder = placeholder->occluder;
+    *placeholder    = std::move(*model);
+    return model_load_state::ready;
+}
 
-    const auto h = next_model_handle_++;
-    models_[h]   = std::move(model);
+void Renderer::drain_model_loads()
+{
+    if (loads_.empty())
+    {
+        return;
+    }
+    [[maybe_unused]] auto profiler_zone =
+        profiler_zone_begin(profiler_, "Renderer::drain_model_loads");
 
-    // Determine loader type for logging
-    auto ext = path.extension().string();
-    std::ranges::transform(ext, ext.begin(), ::tolower);
-    const char* type = (ext == ".gltf" || ext == ".glb") ? "gltf" : "obj";
+    // At least one step per frame, however long it takes
+    const auto start   = std::chrono::steady_clock::now();
+    bool       stepped = false;
+    const auto in_budget = [&]
+    {
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        return !stepped || elapsed.count() < k_model_upload_budget_ms;
+    };
 
-    spdlog::info("=> model ({}): {} ({} meshes, {} verts)",
-                 type,
-                 path.filename().string(),
-                 models_[h].meshes.size(),
-                 data.total_vertices());
-    return h;
+    // Callbacks may load, cancel or unload models, so they run once the
+    // list is no longer walked
+    std::vector<std::pair<std::shared_ptr<model_load>, model_load_state>>
+        settled;
+    for (std::size_t i = 0; i < loads_.size() && in_budget();)
+    {
+        auto& load = loads_[i];
+        if (!load->prepared.load(std::memory_order_acquire))
+        {
+            ++i;
+            continue;
+        }
+
+        stepped          = true;
+        const auto state = advance_model_load(*load);
+        if (state == model_load_state::loading)
+        {
+            continue; // Next phase of the same load, if time is left
+        }
+        settled.emplace_back(std::move(load), state);
+        loads_.erase(loads_.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+
+    for (const auto& [load, state] : settled)
+    {
+        if (load->on_done && state != model_load_state::unknown)
+        {
+            load->on_done(load->handle, state);
+        }
+    }
 }
 
 void Renderer::unload_model(model_handle h)
 {
-    if (auto it = models_.find(h); it != models_.end())
+    if (const auto* model = models_.find(h);
+        model != nullptr && model->state == model_load_state::loading)
+    {
+        cancel_load(h);
+        return;
+    }
+    if (const auto* model = models_.find(h))
     {
-        for (auto& m : it->second.meshes)
+        auto& arena = model->packed ? packed_arena_ : textured_arena_;
+        for (const auto& m : model->meshes)
         {
-            if (m.vertex_buffer != nullptr)
-            {
-                SDL_ReleaseGPUBuffer(device_, m.vertex_buffer);
-            }
-            if (m.index_buffer != nullptr)
-            {
-                SDL_ReleaseGPUBuffer(device_, m.index_buffer);
-            }
+            arena.free(m.range);
         }
+        free_materials_.insert(free_materials_.end(),
+                               model->materials.begin(),
+                               model->materials.end());
         // Unload all textures used by this model
-        for (auto tex : it->second.textures)
+        for (auto tex : model->textures)
         {
             if (tex != invalid_texture && tex != default_texture_)
             {
@@ -1520,232 +3457,539 @@ void Renderer::unload_model(model_handle h)
             }
         }
         // Also unload legacy primary texture if different
-        if (it->second.texture != invalid_texture &&
-            it->second.texture != default_texture_ &&
-            std::find(it->second.textures.begin(),
-                      it->second.textures.end(),
-                      it->second.texture) == it->second.textures.end())
+        if (model->texture != invalid_texture &&
+            model->texture != default_texture_ &&
+            std::find(model->textures.begin(),
+                      model->textures.end(),
+                      model->texture) == model->textures.end())
         {
-            unload_texture(it->second.texture);
+            unload_texture(model->texture);
         }
-        models_.erase(it);
+        models_.erase(h);
     }
 }
 
-void Renderer::draw_textured_mesh_internal(const gpu_textured_mesh& m,
-                                           texture_handle           tex_handle)
+void Renderer::set_profiler(i_profiler* profiler) noexcept
 {
-    [[maybe_unused]] auto profiler_zone =
-        profiler_zone_begin(profiler_, "Renderer::draw_textured_mesh");
+    profiler_ = profiler;
+    jobs_.set_profiler(profiler);
+    loader_.set_profiler(profiler);
+}
 
-    if ((current_pass_ == nullptr) || (current_cmd_ == nullptr))
+void Renderer::draw_model(model_handle h, const transform& xform)
+{
+    draw_model_instanced(h, std::span(&xform, 1));
+}
+
+void Renderer::draw_model_instanced(model_handle               h,
+                                    std::span<const transform> xforms)
+{
+    const auto* model = models_.find(h);
+    if (model == nullptr || xforms.empty())
+    {
+        return;
+    }
+    if (model->state != model_load_state::ready)
     {
+        // Still loading: its bounds, once the file has been parsed
+        if (model->state == model_load_state::loading &&
+            model->model_bounds.size() != glm::vec3(0.0f))
+        {
+            for (const auto& xform : xforms)
+            {
+                debug_lines_.obb(model->model_bounds,
+                                 model_matrix(xform),
+                                 k_loading_bounds_color,
+                                 debug_depth::tested);
+            }
+        }
         return;
     }
 
-    auto tex_it = textures_.find(tex_handle);
-    if (tex_it == textures_.end())
+    // Culling and matrix work is deferred to prepare_frame, which spreads
+    // it over the job system; identical meshes are merged into instanced
+    // draws after sorting
+    if (view_index_ == UINT32_MAX)
     {
-        tex_it = textures_.find(default_texture_);
+        view_index_ = static_cast<std::uint32_t>(frame_views_.size());
+        frame_views_.push_back(view_proj_);
     }
-    if (tex_it == textures_.end())
+    const auto slot = (render_mode_ == render_mode::wireframe)
+                          ? pipeline_slot::textured_wireframe
+                          : pipeline_slot::textured;
+
+    model_draws_.reserve(model_draws_.size() + xforms.size());
+    for (const auto& xform : xforms)
     {
-        return;
+        model_draws_.push_back(
+            { .model = h, .xform = xform, .view = view_index_, .slot = slot });
+    }
+}
+
+void Renderer::record_model_draws()
+{
+    [[maybe_unused]] auto profiler_zone =
+        profiler_zone_begin(profiler_, "Renderer::prepare_frame::record");
+
+    // Enough draws per batch to amortize the atomic, few enough to balance
+    constexpr std::size_t k_batch = 256;
+
+    for (auto& bucket : prep_buckets_)
+    {
+        bucket.clear();
     }
+    lod_current_.assign(model_draws_.size(), {});
+    const bool occlusion = rasterize_occluders();
+    jobs_.parallel_for(
+        model_draws_.size(),
+        k_batch,
+        [this, occlusion](std::size_t worker,
+                          std::size_t first,
+                          std::size_t last)
+        {
+            auto& bucket = prep_buckets_[worker];
+            for (std::size_t i = first; i < last; ++i)
+            {
+                const auto& draw  = model_draws_[i];
+                const auto* model = models_.find(draw.model);
+                if (model == nullptr)
+                {
+                    continue;
+                }
+                const bool same_draw = i < lod_history_.size() &&
+                                       lod_history_[i].model == draw.model;
+                lod_current_[i] = {
+                    .model = draw.model,
+                    .lod   = record_model(
+                        bucket,
+                        *model,
+                        frame_views_[draw.view] * model_matrix(draw.xform),
+                        draw.slot,
+                        same_draw ? lod_history_[i].lod : k_no_lod,
+                        occlusion && draw.view == occlusion_view_),
+                };
+            }
+        });
+
+    // Merge in worker order; the sort makes the result independent of how
+    // the batches were distributed
+    for (const auto& bucket : prep_buckets_)
+    {
+        const auto item_offset =
+            static_cast<std::uint32_t>(draw_items_.size());
+        const auto matrix_offset =
+            static_cast<std::uint32_t>(frame_matrices_.size());
 
-    SDL_GPUTextureSamplerBinding tsb {};
-    tsb.texture = tex_it->second.texture;
-    tsb.sampler = tex_it->second.sampler;
-    SDL_BindGPUFragmentSamplers(current_pass_, 0, &tsb, 1);
+        frame_matrices_.insert(frame_matrices_.end(),
+                               bucket.matrices.begin(),
+                               bucket.matrices.end());
+        for (auto item : bucket.items)
+        {
+            item.matrix += matrix_offset;
+            draw_items_.push_back(item);
+        }
+        draw_queue_.append(bucket.queue.packets(), item_offset);
 
-    SDL_GPUBufferBinding vb {};
-    vb.buffer = m.vertex_buffer;
-    vb.offset = 0;
-    SDL_BindGPUVertexBuffers(current_pass_, 0, &vb, 1);
+        frame_stats_.models_culled += bucket.models_culled;
+        frame_stats_.meshes_culled += bucket.meshes_culled;
+        frame_stats_.meshes_lod += bucket.meshes_lod;
+        frame_stats_.models_occluded += bucket.models_occluded;
+        frame_stats_.meshes_occluded += bucket.meshes_occluded;
 
-    SDL_GPUBufferBinding ib {};
-    ib.buffer = m.index_buffer;
-    ib.offset = 0;
-    SDL_BindGPUIndexBuffer(current_pass_, &ib, SDL_GPU_INDEXELEMENTSIZE_16BIT);
-    SDL_DrawGPUIndexedPrimitives(current_pass_, m.index_count, 1, 0, 0, 0);
+        for (const auto& demand : bucket.texture_demands)
+        {
+            streamer_.request(demand.texture, demand.texels);
+        }
+    }
+    std::swap(lod_history_, lod_current_);
+    stream_textures();
 
-    ++frame_stats_.draw_calls;
-    frame_stats_.triangles += m.index_count / 3;
-    frame_stats_.vertices += m.vertex_count;
+    const auto times = jobs_.worker_times();
+    frame_stats_.prep_workers =
+        static_cast<std::uint32_t>(std::ranges::count_if(
+            times, [](float t) { return t > 0.0f; }));
+    frame_stats_.prep_ms_max = std::ranges::max(times);
+    for (const float t : times)
+    {
+        frame_stats_.prep_ms_total += t;
+    }
 }
 
-void Renderer::set_profiler(i_profiler* profiler) noexcept
+void Renderer::stream_textures()
 {
-    profiler_ = profiler;
+    const auto changes =
+        streamer_.update(texture_budget_, k_stream_upload_limit);
+
+    std::vector<const image_data*> layers;
+    for (const auto& change : changes)
+    {
+        auto*      tex    = textures_.find(change.texture);
+        const auto images = streamer_.layers(change.texture);
+        if (tex == nullptr || images.empty())
+        {
+            continue;
+        }
+
+        layers.clear();
+        for (const auto& image : images)
+        {
+            layers.push_back(&image);
+        }
+        auto created =
+            create_texture_array(device_, staging_, layers, change.level);
+        if (!created)
+        {
+            spdlog::warn("=> texture streaming: {}", created.error());
+            streamer_.set_resident(change.texture, tex->first_level);
+            continue;
+        }
+
+        // Frames in flight may still sample the old texture; SDL releases
+        // it once they are done. Draws refer to the handle, so this frame
+        // already binds the new one.
+        staging_.discard_texture(tex->texture);
+        SDL_ReleaseGPUTexture(device_, tex->texture);
+        tex->texture     = created->texture;
+        tex->mip_levels  = created->mip_levels;
+        tex->first_level = change.level;
+        ++frame_stats_.textures_restreamed;
+    }
+
+    frame_stats_.textures_streamed =
+        static_cast<std::uint32_t>(streamer_.size());
+    frame_stats_.texture_resident_kb =
+        static_cast<std::uint32_t>(streamer_.resident_bytes() / 1024);
+    frame_stats_.texture_requested_kb =
+        static_cast<std::uint32_t>(streamer_.requested_bytes() / 1024);
 }
 
-void Renderer::draw_model(model_handle h, const transform& xform)
+bool Renderer::rasterize_occluders()
 {
     [[maybe_unused]] auto profiler_zone =
-        profiler_zone_begin(profiler_, "Renderer::draw_model");
+        profiler_zone_begin(profiler_, "Renderer::prepare_frame::occlusion");
 
-    auto it = models_.find(h);
-    if (it == models_.end())
+    occlusion_.clear();
+    occlusion_view_ = UINT32_MAX;
+    if (!occlusion_culling_ || depth_width_ == 0 || depth_height_ == 0)
     {
-        return;
+        return false;
     }
 
-    const auto& model = it->second;
-
-    // Build model matrix: translate -> rotate (YXZ order) -> scale
-    // Note: Removed hardcoded 180-degree rotation fix - glTF scenes should be
-    // correctly oriented
-    auto model_mat = glm::mat4(1.0f);
-    model_mat      = glm::translate(model_mat, xform.position);
-    model_mat      = glm::rotate(
-        model_mat, glm::radians(xform.rotation.y), glm::vec3(0, 1, 0));
-    model_mat = glm::rotate(
-        model_mat, glm::radians(xform.rotation.x), glm::vec3(1, 0, 0));
-    model_mat = glm::rotate(
-        model_mat, glm::radians(xform.rotation.z), glm::vec3(0, 0, 1));
-    model_mat = glm::scale(model_mat, xform.scale);
+    const auto start = std::chrono::steady_clock::now();
+    occlusion_.resize(k_occlusion_width,
+                      std::max<std::uint32_t>(
+                          1, k_occlusion_width * depth_height_ / depth_width_));
 
-    // Select pipeline based on render mode
-    auto* pipeline = (render_mode_ == render_mode::wireframe)
-                         ? textured_wireframe_pipeline_
-                         : textured_pipeline_;
-    if ((pipeline != nullptr) && (current_pass_ != nullptr))
+    // Occluders only hide draws of the view they were rasterized from; the
+    // first view with one is the scene camera in practice
+    for (const auto& draw : model_draws_)
     {
-        SDL_BindGPUGraphicsPipeline(current_pass_, pipeline);
+        const auto* model = models_.find(draw.model);
+        if (model == nullptr || !model->occluder ||
+            model->occluder_indices.empty())
+        {
+            continue;
+        }
+        if (occlusion_view_ == UINT32_MAX)
+        {
+            occlusion_view_ = draw.view;
+        }
+        if (draw.view != occlusion_view_)
+        {
+            continue;
+        }
+        const auto  mvp = frame_views_[draw.view] * model_matrix(draw.xform);
+        const auto& box = model->model_bounds;
+        if (!frustum::from_matrix(mvp).intersects(box.center(),
+                                                  box.size() * 0.5f))
+        {
+            continue; // Off screen, hides nothing
+        }
+        occlusion_.add_occluder(
+            model->occluder_positions, model->occluder_indices, mvp);
     }
-
-    const uniform_mvp uniforms { view_proj_ * model_mat };
-    SDL_PushGPUVertexUniformData(current_cmd_, 0, &uniforms, sizeof(uniforms));
-
-    // Draw each mesh with its own texture
-    for (const auto& mesh : model.meshes)
+    if (occlusion_.occluder_count() == 0)
     {
-        [[maybe_unused]] auto profiler_zone_mesh =
-            profiler_zone_begin(profiler_, "Renderer::draw_model::mesh");
-        const auto tex =
-            (mesh.texture != invalid_texture)
-                ? mesh.texture
-                : ((model.texture != invalid_texture) ? model.texture
-                                                      : default_texture_);
-        draw_textured_mesh_internal(mesh, tex);
+        return false;
     }
+
+    jobs_.parallel_for(occlusion_.occluder_count(),
+                       1,
+                       [this](std::size_t, std::size_t first, std::size_t last)
+                       {
+                           for (auto i = first; i < last; ++i)
+                           {
+                               occlusion_.setup_occluder(i);
+                           }
+                       });
+    jobs_.parallel_for(occlusion_.band_count(),
+                       1,
+                       [this](std::size_t, std::size_t first, std::size_t last)
+                       {
+                           for (auto b = first; b < last; ++b)
+                           {
+                               occlusion_.rasterize_band(b);
+                           }
+                       });
+
+    frame_stats_.occluders =
+        static_cast<std::uint32_t>(occlusion_.occluder_count());
+    frame_stats_.occluder_triangles =
+        static_cast<std::uint32_t>(occlusion_.triangle_count());
+    frame_stats_.occlusion_ms =
+        std::chrono::duration<float, std::milli>(
+            std::chrono::steady_clock::now() - start)
+            .count();
+    return true;
 }
 
-bounds Renderer::get_bounds(model_handle h) const
+std::uint8_t Renderer::record_model(prep_bucket&     out,
+                                    const gpu_model& model,
+                                    const glm::mat4& mvp,
+                                    pipeline_slot    slot,
+                                    std::uint8_t     prev_lod,
+                                    bool             occlusion) const
 {
-    if (auto it = models_.find(h); it != models_.end())
-    {
-        return it->second.model_bounds;
+    // Cull in model space: planes extracted from the MVP matrix are already
+    // transformed into the model's local frame, so bounds need no transform
+    out.mesh_visible.assign(model.instances.size(), 1);
+    if (frustum_culling_)
+    {
+        const auto view_frustum = frustum::from_matrix(mvp);
+        if (!view_frustum.intersects(model.model_bounds.center(),
+                                     model.model_bounds.size() * 0.5f))
+        {
+            ++out.models_culled;
+            out.meshes_culled +=
+                static_cast<std::uint32_t>(model.instances.size());
+            return prev_lod;
+        }
+
+        if (model.mesh_bounds.size() == model.instances.size())
+        {
+            const auto visible =
+                cull_aabbs(view_frustum, model.mesh_bounds, out.mesh_visible);
+            out.meshes_culled +=
+                static_cast<std::uint32_t>(model.instances.size() - visible);
+            if (visible == 0)
+            {
+                return prev_lod;
+            }
+        }
     }
-    return {};
-}
 
-void Renderer::draw_bounds(const bounds&    b,
-                           const transform& xform,
-                           const glm::vec3& color)
-{
-    if ((current_pass_ == nullptr) || (current_cmd_ == nullptr))
+    // Hidden behind the occluders rasterized earlier this frame. Occluders
+    // never hide themselves: their bounds are nearer than their surface.
+    if (occlusion)
     {
-        return;
+        if (occlusion_.occluded(model.model_bounds.center(),
+                                model.model_bounds.size() * 0.5f,
+                                mvp))
+        {
+            ++out.models_occluded;
+            out.meshes_occluded +=
+                static_cast<std::uint32_t>(model.instances.size());
+            return prev_lod;
+        }
+
+        const auto& b = model.mesh_bounds;
+        if (model.instances.size() > 1 && b.size() == model.instances.size())
+        {
+            for (std::size_t i = 0; i < model.instances.size(); ++i)
+            {
+                if (out.mesh_visible[i] != 0 &&
+                    occlusion_.occluded(
+                        { b.center_x[i], b.center_y[i], b.center_z[i] },
+                        { b.extent_x[i], b.extent_y[i], b.extent_z[i] },
+                        mvp))
+                {
+                    out.mesh_visible[i] = 0;
+                    ++out.meshes_occluded;
+                }
+            }
+        }
     }
 
-    // Build corners of the AABB in local space
-    // Slightly expand the bounds to ensure wireframe is visible outside the
-    // model
-    const float     expand       = 0.01f; // Small expansion factor (1% larger)
-    const glm::vec3 center       = (b.min + b.max) * 0.5f;
-    const glm::vec3 extents      = (b.max - b.min) * 0.5f * (1.0f + expand);
-    const glm::vec3 expanded_min = center - extents;
-    const glm::vec3 expanded_max = center + extents;
-
-    const glm::vec3 corners[8] = {
-        { expanded_min.x, expanded_min.y, expanded_min.z },
-        { expanded_max.x, expanded_min.y, expanded_min.z },
-        { expanded_max.x, expanded_max.y, expanded_min.z },
-        { expanded_min.x, expanded_max.y, expanded_min.z },
-        { expanded_min.x, expanded_min.y, expanded_max.z },
-        { expanded_max.x, expanded_min.y, expanded_max.z },
-        { expanded_max.x, expanded_max.y, expanded_max.z },
-        { expanded_min.x, expanded_max.y, expanded_max.z },
-    };
+    // Pick the level from the projected size of the model bounds
+    std::uint8_t lod = 0;
+    if (model.lod_count > 1)
+    {
+        const float threshold = k_lod_error_threshold * std::exp2(lod_bias_);
+        const float size      = projected_radius(model, mvp);
+        lod                   = coarsest_lod(model, size, threshold);
 
-    // Build model matrix
-    auto model_mat = glm::mat4(1.0f);
-    model_mat      = glm::translate(model_mat, xform.position);
-    model_mat      = glm::rotate(
-        model_mat, glm::radians(xform.rotation.y), glm::vec3(0, 1, 0));
-    model_mat = glm::rotate(
-        model_mat, glm::radians(xform.rotation.x), glm::vec3(1, 0, 0));
-    model_mat = glm::rotate(
-        model_mat, glm::radians(xform.rotation.z), glm::vec3(0, 0, 1));
-    model_mat = glm::scale(model_mat, xform.scale);
+        // Leave last frame's level only once the change also holds with a
+        // margin, so draws near a boundary do not flicker between levels
+        if (prev_lod < model.lod_count && lod != prev_lod)
+        {
+            const bool  coarser = lod > prev_lod;
+            const float margin  = coarser ? 1.0f + k_lod_hysteresis
+                                          : 1.0f - k_lod_hysteresis;
+            const auto  held = coarsest_lod(model, size * margin, threshold);
+            lod = coarser ? std::max(prev_lod, held) : std::min(prev_lod, held);
+        }
+    }
 
-    // Keep corners in local space - will be transformed by MVP matrix in shader
-    std::vector<vertex_pos_color> verts;
-    verts.reserve(8);
-    for (const auto& c : corners)
+    // Packed positions are dequantized by the vertex shader's matrix.
+    // Instances at the model origin share one matrix, pushed on first use.
+    const auto dequantize = model.packed ? model.dequantize : glm::mat4(1.0f);
+    auto       shared     = UINT32_MAX;
+
+    const auto& arena     = model.packed ? packed_arena_ : textured_arena_;
+    const bool  wireframe = slot == pipeline_slot::textured_wireframe;
+    if (wireframe && model.packed)
     {
-        verts.push_back({ c, color });
+        slot = pipeline_slot::textured_packed_wireframe;
     }
 
-    // Edges of the box
-    constexpr uint16_t edges[] = {
-        0, 1, 1, 2, 2, 3, 3, 0, // Bottom face
-        4, 5, 5, 6, 6, 7, 7, 4, // Top face
-        0, 4, 1, 5, 2, 6, 3, 7, // Vertical edges
-    };
+    // Clip-space w is the view depth for perspective projections
+    const glm::vec4 depth_row { mvp[0][3], mvp[1][3], mvp[2][3], mvp[3][3] };
 
-    // Create mesh and store for cleanup at start of next frame
-    auto mesh =
-        upload_wireframe_mesh(verts, std::span<const uint16_t>(edges, 24));
+    // Pixels covered per model-space unit at unit depth, for the texel
+    // density streamed textures are asked for
+    const float pixel_scale =
+        glm::length(glm::vec3(mvp[0][1], mvp[1][1], mvp[2][1])) * 0.5f *
+        static_cast<float>(view_height_);
 
-    // Bind bounds wireframe pipeline (depth test disabled)
-    // This ensures the wireframe is always visible, even when camera is inside
-    // the object
-    if (wireframe_bounds_pipeline_ != nullptr)
+    // Record each visible mesh instance with its own texture and material;
+    // repeated meshes are merged into instanced draws after sorting
+    for (std::size_t i = 0; i < model.instances.size(); ++i)
     {
-        SDL_BindGPUGraphicsPipeline(current_pass_, wireframe_bounds_pipeline_);
+        const auto& instance = model.instances[i];
+        const auto& mesh     = model.meshes[instance.mesh];
+        if (out.mesh_visible[i] == 0 || mesh.range.index_count == 0)
+        {
+            continue;
+        }
+
+        auto matrix = shared;
+        if (instance.placed || shared == UINT32_MAX)
+        {
+            matrix = static_cast<std::uint32_t>(out.matrices.size());
+            out.matrices.push_back(instance.placed
+                                       ? mvp * instance.transform * dequantize
+                                       : mvp * dequantize);
+            shared = instance.placed ? shared : matrix;
+        }
+
+        const auto tex =
+            (mesh.texture != invalid_texture)
+                ? mesh.texture
+                : ((model.texture != invalid_texture) ? model.texture
+                                                      : default_texture_);
+        const float depth =
+            glm::dot(depth_row, glm::vec4(instance.center, 1.0f));
+        const auto& level =
+            mesh.lods[std::min<std::size_t>(lod, mesh.lod_count - 1u)];
+        if (level.first_index != 0)
+        {
+            ++out.meshes_lod;
+        }
+        if (streamer_.contains(tex))
+        {
+            // UVs are assumed to span the texture once across the mesh
+            const float size = glm::length(mesh.mesh_bounds.size());
+            out.texture_demands.push_back({
+                .texture = tex,
+                .texels  = depth > 0.0f ? size * pixel_scale / depth
+                                        : std::numeric_limits<float>::max(),
+            });
+        }
+
+        // Opaque meshes draw first with discard-free shaders, cut-outs after
+        // them, and blended meshes last from back to front
+        const auto alpha = wireframe ? alpha_mode::opaque : mesh.alpha;
+        const auto mesh_slot =
+            wireframe ? slot : textured_slot(model.packed, alpha);
+        const auto quantized = sort_key::quantize_depth(depth);
+        out.queue.push(
+            alpha == alpha_mode::blend
+                ? sort_key::make_blended(quantized)
+                : sort_key::make(alpha == alpha_mode::mask
+                                     ? sort_key::layer::alpha_test
+                                     : sort_key::layer::world,
+                                 static_cast<std::uint32_t>(mesh_slot),
+                                 mesh.material,
+                                 mesh.id,
+                                 quantized),
+            static_cast<std::uint32_t>(out.items.size()));
+        out.items.push_back(draw_item {
+            .pipeline      = mesh_slot,
+            .vertex_buffer = arena.vertex_buffer(),
+            .index_buffer  = arena.index_buffer(),
+            .index_count   = level.index_count,
+            .vertex_count  = mesh.range.vertex_count,
+            .first_index   = mesh.range.first_index + level.first_index,
+            .vertex_offset = static_cast<Sint32>(mesh.range.first_vertex),
+            .index_size    = mesh.range.index_size,
+            .texture       = tex,
+            .matrix        = matrix,
+            .material      = mesh.material,
+            .triangles     = true,
+        });
     }
-    else if (wireframe_pipeline_ != nullptr)
+    return lod;
+}
+
+void Renderer::set_occluder(model_handle h, bool occluder)
+{
+    if (auto* model = models_.find(h))
     {
-        // Fallback to regular wireframe pipeline if bounds pipeline not
-        // available
-        SDL_BindGPUGraphicsPipeline(current_pass_, wireframe_pipeline_);
+        model->occluder = occluder;
     }
+}
 
-    // Use MVP matrix with model transform (vertices are in local space, need
-    // model transform)
-    const uniform_mvp uniforms { view_proj_ * model_mat };
-    SDL_PushGPUVertexUniformData(current_cmd_, 0, &uniforms, sizeof(uniforms));
-
-    // Draw the mesh directly (don't use draw_mesh_internal as it would
-    // overwrite our MVP)
-    if ((current_pass_ == nullptr) || (current_cmd_ == nullptr))
+bounds Renderer::get_bounds(model_handle h) const
+{
+    if (const auto* model = models_.find(h))
     {
-        return;
+        return model->model_bounds;
     }
+    return {};
+}
 
-    SDL_GPUBufferBinding vb {};
-    vb.buffer = mesh.vertex_buffer;
-    vb.offset = 0;
-    SDL_BindGPUVertexBuffers(current_pass_, 0, &vb, 1);
-
-    SDL_GPUBufferBinding ib {};
-    ib.buffer = mesh.index_buffer;
-    ib.offset = 0;
-    SDL_BindGPUIndexBuffer(current_pass_, &ib, SDL_GPU_INDEXELEMENTSIZE_16BIT);
-    SDL_DrawGPUIndexedPrimitives(current_pass_, mesh.index_count, 1, 0, 0, 0);
-
-    ++frame_stats_.draw_calls;
-    frame_stats_.vertices += mesh.vertex_count;
-
-    // Store in temporary list - will be cleaned up at start of next frame
-    temp_meshes_.push_back(mesh);
+void Renderer::draw_bounds(const bounds&    b,
+                           const transform& xform,
+                           const glm::vec3& color)
+{
+    // Slightly expand the bounds so the box stays visible outside the model
+    const float     expand  = 0.01f; // Small expansion factor (1% larger)
+    const glm::vec3 center  = (b.min + b.max) * 0.5f;
+    const glm::vec3 extents = (b.max - b.min) * 0.5f * (1.0f + expand);
+
+    // Overlay so selection boxes stay visible from inside the object
+    debug_lines_.obb({ .min = center - extents, .max = center + extents },
+                     model_matrix(xform),
+                     color,
+                     debug_depth::overlay);
 }
 
 render_stats Renderer::get_stats() const noexcept
 {
-    return frame_stats_;
+    auto stats = frame_stats_;
+
+    const auto wireframe = wireframe_arena_.stats();
+    const auto textured  = textured_arena_.stats();
+    const auto packed    = packed_arena_.stats();
+    stats.arena_used_kb  = static_cast<std::uint32_t>(
+        (wireframe.used + textured.used + packed.used) / 1024);
+    stats.arena_capacity_kb = static_cast<std::uint32_t>(
+        (wireframe.capacity + textured.capacity + packed.capacity) / 1024);
+    stats.arena_free_blocks =
+        wireframe.free_blocks + textured.free_blocks + packed.free_blocks;
+    stats.arena_compactions = wireframe_arena_.compactions() +
+                              textured_arena_.compactions() +
+                              packed_arena_.compactions();
+    stats.arena_fragmentation = std::max({ wireframe.fragmentation,
+                                           textured.fragmentation,
+                                           packed.fragmentation });
+
+    const auto& staging = staging_.stats();
+    stats.upload_submits =
+        staging.submissions - staging_frame_start_.submissions;
+    stats.upload_kb = static_cast<std::uint32_t>(
+        (staging.bytes_uploaded - staging_frame_start_.bytes_uploaded) / 1024);
+    return stats;
 }
 
 void Renderer::set_msaa_samples(msaa_samples samples)
@@ -1776,18 +4020,16 @@ void Renderer::set_max_anisotropy(float anisotropy)
     if (max_anisotropy_ != anisotropy)
     {
         max_anisotropy_ = anisotropy;
-        sampler_dirty_  = true; // Mark samplers for recreation
-        spdlog::info("Max anisotropy set to {:.1f}, samplers will be recreated",
-                     anisotropy);
-        // Note: Full implementation would recreate all texture samplers
-        // For now, this just stores the value for future texture loads
+        // Only the shared samplers change, they are recreated on next use
+        samplers_.clear();
+        spdlog::info("Max anisotropy set to {:.1f}", anisotropy);
     }
 }
 
 void Renderer::set_texture_filter(texture_filter filter)
 {
     texture_filter_ = filter;
-    sampler_dirty_  = true;
+    samplers_.clear();
     spdlog::info("Texture filter set to: {}",
                  filter == texture_filter::nearest  ? "Nearest"
                  : filter == texture_filter::linear ? "Linear"
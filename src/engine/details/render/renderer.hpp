@@ -5,14 +5,31 @@
 
 #include "core-api/profiler.hpp"
 #include "core-api/renderer.hpp"
+#include "core-api/slot_map.hpp"
+#include "debug_lines.hpp"
+#include "frustum.hpp"
+#include "job_system.hpp"
+#include "mesh_arena.hpp"
 #include "model/model_system.hpp"
+#include "occlusion.hpp"
+#include "pipeline_cache.hpp"
+#include "render_queue.hpp"
+#include "staging.hpp"
+#include "task_queue.hpp"
+#include "texture/sampler_cache.hpp"
+#include "texture/texture.hpp"
+#include "texture_streamer.hpp"
 
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_gpu.h>
 #include <glm/glm.hpp>
 
+#include <array>
+#include <atomic>
+#include <expected>
+#include <memory>
+#include <span>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 namespace egen
@@ -24,41 +41,128 @@ class shader_system;
 /// GPU mesh data for wireframe rendering
 struct gpu_mesh final
 {
-    SDL_GPUBuffer* vertex_buffer = nullptr;
-    SDL_GPUBuffer* index_buffer  = nullptr;
-    Uint32         index_count   = 0;
-    Uint32         vertex_count  = 0;
-    primitive_type type          = primitive_type::lines;
+    mesh_range     range; // Location in the wireframe mesh arena
+    primitive_type type = primitive_type::lines;
+    std::uint32_t  id   = 0; // Sort key mesh id
 };
 
 /// GPU texture with sampler
 struct gpu_texture final
 {
-    SDL_GPUTexture* texture = nullptr;
-    SDL_GPUSampler* sampler = nullptr;
-    std::int32_t    width   = 0;
-    std::int32_t    height  = 0;
+    SDL_GPUTexture* texture     = nullptr;
+    sampler_key     sampler     = {}; // Base state, see sampler_for()
+    std::int32_t    width       = 0;
+    std::int32_t    height      = 0;
+    std::uint32_t   mip_levels  = 1; // Resident levels
+    std::uint32_t   layers      = 1; // More than one for packed textures
+    std::uint32_t   first_level = 0; // Finest resident level, see streamer_
+};
+
+/// Texture as sampled by a material: a layer of a (possibly packed) array
+struct texture_ref final
+{
+    texture_handle texture = invalid_texture;
+    std::uint32_t  layer   = 0;
 };
 
 /// Textured mesh for model rendering
 struct gpu_textured_mesh final
 {
-    SDL_GPUBuffer* vertex_buffer = nullptr;
-    SDL_GPUBuffer* index_buffer  = nullptr;
-    Uint32         index_count   = 0;
-    Uint32         vertex_count  = 0;
-    texture_handle texture       = invalid_texture; // Per-mesh texture
+    mesh_range     range;                         // Location in model's arena
+    texture_handle texture     = invalid_texture; // Per-mesh texture
+    bounds         mesh_bounds = {};              // Mesh-space bounds
+    std::uint32_t  id          = 0;               // Sort key mesh id
+
+    // Material alpha handling; opaque meshes skip the discarding shader
+    alpha_mode    alpha    = alpha_mode::opaque;
+    std::uint32_t material = 0; // Index into the renderer's material table
+
+    // Index ranges within `range` per level of detail, finest first
+    std::array<mesh_lod, k_max_mesh_lods> lods {};
+    std::uint8_t                          lod_count = 1;
+};
+
+/// Placement of a mesh within its model
+struct gpu_mesh_instance final
+{
+    glm::mat4     transform = glm::mat4(1.0f); // Mesh space to model space
+    glm::vec3     center    = {};              // Model-space bounds center
+    std::uint32_t mesh      = 0;               // Index into gpu_model::meshes
+    bool          placed    = false;           // transform is not identity
 };
 
 /// Complete GPU model with meshes, textures, and bounds
 struct gpu_model final
 {
     std::vector<gpu_textured_mesh> meshes;
+    std::vector<gpu_mesh_instance> instances; // What is drawn, in order
     std::vector<texture_handle>    textures; // All textures used by this model
+    std::vector<std::uint32_t>     materials; // Material table entries owned
     texture_handle texture      = invalid_texture; // Legacy: primary texture
     glm::vec3      color        = glm::vec3(1.0f);
     bounds         model_bounds = {};
     bool           has_uvs      = false;
+    aabb_soa       mesh_bounds; // Per-instance bounds for batched culling
+
+    // Meshes use vertex_textured_packed; positions are quantized to the
+    // model bounds and dequantize maps them back into model space
+    bool      packed     = false;
+    glm::mat4 dequantize = glm::mat4(1.0f);
+
+    // Worst mesh error per level, relative to the model's bounds radius.
+    // Meshes with fewer levels stay at their coarsest one.
+    std::array<float, k_max_mesh_lods> lod_errors {};
+    std::uint8_t                       lod_count = 1;
+
+    // Coarse copy of every instance in model space, rasterized into the
+    // occlusion buffer while occluder is set
+    bool                       occluder = false;
+    std::vector<glm::vec3>     occluder_positions;
+    std::vector<std::uint32_t> occluder_indices;
+
+    // Placeholder of an asynchronous load until ready; see model_load
+    model_load_state state = model_load_state::ready;
+};
+
+/// What loading a model texture did with its texture cache entry
+enum class cache_outcome : std::uint8_t
+{
+    unused,       // No codec, or caching is disabled
+    hit,          // Read from the cache
+    stored,       // Encoded and written to the cache
+    write_failed, // Encoded, but the entry could not be written
+};
+
+/// CPU side of a model load: parsed data and its decoded textures, one
+/// image per loaded_model::textures, empty where decoding failed
+struct prepared_model final
+{
+    loaded_model            data;
+    std::vector<image_data> images;
+    std::uint32_t           compressed  = 0; // Images with a block codec
+    std::uint32_t           cache_hits  = 0; // Of those, read from the cache
+    std::uint32_t           cache_fails = 0; // Encoded but not written
+    double                  decode_ms   = 0.0;
+};
+
+/// A load_model_async request, shared by the render thread and the loader
+/// task preparing it. The task writes result before setting prepared; the
+/// render thread reads result only after seeing prepared.
+struct model_load final
+{
+    model_handle          handle = invalid_model;
+    std::filesystem::path path;
+    glm::vec3             color = glm::vec3(1.0f);
+    model_load_callback   on_done;
+
+    std::atomic<bool> cancelled { false }; // Polled by the task
+    std::atomic<bool> prepared { false };
+    std::expected<prepared_model, std::string> result;
+
+    // Upload progress on the render thread: textures, then everything else
+    bool                        textures_created = false;
+    std::vector<texture_ref>    textures;
+    std::vector<texture_handle> owned;
 };
 
 /// Vertex with position and color (wireframe)
@@ -76,10 +180,141 @@ struct vertex_textured final
     glm::vec2 texcoord;
 };
 
-/// MVP uniform data for shaders
+/// Quantized textured vertex, half the size of vertex_textured. Positions
+/// are unorm16 within the model bounds (w is always 1), normals are
+/// octahedral snorm16 and texture coordinates are half floats.
+struct vertex_textured_packed final
+{
+    std::array<std::uint16_t, 4> position {};
+    std::array<std::int16_t, 2>  normal {};
+    std::array<std::uint16_t, 2> texcoord {};
+};
+static_assert(sizeof(vertex_textured_packed) == 16);
+
+/// Shading parameters of one material, an element of the material storage
+/// buffer read by the textured fragment shaders
+struct gpu_material final
+{
+    glm::vec4     base_color   = glm::vec4(1.0f); // Multiplies base texture
+    glm::vec3     emissive     = glm::vec3(0.0f); // Added after lighting
+    float         alpha_cutoff = 0.0f; // Less alpha is discarded
+    float         metallic     = 0.0f;
+    float         roughness    = 1.0f;
+    float         unlit        = 0.0f; // 1 skips lighting
+    std::uint32_t layer        = 0;    // Base texture array layer
+};
+static_assert(sizeof(gpu_material) == 48);
+
+/// MVP uniform data for shaders; textured shaders also read the material
+/// index of the draw
 struct uniform_mvp final
 {
-    glm::mat4 mvp;
+    glm::mat4     mvp;
+    std::uint32_t material   = 0;
+    std::uint32_t padding[3] = {};
+};
+
+/// Uniform data for instanced draws, padded to a 16-byte block
+struct uniform_instancing final
+{
+    std::uint32_t base_instance = 0; // First matrix in the instance buffer
+    std::uint32_t material      = 0; // Shared by every instance of the batch
+    std::uint32_t padding[2]    = {};
+};
+
+/// Pipeline slots referenced by recorded draws and sort keys
+enum class pipeline_slot : std::uint8_t
+{
+    textured,
+    textured_wireframe,
+    textured_packed,
+    textured_packed_wireframe,
+    textured_mask,  // Alpha-tested, drawn after opaque
+    textured_blend, // Alpha-blended, drawn back to front after the rest
+    textured_packed_mask,
+    textured_packed_blend,
+    wireframe,
+    wireframe_tri,
+};
+
+/// Draw recorded during the frame, resolved to GPU state at flush
+struct draw_item final
+{
+    pipeline_slot  pipeline      = pipeline_slot::wireframe;
+    SDL_GPUBuffer* vertex_buffer = nullptr;
+    SDL_GPUBuffer* index_buffer  = nullptr;
+    Uint32         index_count   = 0;
+    Uint32         vertex_count  = 0;
+    Uint32         first_index   = 0;               // Offset in index buffer
+    Sint32         vertex_offset = 0;               // Base vertex
+    SDL_GPUIndexElementSize index_size = SDL_GPU_INDEXELEMENTSIZE_16BIT;
+    texture_handle texture   = invalid_texture; // 0 = no sampler bound
+    std::uint32_t  matrix    = 0;     // Index into frame matrices
+    std::uint32_t  material  = 0;     // Index into the material table
+    bool           triangles = false; // Counted in triangle stats
+};
+
+/// Run of identical sorted draws submitted with one draw call
+struct draw_batch final
+{
+    std::uint32_t item           = 0; // First draw item of the run
+    std::uint32_t instance_count = 1;
+    std::uint32_t base_instance  = 0; // Offset into the instance buffer
+};
+
+/// Model draw deferred to the parallel frame-preparation stage
+struct model_draw final
+{
+    model_handle  model = invalid_model;
+    transform     xform;
+    std::uint32_t view = 0; // Index into the frame's view-projections
+    pipeline_slot slot = pipeline_slot::textured;
+};
+
+/// Marks a model draw without a level of detail from the previous frame
+constexpr std::uint8_t k_no_lod = UINT8_MAX;
+
+/// Level of detail picked for a model draw, kept for hysteresis
+struct lod_state final
+{
+    model_handle model = invalid_model;
+    std::uint8_t lod   = k_no_lod;
+};
+
+/// Screen coverage a recorded draw asks of a streamed texture
+struct texture_demand final
+{
+    texture_handle texture = invalid_texture;
+    float          texels  = 0.0f; // Pixels across the mesh's bounds
+};
+
+/// Draws recorded by one frame-preparation worker. Item and matrix indices
+/// are local to the bucket until it is merged into the frame queue.
+struct prep_bucket final
+{
+    render_queue                queue;
+    std::vector<draw_item>      items;
+    std::vector<glm::mat4>      matrices;
+    std::vector<texture_demand> texture_demands;
+    std::vector<std::uint8_t>   mesh_visible; // Per-mesh culling scratch
+    std::uint32_t               models_culled   = 0;
+    std::uint32_t               meshes_culled   = 0;
+    std::uint32_t               meshes_lod      = 0;
+    std::uint32_t               models_occluded = 0;
+    std::uint32_t               meshes_occluded = 0;
+
+    void clear() noexcept
+    {
+        queue.clear();
+        items.clear();
+        matrices.clear();
+        texture_demands.clear();
+        models_culled   = 0;
+        meshes_culled   = 0;
+        meshes_lod      = 0;
+        models_occluded = 0;
+        meshes_occluded = 0;
+    }
 };
 
 /// Main renderer class implementing IRenderer interface
@@ -101,11 +336,28 @@ public:
     /// Release all GPU resources
     void shutdown();
 
-    /// Begin a new frame
-    void begin_frame(SDL_GPUCommandBuffer* cmd, SDL_GPURenderPass* pass);
+    /// Begin a new frame, draws are recorded until prepare_frame
+    /// @param view_height Height of the scene viewport in pixels
+    void begin_frame(SDL_GPUCommandBuffer* cmd, Uint32 view_height);
+
+    /// Sort recorded draws, merge instances and upload per-instance data.
+    /// Runs a copy pass, so call it before the scene render pass begins.
+    void prepare_frame();
 
-    /// End current frame
-    void end_frame();
+    /// Lay down depth for the prepared opaque draws in a depth-only pass.
+    /// end_frame then shades them with an equal depth test and no depth
+    /// writes. Optional; call between prepare_frame and end_frame.
+    void depth_prepass(SDL_GPURenderPass* pass);
+
+    /// Whether depth_prepass draws anything; false when its pipelines
+    /// could not be built
+    [[nodiscard]] bool depth_prepass_available() const noexcept
+    {
+        return depth_only_pipeline_ != nullptr;
+    }
+
+    /// End current frame: submit the prepared draws into the render pass
+    void end_frame(SDL_GPURenderPass* pass);
 
     /// Ensure depth texture matches given dimensions
     void ensure_depth_texture(Uint32 width, Uint32 height);
@@ -143,6 +395,38 @@ public:
     /// Set texture filter quality
     void set_texture_filter(texture_filter filter) override;
 
+    /// Enable/disable frustum culling of models and meshes
+    void set_frustum_culling(bool enabled) noexcept
+    {
+        frustum_culling_ = enabled;
+    }
+    [[nodiscard]] bool frustum_culling() const noexcept
+    {
+        return frustum_culling_;
+    }
+
+    /// Shift level-of-detail selection; each step doubles (positive) or
+    /// halves (negative) the screen-space error accepted per level
+    void set_lod_bias(float bias) noexcept { lod_bias_ = bias; }
+    [[nodiscard]] float lod_bias() const noexcept { return lod_bias_; }
+
+    /// Enable/disable culling of draws hidden behind occluder models
+    void set_occlusion_culling(bool enabled) noexcept
+    {
+        occlusion_culling_ = enabled;
+    }
+    [[nodiscard]] bool occlusion_culling() const noexcept
+    {
+        return occlusion_culling_;
+    }
+
+    /// GPU memory streamed textures may use before their least recently
+    /// seen levels are dropped
+    void set_texture_budget(std::size_t bytes) noexcept
+    {
+        texture_budget_ = bytes;
+    }
+
     /// Post-processing parameters
     struct postprocess_params
     {
@@ -152,8 +436,11 @@ public:
         float saturation   = 1.0f;
         float vignette     = 0.0f;
         float fxaa_enabled = 0.0f;
-        float res_x        = 1920.0f;
+        float res_x        = 1920.0f; // Scene texture size
         float res_y        = 1080.0f;
+        float uv_scale_x   = 1.0f; // Part of the scene texture rendered to
+        float uv_scale_y   = 1.0f;
+        float padding[2]   = {};
     };
 
     /// Ensure post-processing render target exists
@@ -208,14 +495,27 @@ public:
     // Model management
     model_handle load_model(const std::filesystem::path& path,
                             const glm::vec3&             color) override;
+    model_handle load_model_async(const std::filesystem::path& path,
+                                  const glm::vec3&             color,
+                                  model_load_callback on_done) override;
+    [[nodiscard]] model_load_state get_load_state(
+        model_handle model) const override;
+    void         cancel_load(model_handle model) override;
     void         unload_model(model_handle model) override;
     void draw_model(model_handle model, const transform& xform) override;
+    void draw_model_instanced(model_handle               model,
+                              std::span<const transform> xforms) override;
+    void set_occluder(model_handle model, bool occluder) override;
     [[nodiscard]] bounds get_bounds(model_handle model) const override;
 
     // Debug drawing
     void draw_bounds(const bounds&    b,
                      const transform& xform,
                      const glm::vec3& color) override;
+    [[nodiscard]] i_debug_draw& debug_draw() noexcept override
+    {
+        return debug_lines_;
+    }
 
     // Texture management
     texture_handle load_texture(const std::filesystem::path& path) override;
@@ -224,8 +524,11 @@ public:
     // Statistics
     [[nodiscard]] render_stats get_stats() const noexcept override;
 
-    /// Bind default pipeline (called at frame start)
-    void bind_pipeline();
+    /// Processing applied to models loaded from now on
+    void set_load_options(const load_options& options) noexcept
+    {
+        load_options_ = options;
+    }
 
     /// Rebuild pipelines if shaders changed
     void reload_pipelines();
@@ -240,32 +543,169 @@ public:
     }
 
 private:
-    [[nodiscard]] bool create_wireframe_pipeline();
-    [[nodiscard]] bool create_textured_pipeline();
-    [[nodiscard]] bool create_postprocess_pipeline();
-
-    void draw_mesh_internal(const gpu_mesh& mesh);
-    void draw_textured_mesh_internal(const gpu_textured_mesh& mesh,
-                                     texture_handle           tex);
+    /// Hand the current shaders and vertex layouts to the pipeline cache
+    void register_pipeline_programs();
+    /// Point the pipeline slots at the variants for the current state
+    [[nodiscard]] bool resolve_pipelines();
+    /// Queue the variants for other MSAA levels for background creation
+    void precreate_pipeline_variants();
+
+    [[nodiscard]] SDL_GPUSampleCount msaa_sample_count() const noexcept;
+
+    [[nodiscard]] SDL_GPUGraphicsPipeline* pipeline_for(
+        pipeline_slot slot) const noexcept;
+    /// Instanced variant of a slot, or nullptr if it cannot be instanced
+    [[nodiscard]] SDL_GPUGraphicsPipeline* instanced_pipeline_for(
+        pipeline_slot slot) const noexcept;
+    /// Depth pre-pass variant of a slot, or nullptr if it is not pre-passed
+    [[nodiscard]] SDL_GPUGraphicsPipeline* depth_pipeline_for(
+        pipeline_slot slot, bool instanced) const noexcept;
+
+    /// Shared sampler for a texture. Filtered textures take the filter and
+    /// anisotropy quality settings, nearest-filtered ones keep their state.
+    [[nodiscard]] SDL_GPUSampler* sampler_for(const gpu_texture& tex);
+
+    /// Store a matrix for this frame's draws and return its index
+    [[nodiscard]] std::uint32_t push_frame_matrix(const glm::mat4& m);
+
+    /// Record a draw for submission at end_frame
+    void queue_draw(const draw_item& item, std::uint64_t key);
+
+    /// Compact mesh arenas whose free space has become too scattered; at
+    /// frame start, before any draw references a range
+    void compact_mesh_arenas();
+
+    /// Cull and record the deferred model draws on the job system, then
+    /// merge the per-worker buckets into the frame queue
+    void record_model_draws();
+
+    /// Turn this frame's texture demands into residency changes and
+    /// recreate the textures they affect with their new levels
+    void stream_textures();
+
+    /// Rasterize the occluder draws of the first view into the occlusion
+    /// buffer on the job system
+    /// @return True if draws of occlusion_view_ can be tested against it
+    bool rasterize_occluders();
+
+    /// Record the visible meshes of a model into a worker's bucket
+    /// @param prev_lod Level used by this draw last frame, or k_no_lod
+    /// @param occlusion Also test bounds against the occlusion buffer
+    /// @return Level the meshes were recorded at
+    std::uint8_t record_model(prep_bucket&     out,
+                              const gpu_model& model,
+                              const glm::mat4& mvp,
+                              pipeline_slot    slot,
+                              std::uint8_t     prev_lod,
+                              bool             occlusion) const;
+
+    /// Group sorted draws into batches; with instancing, adjacent draws
+    /// that differ only in their matrix are merged into one batch
+    void build_draw_batches(bool instancing);
+
+    /// Copy this frame's instance matrices into the storage buffer
+    [[nodiscard]] bool upload_instance_data();
+
+    /// Add an entry to the material table, reusing released ones
+    [[nodiscard]] std::uint32_t add_material(const gpu_material& material);
+
+    /// Queue the material table for upload, growing the storage buffer as
+    /// needed
+    [[nodiscard]] bool upload_materials();
+
+    /// Submit prepared batches, skipping redundant binds
+    void flush_draw_queue();
+
+    /// Copy this frame's debug lines into the debug vertex buffer
+    [[nodiscard]] bool upload_debug_lines();
+
+    /// Draw debug lines, one draw call per depth mode
+    void draw_debug_lines();
 
     [[nodiscard]] gpu_mesh upload_wireframe_mesh(
         std::span<const vertex_pos_color> vertices,
         std::span<const uint16_t>         indices);
+    /// @param arena Arena of the vertex format the bytes are in
     [[nodiscard]] gpu_textured_mesh upload_textured_mesh(
-        std::span<const vertex_textured> vertices,
-        std::span<const uint16_t>        indices);
+        mesh_arena&                arena,
+        std::span<const std::byte> vertices,
+        Uint32                     vertex_count,
+        std::span<const uint32_t>  indices,
+        index_format               format);
 
     [[nodiscard]] static std::filesystem::path find_texture_for_model(
         const std::filesystem::path& model_path);
 
-    /// Convert loaded model data to GPU model
-    [[nodiscard]] gpu_model upload_loaded_model(const loaded_model& data,
-                                                const glm::vec3&    color);
+    /// Parse a model and decode its textures, block-compressed when
+    /// options allow it and codecs[codec] says the device samples it.
+    /// Touches no GPU or renderer state, so loader threads run it too.
+    /// Fails early once cancelled is set.
+    [[nodiscard]] static std::expected<prepared_model, std::string>
+    prepare_model(const std::filesystem::path& path,
+                  const load_options&          options,
+                  const std::array<bool, 4>&   codecs,
+                  const parallel_range_fn&     parallel,
+                  const std::atomic<bool>*     cancelled = nullptr);
+
+    /// Create GPU textures for every image of a prepared model, one entry
+    /// per loaded_model::textures. Small ones of equal size and codec are
+    /// packed into texture arrays when load_options_ allow it; streamed
+    /// images move to streamer_. Every created texture is appended to
+    /// owned.
+    [[nodiscard]] std::vector<texture_ref> create_model_textures(
+        prepared_model& prepared, std::vector<texture_handle>& owned);
+
+    /// Decode one model texture. With a codec, its compressed mip chain is
+    /// read from options.texture_cache when an entry for the source bytes
+    /// exists, otherwise encoded through parallel and stored there; images
+    /// whose sides are not multiples of 4 stay RGBA8. An encode that was
+    /// cancelled part way fails instead of being cached.
+    /// @param cache What happened with the cache entry of the image
+    [[nodiscard]] static std::expected<image_data, std::string>
+    load_model_image(const model_texture&     tex,
+                     texture_codec            codec,
+                     const load_options&      options,
+                     const parallel_range_fn& parallel,
+                     const std::atomic<bool>* cancelled,
+                     cache_outcome&           cache);
+
+    /// Spreads texture encoding over the job system; render thread only
+    [[nodiscard]] parallel_range_fn encode_parallel();
+
+    /// Upload the meshes and materials of a prepared model whose textures
+    /// exist. On failure everything it created, owned included, is
+    /// released.
+    [[nodiscard]] std::expected<gpu_model, std::string> finish_model(
+        const prepared_model&        prepared,
+        const std::filesystem::path& path,
+        const glm::vec3&             color,
+        std::span<const texture_ref> textures,
+        std::vector<texture_handle>  owned);
+
+    /// Run the next upload phase of a prepared load; loading while more
+    /// phases remain
+    model_load_state advance_model_load(model_load& load);
+
+    /// Upload prepared asynchronous loads within k_model_upload_budget_ms
+    /// and run the callbacks of those that settled
+    void drain_model_loads();
+
+    /// Convert loaded model data to GPU model, quantizing its vertices
+    /// when load_options_ allow it and the model fits the packed format.
+    /// Materials sample textures[base_color_texture_index], or fallback.
+    [[nodiscard]] gpu_model upload_loaded_model(
+        const loaded_model&          data,
+        std::span<const texture_ref> textures,
+        texture_ref                  fallback,
+        const glm::vec3&             color);
 
     // GPU device (non-owning)
     SDL_GPUDevice* device_  = nullptr;
     shader_system* shaders_ = nullptr;
 
+    // Every pipeline variant; the slots below point into it (non-owning)
+    pipeline_cache pipelines_;
+
     // Pipelines
     SDL_GPUGraphicsPipeline* wireframe_pipeline_ = nullptr;
     SDL_GPUGraphicsPipeline* wireframe_tri_pipeline_ =
@@ -276,23 +716,105 @@ private:
     SDL_GPUGraphicsPipeline* textured_wireframe_pipeline_ = nullptr;
     SDL_GPUGraphicsPipeline* postprocess_pipeline_        = nullptr;
 
+    // Instanced textured pipelines (per-instance MVP from a storage buffer)
+    SDL_GPUGraphicsPipeline* textured_instanced_pipeline_           = nullptr;
+    SDL_GPUGraphicsPipeline* textured_instanced_wireframe_pipeline_ = nullptr;
+
+    // Same pipelines for the quantized vertex format
+    SDL_GPUGraphicsPipeline* textured_packed_pipeline_           = nullptr;
+    SDL_GPUGraphicsPipeline* textured_packed_wireframe_pipeline_ = nullptr;
+    SDL_GPUGraphicsPipeline* textured_packed_instanced_pipeline_ = nullptr;
+    SDL_GPUGraphicsPipeline* textured_packed_instanced_wireframe_pipeline_ =
+        nullptr;
+
+    // Alpha-tested and blended variants of the filled pipelines above. They
+    // fall back to the opaque pipelines if the alpha shaders fail to load.
+    SDL_GPUGraphicsPipeline* textured_mask_pipeline_         = nullptr;
+    SDL_GPUGraphicsPipeline* textured_blend_pipeline_        = nullptr;
+    SDL_GPUGraphicsPipeline* textured_packed_mask_pipeline_  = nullptr;
+    SDL_GPUGraphicsPipeline* textured_packed_blend_pipeline_ = nullptr;
+    SDL_GPUGraphicsPipeline* textured_instanced_mask_pipeline_  = nullptr;
+    SDL_GPUGraphicsPipeline* textured_instanced_blend_pipeline_ = nullptr;
+    SDL_GPUGraphicsPipeline* textured_packed_instanced_mask_pipeline_ = nullptr;
+    SDL_GPUGraphicsPipeline* textured_packed_instanced_blend_pipeline_ =
+        nullptr;
+
+    // Depth pre-pass: position-only pipelines without a color target, and
+    // equal-tested opaque pipelines for the color pass that follows. Either
+    // all are available or none.
+    SDL_GPUGraphicsPipeline* depth_only_pipeline_                  = nullptr;
+    SDL_GPUGraphicsPipeline* depth_only_instanced_pipeline_        = nullptr;
+    SDL_GPUGraphicsPipeline* depth_only_packed_pipeline_           = nullptr;
+    SDL_GPUGraphicsPipeline* depth_only_packed_instanced_pipeline_ = nullptr;
+    SDL_GPUGraphicsPipeline* textured_equal_pipeline_              = nullptr;
+    SDL_GPUGraphicsPipeline* textured_instanced_equal_pipeline_    = nullptr;
+    SDL_GPUGraphicsPipeline* textured_packed_equal_pipeline_       = nullptr;
+    SDL_GPUGraphicsPipeline* textured_packed_instanced_equal_pipeline_ =
+        nullptr;
+
     // Current frame state
-    SDL_GPURenderPass*    current_pass_ = nullptr;
-    SDL_GPUCommandBuffer* current_cmd_  = nullptr;
+    SDL_GPURenderPass*    current_pass_  = nullptr;
+    SDL_GPUCommandBuffer* current_cmd_   = nullptr;
+    bool                  prepass_drawn_ = false; // Depth is already laid
 
     // Render state
-    glm::mat4      view_proj_      = glm::mat4(1.0f);
-    render_mode    render_mode_    = render_mode::wireframe;
-    bool           pipeline_dirty_ = false;
-    msaa_samples   msaa_samples_   = msaa_samples::none;
-    float          max_anisotropy_ = 16.0f;
-    bool           sampler_dirty_  = false;
-    texture_filter texture_filter_ = texture_filter::trilinear;
+    glm::mat4      view_proj_         = glm::mat4(1.0f);
+    render_mode    render_mode_       = render_mode::wireframe;
+    bool           pipeline_dirty_    = false;
+    bool           shaders_dirty_     = false;
+    msaa_samples   msaa_samples_      = msaa_samples::none;
+    float          max_anisotropy_    = 16.0f;
+    texture_filter texture_filter_    = texture_filter::trilinear;
+    bool           frustum_culling_   = true;
+    bool           occlusion_culling_ = true;
+    float          lod_bias_          = 0.0f;
+
+    // Frame preparation: model draws are culled and recorded in parallel
+    job_system               jobs_;
+    std::vector<model_draw>  model_draws_;
+    std::vector<glm::mat4>   frame_views_; // View-projections used this frame
+    std::uint32_t            view_index_ = UINT32_MAX; // Current, if pushed
+    std::vector<prep_bucket> prep_buckets_; // One per worker
+
+    // Depth of this frame's occluders, from the view they were drawn in
+    occlusion_buffer occlusion_;
+    std::uint32_t    occlusion_view_ = UINT32_MAX;
+
+    // Level of detail per model draw, by draw order. Scenes usually submit
+    // in the same order every frame, which is all hysteresis needs.
+    std::vector<lod_state> lod_history_;
+    std::vector<lod_state> lod_current_;
+
+    // Upload ring shared by meshes and textures, flushed once per frame and
+    // once per model load
+    staging_ring  staging_;
+    staging_stats staging_frame_start_; // Counters at begin_frame
+
+    load_options load_options_;
+
+    // Per texture_codec, whether the device can sample it
+    std::array<bool, 4> codec_supported_ {};
+
+    // Asynchronous model loads, oldest first, until they settle
+    task_queue                               loader_;
+    std::vector<std::shared_ptr<model_load>> loads_;
+
+    // Mip residency of streamed model textures
+    texture_streamer streamer_;
+    std::size_t      texture_budget_ = std::size_t { 2048 } << 20;
+
+    // Shared vertex/index buffers, one arena per vertex format
+    mesh_arena wireframe_arena_;
+    mesh_arena textured_arena_;
+    mesh_arena packed_arena_;
 
     // Resource maps
-    std::unordered_map<mesh_handle, gpu_mesh>       meshes_;
-    std::unordered_map<model_handle, gpu_model>     models_;
-    std::unordered_map<texture_handle, gpu_texture> textures_;
+    slot_map<gpu_mesh>    meshes_;
+    slot_map<gpu_model>   models_;
+    slot_map<gpu_texture> textures_;
+
+    // Samplers shared by all textures
+    sampler_cache samplers_;
 
     // Default white texture for untextured models
     texture_handle default_texture_ = invalid_texture;
@@ -301,6 +823,7 @@ private:
     SDL_GPUTexture* depth_texture_ = nullptr;
     Uint32          depth_width_   = 0;
     Uint32          depth_height_  = 0;
+    Uint32          view_height_   = 0; // Scene viewport, see begin_frame
 
     // MSAA render targets (when MSAA > 1)
     SDL_GPUTexture* msaa_color_texture_   = nullptr;
@@ -315,13 +838,33 @@ private:
     Uint32          pp_width_         = 0;
     Uint32          pp_height_        = 0;
 
-    // Handle generators
-    std::uint64_t next_mesh_handle_    = 1;
-    std::uint64_t next_model_handle_   = 1;
-    std::uint64_t next_texture_handle_ = 1;
-
-    // Temporary meshes for debug drawing (cleaned up each frame)
-    std::vector<gpu_mesh> temp_meshes_;
+    // Deferred draws for the current frame
+    render_queue           draw_queue_;
+    std::vector<draw_item> draw_items_;
+    std::vector<glm::mat4> frame_matrices_;
+    std::uint32_t          view_proj_matrix_ = UINT32_MAX; // Cached index
+    std::uint32_t          next_mesh_id_     = 1;
+
+    // Instanced submission: batches are built by prepare_frame
+    std::vector<draw_batch> draw_batches_;
+    std::vector<glm::mat4>  instance_matrices_;
+    SDL_GPUBuffer*          instance_buffer_          = nullptr;
+    SDL_GPUTransferBuffer*  instance_transfer_buffer_ = nullptr;
+    Uint32                  instance_capacity_        = 0; // In matrices
+
+    // Material table shared by all models, uploaded when models load.
+    // Entry 0 is a neutral material for draws that have none.
+    std::vector<gpu_material>  materials_;
+    std::vector<std::uint32_t> free_materials_; // Released entries for reuse
+    SDL_GPUBuffer*             material_buffer_   = nullptr;
+    Uint32                     material_capacity_ = 0; // In materials
+
+    // Immediate-mode debug lines, both depth modes share the budget
+    static constexpr std::uint32_t k_debug_line_budget = 64 * 1024;
+    debug_line_batch       debug_lines_ { k_debug_line_budget };
+    SDL_GPUBuffer*         debug_vertex_buffer_   = nullptr;
+    SDL_GPUTransferBuffer* debug_transfer_buffer_ = nullptr;
+    bool                   debug_lines_uploaded_  = false;
 
     // Per-frame statistics
     mutable render_stats frame_stats_ {};
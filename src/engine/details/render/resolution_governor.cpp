@@ -0,0 +1,94 @@
+/// @file resolution_governor.cpp
+/// @brief PID control of the render scale from smoothed frame times
+
+#include "resolution_governor.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace egen
+{
+
+namespace
+{
+
+/// Weight of the newest frame in the smoothed frame time
+constexpr float k_frame_smoothing = 0.2f;
+
+/// Bound on the accumulated error, in budgets, against integral windup
+constexpr float k_integral_limit = 4.0f;
+
+} // namespace
+
+void resolution_governor::configure(
+    const dynamic_resolution_settings& settings) noexcept
+{
+    settings_           = settings;
+    settings_.min_scale = std::clamp(settings.min_scale, 0.25f, 4.0f);
+    settings_.max_scale =
+        std::clamp(settings.max_scale, settings_.min_scale, 4.0f);
+    settings_.target_ms  = std::max(settings.target_ms, 1.0f);
+    settings_.step       = std::max(settings.step, 0.0f);
+    settings_.hysteresis = std::max(settings.hysteresis, 0.0f);
+
+    state_.scale =
+        std::clamp(state_.scale, settings_.min_scale, settings_.max_scale);
+}
+
+void resolution_governor::reset(float scale) noexcept
+{
+    state_ = dynamic_resolution_state {
+        .scale = std::clamp(scale, settings_.min_scale, settings_.max_scale),
+    };
+    primed_ = false;
+}
+
+float resolution_governor::update(float frame_ms) noexcept
+{
+    if (!(frame_ms > 0.0f) || !std::isfinite(frame_ms))
+    {
+        return state_.scale;
+    }
+
+    state_.frame_ms = primed_ ? state_.frame_ms + (k_frame_smoothing *
+                                                   (frame_ms - state_.frame_ms))
+                              : frame_ms;
+    primed_ = true;
+
+    // Positive error is headroom: the frame came in under budget
+    const float error =
+        (settings_.target_ms - state_.frame_ms) / settings_.target_ms;
+    state_.derivative = error - state_.error;
+    state_.error      = error;
+
+    // Inside the hysteresis band the scale holds, so small frame time
+    // noise does not make the resolution breathe
+    if (std::abs(error) <= settings_.hysteresis)
+    {
+        state_.output = 0.0f;
+        return state_.scale;
+    }
+
+    // Integrate only while the scale can still move in the error's
+    // direction, so a pinned scale does not wind the integral up
+    const bool pinned =
+        (error > 0.0f && state_.scale >= settings_.max_scale) ||
+        (error < 0.0f && state_.scale <= settings_.min_scale);
+    if (!pinned)
+    {
+        state_.integral = std::clamp(
+            state_.integral + error, -k_integral_limit, k_integral_limit);
+    }
+
+    const float output = (settings_.kp * error) +
+                         (settings_.ki * state_.integral) +
+                         (settings_.kd * state_.derivative);
+    const float change = std::clamp(output, -settings_.step, settings_.step);
+    const float previous = state_.scale;
+    state_.scale         = std::clamp(
+        previous + change, settings_.min_scale, settings_.max_scale);
+    state_.output = state_.scale - previous;
+    return state_.scale;
+}
+
+} // namespace egen
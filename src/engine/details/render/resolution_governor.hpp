@@ -0,0 +1,41 @@
+#pragma once
+
+/// @file resolution_governor.hpp
+/// @brief Render scale controller driven by measured frame times
+
+#include <core-api/window.hpp>
+
+namespace egen
+{
+
+/// Picks the render scale for the next frame from the time the last one
+/// took. Frame times are smoothed before the PID terms are computed, and
+/// the integral only accumulates while the scale is free to move.
+class resolution_governor final
+{
+public:
+    /// Apply new limits and gains; the current scale is clamped to them
+    void configure(const dynamic_resolution_settings& settings) noexcept;
+
+    /// Restart from a scale, dropping accumulated controller state
+    void reset(float scale) noexcept;
+
+    /// Feed the last frame's time and return the scale for the next one
+    [[nodiscard]] float update(float frame_ms) noexcept;
+
+    [[nodiscard]] const dynamic_resolution_settings& settings() const noexcept
+    {
+        return settings_;
+    }
+    [[nodiscard]] const dynamic_resolution_state& state() const noexcept
+    {
+        return state_;
+    }
+
+private:
+    dynamic_resolution_settings settings_;
+    dynamic_resolution_state    state_;
+    bool                        primed_ = false; // frame_ms holds a sample
+};
+
+} // namespace egen
@@ -83,6 +83,11 @@ void shader_system::set_reload_callback(ReloadCallback callback) noexcept
     reload_callback_ = std::move(callback);
 }
 
+void shader_system::set_pre_reload_callback(ReloadCallback callback) noexcept
+{
+    pre_reload_callback_ = std::move(callback);
+}
+
 std::expected<std::string, std::string> shader_system::read_file(
     const std::filesystem::path& path) const
 {
@@ -143,12 +148,34 @@ std::expected<SDL_GPUShader*, std::string> shader_system::compile_shader(
 
     const std::string include_dir_str = include_dir.string();
 
+    // Split "NAME=VALUE" defines; shadercross expects a null-terminated array
+    std::vector<std::string> define_names;
+    std::vector<std::string> define_values;
+    define_names.reserve(source.defines.size());
+    define_values.reserve(source.defines.size());
+    for (const auto& define : source.defines)
+    {
+        const auto eq = define.find('=');
+        define_names.push_back(define.substr(0, eq));
+        define_values.push_back(
+            eq == std::string::npos ? std::string("1") : define.substr(eq + 1));
+    }
+
+    std::vector<SDL_ShaderCross_HLSL_Define> defines;
+    defines.reserve(source.defines.size() + 1);
+    for (std::size_t i = 0; i < define_names.size(); ++i)
+    {
+        defines.push_back({ .name  = define_names[i].data(),
+                            .value = define_values[i].data() });
+    }
+    defines.push_back({ .name = nullptr, .value = nullptr });
+
     SDL_ShaderCross_HLSL_Info hlsl_info {};
     hlsl_info.source     = content_result->c_str();
     hlsl_info.entrypoint = source.entry_point.c_str();
     hlsl_info.include_dir =
         include_dir_str.empty() ? nullptr : include_dir_str.c_str();
-    hlsl_info.defines      = nullptr;
+    hlsl_info.defines      = defines.data();
     hlsl_info.shader_stage = stage;
     hlsl_info.props        = 0;
 
@@ -315,6 +342,10 @@ void shader_system::check_for_updates()
                           vertex_changed,
                           fragment_changed);
 
+            if (pre_reload_callback_)
+            {
+                pre_reload_callback_(name);
+            }
             if (reload_program(program))
             {
                 if (reload_callback_)
@@ -11,6 +11,7 @@
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace egen
 {
@@ -23,9 +24,10 @@ enum class ShaderStage
 
 struct ShaderSource
 {
-    std::filesystem::path path;
-    ShaderStage           stage;
-    std::string           entry_point = "main";
+    std::filesystem::path    path;
+    ShaderStage              stage;
+    std::string              entry_point = "main";
+    std::vector<std::string> defines; // "NAME" or "NAME=VALUE"
 };
 
 struct ShaderProgramDesc
@@ -88,6 +90,9 @@ public:
     void set_shader_directory(const std::filesystem::path& dir) noexcept;
     void check_for_updates();
     void set_reload_callback(ReloadCallback cb) noexcept;
+    /// Called before a changed program is recompiled and its old shaders
+    /// are released
+    void set_pre_reload_callback(ReloadCallback cb) noexcept;
 
     void enable_hot_reload(bool e) noexcept override
     {
@@ -112,6 +117,7 @@ private:
     std::filesystem::path                          shader_dir_;
     std::unordered_map<std::string, ShaderProgram> programs_;
     ReloadCallback                                 reload_callback_;
+    ReloadCallback                                 pre_reload_callback_;
     bool                                           hot_reload_enabled_ = true;
 };
 
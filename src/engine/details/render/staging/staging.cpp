@@ -0,0 +1,397 @@
+/// @file staging.cpp
+/// @brief Fence-reclaimed upload ring and batched copy submission
+
+#include "staging.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <cstring>
+
+namespace egen
+{
+
+namespace
+{
+
+/// Alignment of every ring allocation
+constexpr Uint32 k_buffer_alignment = 16;
+
+/// Texture copies start on the strictest placement alignment of the
+/// backends (D3D12 requires 512 bytes)
+constexpr Uint32 k_texture_alignment = 512;
+
+[[nodiscard]] constexpr std::uint64_t align_up(std::uint64_t value,
+                                               std::uint64_t alignment) noexcept
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+staging_ring::~staging_ring()
+{
+    shutdown();
+}
+
+bool staging_ring::init(SDL_GPUDevice* device, Uint32 capacity)
+{
+    device_   = device;
+    capacity_ = static_cast<Uint32>(align_up(capacity, k_texture_alignment));
+
+    SDL_GPUTransferBufferCreateInfo info {};
+    info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+    info.size  = capacity_;
+    ring_      = SDL_CreateGPUTransferBuffer(device_, &info);
+    if (ring_ == nullptr)
+    {
+        spdlog::error("== staging ring: {}", SDL_GetError());
+        capacity_ = 0;
+        return false;
+    }
+
+    head_ = 0;
+    tail_ = 0;
+    spdlog::info("=> staging ring: {} KB", capacity_ / 1024);
+    return true;
+}
+
+void staging_ring::shutdown()
+{
+    if (device_ == nullptr)
+    {
+        return;
+    }
+
+    wait_idle();
+    unmap();
+
+    pending_.clear();
+    mip_chains_.clear();
+    for (auto* tb : dedicated_)
+    {
+        SDL_ReleaseGPUTransferBuffer(device_, tb);
+    }
+    dedicated_.clear();
+
+    if (ring_ != nullptr)
+    {
+        SDL_ReleaseGPUTransferBuffer(device_, ring_);
+        ring_ = nullptr;
+    }
+    capacity_ = 0;
+    device_   = nullptr;
+}
+
+bool staging_ring::upload_to_buffer(SDL_GPUBuffer*             buffer,
+                                    Uint32                     offset,
+                                    std::span<const std::byte> data)
+{
+    if (buffer == nullptr)
+    {
+        return false;
+    }
+    if (data.empty())
+    {
+        return true;
+    }
+
+    const auto alloc = stage(data, k_buffer_alignment);
+    if (!alloc)
+    {
+        return false;
+    }
+
+    pending_.push_back({ .type            = op_type::buffer_upload,
+                         .transfer_buffer = alloc->transfer_buffer,
+                         .src_offset      = alloc->offset,
+                         .dst_buffer      = buffer,
+                         .dst_offset      = offset,
+                         .size = static_cast<Uint32>(data.size_bytes()) });
+    return true;
+}
+
+bool staging_ring::upload_to_texture(const SDL_GPUTextureRegion& region,
+                                     std::span<const std::byte>  data)
+{
+    if (region.texture == nullptr || data.empty())
+    {
+        return false;
+    }
+
+    const auto alloc = stage(data, k_texture_alignment);
+    if (!alloc)
+    {
+        return false;
+    }
+
+    pending_.push_back({ .type            = op_type::texture_upload,
+                         .transfer_buffer = alloc->transfer_buffer,
+                         .src_offset      = alloc->offset,
+                         .size   = static_cast<Uint32>(data.size_bytes()),
+                         .region = region });
+    return true;
+}
+
+void staging_ring::copy_buffer(SDL_GPUBuffer* src,
+                               Uint32         src_offset,
+                               SDL_GPUBuffer* dst,
+                               Uint32         dst_offset,
+                               Uint32         size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+    pending_.push_back({ .type       = op_type::buffer_copy,
+                         .src_buffer = src,
+                         .src_offset = src_offset,
+                         .dst_buffer = dst,
+                         .dst_offset = dst_offset,
+                         .size       = size });
+}
+
+void staging_ring::generate_mipmaps(SDL_GPUTexture* texture)
+{
+    if (texture != nullptr)
+    {
+        mip_chains_.push_back(texture);
+    }
+}
+
+void staging_ring::discard_texture(SDL_GPUTexture* texture)
+{
+    std::erase_if(pending_,
+                  [texture](const pending_op& op)
+                  {
+                      return op.type == op_type::texture_upload &&
+                             op.region.texture == texture;
+                  });
+    std::erase(mip_chains_, texture);
+}
+
+bool staging_ring::flush()
+{
+    if (!has_pending())
+    {
+        return true;
+    }
+
+    // Transfer buffers must be unmapped before a copy pass reads them
+    unmap();
+
+    auto* cmd = SDL_AcquireGPUCommandBuffer(device_);
+    if (cmd == nullptr)
+    {
+        // Keep the pending copies, the next flush retries them
+        spdlog::error("== staging flush: {}", SDL_GetError());
+        return false;
+    }
+
+    auto*         cp    = SDL_BeginGPUCopyPass(cmd);
+    std::uint64_t bytes = 0;
+    for (const auto& op : pending_)
+    {
+        switch (op.type)
+        {
+            case op_type::buffer_upload:
+            {
+                const SDL_GPUTransferBufferLocation src {
+                    .transfer_buffer = op.transfer_buffer,
+                    .offset          = op.src_offset
+                };
+                const SDL_GPUBufferRegion dst { .buffer = op.dst_buffer,
+                                                .offset = op.dst_offset,
+                                                .size   = op.size };
+                SDL_UploadToGPUBuffer(cp, &src, &dst, false);
+                bytes += op.size;
+                break;
+            }
+            case op_type::texture_upload:
+            {
+                SDL_GPUTextureTransferInfo src {};
+                src.transfer_buffer = op.transfer_buffer;
+                src.offset          = op.src_offset;
+                SDL_UploadToGPUTexture(cp, &src, &op.region, false);
+                bytes += op.size;
+                break;
+            }
+            case op_type::buffer_copy:
+            {
+                const SDL_GPUBufferLocation src { .buffer = op.src_buffer,
+                                                  .offset = op.src_offset };
+                const SDL_GPUBufferLocation dst { .buffer = op.dst_buffer,
+                                                  .offset = op.dst_offset };
+                SDL_CopyGPUBufferToBuffer(cp, &src, &dst, op.size, false);
+                break;
+            }
+        }
+    }
+    SDL_EndGPUCopyPass(cp);
+
+    // Blits between levels, must run outside any pass
+    for (auto* tex : mip_chains_)
+    {
+        SDL_GenerateMipmapsForGPUTexture(cmd, tex);
+    }
+
+    auto* fence = SDL_SubmitGPUCommandBufferAndAcquireFence(cmd);
+    pending_.clear();
+    mip_chains_.clear();
+
+    // Dedicated buffers are destroyed once the submission completes
+    for (auto* tb : dedicated_)
+    {
+        SDL_ReleaseGPUTransferBuffer(device_, tb);
+    }
+    dedicated_.clear();
+
+    ++stats_.submissions;
+    stats_.bytes_uploaded += bytes;
+
+    if (fence == nullptr)
+    {
+        // Without a fence there is no way to tell when the ring is free
+        spdlog::warn("== staging fence: {}", SDL_GetError());
+        SDL_WaitForGPUIdle(device_);
+        reclaim();
+        tail_ = head_;
+        return true;
+    }
+
+    in_flight_.push_back({ .fence = fence, .end = head_ });
+    return true;
+}
+
+void staging_ring::reclaim()
+{
+    while (!in_flight_.empty() &&
+           SDL_QueryGPUFence(device_, in_flight_.front().fence))
+    {
+        SDL_ReleaseGPUFence(device_, in_flight_.front().fence);
+        tail_ = in_flight_.front().end;
+        in_flight_.pop_front();
+    }
+}
+
+void staging_ring::wait_idle()
+{
+    while (!in_flight_.empty())
+    {
+        wait_oldest();
+    }
+}
+
+std::optional<staging_ring::staging_alloc> staging_ring::stage(
+    std::span<const std::byte> data, Uint32 alignment)
+{
+    const auto size = static_cast<Uint32>(data.size_bytes());
+
+    // Oversized uploads would monopolise the ring, give them their own buffer
+    if (size > capacity_ / 2)
+    {
+        SDL_GPUTransferBufferCreateInfo info {};
+        info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+        info.size  = size;
+        auto* tb   = SDL_CreateGPUTransferBuffer(device_, &info);
+        if (tb == nullptr)
+        {
+            spdlog::error("== staging buffer: {}", SDL_GetError());
+            return std::nullopt;
+        }
+        auto* ptr = SDL_MapGPUTransferBuffer(device_, tb, false);
+        if (ptr == nullptr)
+        {
+            SDL_ReleaseGPUTransferBuffer(device_, tb);
+            return std::nullopt;
+        }
+        std::memcpy(ptr, data.data(), size);
+        SDL_UnmapGPUTransferBuffer(device_, tb);
+
+        dedicated_.push_back(tb);
+        ++stats_.dedicated;
+        return staging_alloc { .transfer_buffer = tb, .offset = 0 };
+    }
+
+    const auto offset = reserve(size, alignment);
+    if (!offset)
+    {
+        return std::nullopt;
+    }
+
+    // The GPU only reads ring space behind tail_, so mapping without
+    // cycling is safe while earlier batches are still in flight
+    if (mapped_ == nullptr)
+    {
+        mapped_ = static_cast<std::byte*>(
+            SDL_MapGPUTransferBuffer(device_, ring_, false));
+        if (mapped_ == nullptr)
+        {
+            spdlog::error("== staging map: {}", SDL_GetError());
+            return std::nullopt;
+        }
+    }
+    std::memcpy(mapped_ + *offset, data.data(), size);
+    return staging_alloc { .transfer_buffer = ring_, .offset = *offset };
+}
+
+std::optional<Uint32> staging_ring::reserve(Uint32 size, Uint32 alignment)
+{
+    if (ring_ == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    for (;;)
+    {
+        reclaim();
+
+        // Skip the tail end of the ring if the allocation would straddle it
+        auto       pos    = align_up(head_, alignment);
+        const auto offset = pos % capacity_;
+        if (offset + size > capacity_)
+        {
+            pos += capacity_ - offset;
+        }
+
+        if (pos + size - tail_ <= capacity_)
+        {
+            head_ = pos + size;
+            return static_cast<Uint32>(pos % capacity_);
+        }
+
+        // Ring full: submit what is queued so its space can be reclaimed,
+        // then wait for the oldest batch
+        if (!pending_.empty() && !flush())
+        {
+            return std::nullopt;
+        }
+        if (in_flight_.empty())
+        {
+            // Everything submitted has completed, restart at the front
+            tail_ = head_;
+            continue;
+        }
+        ++stats_.stalls;
+        wait_oldest();
+    }
+}
+
+void staging_ring::wait_oldest()
+{
+    auto* fence = in_flight_.front().fence;
+    SDL_WaitForGPUFences(device_, true, &fence, 1);
+    SDL_ReleaseGPUFence(device_, fence);
+    tail_ = in_flight_.front().end;
+    in_flight_.pop_front();
+}
+
+void staging_ring::unmap()
+{
+    if (mapped_ != nullptr)
+    {
+        SDL_UnmapGPUTransferBuffer(device_, ring_);
+        mapped_ = nullptr;
+    }
+}
+
+} // namespace egen
@@ -0,0 +1,165 @@
+#pragma once
+
+/// @file staging.hpp
+/// @brief Persistent upload ring that batches GPU copies into one submission
+
+#include <SDL3/SDL_gpu.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace egen
+{
+
+/// Cumulative staging counters since init
+struct staging_stats final
+{
+    std::uint64_t bytes_uploaded = 0; // Bytes copied out of staging memory
+    std::uint32_t submissions    = 0; // Copy command buffers submitted
+    std::uint32_t dedicated      = 0; // Uploads too large for the ring
+    std::uint32_t stalls         = 0; // Waits on the GPU for ring space
+};
+
+/// Upload ring over one persistently allocated transfer buffer.
+///
+/// Uploads are written into the ring immediately and recorded as pending
+/// copies; flush() replays every pending copy in a single copy pass on its
+/// own command buffer and submits it with a fence. Ring space is reclaimed
+/// once the fence of the submission that read it has signalled. Buffer to
+/// buffer copies go through the same queue so they stay ordered with the
+/// uploads around them. Uploads larger than half the ring get a dedicated
+/// transfer buffer that is released after submission. Mip chain generation
+/// is recorded on the same command buffer after the copy pass, so it reads
+/// the freshly uploaded base level.
+///
+/// Queued destinations must stay alive until the next flush(); textures
+/// released before then must be passed to discard_texture() first.
+class staging_ring final
+{
+public:
+    staging_ring() = default;
+    ~staging_ring();
+
+    staging_ring(const staging_ring&)            = delete;
+    staging_ring& operator=(const staging_ring&) = delete;
+    staging_ring(staging_ring&&)                 = delete;
+    staging_ring& operator=(staging_ring&&)      = delete;
+
+    /// @param capacity Ring size in bytes
+    [[nodiscard]] bool init(SDL_GPUDevice* device, Uint32 capacity);
+
+    /// Wait for in-flight copies and release the ring. Pending uploads that
+    /// were never flushed are dropped.
+    void shutdown();
+
+    /// Queue a copy of data into a GPU buffer
+    [[nodiscard]] bool upload_to_buffer(SDL_GPUBuffer*             buffer,
+                                        Uint32                     offset,
+                                        std::span<const std::byte> data);
+
+    /// Queue a copy of tightly packed texels into a texture region
+    [[nodiscard]] bool upload_to_texture(const SDL_GPUTextureRegion& region,
+                                         std::span<const std::byte>  data);
+
+    /// Queue a GPU-side buffer to buffer copy
+    void copy_buffer(SDL_GPUBuffer* src,
+                     Uint32         src_offset,
+                     SDL_GPUBuffer* dst,
+                     Uint32         dst_offset,
+                     Uint32         size);
+
+    /// Queue filling levels 1..n of a texture from its base level. The
+    /// texture needs SAMPLER and COLOR_TARGET usage.
+    void generate_mipmaps(SDL_GPUTexture* texture);
+
+    /// Drop pending uploads and mip generation for a texture that is about
+    /// to be released. Its staging space is reclaimed with the next batch.
+    void discard_texture(SDL_GPUTexture* texture);
+
+    /// Submit all pending copies as one command buffer. No-op when empty.
+    bool flush();
+
+    /// Release ring space used by submissions the GPU has finished
+    void reclaim();
+
+    /// Block until every submitted copy has completed
+    void wait_idle();
+
+    [[nodiscard]] bool has_pending() const noexcept
+    {
+        return !pending_.empty() || !mip_chains_.empty();
+    }
+    [[nodiscard]] const staging_stats& stats() const noexcept
+    {
+        return stats_;
+    }
+
+private:
+    enum class op_type : std::uint8_t
+    {
+        buffer_upload,
+        texture_upload,
+        buffer_copy,
+    };
+
+    /// One recorded copy, replayed in order on flush
+    struct pending_op final
+    {
+        op_type                type = op_type::buffer_upload;
+        SDL_GPUTransferBuffer* transfer_buffer = nullptr;
+        SDL_GPUBuffer*         src_buffer      = nullptr; // buffer_copy only
+        Uint32                 src_offset      = 0;
+        SDL_GPUBuffer*         dst_buffer      = nullptr;
+        Uint32                 dst_offset      = 0;
+        Uint32                 size            = 0;
+        SDL_GPUTextureRegion   region {}; // texture_upload only
+    };
+
+    /// Submitted batch, its ring space is free once the fence signals
+    struct in_flight_batch final
+    {
+        SDL_GPUFence* fence = nullptr;
+        std::uint64_t end   = 0; // Ring position after the batch
+    };
+
+    /// Staging memory for one upload
+    struct staging_alloc final
+    {
+        SDL_GPUTransferBuffer* transfer_buffer = nullptr;
+        Uint32                 offset          = 0;
+    };
+
+    /// Copy data into ring or dedicated staging memory
+    [[nodiscard]] std::optional<staging_alloc> stage(
+        std::span<const std::byte> data, Uint32 alignment);
+
+    /// Reserve ring space, flushing and waiting for the GPU when full.
+    /// @return Offset into the ring buffer
+    [[nodiscard]] std::optional<Uint32> reserve(Uint32 size, Uint32 alignment);
+
+    /// Wait for the oldest in-flight batch
+    void wait_oldest();
+
+    void unmap();
+
+    SDL_GPUDevice*         device_   = nullptr;
+    SDL_GPUTransferBuffer* ring_     = nullptr;
+    std::byte*             mapped_   = nullptr;
+    Uint32                 capacity_ = 0;
+
+    // Monotonic byte positions, the ring offset is position % capacity
+    std::uint64_t head_ = 0; // Next write
+    std::uint64_t tail_ = 0; // Oldest byte the GPU may still read
+
+    std::vector<pending_op>             pending_;
+    std::vector<SDL_GPUTransferBuffer*> dedicated_; // Released after flush
+    std::vector<SDL_GPUTexture*>        mip_chains_; // Generated after copies
+    std::deque<in_flight_batch>         in_flight_;
+    staging_stats                       stats_;
+};
+
+} // namespace egen
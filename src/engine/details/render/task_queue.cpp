@@ -0,0 +1,80 @@
+/// @file task_queue.cpp
+/// @brief Background worker threads pulling from a task queue
+
+#include "task_queue.hpp"
+
+#include "core-api/profiler.hpp"
+
+#include <string>
+#include <utility>
+
+namespace egen
+{
+
+task_queue::~task_queue()
+{
+    shutdown();
+}
+
+void task_queue::init(std::size_t threads)
+{
+    shutdown();
+
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        workers_.emplace_back([this, i](const std::stop_token& stop)
+                              { worker_loop(stop, i); });
+    }
+}
+
+void task_queue::shutdown()
+{
+    {
+        const std::lock_guard lock(mutex_);
+        tasks_.clear();
+    }
+    // Each jthread requests stop and joins as it is destroyed; the stop
+    // wakes the wake_.wait in worker_loop, which then returns
+    workers_.clear();
+}
+
+void task_queue::submit(task fn)
+{
+    {
+        const std::lock_guard lock(mutex_);
+        tasks_.push_back(std::move(fn));
+    }
+    wake_.notify_one();
+}
+
+void task_queue::worker_loop(const std::stop_token& stop, std::size_t index)
+{
+    const auto name  = "Loader " + std::to_string(index);
+    bool       named = false;
+    for (;;)
+    {
+        task fn;
+        {
+            std::unique_lock lock(mutex_);
+            if (!wake_.wait(lock, stop, [this] { return !tasks_.empty(); }))
+            {
+                return; // Stop requested
+            }
+            fn = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        if (!named && profiler_ != nullptr)
+        {
+            profiler_->set_thread_name(name.c_str());
+            named = true;
+        }
+
+        [[maybe_unused]] auto profiler_zone =
+            profiler_zone_begin(profiler_, "task_queue::task");
+        fn();
+    }
+}
+
+} // namespace egen
@@ -0,0 +1,60 @@
+#pragma once
+
+/// @file task_queue.hpp
+/// @brief Background worker threads for long-running tasks such as loads
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace egen
+{
+
+class i_profiler;
+
+/// First-in, first-out queue of independent tasks run on a few background
+/// threads. Unlike job_system, submitting never waits: tasks run for as
+/// long as they need and report back through state they share with the
+/// submitter.
+class task_queue final
+{
+public:
+    using task = std::function<void()>;
+
+    task_queue() = default;
+    ~task_queue();
+
+    task_queue(const task_queue&)            = delete;
+    task_queue& operator=(const task_queue&) = delete;
+    task_queue(task_queue&&)                 = delete;
+    task_queue& operator=(task_queue&&)      = delete;
+
+    /// Start the worker threads
+    void init(std::size_t threads);
+
+    /// Drop tasks that have not started and join the workers once their
+    /// current tasks return
+    void shutdown();
+
+    /// Queue a task; it runs on a worker, never on the calling thread
+    void submit(task fn);
+
+    /// Profiler for thread names, set while no task is queued
+    void set_profiler(i_profiler* profiler) noexcept { profiler_ = profiler; }
+
+private:
+    void worker_loop(const std::stop_token& stop, std::size_t index);
+
+    i_profiler*               profiler_ = nullptr;
+    std::vector<std::jthread> workers_;
+
+    std::mutex                  mutex_;
+    std::condition_variable_any wake_;
+    std::deque<task>            tasks_;
+};
+
+} // namespace egen
@@ -0,0 +1,69 @@
+/// @file sampler_cache.cpp
+/// @brief Shared sampler creation and release
+
+#include "sampler_cache.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace egen
+{
+
+sampler_cache::~sampler_cache()
+{
+    shutdown();
+}
+
+void sampler_cache::shutdown()
+{
+    clear();
+    device_ = nullptr;
+}
+
+SDL_GPUSampler* sampler_cache::get(const sampler_key& key)
+{
+    const auto it = std::ranges::find(entries_, key, &entry::first);
+    if (it != entries_.end())
+    {
+        return it->second;
+    }
+    if (device_ == nullptr)
+    {
+        return nullptr;
+    }
+
+    SDL_GPUSamplerCreateInfo info {};
+    info.min_filter        = key.min_filter;
+    info.mag_filter        = key.mag_filter;
+    info.mipmap_mode       = key.mipmap_mode;
+    info.address_mode_u    = key.address_u;
+    info.address_mode_v    = key.address_v;
+    info.address_mode_w    = key.address_w;
+    info.mip_lod_bias      = key.mip_lod_bias;
+    info.max_anisotropy    = key.max_anisotropy;
+    info.enable_anisotropy = key.max_anisotropy > 1.0f;
+    // Shared across textures with any level count, the texture clamps
+    info.max_lod = 1000.0f;
+
+    auto* sampler = SDL_CreateGPUSampler(device_, &info);
+    if (sampler == nullptr)
+    {
+        spdlog::error("== sampler: {}", SDL_GetError());
+        return nullptr;
+    }
+
+    entries_.emplace_back(key, sampler);
+    return sampler;
+}
+
+void sampler_cache::clear()
+{
+    for (auto& [key, sampler] : entries_)
+    {
+        SDL_ReleaseGPUSampler(device_, sampler);
+    }
+    entries_.clear();
+}
+
+} // namespace egen
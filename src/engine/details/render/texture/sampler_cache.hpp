@@ -0,0 +1,66 @@
+#pragma once
+
+/// @file sampler_cache.hpp
+/// @brief Shared GPU samplers keyed by their sampling state
+
+#include <SDL3/SDL_gpu.h>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace egen
+{
+
+/// Sampling state that identifies one shared sampler
+struct sampler_key final
+{
+    SDL_GPUFilter             min_filter  = SDL_GPU_FILTER_LINEAR;
+    SDL_GPUFilter             mag_filter  = SDL_GPU_FILTER_LINEAR;
+    SDL_GPUSamplerMipmapMode  mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_LINEAR;
+    SDL_GPUSamplerAddressMode address_u   = SDL_GPU_SAMPLERADDRESSMODE_REPEAT;
+    SDL_GPUSamplerAddressMode address_v   = SDL_GPU_SAMPLERADDRESSMODE_REPEAT;
+    SDL_GPUSamplerAddressMode address_w   = SDL_GPU_SAMPLERADDRESSMODE_REPEAT;
+    float max_anisotropy = 1.0f; // 1 or less disables anisotropic filtering
+    float mip_lod_bias   = 0.0f;
+
+    [[nodiscard]] bool operator==(const sampler_key&) const = default;
+};
+
+/// Creates each distinct sampler once and hands out the shared object.
+/// A scene only uses a handful of sampling states, so entries are kept in
+/// a flat list and found by linear search.
+class sampler_cache final
+{
+public:
+    sampler_cache() = default;
+    ~sampler_cache();
+
+    sampler_cache(const sampler_cache&)            = delete;
+    sampler_cache& operator=(const sampler_cache&) = delete;
+    sampler_cache(sampler_cache&&)                 = delete;
+    sampler_cache& operator=(sampler_cache&&)      = delete;
+
+    void init(SDL_GPUDevice* device) noexcept { device_ = device; }
+
+    /// Release every sampler
+    void shutdown();
+
+    /// Shared sampler for key, created on first use
+    /// @return Sampler, or nullptr if creation failed
+    [[nodiscard]] SDL_GPUSampler* get(const sampler_key& key);
+
+    /// Release every sampler, e.g. after a quality change made them stale.
+    /// Pointers returned by get() are invalid afterwards.
+    void clear();
+
+    [[nodiscard]] std::size_t size() const noexcept { return entries_.size(); }
+
+private:
+    using entry = std::pair<sampler_key, SDL_GPUSampler*>;
+
+    SDL_GPUDevice*     device_ = nullptr;
+    std::vector<entry> entries_;
+};
+
+} // namespace egen
@@ -3,105 +3,222 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "staging.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
 #include <cstring>
 #include <format>
+#include <span>
 
 namespace egen
 {
 
-std::expected<texture_data, std::string> load_texture(
-    SDL_GPUDevice*               device,
-    const std::filesystem::path& path,
-    bool                         flip_vertical)
+namespace
 {
-    if (device == nullptr)
-    {
-        return std::unexpected("null device");
-    }
-    if (path.empty() || !std::filesystem::exists(path))
-    {
-        return std::unexpected(
-            std::format("file not found: {}", path.string()));
-    }
 
-    std::int32_t w  = 0;
-    std::int32_t h  = 0;
-    std::int32_t ch = 0;
+/// Number of levels in a full mip chain down to 1x1
+[[nodiscard]] Uint32 full_mip_count(std::int32_t w, std::int32_t h) noexcept
+{
+    const auto largest = static_cast<std::uint32_t>(std::max({ w, h, 1 }));
+    return static_cast<Uint32>(std::bit_width(largest));
+}
 
-    stbi_set_flip_vertically_on_load(flip_vertical ? 1 : 0);
-    auto* pixels = stbi_load(path.c_str(), &w, &h, &ch, 4);
-    if (pixels == nullptr)
+/// GPU format a codec's blocks are sampled as
+[[nodiscard]] SDL_GPUTextureFormat format_of(texture_codec codec) noexcept
+{
+    switch (codec)
     {
-        return std::unexpected(
-            std::format("stbi_load failed: {}", stbi_failure_reason()));
+        case texture_codec::bc4:
+            return SDL_GPU_TEXTUREFORMAT_BC4_R_UNORM;
+        case texture_codec::bc5:
+            return SDL_GPU_TEXTUREFORMAT_BC5_RG_UNORM;
+        case texture_codec::bc7:
+            return SDL_GPU_TEXTUREFORMAT_BC7_RGBA_UNORM;
+        case texture_codec::none:
+            break;
     }
+    return SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+}
 
-    // Create GPU texture
+/// Create a 2D array texture. Sampled textures are all arrays, so one
+/// shader reads both packed and standalone ones.
+/// @param generated Whether the levels past the first are filled by GPU
+/// mip generation rather than uploaded
+[[nodiscard]] std::expected<SDL_GPUTexture*, std::string> create_array(
+    SDL_GPUDevice* device,
+    texture_codec  codec,
+    std::int32_t   w,
+    std::int32_t   h,
+    Uint32         levels,
+    Uint32         layers,
+    bool           generated)
+{
     SDL_GPUTextureCreateInfo tex_info {};
-    tex_info.type                 = SDL_GPU_TEXTURETYPE_2D;
-    tex_info.format               = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
-    tex_info.usage                = SDL_GPU_TEXTUREUSAGE_SAMPLER;
+    tex_info.type   = SDL_GPU_TEXTURETYPE_2D_ARRAY;
+    tex_info.format = format_of(codec);
+    tex_info.usage  = SDL_GPU_TEXTUREUSAGE_SAMPLER;
+    if (generated && levels > 1)
+    {
+        // Mip generation blits into each level as a render target
+        tex_info.usage |= SDL_GPU_TEXTUREUSAGE_COLOR_TARGET;
+    }
     tex_info.width                = static_cast<Uint32>(w);
     tex_info.height               = static_cast<Uint32>(h);
-    tex_info.layer_count_or_depth = 1;
-    tex_info.num_levels           = 1;
+    tex_info.layer_count_or_depth = layers;
+    tex_info.num_levels           = levels;
     tex_info.sample_count         = SDL_GPU_SAMPLECOUNT_1;
 
     auto* tex = SDL_CreateGPUTexture(device, &tex_info);
     if (tex == nullptr)
     {
-        stbi_image_free(pixels);
         return std::unexpected(
             std::format("SDL_CreateGPUTexture: {}", SDL_GetError()));
     }
+    return tex;
+}
+
+/// Queue one level of one layer on the staging ring
+[[nodiscard]] bool stage_level(staging_ring&              staging,
+                               SDL_GPUTexture*            tex,
+                               Uint32                     layer,
+                               Uint32                     level,
+                               std::span<const std::byte> data,
+                               std::int32_t               w,
+                               std::int32_t               h)
+{
+    SDL_GPUTextureRegion dst {};
+    dst.texture   = tex;
+    dst.mip_level = level;
+    dst.layer     = layer;
+    dst.w         = static_cast<Uint32>(w);
+    dst.h         = static_cast<Uint32>(h);
+    dst.d         = 1;
+    return staging.upload_to_texture(dst, data);
+}
+
+/// Queue the levels an image carries from first_level on into one layer,
+/// first_level becoming the texture's level 0
+[[nodiscard]] bool stage_image(staging_ring&     staging,
+                               SDL_GPUTexture*   tex,
+                               Uint32            layer,
+                               const image_data& image,
+                               Uint32            first_level)
+{
+    std::span<const std::byte> rest = image.pixels;
+    for (Uint32 level = 0; level < image.levels; ++level)
+    {
+        const auto w    = std::max(image.width >> level, 1);
+        const auto h    = std::max(image.height >> level, 1);
+        const auto size = level_size(image.codec, w, h);
+        if (size > rest.size())
+        {
+            return false;
+        }
+        if (level >= first_level &&
+            !stage_level(staging,
+                         tex,
+                         layer,
+                         level - first_level,
+                         rest.first(size),
+                         w,
+                         h))
+        {
+            return false;
+        }
+        rest = rest.subspan(size);
+    }
+    return true;
+}
 
-    // Create sampler with linear filtering
-    SDL_GPUSamplerCreateInfo samp_info {};
-    samp_info.min_filter     = SDL_GPU_FILTER_LINEAR;
-    samp_info.mag_filter     = SDL_GPU_FILTER_LINEAR;
-    samp_info.mipmap_mode    = SDL_GPU_SAMPLERMIPMAPMODE_LINEAR;
-    samp_info.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_REPEAT;
-    samp_info.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_REPEAT;
-    samp_info.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_REPEAT;
-    auto* samp               = SDL_CreateGPUSampler(device, &samp_info);
-
-    const auto data_size = static_cast<Uint32>(w * h * 4);
-
-    // Create transfer buffer and upload pixel data
-    SDL_GPUTransferBufferCreateInfo tb_info {};
-    tb_info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-    tb_info.size  = data_size;
-    auto* tb      = SDL_CreateGPUTransferBuffer(device, &tb_info);
-    auto* ptr     = SDL_MapGPUTransferBuffer(device, tb, false);
-    std::memcpy(ptr, pixels, data_size);
-    SDL_UnmapGPUTransferBuffer(device, tb);
+/// Levels the texture of an image gets: single-level RGBA8 images get a
+/// full chain generated on the GPU, others the levels they carry
+[[nodiscard]] Uint32 texture_levels(const image_data& image) noexcept
+{
+    return image.codec == texture_codec::none && image.levels == 1
+               ? full_mip_count(image.width, image.height)
+               : image.levels;
+}
+
+/// Create an RGBA8 texture and queue its pixels on the staging ring. With
+/// more than one level, the chain is generated on the GPU from the upload.
+[[nodiscard]] std::expected<SDL_GPUTexture*, std::string> create_rgba_texture(
+    SDL_GPUDevice* device,
+    staging_ring&  staging,
+    const void*    pixels,
+    std::int32_t   w,
+    std::int32_t   h,
+    Uint32         levels)
+{
+    auto tex =
+        create_array(device, texture_codec::none, w, h, levels, 1, true);
+    if (!tex)
+    {
+        return tex;
+    }
+    const std::span data { static_cast<const std::byte*>(pixels),
+                           level_size(texture_codec::none, w, h) };
+    if (!stage_level(staging, *tex, 0, 0, data, w, h))
+    {
+        SDL_ReleaseGPUTexture(device, *tex);
+        return std::unexpected("texture staging failed");
+    }
+    if (levels > 1)
+    {
+        staging.generate_mipmaps(*tex);
+    }
+    return tex;
+}
+
+/// Take ownership of stb_image's RGBA8 result
+[[nodiscard]] image_data take_pixels(stbi_uc* pixels, int w, int h)
+{
+    const auto size = static_cast<std::size_t>(w) *
+                      static_cast<std::size_t>(h) * 4;
+    image_data image { .pixels = std::vector<std::byte>(size),
+                       .width  = w,
+                       .height = h };
+    std::memcpy(image.pixels.data(), pixels, size);
     stbi_image_free(pixels);
+    return image;
+}
 
-    // Submit upload command
-    auto* cmd = SDL_AcquireGPUCommandBuffer(device);
-    auto* cp  = SDL_BeginGPUCopyPass(cmd);
+} // namespace
 
-    SDL_GPUTextureTransferInfo src {};
-    src.transfer_buffer = tb;
-    src.offset          = 0;
-    SDL_GPUTextureRegion dst {};
-    dst.texture = tex;
-    dst.w       = static_cast<Uint32>(w);
-    dst.h       = static_cast<Uint32>(h);
-    dst.d       = 1;
-    SDL_UploadToGPUTexture(cp, &src, &dst, false);
+std::size_t level_size(texture_codec codec,
+                       std::int32_t  w,
+                       std::int32_t  h) noexcept
+{
+    if (codec == texture_codec::none)
+    {
+        return static_cast<std::size_t>(w) * static_cast<std::size_t>(h) * 4;
+    }
+    return compressed_size(codec, w, h);
+}
 
-    SDL_EndGPUCopyPass(cp);
-    SDL_SubmitGPUCommandBuffer(cmd);
-    SDL_ReleaseGPUTransferBuffer(device, tb);
+std::expected<texture_data, std::string> load_texture(
+    SDL_GPUDevice*               device,
+    staging_ring&                staging,
+    const std::filesystem::path& path,
+    bool                         flip_vertical)
+{
+    if (device == nullptr)
+    {
+        return std::unexpected("null device");
+    }
 
-    return texture_data {
-        .texture = tex, .sampler = samp, .width = w, .height = h
-    };
+    auto image = decode_image(path, flip_vertical);
+    if (!image)
+    {
+        return std::unexpected(image.error());
+    }
+    return create_texture(device, staging, *image);
 }
 
 std::expected<texture_data, std::string> load_texture_from_memory(
     SDL_GPUDevice* device,
+    staging_ring&  staging,
     const void*    data,
     std::size_t    size,
     bool           flip_vertical)
@@ -110,6 +227,41 @@ std::expected<texture_data, std::string> load_texture_from_memory(
     {
         return std::unexpected("null device");
     }
+
+    auto image = decode_image_from_memory(data, size, flip_vertical);
+    if (!image)
+    {
+        return std::unexpected(image.error());
+    }
+    return create_texture(device, staging, *image);
+}
+
+std::expected<image_data, std::string> decode_image(
+    const std::filesystem::path& path, bool flip_vertical)
+{
+    if (path.empty() || !std::filesystem::exists(path))
+    {
+        return std::unexpected(
+            std::format("file not found: {}", path.string()));
+    }
+
+    std::int32_t w  = 0;
+    std::int32_t h  = 0;
+    std::int32_t ch = 0;
+
+    stbi_set_flip_vertically_on_load_thread(flip_vertical ? 1 : 0);
+    auto* pixels = stbi_load(path.c_str(), &w, &h, &ch, 4);
+    if (pixels == nullptr)
+    {
+        return std::unexpected(
+            std::format("stbi_load failed: {}", stbi_failure_reason()));
+    }
+    return take_pixels(pixels, w, h);
+}
+
+std::expected<image_data, std::string> decode_image_from_memory(
+    const void* data, std::size_t size, bool flip_vertical)
+{
     if (data == nullptr || size == 0)
     {
         return std::unexpected("invalid data or size");
@@ -119,7 +271,7 @@ std::expected<texture_data, std::string> load_texture_from_memory(
     std::int32_t h  = 0;
     std::int32_t ch = 0;
 
-    stbi_set_flip_vertically_on_load(flip_vertical ? 1 : 0);
+    stbi_set_flip_vertically_on_load_thread(flip_vertical ? 1 : 0);
     auto* pixels = stbi_load_from_memory(static_cast<const stbi_uc*>(data),
                                          static_cast<int>(size),
                                          &w,
@@ -131,73 +283,138 @@ std::expected<texture_data, std::string> load_texture_from_memory(
         return std::unexpected(std::format("stbi_load_from_memory failed: {}",
                                            stbi_failure_reason()));
     }
+    return take_pixels(pixels, w, h);
+}
 
-    // Create GPU texture
-    SDL_GPUTextureCreateInfo tex_info {};
-    tex_info.type                 = SDL_GPU_TEXTURETYPE_2D;
-    tex_info.format               = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
-    tex_info.usage                = SDL_GPU_TEXTUREUSAGE_SAMPLER;
-    tex_info.width                = static_cast<Uint32>(w);
-    tex_info.height               = static_cast<Uint32>(h);
-    tex_info.layer_count_or_depth = 1;
-    tex_info.num_levels           = 1;
-    tex_info.sample_count         = SDL_GPU_SAMPLECOUNT_1;
+bool supports_codec(SDL_GPUDevice* device, texture_codec codec)
+{
+    if (codec == texture_codec::none)
+    {
+        return true;
+    }
+    return device != nullptr &&
+           SDL_GPUTextureSupportsFormat(device,
+                                        format_of(codec),
+                                        SDL_GPU_TEXTURETYPE_2D_ARRAY,
+                                        SDL_GPU_TEXTUREUSAGE_SAMPLER);
+}
 
-    auto* tex = SDL_CreateGPUTexture(device, &tex_info);
-    if (tex == nullptr)
+std::expected<texture_data, std::string> create_texture(
+    SDL_GPUDevice* device, staging_ring& staging, const image_data& image)
+{
+    if (device == nullptr)
     {
-        stbi_image_free(pixels);
-        return std::unexpected(
-            std::format("SDL_CreateGPUTexture: {}", SDL_GetError()));
+        return std::unexpected("null device");
+    }
+    if (image.pixels.empty())
+    {
+        return std::unexpected("empty image");
     }
 
-    // Create sampler with linear filtering
-    SDL_GPUSamplerCreateInfo samp_info {};
-    samp_info.min_filter     = SDL_GPU_FILTER_LINEAR;
-    samp_info.mag_filter     = SDL_GPU_FILTER_LINEAR;
-    samp_info.mipmap_mode    = SDL_GPU_SAMPLERMIPMAPMODE_LINEAR;
-    samp_info.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_REPEAT;
-    samp_info.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_REPEAT;
-    samp_info.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_REPEAT;
-    auto* samp               = SDL_CreateGPUSampler(device, &samp_info);
-
-    const auto data_size = static_cast<Uint32>(w * h * 4);
-
-    // Create transfer buffer and upload pixel data
-    SDL_GPUTransferBufferCreateInfo tb_info {};
-    tb_info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-    tb_info.size  = data_size;
-    auto* tb      = SDL_CreateGPUTransferBuffer(device, &tb_info);
-    auto* ptr     = SDL_MapGPUTransferBuffer(device, tb, false);
-    std::memcpy(ptr, pixels, data_size);
-    SDL_UnmapGPUTransferBuffer(device, tb);
-    stbi_image_free(pixels);
+    if (image.codec == texture_codec::none)
+    {
+        const auto levels = full_mip_count(image.width, image.height);
+        auto       tex    = create_rgba_texture(device,
+                                       staging,
+                                       image.pixels.data(),
+                                       image.width,
+                                       image.height,
+                                       levels);
+        if (!tex)
+        {
+            return std::unexpected(tex.error());
+        }
+
+        // Trilinear, repeating
+        return texture_data { .texture    = *tex,
+                              .sampler    = {},
+                              .width      = image.width,
+                              .height     = image.height,
+                              .mip_levels = levels };
+    }
 
-    // Submit upload command
-    auto* cmd = SDL_AcquireGPUCommandBuffer(device);
-    auto* cp  = SDL_BeginGPUCopyPass(cmd);
+    const image_data* layer = &image;
+    return create_texture_array(device, staging, { &layer, 1 });
+}
 
-    SDL_GPUTextureTransferInfo src {};
-    src.transfer_buffer = tb;
-    src.offset          = 0;
-    SDL_GPUTextureRegion dst {};
-    dst.texture = tex;
-    dst.w       = static_cast<Uint32>(w);
-    dst.h       = static_cast<Uint32>(h);
-    dst.d       = 1;
-    SDL_UploadToGPUTexture(cp, &src, &dst, false);
+std::expected<texture_data, std::string> create_texture_array(
+    SDL_GPUDevice*                     device,
+    staging_ring&                      staging,
+    std::span<const image_data* const> layers,
+    std::uint32_t                      first_level)
+{
+    if (device == nullptr)
+    {
+        return std::unexpected("null device");
+    }
+    if (layers.empty())
+    {
+        return std::unexpected("no layers");
+    }
 
-    SDL_EndGPUCopyPass(cp);
-    SDL_SubmitGPUCommandBuffer(cmd);
-    SDL_ReleaseGPUTransferBuffer(device, tb);
+    const auto& first = *layers.front();
+    for (const auto* image : layers)
+    {
+        if (image->width != first.width || image->height != first.height ||
+            image->codec != first.codec || image->levels != first.levels ||
+            image->pixels.empty())
+        {
+            return std::unexpected("layers differ in size or codec");
+        }
+    }
+    if (first_level > 0 && first_level >= first.levels)
+    {
+        return std::unexpected("first level not in the image");
+    }
 
-    return texture_data {
-        .texture = tex, .sampler = samp, .width = w, .height = h
-    };
+    const auto w         = std::max(first.width >> first_level, 1);
+    const auto h         = std::max(first.height >> first_level, 1);
+    const auto levels    = texture_levels(first) - first_level;
+    const bool generated = first.codec == texture_codec::none &&
+                           first.levels == 1;
+    auto       tex       = create_array(device,
+                               first.codec,
+                               w,
+                               h,
+                               levels,
+                               static_cast<Uint32>(layers.size()),
+                               generated);
+    if (!tex)
+    {
+        return std::unexpected(tex.error());
+    }
+    for (std::size_t i = 0; i < layers.size(); ++i)
+    {
+        if (!stage_image(staging,
+                         *tex,
+                         static_cast<Uint32>(i),
+                         *layers[i],
+                         first_level))
+        {
+            // Earlier layers may already be queued
+            staging.discard_texture(*tex);
+            SDL_ReleaseGPUTexture(device, *tex);
+            return std::unexpected("texture staging failed");
+        }
+    }
+    if (generated && levels > 1)
+    {
+        // Fills every level of every layer
+        staging.generate_mipmaps(*tex);
+    }
+
+    // Trilinear, repeating
+    return texture_data { .texture    = *tex,
+                          .sampler    = {},
+                          .width      = w,
+                          .height     = h,
+                          .mip_levels = levels,
+                          .layers     = static_cast<std::uint32_t>(
+                              layers.size()) };
 }
 
 std::expected<texture_data, std::string> create_default_texture(
-    SDL_GPUDevice* device)
+    SDL_GPUDevice* device, staging_ring& staging)
 {
     if (device == nullptr)
     {
@@ -206,59 +423,18 @@ std::expected<texture_data, std::string> create_default_texture(
 
     constexpr std::uint32_t white = 0xFFFFFFFF;
 
-    SDL_GPUTextureCreateInfo tex_info {};
-    tex_info.type                 = SDL_GPU_TEXTURETYPE_2D;
-    tex_info.format               = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
-    tex_info.usage                = SDL_GPU_TEXTUREUSAGE_SAMPLER;
-    tex_info.width                = 1;
-    tex_info.height               = 1;
-    tex_info.layer_count_or_depth = 1;
-    tex_info.num_levels           = 1;
-    tex_info.sample_count         = SDL_GPU_SAMPLECOUNT_1;
-
-    auto* tex = SDL_CreateGPUTexture(device, &tex_info);
-    if (tex == nullptr)
+    auto tex = create_rgba_texture(device, staging, &white, 1, 1, 1);
+    if (!tex)
     {
-        return std::unexpected(
-            std::format("SDL_CreateGPUTexture: {}", SDL_GetError()));
+        return std::unexpected(tex.error());
     }
 
-    SDL_GPUSamplerCreateInfo samp_info {};
-    samp_info.min_filter     = SDL_GPU_FILTER_NEAREST;
-    samp_info.mag_filter     = SDL_GPU_FILTER_NEAREST;
-    samp_info.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_REPEAT;
-    samp_info.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_REPEAT;
-    samp_info.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_REPEAT;
-    auto* samp               = SDL_CreateGPUSampler(device, &samp_info);
-
-    // Upload single white pixel
-    SDL_GPUTransferBufferCreateInfo tb_info {};
-    tb_info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-    tb_info.size  = 4;
-    auto* tb      = SDL_CreateGPUTransferBuffer(device, &tb_info);
-    auto* ptr     = SDL_MapGPUTransferBuffer(device, tb, false);
-    std::memcpy(ptr, &white, 4);
-    SDL_UnmapGPUTransferBuffer(device, tb);
-
-    auto* cmd = SDL_AcquireGPUCommandBuffer(device);
-    auto* cp  = SDL_BeginGPUCopyPass(cmd);
-
-    SDL_GPUTextureTransferInfo src {};
-    src.transfer_buffer = tb;
-    src.offset          = 0;
-    SDL_GPUTextureRegion dst {};
-    dst.texture = tex;
-    dst.w       = 1;
-    dst.h       = 1;
-    dst.d       = 1;
-    SDL_UploadToGPUTexture(cp, &src, &dst, false);
-
-    SDL_EndGPUCopyPass(cp);
-    SDL_SubmitGPUCommandBuffer(cmd);
-    SDL_ReleaseGPUTransferBuffer(device, tb);
+    const sampler_key samp { .min_filter  = SDL_GPU_FILTER_NEAREST,
+                             .mag_filter  = SDL_GPU_FILTER_NEAREST,
+                             .mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST };
 
     return texture_data {
-        .texture = tex, .sampler = samp, .width = 1, .height = 1
+        .texture = *tex, .sampler = samp, .width = 1, .height = 1
     };
 }
 
@@ -268,10 +444,6 @@ void release_texture(SDL_GPUDevice* device, texture_data& tex)
     {
         SDL_ReleaseGPUTexture(device, tex.texture);
     }
-    if (tex.sampler != nullptr)
-    {
-        SDL_ReleaseGPUSampler(device, tex.sampler);
-    }
     tex = {};
 }
 
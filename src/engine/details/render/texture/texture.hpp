@@ -3,38 +3,69 @@
 /// @file texture.hpp
 /// @brief GPU texture loading and management utilities
 
+#include "sampler_cache.hpp"
+#include "texture_compress.hpp"
+
 #include <SDL3/SDL_gpu.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <expected>
 #include <filesystem>
+#include <span>
 #include <string>
+#include <vector>
 
 namespace egen
 {
 
-/// GPU texture data with sampler
+class staging_ring;
+
+/// GPU texture data with the sampling state it should be read with
 struct texture_data final
 {
-    SDL_GPUTexture* texture = nullptr;
-    SDL_GPUSampler* sampler = nullptr;
-    std::int32_t    width   = 0;
-    std::int32_t    height  = 0;
+    SDL_GPUTexture* texture    = nullptr;
+    sampler_key     sampler    = {}; // Resolved through a sampler_cache
+    std::int32_t    width      = 0;
+    std::int32_t    height     = 0;
+    std::uint32_t   mip_levels = 1; // Full chain for loaded images
+    std::uint32_t   layers     = 1; // Every texture is a 2D array
+};
+
+/// Image not yet on the GPU: tightly packed RGBA8 rows, or with a codec
+/// the compressed blocks of every mip level, finest first
+struct image_data final
+{
+    std::vector<std::byte> pixels;
+    std::int32_t           width  = 0;
+    std::int32_t           height = 0;
+    texture_codec          codec  = texture_codec::none;
+    std::uint32_t          levels = 1; // Levels in pixels; RGBA8 has one
 };
 
-/// Load texture from file and create GPU resources
+/// Bytes of one level of one layer of a w x h texture
+[[nodiscard]] std::size_t level_size(texture_codec codec,
+                                     std::int32_t  w,
+                                     std::int32_t  h) noexcept;
+
+/// Load texture from file and create GPU resources. The pixel upload and
+/// the mip chain generation are queued on the staging ring and land with
+/// its next flush.
 /// @param device GPU device to create texture on
+/// @param staging Upload queue for the pixel data
 /// @param path Path to image file (supports TGA, PNG, JPG, etc.)
 /// @param flip_vertical Whether to flip the image vertically (default: true for
 /// OpenGL coord system)
 /// @return Texture data on success, error message on failure
 [[nodiscard]] std::expected<texture_data, std::string> load_texture(
     SDL_GPUDevice*               device,
+    staging_ring&                staging,
     const std::filesystem::path& path,
     bool                         flip_vertical = true);
 
 /// Load texture from memory buffer and create GPU resources
 /// @param device GPU device to create texture on
+/// @param staging Upload queue for the pixel data
 /// @param data Pointer to image data in memory
 /// @param size Size of image data in bytes
 /// @param flip_vertical Whether to flip the image vertically (default: true for
@@ -42,15 +73,59 @@ struct texture_data final
 /// @return Texture data on success, error message on failure
 [[nodiscard]] std::expected<texture_data, std::string> load_texture_from_memory(
     SDL_GPUDevice* device,
+    staging_ring&  staging,
     const void*    data,
     std::size_t    size,
     bool           flip_vertical = true);
 
+/// Decode an image file to RGBA8 without creating GPU resources
+/// @param path Path to image file
+/// @param flip_vertical Whether to flip the image vertically
+/// @return Decoded image on success, error message on failure
+[[nodiscard]] std::expected<image_data, std::string> decode_image(
+    const std::filesystem::path& path, bool flip_vertical = true);
+
+/// Decode an image in memory to RGBA8 without creating GPU resources
+/// @param data Pointer to image data in memory
+/// @param size Size of image data in bytes
+/// @param flip_vertical Whether to flip the image vertically
+/// @return Decoded image on success, error message on failure
+[[nodiscard]] std::expected<image_data, std::string> decode_image_from_memory(
+    const void* data, std::size_t size, bool flip_vertical = true);
+
+/// Whether the device can sample 2D arrays in a codec's format
+[[nodiscard]] bool supports_codec(SDL_GPUDevice* device, texture_codec codec);
+
+/// Create a texture with a full mip chain from a decoded image. RGBA8
+/// images have their chain generated on the GPU; compressed images carry
+/// theirs and every level is uploaded as is.
+/// @param device GPU device to create texture on
+/// @param staging Upload queue for the pixel data
+/// @param image Decoded image
+/// @return Texture data on success, error message on failure
+[[nodiscard]] std::expected<texture_data, std::string> create_texture(
+    SDL_GPUDevice* device, staging_ring& staging, const image_data& image);
+
+/// Create one texture array with a full mip chain from images of the same
+/// size and codec, layer i holding layers[i]
+/// @param device GPU device to create texture on
+/// @param staging Upload queue for the pixel data
+/// @param layers Decoded images, all of one size and codec
+/// @param first_level Finest level to create; the texture's size is that
+/// level's. Above 0 only for images that carry their levels.
+/// @return Texture data on success, error message on failure
+[[nodiscard]] std::expected<texture_data, std::string> create_texture_array(
+    SDL_GPUDevice*                     device,
+    staging_ring&                      staging,
+    std::span<const image_data* const> layers,
+    std::uint32_t                      first_level = 0);
+
 /// Create a 1x1 white texture for fallback/placeholder use
 /// @param device GPU device to create texture on
+/// @param staging Upload queue for the pixel data
 /// @return Texture data on success, error message on failure
 [[nodiscard]] std::expected<texture_data, std::string> create_default_texture(
-    SDL_GPUDevice* device);
+    SDL_GPUDevice* device, staging_ring& staging);
 
 /// Release texture GPU resources
 /// @param device GPU device that owns the texture
@@ -0,0 +1,181 @@
+/// @file texture_cache.cpp
+/// @brief On-disk cache of encoded texture mip chains
+
+#include "texture_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <format>
+#include <fstream>
+#include <random>
+#include <system_error>
+
+namespace egen
+{
+
+namespace
+{
+
+/// Bumped whenever the encoders change their output, so stale entries
+/// miss instead of being uploaded
+constexpr std::uint32_t k_encoder_version = 1;
+constexpr std::uint32_t k_cache_magic     = 0x43544745; // "EGTC"
+constexpr std::uint32_t k_cache_version   = 1;
+
+/// Fixed-size header in front of the level data of every entry
+struct cache_header final
+{
+    std::uint32_t magic   = k_cache_magic;
+    std::uint32_t version = k_cache_version;
+    std::uint32_t codec   = 0;
+    std::int32_t  width   = 0;
+    std::int32_t  height  = 0;
+    std::uint32_t levels  = 0;
+    std::uint64_t size    = 0; // Bytes of level data that follow
+};
+
+constexpr std::uint64_t k_fnv_offset = 0xcbf29ce484222325ULL;
+constexpr std::uint64_t k_fnv_prime  = 0x100000001b3ULL;
+
+[[nodiscard]] std::uint64_t fnv1a(std::span<const std::byte> bytes,
+                                  std::uint64_t hash = k_fnv_offset) noexcept
+{
+    for (const auto b : bytes)
+    {
+        hash ^= static_cast<std::uint64_t>(b);
+        hash *= k_fnv_prime;
+    }
+    return hash;
+}
+
+[[nodiscard]] std::filesystem::path entry_path(
+    const std::filesystem::path& dir, std::uint64_t key)
+{
+    return dir / std::format("{:016x}.egtc", key);
+}
+
+/// Total level bytes a header describes, 0 if it is not a valid entry
+[[nodiscard]] std::size_t expected_size(const cache_header& header) noexcept
+{
+    const auto codec = static_cast<texture_codec>(header.codec);
+    if (block_bytes(codec) == 0 || header.width <= 0 || header.height <= 0 ||
+        header.levels != mip_count(header.width, header.height))
+    {
+        return 0;
+    }
+
+    std::size_t total = 0;
+    for (std::uint32_t level = 0; level < header.levels; ++level)
+    {
+        total += compressed_size(codec,
+                                 std::max(header.width >> level, 1),
+                                 std::max(header.height >> level, 1));
+    }
+    return total;
+}
+
+} // namespace
+
+std::uint64_t texture_cache_key(std::span<const std::byte> source,
+                                texture_codec              codec) noexcept
+{
+    const std::array<std::uint64_t, 3> salt {
+        static_cast<std::uint64_t>(codec),
+        k_encoder_version,
+        source.size(),
+    };
+    return fnv1a(std::as_bytes(std::span { salt }), fnv1a(source));
+}
+
+std::optional<image_data> read_cached_texture(
+    const std::filesystem::path& dir, std::uint64_t key)
+{
+    std::ifstream file(entry_path(dir, key), std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        return std::nullopt;
+    }
+
+    cache_header header {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != k_cache_magic ||
+        header.version != k_cache_version ||
+        header.size != expected_size(header) || header.size == 0)
+    {
+        return std::nullopt;
+    }
+
+    image_data image { .pixels = std::vector<std::byte>(header.size),
+                       .width  = header.width,
+                       .height = header.height,
+                       .codec  = static_cast<texture_codec>(header.codec),
+                       .levels = header.levels };
+    file.read(reinterpret_cast<char*>(image.pixels.data()),
+              static_cast<std::streamsize>(image.pixels.size()));
+    if (!file)
+    {
+        return std::nullopt;
+    }
+    return image;
+}
+
+bool write_cached_texture(const std::filesystem::path& dir,
+                          std::uint64_t                key,
+                          const image_data&            image)
+{
+    const cache_header header {
+        .magic   = k_cache_magic,
+        .version = k_cache_version,
+        .codec   = static_cast<std::uint32_t>(image.codec),
+        .width   = image.width,
+        .height  = image.height,
+        .levels  = image.levels,
+        .size    = image.pixels.size(),
+    };
+    if (header.size == 0 || header.size != expected_size(header))
+    {
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec)
+    {
+        return false;
+    }
+
+    // Loads on several threads, or in several processes, may encode the
+    // same source at once; each writes its own file and the last rename wins
+    thread_local std::mt19937_64 random { std::random_device {}() };
+
+    const auto path = entry_path(dir, key);
+    auto       temp = path;
+    temp += std::format(".{:016x}.tmp", random());
+    {
+        std::ofstream file(temp,
+                           std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(image.pixels.data()),
+                   static_cast<std::streamsize>(image.pixels.size()));
+        if (!file)
+        {
+            file.close();
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace egen
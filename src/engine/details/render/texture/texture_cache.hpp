@@ -0,0 +1,34 @@
+#pragma once
+
+/// @file texture_cache.hpp
+/// @brief On-disk cache of block-compressed mip chains
+
+#include "texture.hpp"
+#include "texture_compress.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+namespace egen
+{
+
+/// Cache key of a texture's compressed form: a hash of its encoded source
+/// bytes (PNG, JPG, ...), the codec and the encoder version
+[[nodiscard]] std::uint64_t texture_cache_key(
+    std::span<const std::byte> source, texture_codec codec) noexcept;
+
+/// Compressed image stored under key in dir, if present and intact
+[[nodiscard]] std::optional<image_data> read_cached_texture(
+    const std::filesystem::path& dir, std::uint64_t key);
+
+/// Store a compressed image under key in dir, creating dir as needed. The
+/// file is written under a temporary name and renamed into place, so
+/// readers never see a partial entry.
+[[nodiscard]] bool write_cached_texture(const std::filesystem::path& dir,
+                                        std::uint64_t                key,
+                                        const image_data&            image);
+
+} // namespace egen
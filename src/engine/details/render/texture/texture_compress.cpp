@@ -0,0 +1,662 @@
+/// @file texture_compress.cpp
+/// @brief BC4/BC5 and BC7 mode 6 block encoders, decoders and mip chains
+
+#include "texture_compress.hpp"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace egen
+{
+
+namespace
+{
+
+/// BC7 interpolation weights of 4-bit indices, out of 64
+constexpr std::array<std::uint32_t, 16> k_weights4 {
+    0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64
+};
+
+/// BC7 mode 6 in the 7-bit unary mode field, read least significant first
+constexpr std::uint32_t k_bc7_mode6 = 0x40;
+
+/// Power iterations for the principal axis of a block's colors
+constexpr int k_axis_iterations = 8;
+
+/// Axis or extent length below which a block is treated as one color
+constexpr float k_flat_epsilon = 1e-4f;
+
+/// One value per texel for each of R, G, B and A
+using block_channels = std::array<std::array<float, 16>, 4>;
+
+/// Little-endian bit stream over one 128-bit block
+struct bit_stream final
+{
+    std::array<std::uint8_t, 16> bytes {};
+    std::uint32_t                pos = 0;
+
+    void put(std::uint32_t value, std::uint32_t bits) noexcept
+    {
+        for (std::uint32_t b = 0; b < bits; ++b, ++pos)
+        {
+            bytes[pos >> 3] |=
+                static_cast<std::uint8_t>(((value >> b) & 1u) << (pos & 7u));
+        }
+    }
+
+    [[nodiscard]] std::uint32_t get(std::uint32_t bits) noexcept
+    {
+        std::uint32_t value = 0;
+        for (std::uint32_t b = 0; b < bits; ++b, ++pos)
+        {
+            value |= ((bytes[pos >> 3] >> (pos & 7u)) & 1u) << b;
+        }
+        return value;
+    }
+};
+
+/// BC7 endpoint: 7 bits per channel and a p-bit shared by all four
+struct bc7_endpoint final
+{
+    std::array<std::uint32_t, 4> color {};
+    std::uint32_t                pbit = 0;
+
+    [[nodiscard]] std::uint32_t value(std::size_t channel) const noexcept
+    {
+        return (color[channel] << 1) | pbit;
+    }
+};
+
+/// Closest representable endpoint, trying both p-bits
+[[nodiscard]] bc7_endpoint quantize_endpoint(
+    const std::array<float, 4>& e) noexcept
+{
+    bc7_endpoint best;
+    float        best_error = std::numeric_limits<float>::max();
+    for (std::uint32_t p = 0; p < 2; ++p)
+    {
+        bc7_endpoint candidate { .color = {}, .pbit = p };
+        float        error = 0.0f;
+        for (std::size_t c = 0; c < 4; ++c)
+        {
+            const float q = std::round((e[c] - static_cast<float>(p)) * 0.5f);
+            candidate.color[c] =
+                static_cast<std::uint32_t>(std::clamp(q, 0.0f, 127.0f));
+            const float d =
+                static_cast<float>(candidate.value(c)) - e[c];
+            error += d * d;
+        }
+        if (error < best_error)
+        {
+            best       = candidate;
+            best_error = error;
+        }
+    }
+    return best;
+}
+
+/// Index of the closest palette entry for every texel, by squared RGBA
+/// distance. Four texels are tested per SIMD lane group.
+void select_indices(const block_channels&         texels,
+                    const block_channels&         palette,
+                    std::array<std::uint8_t, 16>& indices) noexcept
+{
+#if defined(__SSE__) || defined(_M_X64)
+    for (std::size_t i = 0; i < 16; i += 4)
+    {
+        const __m128 r = _mm_loadu_ps(texels[0].data() + i);
+        const __m128 g = _mm_loadu_ps(texels[1].data() + i);
+        const __m128 b = _mm_loadu_ps(texels[2].data() + i);
+        const __m128 a = _mm_loadu_ps(texels[3].data() + i);
+
+        __m128 best  = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128 index = _mm_setzero_ps();
+        for (std::size_t k = 0; k < 16; ++k)
+        {
+            const __m128 dr = _mm_sub_ps(r, _mm_set1_ps(palette[0][k]));
+            const __m128 dg = _mm_sub_ps(g, _mm_set1_ps(palette[1][k]));
+            const __m128 db = _mm_sub_ps(b, _mm_set1_ps(palette[2][k]));
+            const __m128 da = _mm_sub_ps(a, _mm_set1_ps(palette[3][k]));
+
+            __m128 e = _mm_mul_ps(dr, dr);
+            e        = _mm_add_ps(e, _mm_mul_ps(dg, dg));
+            e        = _mm_add_ps(e, _mm_mul_ps(db, db));
+            e        = _mm_add_ps(e, _mm_mul_ps(da, da));
+
+            const __m128 closer = _mm_cmplt_ps(e, best);
+            best                = _mm_min_ps(e, best);
+            index               = _mm_or_ps(
+                _mm_and_ps(closer, _mm_set1_ps(static_cast<float>(k))),
+                _mm_andnot_ps(closer, index));
+        }
+
+        std::array<float, 4> lanes {};
+        _mm_storeu_ps(lanes.data(), index);
+        for (std::size_t lane = 0; lane < 4; ++lane)
+        {
+            indices[i + lane] = static_cast<std::uint8_t>(lanes[lane]);
+        }
+    }
+#else
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+        float best = std::numeric_limits<float>::max();
+        for (std::size_t k = 0; k < 16; ++k)
+        {
+            float e = 0.0f;
+            for (std::size_t c = 0; c < 4; ++c)
+            {
+                const float d = texels[c][i] - palette[c][k];
+                e += d * d;
+            }
+            if (e < best)
+            {
+                best       = e;
+                indices[i] = static_cast<std::uint8_t>(k);
+            }
+        }
+    }
+#endif
+}
+
+/// BC7 mode 6: endpoints along the principal axis of the block's colors,
+/// refit by least squares to the projected indices, then quantized and
+/// indexed exhaustively
+void encode_bc7(const std::uint8_t* texels, std::byte* out) noexcept
+{
+    block_channels       t {};
+    std::array<float, 4> mean {};
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+        for (std::size_t c = 0; c < 4; ++c)
+        {
+            t[c][i]  = static_cast<float>(texels[(i * 4) + c]);
+            mean[c] += t[c][i];
+        }
+    }
+    for (auto& m : mean)
+    {
+        m *= 1.0f / 16.0f;
+    }
+
+    std::array<std::array<float, 4>, 4> cov {};
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+        for (std::size_t r = 0; r < 4; ++r)
+        {
+            for (std::size_t c = 0; c < 4; ++c)
+            {
+                cov[r][c] += (t[r][i] - mean[r]) * (t[c][i] - mean[c]);
+            }
+        }
+    }
+
+    // Seed with the row of the channel that varies most
+    std::size_t seed = 0;
+    for (std::size_t c = 1; c < 4; ++c)
+    {
+        seed = cov[c][c] > cov[seed][seed] ? c : seed;
+    }
+    std::array<float, 4> axis = cov[seed];
+    for (int iter = 0; iter < k_axis_iterations; ++iter)
+    {
+        std::array<float, 4> next {};
+        float                largest = 0.0f;
+        for (std::size_t r = 0; r < 4; ++r)
+        {
+            for (std::size_t c = 0; c < 4; ++c)
+            {
+                next[r] += cov[r][c] * axis[c];
+            }
+            largest = std::max(largest, std::abs(next[r]));
+        }
+        if (largest < k_flat_epsilon)
+        {
+            break;
+        }
+        for (std::size_t c = 0; c < 4; ++c)
+        {
+            axis[c] = next[c] / largest;
+        }
+    }
+    float length = 0.0f;
+    for (const float a : axis)
+    {
+        length += a * a;
+    }
+    length = std::sqrt(length);
+
+    std::array<float, 4> e0 = mean;
+    std::array<float, 4> e1 = mean;
+    if (length > k_flat_epsilon)
+    {
+        for (auto& a : axis)
+        {
+            a /= length;
+        }
+
+        std::array<float, 16> proj {};
+        float                 lo = std::numeric_limits<float>::max();
+        float                 hi = std::numeric_limits<float>::lowest();
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            for (std::size_t c = 0; c < 4; ++c)
+            {
+                proj[i] += (t[c][i] - mean[c]) * axis[c];
+            }
+            lo = std::min(lo, proj[i]);
+            hi = std::max(hi, proj[i]);
+        }
+        for (std::size_t c = 0; c < 4; ++c)
+        {
+            e0[c] = mean[c] + (axis[c] * lo);
+            e1[c] = mean[c] + (axis[c] * hi);
+        }
+
+        // Least squares refit: minimize the error of (1 - w) e0 + w e1
+        // over the weights the projection picks
+        if (hi - lo > k_flat_epsilon)
+        {
+            float                aa = 0.0f;
+            float                ab = 0.0f;
+            float                bb = 0.0f;
+            std::array<float, 4> ax {};
+            std::array<float, 4> bx {};
+            for (std::size_t i = 0; i < 16; ++i)
+            {
+                const auto step = std::clamp(
+                    std::lround((proj[i] - lo) / (hi - lo) * 15.0f), 0l, 15l);
+                const float w =
+                    static_cast<float>(
+                        k_weights4[static_cast<std::size_t>(step)]) /
+                    64.0f;
+                aa += (1.0f - w) * (1.0f - w);
+                ab += (1.0f - w) * w;
+                bb += w * w;
+                for (std::size_t c = 0; c < 4; ++c)
+                {
+                    ax[c] += (1.0f - w) * t[c][i];
+                    bx[c] += w * t[c][i];
+                }
+            }
+            const float det = (aa * bb) - (ab * ab);
+            if (std::abs(det) > k_flat_epsilon)
+            {
+                for (std::size_t c = 0; c < 4; ++c)
+                {
+                    e0[c] = ((bb * ax[c]) - (ab * bx[c])) / det;
+                    e1[c] = ((aa * bx[c]) - (ab * ax[c])) / det;
+                }
+            }
+        }
+    }
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+        e0[c] = std::clamp(e0[c], 0.0f, 255.0f);
+        e1[c] = std::clamp(e1[c], 0.0f, 255.0f);
+    }
+
+    auto q0 = quantize_endpoint(e0);
+    auto q1 = quantize_endpoint(e1);
+
+    block_channels palette {};
+    for (std::size_t k = 0; k < 16; ++k)
+    {
+        for (std::size_t c = 0; c < 4; ++c)
+        {
+            palette[c][k] = static_cast<float>(
+                (((64 - k_weights4[k]) * q0.value(c)) +
+                 (k_weights4[k] * q1.value(c)) + 32) >>
+                6);
+        }
+    }
+    std::array<std::uint8_t, 16> indices {};
+    select_indices(t, palette, indices);
+
+    // The first index is stored with 3 bits, so its top bit must be clear.
+    // The weights are symmetric: swapping the endpoints and mirroring the
+    // indices decodes to the same texels.
+    if ((indices[0] & 8u) != 0)
+    {
+        std::swap(q0, q1);
+        for (auto& index : indices)
+        {
+            index = static_cast<std::uint8_t>(15u - index);
+        }
+    }
+
+    bit_stream bits;
+    bits.put(k_bc7_mode6, 7);
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+        bits.put(q0.color[c], 7);
+        bits.put(q1.color[c], 7);
+    }
+    bits.put(q0.pbit, 1);
+    bits.put(q1.pbit, 1);
+    bits.put(indices[0], 3);
+    for (std::size_t i = 1; i < 16; ++i)
+    {
+        bits.put(indices[i], 4);
+    }
+    std::memcpy(out, bits.bytes.data(), bits.bytes.size());
+}
+
+void decode_bc7(const std::byte* in, std::uint8_t* texels) noexcept
+{
+    bit_stream bits;
+    std::memcpy(bits.bytes.data(), in, bits.bytes.size());
+    if (bits.get(7) != k_bc7_mode6)
+    {
+        // Only the mode the encoder writes is decoded
+        std::memset(texels, 0, 64);
+        return;
+    }
+
+    bc7_endpoint q0;
+    bc7_endpoint q1;
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+        q0.color[c] = bits.get(7);
+        q1.color[c] = bits.get(7);
+    }
+    q0.pbit = bits.get(1);
+    q1.pbit = bits.get(1);
+
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+        const auto w = k_weights4[bits.get(i == 0 ? 3 : 4)];
+        for (std::size_t c = 0; c < 4; ++c)
+        {
+            texels[(i * 4) + c] = static_cast<std::uint8_t>(
+                (((64 - w) * q0.value(c)) + (w * q1.value(c)) + 32) >> 6);
+        }
+    }
+}
+
+/// One channel as BC4: the block's extremes as endpoints, so the eight
+/// value mode applies, and the closest of those values per texel
+void encode_bc4(const std::uint8_t* texels,
+                std::size_t         channel,
+                std::byte*          out) noexcept
+{
+    std::uint8_t lo = 255;
+    std::uint8_t hi = 0;
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+        lo = std::min(lo, texels[(i * 4) + channel]);
+        hi = std::max(hi, texels[(i * 4) + channel]);
+    }
+
+    std::memset(out, 0, 8);
+    out[0] = static_cast<std::byte>(hi);
+    out[1] = static_cast<std::byte>(lo);
+    if (hi == lo)
+    {
+        return;
+    }
+
+    // Index 0 is hi, 1 is lo, 2..7 step from hi towards lo
+    std::array<float, 8> palette {};
+    palette[0] = hi;
+    palette[1] = lo;
+    for (std::size_t k = 2; k < 8; ++k)
+    {
+        palette[k] = (static_cast<float>(8 - k) * hi +
+                      static_cast<float>(k - 1) * lo) /
+                     7.0f;
+    }
+
+    std::uint64_t packed = 0;
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+        const float   v     = texels[(i * 4) + channel];
+        std::uint64_t index = 0;
+        float         best  = std::numeric_limits<float>::max();
+        for (std::size_t k = 0; k < 8; ++k)
+        {
+            const float d = std::abs(v - palette[k]);
+            if (d < best)
+            {
+                best  = d;
+                index = k;
+            }
+        }
+        packed |= index << (3 * i);
+    }
+    for (std::size_t b = 0; b < 6; ++b)
+    {
+        out[2 + b] = static_cast<std::byte>((packed >> (8 * b)) & 0xFFu);
+    }
+}
+
+void decode_bc4(const std::byte* in,
+                std::size_t      channel,
+                std::uint8_t*    texels) noexcept
+{
+    const auto e0 = std::to_integer<std::uint32_t>(in[0]);
+    const auto e1 = std::to_integer<std::uint32_t>(in[1]);
+
+    std::array<std::uint32_t, 8> palette { e0, e1 };
+    if (e0 > e1)
+    {
+        for (std::uint32_t k = 2; k < 8; ++k)
+        {
+            palette[k] = (((8 - k) * e0) + ((k - 1) * e1) + 3) / 7;
+        }
+    }
+    else
+    {
+        for (std::uint32_t k = 2; k < 6; ++k)
+        {
+            palette[k] = (((6 - k) * e0) + ((k - 1) * e1) + 2) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    std::uint64_t packed = 0;
+    for (std::size_t b = 0; b < 6; ++b)
+    {
+        packed |= std::to_integer<std::uint64_t>(in[2 + b]) << (8 * b);
+    }
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+        texels[(i * 4) + channel] =
+            static_cast<std::uint8_t>(palette[(packed >> (3 * i)) & 7u]);
+    }
+}
+
+/// Half-size level, each texel the mean of up to four source texels
+void downsample(const std::vector<std::uint8_t>& src,
+                std::int32_t                     width,
+                std::int32_t                     height,
+                std::vector<std::uint8_t>&       dst)
+{
+    const auto w  = static_cast<std::size_t>(width);
+    const auto h  = static_cast<std::size_t>(height);
+    const auto dw = std::max<std::size_t>(w / 2, 1);
+    const auto dh = std::max<std::size_t>(h / 2, 1);
+    dst.resize(dw * dh * 4);
+
+    for (std::size_t y = 0; y < dh; ++y)
+    {
+        const auto y0 = std::min(2 * y, h - 1);
+        const auto y1 = std::min((2 * y) + 1, h - 1);
+        for (std::size_t x = 0; x < dw; ++x)
+        {
+            const auto x0 = std::min(2 * x, w - 1);
+            const auto x1 = std::min((2 * x) + 1, w - 1);
+            for (std::size_t c = 0; c < 4; ++c)
+            {
+                const std::uint32_t sum = src[(((y0 * w) + x0) * 4) + c] +
+                                          src[(((y0 * w) + x1) * 4) + c] +
+                                          src[(((y1 * w) + x0) * 4) + c] +
+                                          src[(((y1 * w) + x1) * 4) + c];
+                dst[(((y * dw) + x) * 4) + c] =
+                    static_cast<std::uint8_t>((sum + 2) >> 2);
+            }
+        }
+    }
+}
+
+/// Encode every block of one level; edge blocks repeat the last texels
+void encode_level(texture_codec                    codec,
+                  const std::vector<std::uint8_t>& rgba,
+                  std::int32_t                     width,
+                  std::int32_t                     height,
+                  std::byte*                       out,
+                  const parallel_range_fn&         parallel)
+{
+    const auto w        = static_cast<std::size_t>(width);
+    const auto h        = static_cast<std::size_t>(height);
+    const auto blocks_x = (w + 3) / 4;
+    const auto blocks_y = (h + 3) / 4;
+    const auto bytes    = block_bytes(codec);
+
+    const auto encode_rows = [&](std::size_t first, std::size_t last)
+    {
+        std::array<std::uint8_t, 64> block {};
+        for (std::size_t by = first; by < last; ++by)
+        {
+            for (std::size_t bx = 0; bx < blocks_x; ++bx)
+            {
+                for (std::size_t y = 0; y < 4; ++y)
+                {
+                    const auto sy = std::min((by * 4) + y, h - 1);
+                    for (std::size_t x = 0; x < 4; ++x)
+                    {
+                        const auto sx = std::min((bx * 4) + x, w - 1);
+                        std::memcpy(block.data() + (((y * 4) + x) * 4),
+                                    rgba.data() + (((sy * w) + sx) * 4),
+                                    4);
+                    }
+                }
+                encode_block(codec,
+                             block.data(),
+                             out + (((by * blocks_x) + bx) * bytes));
+            }
+        }
+    };
+
+    if (parallel)
+    {
+        parallel(blocks_y, encode_rows);
+    }
+    else
+    {
+        encode_rows(0, blocks_y);
+    }
+}
+
+} // namespace
+
+std::uint32_t mip_count(std::int32_t width, std::int32_t height) noexcept
+{
+    const auto largest =
+        static_cast<std::uint32_t>(std::max({ width, height, 1 }));
+    return static_cast<std::uint32_t>(std::bit_width(largest));
+}
+
+std::size_t compressed_size(texture_codec codec,
+                            std::int32_t  width,
+                            std::int32_t  height) noexcept
+{
+    const auto blocks_x = (static_cast<std::size_t>(width) + 3) / 4;
+    const auto blocks_y = (static_cast<std::size_t>(height) + 3) / 4;
+    return blocks_x * blocks_y * block_bytes(codec);
+}
+
+void encode_block(texture_codec       codec,
+                  const std::uint8_t* texels,
+                  std::byte*          out) noexcept
+{
+    switch (codec)
+    {
+        case texture_codec::bc4:
+            encode_bc4(texels, 0, out);
+            break;
+        case texture_codec::bc5:
+            encode_bc4(texels, 0, out);
+            encode_bc4(texels, 1, out + 8);
+            break;
+        case texture_codec::bc7:
+            encode_bc7(texels, out);
+            break;
+        case texture_codec::none:
+            break;
+    }
+}
+
+void decode_block(texture_codec    codec,
+                  const std::byte* in,
+                  std::uint8_t*    texels) noexcept
+{
+    if (codec == texture_codec::bc7)
+    {
+        decode_bc7(in, texels);
+        return;
+    }
+
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+        texels[(i * 4) + 0] = 0;
+        texels[(i * 4) + 1] = 0;
+        texels[(i * 4) + 2] = 0;
+        texels[(i * 4) + 3] = 255;
+    }
+    if (codec == texture_codec::bc4 || codec == texture_codec::bc5)
+    {
+        decode_bc4(in, 0, texels);
+    }
+    if (codec == texture_codec::bc5)
+    {
+        decode_bc4(in + 8, 1, texels);
+    }
+}
+
+std::vector<std::byte> compress_mip_chain(texture_codec              codec,
+                                          std::span<const std::byte> rgba,
+                                          std::int32_t               width,
+                                          std::int32_t               height,
+                                          const parallel_range_fn& parallel)
+{
+    const auto levels = mip_count(width, height);
+
+    std::size_t total = 0;
+    for (std::uint32_t l = 0; l < levels; ++l)
+    {
+        total += compressed_size(
+            codec, std::max(width >> l, 1), std::max(height >> l, 1));
+    }
+    std::vector<std::byte> out(total);
+
+    const auto* first = reinterpret_cast<const std::uint8_t*>(rgba.data());
+    std::vector<std::uint8_t> level(first, first + rgba.size());
+    std::vector<std::uint8_t> next;
+
+    std::size_t offset = 0;
+    for (std::uint32_t l = 0; l < levels; ++l)
+    {
+        const auto w = std::max(width >> l, 1);
+        const auto h = std::max(height >> l, 1);
+        encode_level(codec, level, w, h, out.data() + offset, parallel);
+        offset += compressed_size(codec, w, h);
+        if (l + 1 < levels)
+        {
+            downsample(level, w, h, next);
+            std::swap(level, next);
+        }
+    }
+    return out;
+}
+
+} // namespace egen
@@ -0,0 +1,76 @@
+#pragma once
+
+/// @file texture_compress.hpp
+/// @brief CPU block compression of RGBA8 images to BC4, BC5 and BC7
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace egen
+{
+
+/// Block-compressed encoding of a texture; none keeps RGBA8
+enum class texture_codec : std::uint8_t
+{
+    none,
+    bc4, // Red channel only, 8 bytes per block
+    bc5, // Red and green, e.g. normals with z reconstructed; 16 bytes
+    bc7, // RGBA, 16 bytes per block
+};
+
+/// Bytes per 4x4 block, 0 for uncompressed
+[[nodiscard]] constexpr std::size_t block_bytes(texture_codec codec) noexcept
+{
+    switch (codec)
+    {
+        case texture_codec::bc4:
+            return 8;
+        case texture_codec::bc5:
+        case texture_codec::bc7:
+            return 16;
+        case texture_codec::none:
+            break;
+    }
+    return 0;
+}
+
+/// Levels in a full mip chain down to 1x1
+[[nodiscard]] std::uint32_t mip_count(std::int32_t width,
+                                      std::int32_t height) noexcept;
+
+/// Bytes of one compressed level; partial blocks at the edges count whole
+[[nodiscard]] std::size_t compressed_size(texture_codec codec,
+                                          std::int32_t  width,
+                                          std::int32_t  height) noexcept;
+
+/// Encode one 4x4 block of RGBA8 texels, row-major, into block_bytes(codec)
+/// bytes. BC7 uses mode 6: one subset, RGBA endpoints and 4-bit indices.
+void encode_block(texture_codec       codec,
+                  const std::uint8_t* texels,
+                  std::byte*          out) noexcept;
+
+/// Decode a block written by encode_block back to 4x4 RGBA8 texels.
+/// Channels a codec does not store read as 0, alpha as 255.
+void decode_block(texture_codec    codec,
+                  const std::byte* in,
+                  std::uint8_t*    texels) noexcept;
+
+/// Runs fn(first, last) over [0, count), possibly split across threads
+using parallel_range_fn = std::function<void(
+    std::size_t count,
+    const std::function<void(std::size_t, std::size_t)>& fn)>;
+
+/// Compress an RGBA8 image and every level of a box-filtered mip chain
+/// built from it, levels finest first and tightly packed. Block rows of
+/// each level are encoded through parallel when given.
+[[nodiscard]] std::vector<std::byte> compress_mip_chain(
+    texture_codec              codec,
+    std::span<const std::byte> rgba,
+    std::int32_t               width,
+    std::int32_t               height,
+    const parallel_range_fn&   parallel = {});
+
+} // namespace egen
@@ -0,0 +1,252 @@
+/// @file texture_streamer.cpp
+/// @brief Mip residency decisions, LRU eviction and stream-in order
+
+#include "texture_streamer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace egen
+{
+
+std::uint32_t texture_streamer::tail_level(const image_data& image) noexcept
+{
+    // Block formats need whole blocks at the top level of the texture
+    const bool blocks = block_bytes(image.codec) > 0;
+
+    std::uint32_t level = 0;
+    while (level + 1 < image.levels &&
+           std::max(image.width >> level, image.height >> level) >
+               k_tail_size)
+    {
+        const auto block = 4 << (level + 1);
+        if (blocks && (image.width % block != 0 || image.height % block != 0))
+        {
+            break;
+        }
+        ++level;
+    }
+    return level;
+}
+
+void texture_streamer::add(texture_handle          texture,
+                           std::vector<image_data> layers)
+{
+    if (layers.empty())
+    {
+        return;
+    }
+    remove(texture);
+
+    const auto& first = layers.front();
+    entry       e {};
+    e.size = std::max(first.width, first.height);
+    e.tail = tail_level(first);
+    e.bytes_from.assign(first.levels + 1, 0);
+    for (auto level = first.levels; level-- > 0;)
+    {
+        const auto w = std::max(first.width >> level, 1);
+        const auto h = std::max(first.height >> level, 1);
+        e.bytes_from[level] = e.bytes_from[level + 1] +
+                              (level_size(first.codec, w, h) * layers.size());
+    }
+    e.resident = e.tail;
+    e.applied  = e.tail;
+    e.wanted   = e.tail;
+    e.demand   = e.tail;
+    e.layers   = std::move(layers);
+
+    resident_bytes_ += e.bytes_from[e.resident];
+    requested_bytes_ += e.bytes_from[e.wanted];
+    entries_.emplace(texture, std::move(e));
+}
+
+void texture_streamer::remove(texture_handle texture)
+{
+    const auto it = entries_.find(texture);
+    if (it == entries_.end())
+    {
+        return;
+    }
+    resident_bytes_ -= it->second.bytes_from[it->second.resident];
+    requested_bytes_ -= std::min(requested_bytes_,
+                                 it->second.bytes_from[it->second.wanted]);
+    entries_.erase(it);
+}
+
+void texture_streamer::request(texture_handle texture, float texels)
+{
+    const auto it = entries_.find(texture);
+    if (it == entries_.end())
+    {
+        return;
+    }
+    auto& e = it->second;
+
+    // Coarsest level that still has a texel per covered pixel
+    std::uint32_t level = e.tail;
+    if (texels > 0.0f)
+    {
+        const float ratio = static_cast<float>(e.size) / texels;
+        level             = ratio <= 1.0f
+                                ? 0
+                                : static_cast<std::uint32_t>(std::log2(ratio));
+        level             = std::min(level, e.tail);
+    }
+
+    if (e.last_seen != frame_)
+    {
+        e.last_seen = frame_;
+        e.demand    = level;
+    }
+    else
+    {
+        e.demand = std::min(e.demand, level);
+    }
+}
+
+std::span<const texture_residency> texture_streamer::update(
+    std::size_t budget, std::size_t upload_limit)
+{
+    requested_bytes_ = 0;
+    for (auto& [texture, e] : entries_)
+    {
+        if (e.last_seen == frame_)
+        {
+            e.wanted = e.demand;
+        }
+        else if (frame_ - e.last_seen > k_stale_frames)
+        {
+            e.wanted = e.tail;
+        }
+        requested_bytes_ += e.bytes_from[e.wanted];
+    }
+
+    // Over budget, e.g. after it shrank: textures not drawn this frame
+    // give up their levels first, then everything down to the tails
+    if (resident_bytes_ > budget)
+    {
+        evict(budget, false);
+        evict(budget, true);
+    }
+
+    // Stream in what this frame's draws asked for, the textures missing
+    // the most levels first
+    order_.clear();
+    for (auto& [texture, e] : entries_)
+    {
+        if (e.last_seen == frame_ && e.wanted < e.resident)
+        {
+            order_.push_back(&e);
+        }
+    }
+    std::ranges::stable_sort(order_,
+                             std::greater {},
+                             [](const entry* e)
+                             { return e->resident - e->wanted; });
+
+    std::size_t uploaded = 0;
+    for (auto* e : order_)
+    {
+        // Finest level that fits, each recreation uploads the whole chain
+        for (auto level = e->wanted; level < e->resident; ++level)
+        {
+            const auto upload = e->bytes_from[level];
+            if (uploaded > 0 && uploaded + upload > upload_limit)
+            {
+                continue;
+            }
+            const auto grow = upload - e->bytes_from[e->resident];
+            if (grow > budget)
+            {
+                continue;
+            }
+            if (resident_bytes_ + grow > budget)
+            {
+                evict(budget - grow, false);
+                if (resident_bytes_ + grow > budget)
+                {
+                    continue;
+                }
+            }
+            set_level(*e, level);
+            uploaded += upload;
+            break;
+        }
+    }
+
+    changes_.clear();
+    for (auto& [texture, e] : entries_)
+    {
+        if (e.resident != e.applied)
+        {
+            changes_.push_back({ .texture = texture, .level = e.resident });
+            e.applied = e.resident;
+        }
+    }
+    ++frame_;
+    return changes_;
+}
+
+std::span<const image_data> texture_streamer::layers(
+    texture_handle texture) const noexcept
+{
+    const auto it = entries_.find(texture);
+    if (it == entries_.end())
+    {
+        return {};
+    }
+    return it->second.layers;
+}
+
+void texture_streamer::set_resident(texture_handle texture,
+                                    std::uint32_t  level)
+{
+    const auto it = entries_.find(texture);
+    if (it == entries_.end())
+    {
+        return;
+    }
+    set_level(it->second, level);
+    it->second.applied = level;
+}
+
+void texture_streamer::set_level(entry& e, std::uint32_t level) noexcept
+{
+    resident_bytes_ -= e.bytes_from[e.resident];
+    resident_bytes_ += e.bytes_from[level];
+    e.resident = level;
+}
+
+void texture_streamer::evict(std::size_t target, bool force)
+{
+    const auto floor_of = [this, force](const entry& e)
+    { return !force && e.last_seen == frame_ ? e.wanted : e.tail; };
+
+    victims_.clear();
+    for (auto& [texture, e] : entries_)
+    {
+        if (e.resident < floor_of(e))
+        {
+            victims_.push_back(&e);
+        }
+    }
+    std::ranges::stable_sort(
+        victims_, {}, [](const entry* e) { return e->last_seen; });
+
+    for (auto* e : victims_)
+    {
+        const auto floor = floor_of(*e);
+        while (resident_bytes_ > target && e->resident < floor)
+        {
+            set_level(*e, e->resident + 1);
+        }
+        if (resident_bytes_ <= target)
+        {
+            return;
+        }
+    }
+}
+
+} // namespace egen
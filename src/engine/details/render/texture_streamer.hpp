@@ -0,0 +1,124 @@
+#pragma once
+
+/// @file texture_streamer.hpp
+/// @brief Mip residency of textures under a VRAM budget
+
+#include "core-api/renderer.hpp"
+#include "texture/texture.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace egen
+{
+
+/// Finest level a streamed texture should be resident from, decided by
+/// texture_streamer::update() and applied by recreating the texture
+struct texture_residency final
+{
+    texture_handle texture = invalid_texture;
+    std::uint32_t  level   = 0;
+};
+
+/// Decides which mip levels of streamed textures live on the GPU. Streamed
+/// textures keep every level of every layer on the CPU, start from a small
+/// tail of coarse levels and gain finer ones as draws ask for them.
+///
+/// Each frame, draws report the texels they cover on screen with
+/// request(); update() then turns the finest level asked for into
+/// residency changes. Levels are only dropped while the resident total is
+/// over the budget, least recently seen textures first, so textures seen
+/// once stay cached while there is room.
+class texture_streamer final
+{
+public:
+    /// Tail levels are at most this many texels on a side
+    static constexpr std::int32_t k_tail_size = 64;
+
+    /// Frames without a request after which a texture only needs its tail
+    static constexpr std::uint64_t k_stale_frames = 120;
+
+    /// Level a streamed texture starts from: the finest whose size is at
+    /// most k_tail_size, but never a level compressed blocks cannot start.
+    /// 0 means the texture is too small to stream.
+    [[nodiscard]] static std::uint32_t tail_level(
+        const image_data& image) noexcept;
+
+    /// Track a texture created from tail_level(layers.front()). The images
+    /// must carry every level and are kept to recreate it.
+    void add(texture_handle texture, std::vector<image_data> layers);
+
+    void remove(texture_handle texture);
+
+    [[nodiscard]] bool contains(texture_handle texture) const noexcept
+    {
+        return entries_.contains(texture);
+    }
+
+    /// A draw this frame covers about texels screen pixels along the
+    /// texture's larger side. Ignored for textures that do not stream.
+    void request(texture_handle texture, float texels);
+
+    /// Close the frame: evict over budget and stream in requested levels
+    /// while they fit. Recreations are limited to upload_limit bytes per
+    /// call, except that the first one always goes through.
+    [[nodiscard]] std::span<const texture_residency> update(
+        std::size_t budget, std::size_t upload_limit);
+
+    /// Every level of every layer of a streamed texture
+    [[nodiscard]] std::span<const image_data> layers(
+        texture_handle texture) const noexcept;
+
+    /// The GPU still holds level for a texture, after a failed recreation
+    void set_resident(texture_handle texture, std::uint32_t level);
+
+    /// Bytes of the levels on the GPU
+    [[nodiscard]] std::size_t resident_bytes() const noexcept
+    {
+        return resident_bytes_;
+    }
+
+    /// Bytes the levels draws asked for would take, tails for textures not
+    /// seen lately
+    [[nodiscard]] std::size_t requested_bytes() const noexcept
+    {
+        return requested_bytes_;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return entries_.size(); }
+
+private:
+    struct entry final
+    {
+        std::vector<image_data>  layers;
+        std::vector<std::size_t> bytes_from; // [level] = that level onwards
+        std::int32_t             size      = 0; // Larger side of level 0
+        std::uint32_t            tail      = 0;
+        std::uint32_t            resident  = 0; // Finest level on the GPU
+        std::uint32_t            applied   = 0; // Last reported resident
+        std::uint32_t            wanted    = 0; // Finest level asked for
+        std::uint32_t            demand    = 0; // Finest this frame so far
+        std::uint64_t            last_seen = 0; // Frame of the last request
+    };
+
+    /// Move an entry to a new finest level, keeping the byte totals
+    void set_level(entry& e, std::uint32_t level) noexcept;
+
+    /// Drop top levels of entries, least recently seen first, until the
+    /// resident total is at most target. Entries seen this frame keep at
+    /// least their wanted level unless force is set.
+    void evict(std::size_t target, bool force);
+
+    std::unordered_map<texture_handle, entry> entries_;
+    std::vector<texture_residency>            changes_;
+    std::vector<entry*>                       order_;   // Stream-in order
+    std::vector<entry*>                       victims_; // Eviction order
+    std::size_t                               resident_bytes_  = 0;
+    std::size_t                               requested_bytes_ = 0;
+    std::uint64_t                             frame_           = 1;
+};
+
+} // namespace egen
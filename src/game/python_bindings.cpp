@@ -96,7 +96,8 @@ void bind_scene_api()
         py::arg("path"),
         py::arg("position") = py::make_tuple(0.0f, 0.0f, 0.0f),
         py::arg("scale")    = 1.0f,
-        "Add a model to the scene");
+        "Add a model to the scene; False if the file does not exist. The "
+        "model loads over the following frames, see get_model_state");
 
     g_scene_module.def(
         "remove_model",
@@ -104,6 +105,33 @@ void bind_scene_api()
         py::arg("index"),
         "Remove a model from the scene");
 
+    g_scene_module.def(
+        "get_model_state",
+        [](int idx) -> std::string
+        {
+            if (idx < 0 ||
+                static_cast<std::size_t>(idx) >= scene::g_models.size())
+            {
+                return "unknown";
+            }
+            const auto& m = scene::g_models[static_cast<std::size_t>(idx)];
+            switch (scene::g_ctx->render_system->get_load_state(m.handle))
+            {
+                case egen::model_load_state::unknown:
+                    break;
+                case egen::model_load_state::loading:
+                    return "loading";
+                case egen::model_load_state::ready:
+                    return "ready";
+                case egen::model_load_state::failed:
+                    return "failed";
+            }
+            return "unknown";
+        },
+        py::arg("index"),
+        "Get model load state: loading, ready, failed or unknown. Models "
+        "that failed leave the scene on the next update");
+
     g_scene_module.def(
         "get_model_count",
         []() { return static_cast<int>(scene::g_models.size()); },
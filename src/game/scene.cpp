@@ -10,6 +10,7 @@
 #include <filesystem>
 #include <numbers>
 #include <ranges>
+#include <unordered_map>
 #include <utility>
 
 namespace scene
@@ -32,6 +33,13 @@ constexpr int key_tab    = 43;
 constexpr int key_space  = 44;
 constexpr int key_grave  = 53;
 
+/// Count scene objects drawing the given model handle
+[[nodiscard]] std::size_t handle_users(egen::model_handle h)
+{
+    return static_cast<std::size_t>(std::ranges::count(
+        g_models, h, [](const model_instance& m) { return m.handle; }));
+}
+
 void setup_scene()
 {
     rebuild_grid();
@@ -197,6 +205,34 @@ void animate(float t, float dt)
     }
 }
 
+/// Pick up models whose loads settled since the last frame; objects whose
+/// model failed to load leave the scene
+void poll_model_loads()
+{
+    for (auto i = g_models.size(); i-- > 0;)
+    {
+        auto& m = g_models[i];
+        if (!m.loading)
+        {
+            continue;
+        }
+        const auto state = g_ctx->render_system->get_load_state(m.handle);
+        if (state == egen::model_load_state::loading)
+        {
+            continue;
+        }
+        if (state == egen::model_load_state::ready)
+        {
+            m.bounds  = g_ctx->render_system->get_bounds(m.handle);
+            m.loading = false;
+            ui::log(2, "Loaded: " + m.name);
+            continue;
+        }
+        ui::log(4, "Failed to load: " + m.name);
+        remove_model(static_cast<int>(i));
+    }
+}
+
 } // namespace
 
 void init(egen::engine_context* ctx)
@@ -252,15 +288,17 @@ void init(egen::engine_context* ctx)
 
 void shutdown()
 {
-    for (auto& m : g_models)
+    // Duplicates share a handle, unload each model once
+    while (!g_models.empty())
     {
-        if (m.handle != egen::invalid_model &&
-            (g_ctx->render_system != nullptr))
+        const auto h = g_models.back().handle;
+        if (h != egen::invalid_model && (g_ctx->render_system != nullptr) &&
+            handle_users(h) == 1)
         {
-            g_ctx->render_system->unload_model(m.handle);
+            g_ctx->render_system->unload_model(h);
         }
+        g_models.pop_back();
     }
-    g_models.clear();
 
     for (auto& a : g_audio)
     {
@@ -304,9 +342,10 @@ void update(egen::engine_context* ctx)
 
     // Stats
     constexpr int history_size = 300;
-    g_frame_times[g_frame_idx] = ctx->time.delta * 1000.0f;
-    g_fps_history[g_frame_idx] = ctx->time.fps;
-    g_frame_idx                = (g_frame_idx + 1) % history_size;
+    g_frame_times[g_frame_idx]   = ctx->time.delta * 1000.0f;
+    g_fps_history[g_frame_idx]   = ctx->time.fps;
+    g_scale_history[g_frame_idx] = ctx->settings->get_render_scale();
+    g_frame_idx                  = (g_frame_idx + 1) % history_size;
 
     // Calculate FPS stats
     g_min_fps     = 999.0f;
@@ -332,6 +371,7 @@ void update(egen::engine_context* ctx)
                                             ? egen::render_mode::wireframe
                                             : egen::render_mode::textured);
 
+    poll_model_loads();
     process_input();
     animate(ctx->time.elapsed, ctx->time.delta);
 }
@@ -480,26 +520,29 @@ model_instance* add_model(const std::string& path,
                           const glm::vec3&   pos,
                           float              scale)
 {
+    // A missing file fails here; everything else once the load settles
     std::filesystem::path model_path(path);
-    auto                  handle = g_ctx->render_system->load_model(model_path);
-    if (handle == egen::invalid_model)
+    if (std::error_code ec; !std::filesystem::is_regular_file(model_path, ec))
     {
         ui::log(4, "Failed to load: " + model_path.filename().string());
         return nullptr;
     }
 
+    // Loads in the background; poll_model_loads() fills in the bounds
+    auto handle = g_ctx->render_system->load_model_async(model_path);
+
     model_instance m;
     m.handle             = handle;
     m.path               = path;
     m.name               = std::filesystem::path(path).stem().string();
-    m.bounds             = g_ctx->render_system->get_bounds(handle);
+    m.loading            = true;
     m.transform.position = pos;
     m.transform.scale    = glm::vec3(scale);
     m.hover_base         = pos.y;
 
     std::string name = m.name; // capture before move
     g_models.push_back(std::move(m));
-    ui::log(2, "Loaded: " + name);
+    ui::log(2, "Loading: " + name);
     return &g_models.back();
 }
 
@@ -509,8 +552,12 @@ void remove_model(int idx)
     {
         return;
     }
-    g_ctx->render_system->unload_model(
-        g_models[static_cast<std::size_t>(idx)].handle);
+    // Keep the model loaded while duplicates still draw it
+    const auto h = g_models[static_cast<std::size_t>(idx)].handle;
+    if (handle_users(h) == 1)
+    {
+        g_ctx->render_system->unload_model(h);
+    }
     g_models.erase(g_models.begin() + idx);
 
     // Update selections - remove deleted index and adjust others
@@ -544,6 +591,41 @@ void remove_model(int idx)
     }
 }
 
+void reload_models()
+{
+    // Instances sharing a handle keep sharing the reloaded one
+    std::unordered_map<egen::model_handle, egen::model_handle> reloaded;
+    for (auto& m : g_models)
+    {
+        auto [it, inserted] = reloaded.try_emplace(m.handle);
+        if (inserted)
+        {
+            g_ctx->render_system->unload_model(m.handle);
+            it->second = g_ctx->render_system->load_model_async(m.path);
+        }
+        m.handle  = it->second;
+        m.loading = true;
+        if (m.occluder)
+        {
+            g_ctx->render_system->set_occluder(m.handle, true);
+        }
+    }
+    ui::log(2, "Reloading " + std::to_string(reloaded.size()) + " models");
+}
+
+void set_occluder(egen::model_handle handle, bool occluder)
+{
+    // The renderer marks the model, so every instance of it follows
+    for (auto& m : g_models)
+    {
+        if (m.handle == handle)
+        {
+            m.occluder = occluder;
+        }
+    }
+    g_ctx->render_system->set_occluder(handle, occluder);
+}
+
 model_instance* duplicate_model(int idx)
 {
     if (idx < 0 || static_cast<std::size_t>(idx) >= g_models.size())
@@ -556,12 +638,14 @@ model_instance* duplicate_model(int idx)
     // Create duplicate with offset position
     glm::vec3 new_pos = src.transform.position + glm::vec3(2.0f, 0.0f, 2.0f);
 
-    model_instance        m;
-    std::filesystem::path model_path(src.path);
-    m.handle             = g_ctx->render_system->load_model(model_path);
+    // Share the source handle so copies batch into instanced draws
+    model_instance m;
+    m.handle             = src.handle;
     m.path               = src.path;
     m.name               = src.name + "_copy";
-    m.bounds             = g_ctx->render_system->get_bounds(m.handle);
+    m.bounds             = src.bounds;
+    m.occluder           = src.occluder;
+    m.loading            = src.loading;
     m.transform          = src.transform;
     m.transform.position = new_pos;
     m.animate            = src.animate;
@@ -597,7 +681,12 @@ void focus_camera_on_object(int idx)
     }
 
     const auto& obj = g_models[static_cast<std::size_t>(idx)];
-    auto&       cam = g_ctx->registry->get<egen::camera_component>(g_camera);
+    if (obj.loading)
+    {
+        ui::log(3, "Still loading: " + obj.name);
+        return; // Bounds are not known yet
+    }
+    auto& cam = g_ctx->registry->get<egen::camera_component>(g_camera);
 
     // Get object position and size
     glm::vec3 obj_pos  = obj.transform.position;
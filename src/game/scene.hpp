@@ -15,6 +15,8 @@ struct model_instance
     std::string        path;
     egen::transform    transform;
     egen::bounds       bounds;
+    bool               occluder    = false; // Same for all of one handle
+    bool               loading     = false; // Bounds unknown until loaded
     bool               animate     = false;
     float              anim_speed  = 25.0f;
     bool               hover       = false;
@@ -63,14 +65,15 @@ inline std::string g_lib_path;
 inline std::size_t g_lib_size = 0;
 
 // Stats
-inline int   g_draw_calls       = 0;
-inline int   g_triangles        = 0;
-inline float g_frame_times[300] = {}; // Extended for better history
-inline float g_fps_history[300] = {}; // FPS tracking
-inline int   g_frame_idx        = 0;
-inline float g_min_fps          = 999.0f;
-inline float g_max_fps          = 0.0f;
-inline float g_avg_fps          = 0.0f;
+inline int   g_draw_calls         = 0;
+inline int   g_triangles          = 0;
+inline float g_frame_times[300]   = {}; // Extended for better history
+inline float g_fps_history[300]   = {}; // FPS tracking
+inline float g_scale_history[300] = {}; // Render scale, for the governor
+inline int   g_frame_idx          = 0;
+inline float g_min_fps            = 999.0f;
+inline float g_max_fps            = 0.0f;
+inline float g_avg_fps            = 0.0f;
 
 void init(egen::engine_context* ctx);
 void shutdown();
@@ -85,6 +88,8 @@ model_instance* add_model(const std::string& path,
                           float              scale = 0.1f);
 void            remove_model(int idx);
 model_instance* duplicate_model(int idx);
+void            reload_models();
+void            set_occluder(egen::model_handle handle, bool occluder);
 void            focus_camera_on_object(int idx);
 void            teleport_object_to_camera(int idx);
 void            apply_sky();
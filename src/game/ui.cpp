@@ -114,8 +114,7 @@ void load_gltf_glb_scene(const std::filesystem::path& path)
     // Engine's glTF loader handles hierarchy and transforms internally
     if (auto* m = scene::add_model(path.string(), { 0.0f, 0.0f, 0.0f }, 1.0f))
     {
-        m->name = path.stem().string();
-        log(2, "Successfully loaded " + file_type + " scene: " + filename);
+        m->name = path.stem().string(); // Logged once the load settles
         g_show_file_dialog = false;
         g_file_dialog_selected_file.clear();
     }
@@ -708,6 +707,21 @@ void draw_inspector()
                 }
             }
 
+            // Let the renderer cull what this model hides
+            bool occluder = m.occluder;
+            if (ImGui::Checkbox("Occluder", &occluder) &&
+                scene::g_ctx->render_system != nullptr)
+            {
+                scene::set_occluder(m.handle, occluder);
+            }
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::SetTooltip("Rasterize a coarse copy of this model on "
+                                  "the CPU and skip draws hidden behind it. "
+                                  "Applies to every copy of the model. "
+                                  "Best for large, solid models.");
+            }
+
             // Color tint (especially for duck)
             if (m.name.find("duck") != std::string::npos || m.name == "duck")
             {
@@ -1271,6 +1285,48 @@ void draw_engine(egen::engine_context* ctx)
                               "quarter, 1.0x = native, 4.0x = supersampling)");
         }
 
+        // Dynamic resolution governor
+        auto dynamic         = ctx->settings->get_dynamic_resolution();
+        bool dynamic_changed = ImGui::Checkbox("Dynamic Resolution",
+                                               &dynamic.enabled);
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Adjust the render scale every frame to keep "
+                              "frame time within the budget");
+        }
+        if (dynamic.enabled)
+        {
+            dynamic_changed |= ImGui::SliderFloat(
+                "Frame Budget", &dynamic.target_ms, 4.0f, 50.0f, "%.1f ms");
+            dynamic_changed |= ImGui::DragFloatRange2("Scale Range",
+                                                      &dynamic.min_scale,
+                                                      &dynamic.max_scale,
+                                                      0.01f,
+                                                      0.25f,
+                                                      2.0f,
+                                                      "%.2fx");
+            dynamic_changed |= ImGui::SliderFloat(
+                "Max Step", &dynamic.step, 0.005f, 0.2f, "%.3f");
+            dynamic_changed |= ImGui::SliderFloat(
+                "Hysteresis", &dynamic.hysteresis, 0.0f, 0.25f, "%.2f");
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::SetTooltip("Frame time error, as a fraction of the "
+                                  "budget, that leaves the scale alone");
+            }
+
+            const auto state = ctx->settings->get_dynamic_resolution_state();
+            ImGui::Text("%.2fx  %.2f ms  err %+.3f  int %+.2f",
+                        state.scale,
+                        state.frame_ms,
+                        state.error,
+                        state.integral);
+        }
+        if (dynamic_changed)
+        {
+            ctx->settings->set_dynamic_resolution(dynamic);
+        }
+
         // Texture Quality
         ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.55f, 0.55f, 0.58f, 1.0f));
         ImGui::Text("Texture Filtering");
@@ -1412,6 +1468,110 @@ void draw_engine(egen::engine_context* ctx)
                               "beyond this distance are not rendered.");
         }
 
+        bool frustum_culling = ctx->settings->is_frustum_culling_enabled();
+        if (ImGui::Checkbox("Frustum Culling", &frustum_culling))
+        {
+            ctx->settings->set_frustum_culling(frustum_culling);
+        }
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Skip models and meshes whose bounds are "
+                              "outside the camera view");
+        }
+
+        bool occlusion_culling = ctx->settings->is_occlusion_culling_enabled();
+        if (ImGui::Checkbox("Occlusion Culling", &occlusion_culling))
+        {
+            ctx->settings->set_occlusion_culling(occlusion_culling);
+        }
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Skip models and meshes hidden behind objects "
+                              "marked as occluders in the inspector");
+        }
+
+        bool depth_prepass = ctx->settings->is_depth_prepass_enabled();
+        if (ImGui::Checkbox("Depth Pre-pass", &depth_prepass))
+        {
+            ctx->settings->set_depth_prepass(depth_prepass);
+        }
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Draw opaque depth first so hidden fragments "
+                              "are never shaded; compare frame times");
+        }
+
+        float lod_bias = ctx->settings->get_lod_bias();
+        if (ImGui::SliderFloat("LOD Bias", &lod_bias, -2.0f, 4.0f, "%.1f"))
+        {
+            ctx->settings->set_lod_bias(lod_bias);
+        }
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Switch to simplified meshes closer to the "
+                              "camera (positive) or further away (negative)");
+        }
+
+        int texture_budget =
+            static_cast<int>(ctx->settings->get_texture_budget_mb());
+        if (ImGui::SliderInt(
+                "Texture Budget", &texture_budget, 256, 8192, "%d MB"))
+        {
+            ctx->settings->set_texture_budget_mb(
+                static_cast<std::uint32_t>(texture_budget));
+        }
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("GPU memory for streamed texture mips; over "
+                              "it, textures not seen lately lose detail");
+        }
+
+        // Load options only affect models loaded afterwards, so changing
+        // them is followed by a reload to compare
+        ImGui::Spacing();
+        ImGui::TextDisabled("Model Loading");
+        auto load    = ctx->settings->get_load_options();
+        bool changed = false;
+        bool lods    = load.lod_levels > 0;
+
+        changed |= ImGui::Checkbox("Optimize Meshes", &load.optimize_meshes);
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Reorder triangles and vertices for the "
+                              "vertex cache and fetch locality");
+        }
+        changed |=
+            ImGui::Checkbox("Split Large Meshes", &load.split_large_meshes);
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Split meshes over 65536 vertices so they "
+                              "can use 16-bit indices");
+        }
+        changed |=
+            ImGui::Checkbox("Quantize Vertices", &load.quantize_vertices);
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Upload 16-byte packed vertices instead of "
+                              "32-byte floats where they fit");
+        }
+        if (ImGui::Checkbox("Generate LODs", &lods))
+        {
+            load.lod_levels = lods ? 4 : 0;
+            changed         = true;
+        }
+        changed |= ImGui::Checkbox("Pack Textures", &load.pack_textures);
+        changed |=
+            ImGui::Checkbox("Compress Textures", &load.compress_textures);
+        changed |= ImGui::Checkbox("Stream Textures", &load.stream_textures);
+        if (changed)
+        {
+            ctx->settings->set_load_options(load);
+        }
+        if (ImGui::Button("Reload Models", ImVec2(-1, 0)))
+        {
+            scene::reload_models();
+        }
+
         ImGui::Spacing();
 
         // Post-Processing settings
@@ -1696,6 +1856,142 @@ void draw_stats(egen::engine_context* ctx)
             ImGui::TableNextColumn();
             ImGui::Text("%zu", scene::g_models.size());
 
+            // Culled by the renderer this frame
+            if (ctx->render_system != nullptr)
+            {
+                const auto stats = ctx->render_system->get_stats();
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextColored(ImVec4(0.55f, 0.55f, 0.58f, 1.0f),
+                                   "Culled:");
+                ImGui::TableNextColumn();
+                ImGui::Text("%u models / %u meshes",
+                            stats.models_culled,
+                            stats.meshes_culled);
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextColored(ImVec4(0.55f, 0.55f, 0.58f, 1.0f),
+                                   "Reduced LOD:");
+                ImGui::TableNextColumn();
+                ImGui::Text("%u meshes", stats.meshes_lod);
+
+                // Hidden behind occluders in the software depth buffer
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextColored(ImVec4(0.55f, 0.55f, 0.58f, 1.0f),
+                                   "Occluded:");
+                ImGui::TableNextColumn();
+                ImGui::Text("%u models / %u meshes",
+                            stats.models_occluded,
+                            stats.meshes_occluded);
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextColored(ImVec4(0.55f, 0.55f, 0.58f, 1.0f),
+                                   "Occluders:");
+                ImGui::TableNextColumn();
+                ImGui::Text("%u (%u tris)  %.2f ms",
+                            stats.occluders,
+                            stats.occluder_triangles,
+                            stats.occlusion_ms);
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextColored(ImVec4(0.55f, 0.55f, 0.58f, 1.0f),
+                                   "Pre-pass:");
+                ImGui::TableNextColumn();
+                ImGui::Text("%u draws (%u tris)  %.2f ms",
+                            stats.prepass_draw_calls,
+                            stats.prepass_triangles,
+                            stats.prepass_ms);
+
+                // Redundant state changes skipped by the sorted draw queue
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextColored(ImVec4(0.55f, 0.55f, 0.58f, 1.0f),
+                                   "Binds Saved:");
+                ImGui::TableNextColumn();
+                ImGui::Text("pso %u  tex %u  buf %u",
+                            stats.pipeline_binds_saved,
+                            stats.texture_binds_saved,
+                            stats.buffer_binds_saved);
+
+                // Small textures sharing a binding through array layers
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextColored(ImVec4(0.55f, 0.55f, 0.58f, 1.0f),
+                                   "Tex Arrays:");
+                ImGui::TableNextColumn();
+                ImGui::Text("%u textures in %u arrays",
+                            stats.textures_packed,
+                            stats.texture_arrays);
+
+                // Streamed texture levels against what draws asked for
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextColored(ImVec4(0.55f, 0.55f, 0.58f, 1.0f),
+                                   "Tex Stream:");
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f / %.1f MB, %u textures",
+                            static_cast<double>(stats.texture_resident_kb) /
+                                1024.0,
+                            static_cast<double>(stats.texture_requested_kb) /
+                                1024.0,
+                            stats.textures_streamed);
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextColored(ImVec4(0.55f, 0.55f, 0.58f, 1.0f),
+                                   "Instanced:");
+                ImGui::TableNextColumn();
+                ImGui::Text("%u draws / %u instances",
+                            stats.instanced_draws,
+                            stats.instances);
+
+                // Model draws culled and recorded across worker threads
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextColored(ImVec4(0.55f, 0.55f, 0.58f, 1.0f),
+                                   "Frame Prep:");
+                ImGui::TableNextColumn();
+                ImGui::Text("%u threads  max %.2f ms  sum %.2f ms",
+                            stats.prep_workers,
+                            stats.prep_ms_max,
+                            stats.prep_ms_total);
+
+                // Shared mesh buffer usage and free-list fragmentation
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextColored(ImVec4(0.55f, 0.55f, 0.58f, 1.0f),
+                                   "Mesh Arena:");
+                ImGui::TableNextColumn();
+                ImGui::Text("%u / %u KB  frag %.0f%% (%u holes)",
+                            stats.arena_used_kb,
+                            stats.arena_capacity_kb,
+                            stats.arena_fragmentation * 100.0f,
+                            stats.arena_free_blocks);
+
+                // Staging ring traffic this frame
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextColored(ImVec4(0.55f, 0.55f, 0.58f, 1.0f),
+                                   "Uploads:");
+                ImGui::TableNextColumn();
+                ImGui::Text("%u KB in %u submits",
+                            stats.upload_kb,
+                            stats.upload_submits);
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextColored(ImVec4(0.55f, 0.55f, 0.58f, 1.0f),
+                                   "Debug Lines:");
+                ImGui::TableNextColumn();
+                ImGui::Text("%u (%u dropped)",
+                            stats.debug_lines,
+                            stats.debug_lines_dropped);
+            }
+
             // Resolution
             ImGui::TableNextRow();
             ImGui::TableNextColumn();
@@ -1773,6 +2069,35 @@ void draw_stats(egen::engine_context* ctx)
             ImPlot::EndPlot();
         }
 
+        // Render scale chosen by the dynamic resolution governor
+        if (ctx->settings->get_dynamic_resolution().enabled &&
+            ImPlot::BeginPlot("Render Scale History",
+                              ImVec2(-1, 120),
+                              ImPlotFlags_NoTitle | ImPlotFlags_NoMenus |
+                                  ImPlotFlags_NoBoxSelect |
+                                  ImPlotFlags_NoLegend))
+        {
+            ImPlot::SetupAxes(
+                nullptr,
+                "Scale",
+                ImPlotAxisFlags_NoLabel | ImPlotAxisFlags_NoTickLabels,
+                ImPlotAxisFlags_None);
+            ImPlot::SetupAxisLimits(ImAxis_X1, 0, size, ImGuiCond_Always);
+            ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, 2.0, ImGuiCond_Once);
+            ImPlot::SetupAxisFormat(ImAxis_Y1, "%.2fx");
+
+            ImPlot::SetNextLineStyle(ImVec4(0.38f, 0.68f, 0.93f, 1.0f), 2.0f);
+            ImPlot::PlotLine("Scale",
+                             scene::g_scale_history,
+                             size,
+                             1.0,
+                             0.0,
+                             ImPlotLineFlags_None,
+                             idx);
+
+            ImPlot::EndPlot();
+        }
+
 #ifdef TRACY_ENABLE
         ImGui::Spacing();
         ImGui::Separator();